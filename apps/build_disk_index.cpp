@@ -21,6 +21,8 @@ int main(int argc, char **argv)
     float B, M;
     bool append_reorder_data = false;
     bool use_opq = false;
+    bool reorder_layout = false;
+    bool kmeans_parallel = false;
 
     po::options_description desc{
         program_options_utils::make_program_description("build_disk_index", "Build a disk-based index.")};
@@ -63,6 +65,13 @@ int main(int argc, char **argv)
         optional_configs.add_options()("append_reorder_data", po::bool_switch()->default_value(false),
                                        "Include full precision data in the index. Use only in "
                                        "conjuction with compressed data on SSD.");
+        optional_configs.add_options()("reorder_layout", po::bool_switch(&reorder_layout)->default_value(false),
+                                       "Order nodes on disk so that graph neighbours share sectors. Helps when "
+                                       "several nodes fit in a sector.");
+        optional_configs.add_options()("kmeans_parallel", po::bool_switch(&kmeans_parallel)->default_value(false),
+                                       "Seed the k-means of the partitioning and PQ training with k-means|| instead "
+                                       "of k-means++. Faster on many cores with an optimized BLAS, and avoids the "
+                                       "random seeding k-means++ falls back to above 8388608 points.");
         optional_configs.add_options()("build_PQ_bytes", po::value<uint32_t>(&build_PQ)->default_value(0),
                                        program_options_utils::BUIlD_GRAPH_PQ_BYTES);
         optional_configs.add_options()("use_opq", po::bool_switch()->default_value(false),
@@ -137,7 +146,9 @@ int main(int argc, char **argv)
                          std::string(std::to_string(B)) + " " + std::string(std::to_string(M)) + " " +
                          std::string(std::to_string(num_threads)) + " " + std::string(std::to_string(disk_PQ)) + " " +
                          std::string(std::to_string(append_reorder_data)) + " " +
-                         std::string(std::to_string(build_PQ)) + " " + std::string(std::to_string(QD));
+                         std::string(std::to_string(build_PQ)) + " " + std::string(std::to_string(QD)) + " " +
+                         std::string(std::to_string(reorder_layout)) + " " +
+                         std::string(std::to_string(kmeans_parallel));
 
     try
     {
@@ -27,7 +27,7 @@ int main(int argc, char **argv)
     std::string data_type, dist_fn, data_path, index_path_prefix, label_file, universal_label, label_type;
     uint32_t num_threads, R, L, Lf, build_PQ_bytes;
     float alpha;
-    bool use_pq_build, use_opq;
+    bool use_pq_build, use_opq, flat_graph;
 
     po::options_description desc{
         program_options_utils::make_program_description("build_memory_index", "Build a memory-based DiskANN index.")};
@@ -70,6 +70,8 @@ int main(int argc, char **argv)
                                        program_options_utils::FILTERED_LBUILD);
         optional_configs.add_options()("label_type", po::value<std::string>(&label_type)->default_value("uint"),
                                        program_options_utils::LABEL_TYPE_DESCRIPTION);
+        optional_configs.add_options()("flat_graph", po::bool_switch(&flat_graph)->default_value(false),
+                                       program_options_utils::FLAT_GRAPH_DESCRIPTION);
 
         // Merge required and optional parameters
         desc.add(required_configs).add(optional_configs);
@@ -137,7 +139,8 @@ int main(int argc, char **argv)
                           .with_dimension(data_dim)
                           .with_max_points(data_num)
                           .with_data_load_store_strategy(diskann::DataStoreStrategy::MEMORY)
-                          .with_graph_load_store_strategy(diskann::GraphStoreStrategy::MEMORY)
+                          .with_graph_load_store_strategy(flat_graph ? diskann::GraphStoreStrategy::FLAT
+                                                                     : diskann::GraphStoreStrategy::MEMORY)
                           .with_data_type(data_type)
                           .with_label_type(label_type)
                           .is_dynamic_index(false)
@@ -17,14 +17,16 @@ namespace po = boost::program_options;
 std::unique_ptr<Server> g_httpServer(nullptr);
 std::vector<std::unique_ptr<diskann::BaseSearch>> g_inMemorySearch;
 
-void setup(const utility::string_t &address, const std::string &typestring)
+void setup(const utility::string_t &address, const std::string &typestring, const uint32_t max_batch_size,
+           const uint32_t batch_window_us)
 {
     web::http::uri_builder uriBldr(address);
     auto uri = uriBldr.to_uri();
 
     std::cout << "Attempting to start server on " << uri.to_string() << std::endl;
 
-    g_httpServer = std::unique_ptr<Server>(new Server(uri, g_inMemorySearch, typestring));
+    g_httpServer =
+        std::unique_ptr<Server>(new Server(uri, g_inMemorySearch, typestring, max_batch_size, batch_window_us));
     std::cout << "Created a server object" << std::endl;
 
     g_httpServer->open().wait();
@@ -40,6 +42,7 @@ int main(int argc, char *argv[])
 {
     std::string data_type, index_file, data_file, address, dist_fn, tags_file;
     uint32_t num_threads;
+    uint32_t max_batch_size, batch_window_us;
     uint32_t l_search;
 
     po::options_description desc{"Arguments"};
@@ -59,6 +62,13 @@ int main(int argc, char *argv[])
                            "distance function <l2/mips>");
         desc.add_options()("tags_file", po::value<std::string>(&tags_file)->default_value(std::string()),
                            "Tags file location");
+        desc.add_options()("max_batch_size",
+                           po::value<uint32_t>(&max_batch_size)->default_value(DEFAULT_MAX_BATCH_SIZE),
+                           "Most concurrent requests each index searches as one batch");
+        desc.add_options()("batch_window_us",
+                           po::value<uint32_t>(&batch_window_us)->default_value(DEFAULT_BATCH_WINDOW_US),
+                           "Microseconds a request may wait for others to batch with (default 0: batch only "
+                           "requests that queued while the previous batch was searched)");
         po::variables_map vm;
         po::store(po::parse_command_line(argc, argv, desc), vm);
         if (vm.count("help"))
@@ -111,7 +121,7 @@ int main(int argc, char *argv[])
     {
         try
         {
-            setup(address, data_type);
+            setup(address, data_type, max_batch_size, batch_window_us);
             std::cout << "Type 'exit' (case-sensitive) to exit" << std::endl;
             std::string line;
             std::getline(std::cin, line);
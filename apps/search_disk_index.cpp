@@ -10,6 +10,8 @@
 #include "memory_mapper.h"
 #include "partition.h"
 #include "pq_flash_index.h"
+#include "huge_page_allocator.h"
+#include "numa_utils.h"
 #include "timer.h"
 #include "percentile_stats.h"
 #include "program_options_utils.hpp"
@@ -19,6 +21,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include "linux_aligned_file_reader.h"
+#ifdef USE_IO_URING
+#include "io_uring_aligned_file_reader.h"
+#endif
 #else
 #ifdef USE_BING_INFRA
 #include "bing_aligned_file_reader.h"
@@ -53,7 +58,12 @@ int search_disk_index(diskann::Metric &metric, const std::string &index_path_pre
                       const uint32_t num_threads, const uint32_t recall_at, const uint32_t beamwidth,
                       const uint32_t num_nodes_to_cache, const uint32_t search_io_limit,
                       const std::vector<uint32_t> &Lvec, const float fail_if_recall_below,
-                      const std::vector<std::string> &query_filters, const bool use_reorder_data = false)
+                      const std::vector<std::string> &query_filters, const bool use_reorder_data = false,
+                      const bool use_pipelined_search = false, const bool use_io_uring = false,
+                      const uint32_t queries_per_thread = 1, const uint32_t dynamic_cache_mb = 0,
+                      const diskann::VisitedSetType visited_set_type = diskann::VisitedSetType::AUTO,
+                      const float filter_brute_force_threshold = diskann::defaults::FILTER_BRUTE_FORCE_SELECTIVITY,
+                      const uint32_t adaptive_stable_hops = 0, const bool numa = false)
 {
     diskann::cout << "Search parameters: #threads: " << num_threads << ", ";
     if (beamwidth <= 0)
@@ -86,6 +96,11 @@ int search_disk_index(diskann::Metric &metric, const std::string &index_path_pre
             return -1; // To return -1 or some other error handling?
         }
     }
+    if (queries_per_thread > 1 && (filtered_search || use_reorder_data))
+    {
+        std::cerr << "WARNING: queries_per_thread is ignored for " << (filtered_search ? "filtered" : "reordered")
+                  << " search; each thread searches one query at a time." << std::endl;
+    }
 
     bool calc_recall_flag = false;
     if (gt_file != std::string("null") && gt_file != std::string("NULL") && file_exists(gt_file))
@@ -106,18 +121,34 @@ int search_disk_index(diskann::Metric &metric, const std::string &index_path_pre
     reader.reset(new diskann::BingAlignedFileReader());
 #endif
 #else
+#ifdef USE_IO_URING
+    if (use_io_uring)
+        reader.reset(new IoUringAlignedFileReader());
+    else
+        reader.reset(new LinuxAlignedFileReader());
+#else
+    if (use_io_uring)
+    {
+        diskann::cerr << "Not built with io_uring support (configure with -DIO_URING=ON)." << std::endl;
+        return -1;
+    }
     reader.reset(new LinuxAlignedFileReader());
+#endif
 #endif
 
     std::unique_ptr<diskann::PQFlashIndex<T, LabelT>> _pFlashIndex(
         new diskann::PQFlashIndex<T, LabelT>(reader, metric));
 
+    _pFlashIndex->set_visited_set_type(visited_set_type);
     int res = _pFlashIndex->load(num_threads, index_path_prefix.c_str());
 
     if (res != 0)
     {
         return res;
     }
+    _pFlashIndex->set_pipelined_search(use_pipelined_search);
+    _pFlashIndex->set_filter_brute_force_threshold(filter_brute_force_threshold);
+    _pFlashIndex->set_adaptive_search(adaptive_stable_hops);
 
     std::vector<uint32_t> node_list;
     diskann::cout << "Caching " << num_nodes_to_cache << " nodes around medoid(s)" << std::endl;
@@ -126,10 +157,21 @@ int search_disk_index(diskann::Metric &metric, const std::string &index_path_pre
     //     _pFlashIndex->generate_cache_list_from_sample_queries(warmup_query_file, 15, 6, num_nodes_to_cache,
     //     num_threads, node_list);
     _pFlashIndex->load_cache_list(node_list);
+    if (numa)
+        _pFlashIndex->replicate_for_numa();
+    if (diskann::get_huge_page_mode() != diskann::HugePageMode::NONE)
+    {
+        diskann::AllocatorStats alloc_stats = diskann::get_allocator_stats();
+        diskann::cout << "Large buffers: " << alloc_stats.n_allocations << " using " << (alloc_stats.bytes >> 20)
+                      << " MB, " << (alloc_stats.huge_page_bytes >> 20) << " MB of it on hugepages" << std::endl;
+    }
+    _pFlashIndex->enable_dynamic_cache((uint64_t)dynamic_cache_mb * 1024 * 1024);
     node_list.clear();
     node_list.shrink_to_fit();
 
     omp_set_num_threads(num_threads);
+    if (numa && !diskann::pin_omp_threads_to_numa_nodes(num_threads))
+        diskann::cout << "Could not pin search threads to NUMA nodes" << std::endl;
 
     uint64_t warmup_L = 20;
     uint64_t warmup_num = 0, warmup_dim = 0, warmup_aligned_dim = 0;
@@ -224,31 +266,52 @@ int search_disk_index(diskann::Metric &metric, const std::string &index_path_pre
         std::vector<uint64_t> query_result_ids_64(recall_at * query_num);
         auto s = std::chrono::high_resolution_clock::now();
 
-#pragma omp parallel for schedule(dynamic, 1)
-        for (int64_t i = 0; i < (int64_t)query_num; i++)
+        if (queries_per_thread > 1 && !filtered_search && !use_reorder_data)
         {
-            if (!filtered_search)
+            // each thread multiplexes a contiguous chunk of queries over its own IO context
+            int64_t chunk_size = DIV_ROUND_UP(query_num, num_threads);
+#pragma omp parallel for schedule(dynamic, 1)
+            for (int64_t chunk_start = 0; chunk_start < (int64_t)query_num; chunk_start += chunk_size)
             {
-                _pFlashIndex->cached_beam_search(query + (i * query_aligned_dim), recall_at, L,
-                                                 query_result_ids_64.data() + (i * recall_at),
-                                                 query_result_dists[test_id].data() + (i * recall_at),
-                                                 optimized_beamwidth, use_reorder_data, stats + i);
+                uint64_t chunk_num = (std::min)((uint64_t)chunk_size, (uint64_t)(query_num - chunk_start));
+                _pFlashIndex->multiplexed_beam_search(query + (chunk_start * query_aligned_dim), chunk_num,
+                                                      query_aligned_dim, recall_at, L,
+                                                      query_result_ids_64.data() + (chunk_start * recall_at),
+                                                      query_result_dists[test_id].data() + (chunk_start * recall_at),
+                                                      optimized_beamwidth, search_io_limit, queries_per_thread,
+                                                      stats + chunk_start);
             }
-            else
+        }
+        else
+        {
+#pragma omp parallel for schedule(dynamic, 1)
+            for (int64_t i = 0; i < (int64_t)query_num; i++)
             {
-                LabelT label_for_search;
-                if (query_filters.size() == 1)
-                { // one label for all queries
-                    label_for_search = _pFlashIndex->get_converted_label(query_filters[0]);
+                if (!filtered_search)
+                {
+                    _pFlashIndex->cached_beam_search(query + (i * query_aligned_dim), recall_at, L,
+                                                     query_result_ids_64.data() + (i * recall_at),
+                                                     query_result_dists[test_id].data() + (i * recall_at),
+                                                     optimized_beamwidth, search_io_limit, use_reorder_data,
+                                                     stats + i);
                 }
                 else
-                { // one label for each query
-                    label_for_search = _pFlashIndex->get_converted_label(query_filters[i]);
+                {
+                    diskann::LabelFilter<LabelT> filter_for_search;
+                    if (query_filters.size() == 1)
+                    { // one filter for all queries
+                        filter_for_search = _pFlashIndex->get_converted_filter(query_filters[0]);
+                    }
+                    else
+                    { // one filter for each query
+                        filter_for_search = _pFlashIndex->get_converted_filter(query_filters[i]);
+                    }
+                    _pFlashIndex->cached_beam_search(query + (i * query_aligned_dim), recall_at, L,
+                                                     query_result_ids_64.data() + (i * recall_at),
+                                                     query_result_dists[test_id].data() + (i * recall_at),
+                                                     optimized_beamwidth, filter_for_search, search_io_limit,
+                                                     use_reorder_data, stats + i);
                 }
-                _pFlashIndex->cached_beam_search(
-                    query + (i * query_aligned_dim), recall_at, L, query_result_ids_64.data() + (i * recall_at),
-                    query_result_dists[test_id].data() + (i * recall_at), optimized_beamwidth, true, label_for_search,
-                    use_reorder_data, stats + i);
             }
         }
         auto e = std::chrono::high_resolution_clock::now();
@@ -290,6 +353,27 @@ int search_disk_index(diskann::Metric &metric, const std::string &index_path_pre
         }
         else
             diskann::cout << std::endl;
+        if (dynamic_cache_mb > 0)
+        {
+            auto mean_dyn_hits = diskann::get_mean_stats<uint32_t>(
+                stats, query_num, [](const diskann::QueryStats &stats) { return stats.n_dyn_cache_hits; });
+            auto mean_dyn_misses = diskann::get_mean_stats<uint32_t>(
+                stats, query_num, [](const diskann::QueryStats &stats) { return stats.n_dyn_cache_misses; });
+            diskann::cout << "       dynamic cache: " << mean_dyn_hits << " hits, " << mean_dyn_misses
+                          << " misses per query" << std::endl;
+        }
+        if (adaptive_stable_hops > 0)
+        {
+            uint64_t n_stopped_early = 0;
+            for (uint64_t i = 0; i < query_num; i++)
+                if (stats[i].stop_reason == diskann::SearchStopReason::TOP_K_STABLE)
+                    n_stopped_early++;
+            auto mean_beam_width = diskann::get_mean_stats<uint32_t>(
+                stats, query_num, [](const diskann::QueryStats &stats) { return stats.beam_width; });
+            diskann::cout << "       adaptive search: " << (100.0 * n_stopped_early) / query_num
+                          << "% of queries stopped early, final beamwidth " << mean_beam_width << " on average"
+                          << std::endl;
+        }
         delete[] stats;
     }
 
@@ -316,11 +400,18 @@ int search_disk_index(diskann::Metric &metric, const std::string &index_path_pre
 int main(int argc, char **argv)
 {
     std::string data_type, dist_fn, index_path_prefix, result_path_prefix, query_file, gt_file, filter_label,
-        label_type, query_filters_file;
+        label_type, query_filters_file, visited_set, huge_pages;
     uint32_t num_threads, K, W, num_nodes_to_cache, search_io_limit;
     std::vector<uint32_t> Lvec;
     bool use_reorder_data = false;
+    bool use_pipelined_search = false;
+    bool use_io_uring = false;
+    bool numa = false;
+    uint32_t queries_per_thread = 1;
+    uint32_t dynamic_cache_mb = 0;
     float fail_if_recall_below = 0.0f;
+    float filter_brute_force_threshold = diskann::defaults::FILTER_BRUTE_FORCE_SELECTIVITY;
+    uint32_t adaptive_stable_hops = 0;
 
     po::options_description desc{
         program_options_utils::make_program_description("search_disk_index", "Searches on-disk DiskANN indexes")};
@@ -364,9 +455,45 @@ int main(int argc, char **argv)
         optional_configs.add_options()("use_reorder_data", po::bool_switch()->default_value(false),
                                        "Include full precision data in the index. Use only in "
                                        "conjuction with compressed data on SSD.  Default value: false");
+        optional_configs.add_options()("pipelined_search", po::bool_switch(&use_pipelined_search)->default_value(false),
+                                       "Keep beamwidth reads in flight and expand nodes as their reads complete "
+                                       "instead of waiting for the whole beam.  Default value: false");
+        optional_configs.add_options()("use_io_uring", po::bool_switch(&use_io_uring)->default_value(false),
+                                       "Read the index with io_uring instead of libaio (Linux builds with "
+                                       "-DIO_URING=ON).  Default value: false");
+        optional_configs.add_options()("queries_per_thread", po::value<uint32_t>(&queries_per_thread)->default_value(1),
+                                       "Number of queries each thread keeps in flight at once, overlapping their "
+                                       "reads. Values above 1 need an asynchronous reader and are ignored for "
+                                       "filtered or reordered search.  Default value: 1");
+        optional_configs.add_options()("dynamic_cache_mb", po::value<uint32_t>(&dynamic_cache_mb)->default_value(0),
+                                       "Memory budget (MB) for an adaptive cache of nodes read during search, in "
+                                       "addition to num_nodes_to_cache.  Default value: 0 (disabled)");
+        optional_configs.add_options()("huge_pages", po::value<std::string>(&huge_pages)->default_value("none"),
+                                       "Page size for the large index and scratch buffers: none, transparent, "
+                                       "2mb or 1gb (explicit hugepages, which must be reserved beforehand).  "
+                                       "Default value: none");
+        optional_configs.add_options()("numa", po::bool_switch(&numa)->default_value(false),
+                                       "Pin search threads round-robin to NUMA nodes and give each node its own "
+                                       "copy of the PQ codes and node cache.  Default value: false");
+        optional_configs.add_options()("visited_set", po::value<std::string>(&visited_set)->default_value("auto"),
+                                       "How searches track visited nodes: auto, hash, epoch (per-thread tag "
+                                       "array, fastest) or bloom (fixed-size filter for very large indexes, may skip "
+                                       "a few nodes).  Default value: auto");
         optional_configs.add_options()("filter_label",
                                        po::value<std::string>(&filter_label)->default_value(std::string("")),
                                        program_options_utils::FILTER_LABEL_DESCRIPTION);
+        optional_configs.add_options()(
+            "filter_brute_force_threshold",
+            po::value<float>(&filter_brute_force_threshold)
+                ->default_value(diskann::defaults::FILTER_BRUTE_FORCE_SELECTIVITY),
+            "Filters that at most this fraction of the points can match are answered by scanning those points "
+            "instead of the graph; 0 disables the scan.  Filters may join labels with '&' (all must match) or '|' "
+            "(any may match), but not both.  Default value: 0.001");
+        optional_configs.add_options()(
+            "adaptive_stable_hops", po::value<uint32_t>(&adaptive_stable_hops)->default_value(0),
+            "Adaptive search: start at the given beamwidth, widen it each hop that leaves the top K unchanged, and "
+            "stop once the top K has held for this many hops.  Ignored with pipelined_search.  Default value: 0 "
+            "(disabled)");
         optional_configs.add_options()("query_filters_file",
                                        po::value<std::string>(&query_filters_file)->default_value(std::string("")),
                                        program_options_utils::FILTERS_FILE_DESCRIPTION);
@@ -437,6 +564,27 @@ int main(int argc, char **argv)
         return -1;
     }
 
+    try
+    {
+        diskann::set_huge_page_mode(diskann::get_huge_page_mode(huge_pages));
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return -1;
+    }
+
+    diskann::VisitedSetType visited_set_type;
+    try
+    {
+        visited_set_type = diskann::get_visited_set_type(visited_set);
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return -1;
+    }
+
     std::vector<std::string> query_filters;
     if (filter_label != "")
     {
@@ -454,15 +602,21 @@ int main(int argc, char **argv)
             if (data_type == std::string("float"))
                 return search_disk_index<float, uint16_t>(
                     metric, index_path_prefix, result_path_prefix, query_file, gt_file, num_threads, K, W,
-                    num_nodes_to_cache, search_io_limit, Lvec, fail_if_recall_below, query_filters, use_reorder_data);
+                    num_nodes_to_cache, search_io_limit, Lvec, fail_if_recall_below, query_filters, use_reorder_data,
+                    use_pipelined_search, use_io_uring, queries_per_thread, dynamic_cache_mb, visited_set_type,
+                    filter_brute_force_threshold, adaptive_stable_hops, numa);
             else if (data_type == std::string("int8"))
                 return search_disk_index<int8_t, uint16_t>(
                     metric, index_path_prefix, result_path_prefix, query_file, gt_file, num_threads, K, W,
-                    num_nodes_to_cache, search_io_limit, Lvec, fail_if_recall_below, query_filters, use_reorder_data);
+                    num_nodes_to_cache, search_io_limit, Lvec, fail_if_recall_below, query_filters, use_reorder_data,
+                    use_pipelined_search, use_io_uring, queries_per_thread, dynamic_cache_mb, visited_set_type,
+                    filter_brute_force_threshold, adaptive_stable_hops, numa);
             else if (data_type == std::string("uint8"))
                 return search_disk_index<uint8_t, uint16_t>(
                     metric, index_path_prefix, result_path_prefix, query_file, gt_file, num_threads, K, W,
-                    num_nodes_to_cache, search_io_limit, Lvec, fail_if_recall_below, query_filters, use_reorder_data);
+                    num_nodes_to_cache, search_io_limit, Lvec, fail_if_recall_below, query_filters, use_reorder_data,
+                    use_pipelined_search, use_io_uring, queries_per_thread, dynamic_cache_mb, visited_set_type,
+                    filter_brute_force_threshold, adaptive_stable_hops, numa);
             else
             {
                 std::cerr << "Unsupported data type. Use float or int8 or uint8" << std::endl;
@@ -474,15 +628,24 @@ int main(int argc, char **argv)
             if (data_type == std::string("float"))
                 return search_disk_index<float>(metric, index_path_prefix, result_path_prefix, query_file, gt_file,
                                                 num_threads, K, W, num_nodes_to_cache, search_io_limit, Lvec,
-                                                fail_if_recall_below, query_filters, use_reorder_data);
+                                                fail_if_recall_below, query_filters, use_reorder_data,
+                                                use_pipelined_search, use_io_uring, queries_per_thread,
+                                                dynamic_cache_mb, visited_set_type, filter_brute_force_threshold,
+                                                adaptive_stable_hops, numa);
             else if (data_type == std::string("int8"))
                 return search_disk_index<int8_t>(metric, index_path_prefix, result_path_prefix, query_file, gt_file,
                                                  num_threads, K, W, num_nodes_to_cache, search_io_limit, Lvec,
-                                                 fail_if_recall_below, query_filters, use_reorder_data);
+                                                 fail_if_recall_below, query_filters, use_reorder_data,
+                                                 use_pipelined_search, use_io_uring, queries_per_thread,
+                                                 dynamic_cache_mb, visited_set_type, filter_brute_force_threshold,
+                                                 adaptive_stable_hops, numa);
             else if (data_type == std::string("uint8"))
                 return search_disk_index<uint8_t>(metric, index_path_prefix, result_path_prefix, query_file, gt_file,
                                                   num_threads, K, W, num_nodes_to_cache, search_io_limit, Lvec,
-                                                  fail_if_recall_below, query_filters, use_reorder_data);
+                                                  fail_if_recall_below, query_filters, use_reorder_data,
+                                                  use_pipelined_search, use_io_uring, queries_per_thread,
+                                                  dynamic_cache_mb, visited_set_type, filter_brute_force_threshold,
+                                                  adaptive_stable_hops, numa);
             else
             {
                 std::cerr << "Unsupported data type. Use float or int8 or uint8" << std::endl;
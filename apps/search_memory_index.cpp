@@ -23,6 +23,8 @@
 #include "utils.h"
 #include "program_options_utils.hpp"
 #include "index_factory.h"
+#include "huge_page_allocator.h"
+#include "numa_utils.h"
 
 namespace po = boost::program_options;
 
@@ -31,7 +33,9 @@ int search_memory_index(diskann::Metric &metric, const std::string &index_path,
                         const std::string &query_file, const std::string &truthset_file, const uint32_t num_threads,
                         const uint32_t recall_at, const bool print_all_recalls, const std::vector<uint32_t> &Lvec,
                         const bool dynamic, const bool tags, const bool show_qps_per_thread,
-                        const std::vector<std::string> &query_filters, const float fail_if_recall_below)
+                        const std::vector<std::string> &query_filters, const float fail_if_recall_below,
+                        const diskann::VisitedSetType visited_set_type, const bool flat_graph,
+                        const bool batch_search, const bool use_mmap, const uint32_t mmap_flags)
 {
     using TagT = uint32_t;
     // Load the query file
@@ -75,8 +79,12 @@ int search_memory_index(diskann::Metric &metric, const std::string &index_path,
                       .with_metric(metric)
                       .with_dimension(query_dim)
                       .with_max_points(0)
-                      .with_data_load_store_strategy(diskann::DataStoreStrategy::MEMORY)
-                      .with_graph_load_store_strategy(diskann::GraphStoreStrategy::MEMORY)
+                      .with_data_load_store_strategy(use_mmap ? diskann::DataStoreStrategy::MMAP
+                                                              : diskann::DataStoreStrategy::MEMORY)
+                      .with_graph_load_store_strategy(use_mmap     ? diskann::GraphStoreStrategy::MMAP
+                                                      : flat_graph ? diskann::GraphStoreStrategy::FLAT
+                                                                   : diskann::GraphStoreStrategy::MEMORY)
+                      .with_mmap_flags(mmap_flags)
                       .with_data_type(diskann_type_to_name<T>())
                       .with_label_type(diskann_type_to_name<LabelT>())
                       .with_tag_type(diskann_type_to_name<TagT>())
@@ -91,8 +99,15 @@ int search_memory_index(diskann::Metric &metric, const std::string &index_path,
 
     auto index_factory = diskann::IndexFactory(config);
     auto index = index_factory.create_instance();
+    index->set_visited_set_type(visited_set_type);
     index->load(index_path.c_str(), num_threads, *(std::max_element(Lvec.begin(), Lvec.end())));
     std::cout << "Index loaded" << std::endl;
+    if (diskann::get_huge_page_mode() != diskann::HugePageMode::NONE)
+    {
+        diskann::AllocatorStats alloc_stats = diskann::get_allocator_stats();
+        diskann::cout << "Large buffers: " << alloc_stats.n_allocations << " using " << (alloc_stats.bytes >> 20)
+                      << " MB, " << (alloc_stats.huge_page_bytes >> 20) << " MB of it on hugepages" << std::endl;
+    }
 
     if (metric == diskann::FAST_L2)
         index->optimize_index_layout();
@@ -163,6 +178,16 @@ int search_memory_index(diskann::Metric &metric, const std::string &index_path,
 
         auto s = std::chrono::high_resolution_clock::now();
         omp_set_num_threads(num_threads);
+        if (batch_search && !filtered_search && !tags && metric != diskann::FAST_L2)
+        {
+            index->batch_search(query, query_num, query_aligned_dim, recall_at, L, query_result_ids[test_id].data(),
+                                query_result_dists[test_id].data(), cmp_stats.data());
+            // queries finish together within a batch, so report the average time a thread spent per query
+            std::chrono::duration<double> batch_diff = std::chrono::high_resolution_clock::now() - s;
+            std::fill(latency_stats[test_id].begin(), latency_stats[test_id].end(),
+                      (float)(batch_diff.count() * 1000000 * num_threads / query_num));
+        }
+        else
 #pragma omp parallel for schedule(dynamic, 1)
         for (int64_t i = 0; i < (int64_t)query_num; i++)
         {
@@ -292,10 +317,11 @@ int search_memory_index(diskann::Metric &metric, const std::string &index_path,
 int main(int argc, char **argv)
 {
     std::string data_type, dist_fn, index_path_prefix, result_path, query_file, gt_file, filter_label, label_type,
-        query_filters_file;
+        query_filters_file, visited_set, huge_pages;
     uint32_t num_threads, K;
     std::vector<uint32_t> Lvec;
-    bool print_all_recalls, dynamic, tags, show_qps_per_thread;
+    bool print_all_recalls, dynamic, tags, show_qps_per_thread, flat_graph, batch_search, use_mmap, mmap_populate,
+        mmap_hugepages, numa;
     float fail_if_recall_below = 0.0f;
 
     po::options_description desc{
@@ -345,6 +371,27 @@ int main(int argc, char **argv)
         optional_configs.add_options()("fail_if_recall_below",
                                        po::value<float>(&fail_if_recall_below)->default_value(0.0f),
                                        program_options_utils::FAIL_IF_RECALL_BELOW);
+        optional_configs.add_options()("huge_pages", po::value<std::string>(&huge_pages)->default_value("none"),
+                                       "Page size for the large index and scratch buffers: none, transparent, "
+                                       "2mb or 1gb (explicit hugepages, which must be reserved beforehand).  "
+                                       "Default value: none");
+        optional_configs.add_options()("visited_set", po::value<std::string>(&visited_set)->default_value("auto"),
+                                       "How searches track visited nodes: auto, hash, epoch (per-thread tag "
+                                       "array, fastest) or bloom (fixed-size filter for very large indexes, may skip "
+                                       "a few nodes).  Default value: auto");
+        optional_configs.add_options()("flat_graph", po::bool_switch(&flat_graph)->default_value(false),
+                                       program_options_utils::FLAT_GRAPH_DESCRIPTION);
+        optional_configs.add_options()("batch_search", po::bool_switch(&batch_search)->default_value(false),
+                                       "Search queries in small lockstep groups that share each base vector read. "
+                                       "Ignored with filters, tags or fast_l2.");
+        optional_configs.add_options()("mmap", po::bool_switch(&use_mmap)->default_value(false),
+                                       program_options_utils::MMAP_DESCRIPTION);
+        optional_configs.add_options()("mmap_populate", po::bool_switch(&mmap_populate)->default_value(false),
+                                       "With --mmap, fault the whole index in at load instead of on first access.");
+        optional_configs.add_options()("mmap_hugepages", po::bool_switch(&mmap_hugepages)->default_value(false),
+                                       "With --mmap, ask for transparent hugepages on the mapping.");
+        optional_configs.add_options()("numa", po::bool_switch(&numa)->default_value(false),
+                                       "Pin search threads round-robin to NUMA nodes.");
 
         // Output controls
         po::options_description output_controls("Output controls");
@@ -417,6 +464,32 @@ int main(int argc, char **argv)
         return -1;
     }
 
+    if (numa && !diskann::pin_omp_threads_to_numa_nodes(num_threads))
+        diskann::cout << "Could not pin search threads to NUMA nodes" << std::endl;
+
+    uint32_t mmap_flags = (mmap_populate ? diskann::MMAP_POPULATE : 0) | (mmap_hugepages ? diskann::MMAP_HUGEPAGES : 0);
+
+    try
+    {
+        diskann::set_huge_page_mode(diskann::get_huge_page_mode(huge_pages));
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return -1;
+    }
+
+    diskann::VisitedSetType visited_set_type;
+    try
+    {
+        visited_set_type = diskann::get_visited_set_type(visited_set);
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return -1;
+    }
+
     std::vector<std::string> query_filters;
     if (filter_label != "")
     {
@@ -435,19 +508,23 @@ int main(int argc, char **argv)
             {
                 return search_memory_index<int8_t, uint16_t>(
                     metric, index_path_prefix, result_path, query_file, gt_file, num_threads, K, print_all_recalls,
-                    Lvec, dynamic, tags, show_qps_per_thread, query_filters, fail_if_recall_below);
+                    Lvec, dynamic, tags, show_qps_per_thread, query_filters, fail_if_recall_below, visited_set_type,
+                    flat_graph, batch_search, use_mmap, mmap_flags);
             }
             else if (data_type == std::string("uint8"))
             {
                 return search_memory_index<uint8_t, uint16_t>(
                     metric, index_path_prefix, result_path, query_file, gt_file, num_threads, K, print_all_recalls,
-                    Lvec, dynamic, tags, show_qps_per_thread, query_filters, fail_if_recall_below);
+                    Lvec, dynamic, tags, show_qps_per_thread, query_filters, fail_if_recall_below, visited_set_type,
+                    flat_graph, batch_search, use_mmap, mmap_flags);
             }
             else if (data_type == std::string("float"))
             {
                 return search_memory_index<float, uint16_t>(metric, index_path_prefix, result_path, query_file, gt_file,
                                                             num_threads, K, print_all_recalls, Lvec, dynamic, tags,
-                                                            show_qps_per_thread, query_filters, fail_if_recall_below);
+                                                            show_qps_per_thread, query_filters, fail_if_recall_below,
+                                                            visited_set_type, flat_graph, batch_search, use_mmap,
+                                                            mmap_flags);
             }
             else
             {
@@ -461,19 +538,22 @@ int main(int argc, char **argv)
             {
                 return search_memory_index<int8_t>(metric, index_path_prefix, result_path, query_file, gt_file,
                                                    num_threads, K, print_all_recalls, Lvec, dynamic, tags,
-                                                   show_qps_per_thread, query_filters, fail_if_recall_below);
+                                                   show_qps_per_thread, query_filters, fail_if_recall_below,
+                                                   visited_set_type, flat_graph, batch_search, use_mmap, mmap_flags);
             }
             else if (data_type == std::string("uint8"))
             {
                 return search_memory_index<uint8_t>(metric, index_path_prefix, result_path, query_file, gt_file,
                                                     num_threads, K, print_all_recalls, Lvec, dynamic, tags,
-                                                    show_qps_per_thread, query_filters, fail_if_recall_below);
+                                                    show_qps_per_thread, query_filters, fail_if_recall_below,
+                                                    visited_set_type, flat_graph, batch_search, use_mmap, mmap_flags);
             }
             else if (data_type == std::string("float"))
             {
                 return search_memory_index<float>(metric, index_path_prefix, result_path, query_file, gt_file,
                                                   num_threads, K, print_all_recalls, Lvec, dynamic, tags,
-                                                  show_qps_per_thread, query_filters, fail_if_recall_below);
+                                                  show_qps_per_thread, query_filters, fail_if_recall_below,
+                                                  visited_set_type, flat_graph, batch_search, use_mmap, mmap_flags);
             }
             else
             {
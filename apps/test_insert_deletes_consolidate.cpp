@@ -134,6 +134,8 @@ void delete_from_beginning(diskann::AbstractIndex &index, diskann::IndexWritePar
                   << "empty slots: " << report._empty_slots << std::endl
                   << "deletes processed: " << report._slots_released << std::endl
                   << "latest delete size: " << report._delete_set_size << std::endl
+                  << "nodes processed: " << report._num_calls_to_process_delete << std::endl
+                  << "in-neighbor index: " << report._in_neighbor_index_bytes / (1024 * 1024) << "MB" << std::endl
                   << "rate: (" << points_to_delete_from_beginning / report._time << " points/second overall, "
                   << points_to_delete_from_beginning / report._time / delete_params.num_threads << " per thread)"
                   << std::endl;
@@ -149,8 +151,8 @@ void build_incremental_index(const std::string &data_path, diskann::IndexWritePa
                              size_t max_points_to_insert, size_t beginning_index_size, float start_point_norm,
                              uint32_t num_start_pts, size_t points_per_checkpoint, size_t checkpoints_per_snapshot,
                              const std::string &save_path, size_t points_to_delete_from_beginning,
-                             size_t start_deletes_after, bool concurrent, const std::string &label_file,
-                             const std::string &universal_label)
+                             size_t start_deletes_after, bool concurrent, bool track_in_neighbors, bool flat_graph,
+                             const std::string &label_file, const std::string &universal_label)
 {
     size_t dim, aligned_dim;
     size_t num_points;
@@ -177,11 +179,14 @@ void build_incremental_index(const std::string &data_path, diskann::IndexWritePa
                                             .with_tag_type(diskann_type_to_name<TagT>())
                                             .with_label_type(diskann_type_to_name<LabelT>())
                                             .with_data_load_store_strategy(diskann::DataStoreStrategy::MEMORY)
-                                            .with_graph_load_store_strategy(diskann::GraphStoreStrategy::MEMORY)
+                                            .with_graph_load_store_strategy(flat_graph
+                                                                                ? diskann::GraphStoreStrategy::FLAT
+                                                                                : diskann::GraphStoreStrategy::MEMORY)
                                             .is_enable_tags(enable_tags)
                                             .is_filtered(has_labels)
                                             .with_num_frozen_pts(num_start_pts)
                                             .is_concurrent_consolidate(concurrent)
+                                            .with_in_neighbor_tracking(track_in_neighbors)
                                             .build();
 
     diskann::IndexFactory index_factory = diskann::IndexFactory(index_config);
@@ -378,7 +383,7 @@ int main(int argc, char **argv)
     float alpha, start_point_norm;
     size_t points_to_skip, max_points_to_insert, beginning_index_size, points_per_checkpoint, checkpoints_per_snapshot,
         points_to_delete_from_beginning, start_deletes_after;
-    bool concurrent;
+    bool concurrent, track_in_neighbors, flat_graph;
 
     // label options
     std::string label_file, label_type, universal_label;
@@ -428,6 +433,11 @@ int main(int argc, char **argv)
                                        "These number of points from the file are inserted after "
                                        "points_to_skip");
         optional_configs.add_options()("do_concurrent", po::value<bool>(&concurrent)->default_value(false), "");
+        optional_configs.add_options()("track_in_neighbors", po::bool_switch(&track_in_neighbors)->default_value(false),
+                                       "Keep a reverse-edge index so consolidation only visits nodes that point "
+                                       "at deleted ones, at the cost of memory about the size of the graph");
+        optional_configs.add_options()("flat_graph", po::bool_switch(&flat_graph)->default_value(false),
+                                       program_options_utils::FLAT_GRAPH_DESCRIPTION);
         optional_configs.add_options()("start_deletes_after",
                                        po::value<uint64_t>(&start_deletes_after)->default_value(0), "");
         optional_configs.add_options()("start_point_norm", po::value<float>(&start_point_norm)->default_value(0),
@@ -507,17 +517,20 @@ int main(int argc, char **argv)
             build_incremental_index<int8_t>(
                 data_path, params, points_to_skip, max_points_to_insert, beginning_index_size, start_point_norm,
                 num_start_pts, points_per_checkpoint, checkpoints_per_snapshot, index_path_prefix,
-                points_to_delete_from_beginning, start_deletes_after, concurrent, label_file, universal_label);
+                points_to_delete_from_beginning, start_deletes_after, concurrent, track_in_neighbors, flat_graph,
+                label_file, universal_label);
         else if (data_type == std::string("uint8"))
             build_incremental_index<uint8_t>(
                 data_path, params, points_to_skip, max_points_to_insert, beginning_index_size, start_point_norm,
                 num_start_pts, points_per_checkpoint, checkpoints_per_snapshot, index_path_prefix,
-                points_to_delete_from_beginning, start_deletes_after, concurrent, label_file, universal_label);
+                points_to_delete_from_beginning, start_deletes_after, concurrent, track_in_neighbors, flat_graph,
+                label_file, universal_label);
         else if (data_type == std::string("float"))
             build_incremental_index<float>(data_path, params, points_to_skip, max_points_to_insert,
                                            beginning_index_size, start_point_norm, num_start_pts, points_per_checkpoint,
                                            checkpoints_per_snapshot, index_path_prefix, points_to_delete_from_beginning,
-                                           start_deletes_after, concurrent, label_file, universal_label);
+                                           start_deletes_after, concurrent, track_in_neighbors, flat_graph,
+                                           label_file, universal_label);
         else
             std::cout << "Unsupported type. Use float/int8/uint8" << std::endl;
     }
@@ -180,12 +180,40 @@ void delete_and_consolidate(diskann::AbstractIndex &index, diskann::IndexWritePa
     }
 }
 
+template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t>
+void delete_and_wait_for_background(diskann::AbstractIndex &index, size_t start, size_t end)
+{
+    std::cout << std::endl << "Lazy deleting points " << start << " to " << end << "... ";
+    for (size_t i = start; i < end; ++i)
+        index.lazy_delete(static_cast<TagT>(1 + i));
+    std::cout << "lazy delete done." << std::endl;
+
+    // hold the next deletion task back until the service has caught up, so inserts cannot run out of slots
+    diskann::Timer timer;
+    auto progress = index.get_consolidation_progress();
+    while (progress._running && progress._pending_deletes > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        progress = index.get_consolidation_progress();
+    }
+    if (!progress._error.empty())
+    {
+        std::cerr << "Exiting after error in background consolidation: " << progress._error << std::endl;
+        exit(-1);
+    }
+    std::cout << "Background consolidation caught up " << timer.elapsed() / 1000 << "ms after the lazy deletes: "
+              << progress._batches_completed << " batches, " << progress._slots_released << " slots released, "
+              << progress._num_calls_to_process_delete << " nodes processed, last batch took "
+              << progress._last_batch_secs << "s" << std::endl;
+}
+
 template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t>
 void build_incremental_index(const std::string &data_path, const uint32_t L, const uint32_t R, const float alpha,
                              const uint32_t insert_threads, const uint32_t consolidate_threads,
                              size_t max_points_to_insert, size_t active_window, size_t consolidate_interval,
                              const float start_point_norm, uint32_t num_start_pts, const std::string &save_path,
-                             const std::string &label_file, const std::string &universal_label, const uint32_t Lf)
+                             const std::string &label_file, const std::string &universal_label, const uint32_t Lf,
+                             const bool background_consolidate)
 {
     const uint32_t C = 500;
     const bool saturate_graph = false;
@@ -234,6 +262,8 @@ void build_incremental_index(const std::string &data_path, const uint32_t L, con
                             .with_max_points(active_window + 4 * consolidate_interval)
                             .is_dynamic_index(true)
                             .is_enable_tags(true)
+                            .is_concurrent_consolidate(background_consolidate)
+                            .with_in_neighbor_tracking(background_consolidate)
                             .is_use_opq(false)
                             .is_filtered(has_labels)
                             .with_num_pq_chunks(0)
@@ -295,6 +325,9 @@ void build_incremental_index(const std::string &data_path, const uint32_t L, con
     });
     insert_task.wait();
 
+    if (background_consolidate)
+        index->start_background_consolidation(delete_params, diskann::BackgroundConsolidationParams());
+
     for (size_t start = active_window; start + consolidate_interval <= max_points_to_insert;
          start += consolidate_interval)
     {
@@ -314,13 +347,20 @@ void build_incremental_index(const std::string &data_path, const uint32_t L, con
             auto end_del = start - active_window;
 
             delete_tasks.emplace_back(std::async(std::launch::async, [&]() {
-                delete_and_consolidate<T, TagT, LabelT>(*index, delete_params, (size_t)start_del, (size_t)end_del);
+                if (background_consolidate)
+                    delete_and_wait_for_background<T, TagT, LabelT>(*index, (size_t)start_del, (size_t)end_del);
+                else
+                    delete_and_consolidate<T, TagT, LabelT>(*index, delete_params, (size_t)start_del,
+                                                            (size_t)end_del);
             }));
         }
     }
     if (delete_tasks.size() > 0)
         delete_tasks[delete_tasks.size() - 1].wait();
 
+    if (background_consolidate)
+        index->stop_background_consolidation();
+
     std::cout << "Time Elapsed " << timer.elapsed() / 1000 << "ms\n";
 
     index->save(save_path_inc.c_str(), true);
@@ -333,6 +373,7 @@ int main(int argc, char **argv)
     std::string data_type, dist_fn, data_path, index_path_prefix, label_file, universal_label, label_type;
     uint32_t insert_threads, consolidate_threads, R, L, num_start_pts, Lf, unique_labels_supported;
     float alpha, start_point_norm;
+    bool background_consolidate = false;
     size_t max_points_to_insert, active_window, consolidate_interval;
 
     po::options_description desc{program_options_utils::make_program_description("test_streaming_scenario",
@@ -402,6 +443,9 @@ int main(int argc, char **argv)
         optional_configs.add_options()("unique_labels_supported",
                                        po::value<uint32_t>(&unique_labels_supported)->default_value(0),
                                        "Number of unique labels supported by the dynamic index.");
+        optional_configs.add_options()("background_consolidate", po::bool_switch(&background_consolidate),
+                                       "Only lazily delete in the deletion task and let a background service "
+                                       "consolidate the deletes in small batches");
 
         // Merge required and optional parameters
         desc.add(required_configs).add(optional_configs);
@@ -463,14 +507,14 @@ int main(int argc, char **argv)
                 build_incremental_index<uint8_t, uint32_t, uint16_t>(
                     data_path, L, R, alpha, insert_threads, consolidate_threads, max_points_to_insert, active_window,
                     consolidate_interval, start_point_norm, num_start_pts, index_path_prefix, label_file,
-                    universal_label, Lf);
+                    universal_label, Lf, background_consolidate);
             }
             else if (label_type == std::string("uint"))
             {
                 build_incremental_index<uint8_t, uint32_t, uint32_t>(
                     data_path, L, R, alpha, insert_threads, consolidate_threads, max_points_to_insert, active_window,
                     consolidate_interval, start_point_norm, num_start_pts, index_path_prefix, label_file,
-                    universal_label, Lf);
+                    universal_label, Lf, background_consolidate);
             }
         }
         else if (data_type == std::string("int8"))
@@ -480,14 +524,14 @@ int main(int argc, char **argv)
                 build_incremental_index<int8_t, uint32_t, uint16_t>(
                     data_path, L, R, alpha, insert_threads, consolidate_threads, max_points_to_insert, active_window,
                     consolidate_interval, start_point_norm, num_start_pts, index_path_prefix, label_file,
-                    universal_label, Lf);
+                    universal_label, Lf, background_consolidate);
             }
             else if (label_type == std::string("uint"))
             {
                 build_incremental_index<int8_t, uint32_t, uint32_t>(
                     data_path, L, R, alpha, insert_threads, consolidate_threads, max_points_to_insert, active_window,
                     consolidate_interval, start_point_norm, num_start_pts, index_path_prefix, label_file,
-                    universal_label, Lf);
+                    universal_label, Lf, background_consolidate);
             }
         }
         else if (data_type == std::string("float"))
@@ -497,14 +541,14 @@ int main(int argc, char **argv)
                 build_incremental_index<float, uint32_t, uint16_t>(
                     data_path, L, R, alpha, insert_threads, consolidate_threads, max_points_to_insert, active_window,
                     consolidate_interval, start_point_norm, num_start_pts, index_path_prefix, label_file,
-                    universal_label, Lf);
+                    universal_label, Lf, background_consolidate);
             }
             else if (label_type == std::string("uint"))
             {
                 build_incremental_index<float, uint32_t, uint32_t>(
                     data_path, L, R, alpha, insert_threads, consolidate_threads, max_points_to_insert, active_window,
                     consolidate_interval, start_point_norm, num_start_pts, index_path_prefix, label_file,
-                    universal_label, Lf);
+                    universal_label, Lf, background_consolidate);
             }
         }
     }
@@ -9,7 +9,8 @@
 
 template <typename T>
 bool generate_pq(const std::string &data_path, const std::string &index_prefix_path, const size_t num_pq_centers,
-                 const size_t num_pq_chunks, const float sampling_rate, const bool opq)
+                 const size_t num_pq_chunks, const float sampling_rate, const bool opq,
+                 const uint32_t kmeans_batch_size, const bool kmeans_parallel)
 {
     std::string pq_pivots_path = index_prefix_path + "_pq_pivots.bin";
     std::string pq_compressed_vectors_path = index_prefix_path + "_pq_compressed.bin";
@@ -23,15 +24,16 @@ bool generate_pq(const std::string &data_path, const std::string &index_prefix_p
     if (opq)
     {
         diskann::generate_opq_pivots(train_data, train_size, (uint32_t)train_dim, (uint32_t)num_pq_centers,
-                                     (uint32_t)num_pq_chunks, pq_pivots_path, true);
+                                     (uint32_t)num_pq_chunks, pq_pivots_path, true, kmeans_batch_size, kmeans_parallel);
     }
     else
     {
         diskann::generate_pq_pivots(train_data, train_size, (uint32_t)train_dim, (uint32_t)num_pq_centers,
-                                    (uint32_t)num_pq_chunks, KMEANS_ITERS_FOR_PQ, pq_pivots_path);
+                                    (uint32_t)num_pq_chunks, KMEANS_ITERS_FOR_PQ, pq_pivots_path, false,
+                                    kmeans_batch_size, kmeans_parallel);
     }
     diskann::generate_pq_data_from_pivots<T>(data_path, (uint32_t)num_pq_centers, (uint32_t)num_pq_chunks,
-                                             pq_pivots_path, pq_compressed_vectors_path, true);
+                                             pq_pivots_path, pq_compressed_vectors_path, opq);
 
     delete[] train_data;
 
@@ -40,13 +42,14 @@ bool generate_pq(const std::string &data_path, const std::string &index_prefix_p
 
 int main(int argc, char **argv)
 {
-    if (argc != 7)
+    if (argc < 7 || argc > 9)
     {
         std::cout << "Usage: \n"
                   << argv[0]
                   << "  <data_type[float/uint8/int8]>   <data_file[.bin]>"
                      "  <PQ_prefix_path>  <target-bytes/data-point>  "
-                     "<sampling_rate> <PQ(0)/OPQ(1)>"
+                     "<sampling_rate> <PQ(0)/OPQ(1)> [kmeans_batch_size (0 for full k-means)]"
+                     " [kmeans_parallel (1 to seed k-means with k-means||)]"
                   << std::endl;
     }
     else
@@ -57,13 +60,18 @@ int main(int argc, char **argv)
         const size_t num_pq_chunks = (size_t)atoi(argv[4]);
         const float sampling_rate = (float)atof(argv[5]);
         const bool opq = atoi(argv[6]) == 0 ? false : true;
+        const uint32_t kmeans_batch_size = argc >= 8 ? (uint32_t)atoi(argv[7]) : 0;
+        const bool kmeans_parallel = argc == 9 && atoi(argv[8]) == 1;
 
         if (std::string(argv[1]) == std::string("float"))
-            generate_pq<float>(data_path, index_prefix_path, num_pq_centers, num_pq_chunks, sampling_rate, opq);
+            generate_pq<float>(data_path, index_prefix_path, num_pq_centers, num_pq_chunks, sampling_rate, opq,
+                               kmeans_batch_size, kmeans_parallel);
         else if (std::string(argv[1]) == std::string("int8"))
-            generate_pq<int8_t>(data_path, index_prefix_path, num_pq_centers, num_pq_chunks, sampling_rate, opq);
+            generate_pq<int8_t>(data_path, index_prefix_path, num_pq_centers, num_pq_chunks, sampling_rate, opq,
+                                kmeans_batch_size, kmeans_parallel);
         else if (std::string(argv[1]) == std::string("uint8"))
-            generate_pq<uint8_t>(data_path, index_prefix_path, num_pq_centers, num_pq_chunks, sampling_rate, opq);
+            generate_pq<uint8_t>(data_path, index_prefix_path, num_pq_centers, num_pq_chunks, sampling_rate, opq,
+                                 kmeans_batch_size, kmeans_parallel);
         else
             std::cout << "Error. wrong file type" << std::endl;
     }
@@ -10,13 +10,14 @@
 
 int main(int argc, char **argv)
 {
-    if (argc != 8)
+    if (argc != 8 && argc != 9)
     {
         std::cout << "Usage:\n"
                   << argv[0]
                   << "  datatype<int8/uint8/float>  <data_path>"
                      "  <prefix_path>  <sampling_rate>  "
                      "  <ram_budget(GB)> <graph_degree>  <k_index>"
+                     "  [kmeans_parallel (1 to seed k-means with k-means||)]"
                   << std::endl;
         exit(-1);
     }
@@ -27,13 +28,17 @@ int main(int argc, char **argv)
     const double ram_budget = (double)std::atof(argv[5]);
     const size_t graph_degree = (size_t)std::atoi(argv[6]);
     const size_t k_index = (size_t)std::atoi(argv[7]);
+    const bool kmeans_parallel = argc == 9 && std::atoi(argv[8]) == 1;
 
     if (std::string(argv[1]) == std::string("float"))
-        partition_with_ram_budget<float>(data_path, sampling_rate, ram_budget, graph_degree, prefix_path, k_index);
+        partition_with_ram_budget<float>(data_path, sampling_rate, ram_budget, graph_degree, prefix_path, k_index,
+                                         kmeans_parallel);
     else if (std::string(argv[1]) == std::string("int8"))
-        partition_with_ram_budget<int8_t>(data_path, sampling_rate, ram_budget, graph_degree, prefix_path, k_index);
+        partition_with_ram_budget<int8_t>(data_path, sampling_rate, ram_budget, graph_degree, prefix_path, k_index,
+                                          kmeans_parallel);
     else if (std::string(argv[1]) == std::string("uint8"))
-        partition_with_ram_budget<uint8_t>(data_path, sampling_rate, ram_budget, graph_degree, prefix_path, k_index);
+        partition_with_ram_budget<uint8_t>(data_path, sampling_rate, ram_budget, graph_degree, prefix_path, k_index,
+                                           kmeans_parallel);
     else
         std::cout << "unsupported data format. use float/int8/uint8" << std::endl;
 }
@@ -93,6 +93,11 @@ template <typename data_t> class AbstractDataStore
     virtual void get_distance(const data_t *preprocessed_query, const std::vector<location_t> &ids,
                               std::vector<float> &distances, AbstractScratch<data_t> *scratch_space) const = 0;
     virtual float get_distance(const location_t loc1, const location_t loc2) const = 0;
+    // Distances from the point at loc to each of num_queries preprocessed queries, for batched search.
+    // The default calls get_distance() per query; stores that hold full vectors load the point once.
+    DISKANN_DLLEXPORT virtual void get_distance_batch(const data_t *const *preprocessed_queries,
+                                                      const uint32_t num_queries, const location_t loc,
+                                                      float *distances) const;
 
     // stats of the data stored in store
     // Returns the point in the dataset that is closest to the mean of all points
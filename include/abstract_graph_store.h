@@ -10,6 +10,45 @@
 namespace diskann
 {
 
+// Read-only view of one node's adjacency list. Valid until that list is next modified or the graph is resized;
+// copy it out under the node's lock if it must outlive either.
+class NeighbourList
+{
+  public:
+    NeighbourList(const location_t *data, size_t size) : _data(data), _size(size)
+    {
+    }
+
+    const location_t *begin() const
+    {
+        return _data;
+    }
+    const location_t *end() const
+    {
+        return _data + _size;
+    }
+    const location_t *data() const
+    {
+        return _data;
+    }
+    size_t size() const
+    {
+        return _size;
+    }
+    bool empty() const
+    {
+        return _size == 0;
+    }
+    location_t operator[](size_t i) const
+    {
+        return _data[i];
+    }
+
+  private:
+    const location_t *_data;
+    size_t _size;
+};
+
 class AbstractGraphStore
 {
   public:
@@ -27,7 +66,19 @@ class AbstractGraphStore
                       const uint32_t start) = 0;
 
     // not synchronised, user should use lock when necvessary.
-    virtual const std::vector<location_t> &get_neighbours(const location_t i) const = 0;
+    virtual NeighbourList get_neighbours(const location_t i) const = 0;
+
+    // Stores that return true from lock_free_reads() version every list, so copy_neighbours can run while a writer
+    // holding the node's lock rewrites it; otherwise copy_neighbours needs the lock like get_neighbours.
+    virtual bool lock_free_reads() const
+    {
+        return false;
+    }
+    virtual void copy_neighbours(const location_t i, std::vector<location_t> &neighbours) const
+    {
+        auto nbrs = get_neighbours(i);
+        neighbours.assign(nbrs.begin(), nbrs.end());
+    }
     virtual void add_neighbour(const location_t i, location_t neighbour_id) = 0;
     virtual void clear_neighbours(const location_t i) = 0;
     virtual void swap_neighbours(const location_t a, location_t b) = 0;
@@ -5,6 +5,7 @@
 #include "types.h"
 #include "index_config.h"
 #include "index_build_params.h"
+#include "visited_set.h"
 #include <any>
 
 namespace diskann
@@ -21,17 +22,35 @@ struct consolidation_report
     status_code _status;
     size_t _active_points, _max_points, _empty_slots, _slots_released, _delete_set_size, _num_calls_to_process_delete;
     double _time;
+    // memory held by the reverse-edge index, 0 unless in-neighbor tracking is enabled
+    size_t _in_neighbor_index_bytes;
 
     consolidation_report(status_code status, size_t active_points, size_t max_points, size_t empty_slots,
                          size_t slots_released, size_t delete_set_size, size_t num_calls_to_process_delete,
-                         double time_secs)
+                         double time_secs, size_t in_neighbor_index_bytes = 0)
         : _status(status), _active_points(active_points), _max_points(max_points), _empty_slots(empty_slots),
           _slots_released(slots_released), _delete_set_size(delete_set_size),
-          _num_calls_to_process_delete(num_calls_to_process_delete), _time(time_secs)
+          _num_calls_to_process_delete(num_calls_to_process_delete), _time(time_secs),
+          _in_neighbor_index_bytes(in_neighbor_index_bytes)
     {
     }
 };
 
+// Snapshot of the service started by start_background_consolidation
+struct consolidation_progress
+{
+    bool _running = false;
+    size_t _pending_deletes = 0;   // lazily deleted points whose slots are not released yet
+    size_t _batch_deletes = 0;     // deletes in the batch being consolidated, 0 between batches
+    size_t _batch_nodes_done = 0;  // nodes of the current batch visited so far
+    size_t _batch_nodes_total = 0; // nodes the current batch has to visit
+    size_t _batches_completed = 0;
+    size_t _slots_released = 0; // since the service started
+    size_t _num_calls_to_process_delete = 0;
+    double _last_batch_secs = 0;
+    std::string _error; // why the service stopped, if it stopped on an exception
+};
+
 /* A templated independent class for intercation with Index. Uses Type Erasure to add virtual implemetation of methods
 that can take any type(using std::any) and Provides a clean API that can be inherited by different type of Index.
 */
@@ -72,6 +91,14 @@ class AbstractIndex
     std::pair<uint32_t, uint32_t> search(const data_type *query, const size_t K, const uint32_t L, IDType *indices,
                                          float *distances = nullptr);
 
+    // Searches num_queries queries stored query_stride elements apart and writes K results per query at
+    // indices + i * K (and distances + i * K). Queries are walked in small lockstep groups so that each base
+    // vector fetched is compared against every query in the group that reached it. cmps, if given, receives the
+    // distance comparisons of each query.
+    template <typename data_type, typename IDType>
+    void batch_search(const data_type *queries, const size_t num_queries, const size_t query_stride, const size_t K,
+                      const uint32_t L, IDType *indices, float *distances = nullptr, uint32_t *cmps = nullptr);
+
     // Filter support search
     // IndexType is either uint32_t or uint64_t
     template <typename IndexType>
@@ -99,8 +126,17 @@ class AbstractIndex
 
     virtual consolidation_report consolidate_deletes(const IndexWriteParameters &parameters) = 0;
 
+    // consolidate deletes on a background thread in small batches and slices, releasing slots as each batch finishes
+    virtual void start_background_consolidation(const IndexWriteParameters &parameters,
+                                                const BackgroundConsolidationParams &background_params) = 0;
+    virtual void stop_background_consolidation() = 0;
+    virtual consolidation_progress get_consolidation_progress() = 0;
+
     virtual void optimize_index_layout() = 0;
 
+    // how searches track visited nodes; takes effect on the next search from each scratch space
+    virtual void set_visited_set_type(VisitedSetType type) = 0;
+
     // memory should be allocated for vec before calling this function
     template <typename tag_type, typename data_type> int get_vector_by_tag(tag_type &tag, data_type *vec);
 
@@ -110,6 +146,9 @@ class AbstractIndex
     virtual void _build(const DataType &data, const size_t num_points_to_load, TagVector &tags) = 0;
     virtual std::pair<uint32_t, uint32_t> _search(const DataType &query, const size_t K, const uint32_t L,
                                                   std::any &indices, float *distances = nullptr) = 0;
+    virtual void _batch_search(const DataType &queries, const size_t num_queries, const size_t query_stride,
+                               const size_t K, const uint32_t L, std::any &indices, float *distances,
+                               uint32_t *cmps) = 0;
     virtual std::pair<uint32_t, uint32_t> _search_with_filters(const DataType &query, const std::string &filter_label,
                                                                const size_t K, const uint32_t L, std::any &indices,
                                                                float *distances) = 0;
@@ -118,6 +118,32 @@ class AlignedFileReader
     // NOTE :: blocking call
     virtual void read(std::vector<AlignedRead> &read_reqs, IOContext &ctx, bool async = false) = 0;
 
+    // Asynchronous interface used by pipelined search. submit_reads() issues the
+    // batch without waiting for it, and get_completed() reaps at least
+    // min_completions finished reads (plus any others already done), returning
+    // the buf of each. Readers that cannot do this keep the defaults below.
+    // NOTE :: do not mix with read() on the same ctx while reads are pending
+    virtual bool supports_async_reads()
+    {
+        return false;
+    }
+    virtual void submit_reads(std::vector<AlignedRead> &read_reqs, IOContext &ctx)
+    {
+        throw diskann::ANNException("Asynchronous reads not supported by this reader", -1, __FUNCSIG__, __FILE__,
+                                    __LINE__);
+    }
+    virtual void get_completed(IOContext &ctx, uint64_t min_completions, std::vector<void *> &completed_bufs)
+    {
+        throw diskann::ANNException("Asynchronous reads not supported by this reader", -1, __FUNCSIG__, __FILE__,
+                                    __LINE__);
+    }
+
+    // optionally pin a long-lived, 512-aligned buffer that reads on ctx will
+    // target, so the reader can skip per-request buffer mapping
+    virtual void register_buffer(IOContext &ctx, void *buf, uint64_t len)
+    {
+    }
+
 #ifdef USE_BING_INFRA
     // wait for completion of one request in a batch of requests
     virtual void wait(IOContext &ctx, int &completedIndex) = 0;
@@ -18,11 +18,29 @@ const uint32_t NUM_FROZEN_POINTS_DYNAMIC = 1;
 
 // In-mem index related limits
 const float GRAPH_SLACK_FACTOR = 1.3f;
+// filtered static indexes keep per-point label bitsets when every label fits in this many 64-bit words
+const uint32_t MAX_LABEL_BITSET_WORDS = 4;
+// queries one thread walks together in Index::batch_search
+const uint32_t QUERY_BATCH_SIZE = 8;
+// background consolidation: deletes per batch (when in-neighbors are tracked), nodes per slice, pause between slices
+// and how often an idle service checks for new deletes
+const uint32_t CONSOLIDATE_DELETES_PER_BATCH = 10000;
+const uint32_t CONSOLIDATE_NODES_PER_SLICE = 4096;
+const uint32_t CONSOLIDATE_SLICE_PAUSE_MS = 1;
+const uint32_t CONSOLIDATE_IDLE_POLL_MS = 100;
 
 // SSD Index related limits
 const uint64_t MAX_GRAPH_DEGREE = 512;
 const uint64_t SECTOR_LEN = 4096;
 const uint64_t MAX_N_SECTOR_READS = 128;
+// buffers smaller than this stay on base pages whatever the huge page mode, since a hugepage would mostly be waste
+const uint64_t HUGE_PAGE_MIN_ALLOC_BYTES = 1ULL << 20;
+// filtered disk search scans the matching points' PQ codes instead of walking the graph when at most this fraction
+// of the index can match
+const float FILTER_BRUTE_FORCE_SELECTIVITY = 0.001f;
+// adaptive disk search ends once the top k has held for this many hops, and widens its beam up to this width
+const uint32_t ADAPTIVE_SEARCH_STABLE_HOPS = 3;
+const uint32_t ADAPTIVE_SEARCH_MAX_BEAM_WIDTH = 16;
 
 // following constants should always be specified, but are useful as a
 // sensible default at cli / python boundaries
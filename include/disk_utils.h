@@ -40,6 +40,11 @@ const double THRESHOLD_FOR_CACHING_IN_GB = 1.0;
 const uint32_t NUM_NODES_TO_CACHE = 250000;
 const uint32_t WARMUP_L = 20;
 const uint32_t NUM_KMEANS_REPS = 12;
+// write buffers, shared by all location buckets, when scattering nodes into a graph-ordered disk layout
+const uint64_t LAYOUT_WINDOW_BYTES = 1ULL << 30;
+// sectors assembled per block, and blocks in flight between reader, assembly and writer, when writing a disk layout
+const uint64_t LAYOUT_BLOCK_BYTES = 32ULL << 20;
+const uint32_t LAYOUT_PIPELINE_DEPTH = 3;
 
 template <typename T, typename LabelT> class PQFlashIndex;
 
@@ -51,6 +56,12 @@ DISKANN_DLLEXPORT size_t calculate_num_pq_chunks(double final_index_ram_limit, s
 
 DISKANN_DLLEXPORT void read_idmap(const std::string &fname, std::vector<uint32_t> &ivecs);
 
+// graph given as npts rows of slot_width words, each a neighbour count followed by the neighbours; returns the node
+// id stored at each location
+DISKANN_DLLEXPORT std::vector<uint32_t> pack_sectors_by_graph(const uint32_t *graph_slots, const uint64_t npts,
+                                                              const uint64_t slot_width, const uint32_t medoid,
+                                                              const uint64_t nnodes_per_sector);
+
 #ifdef EXEC_ENV_OLS
 template <typename T>
 DISKANN_DLLEXPORT T *load_warmup(MemoryMappedFiles &files, const std::string &cache_warmup_file, uint64_t &warmup_num,
@@ -82,7 +93,8 @@ DISKANN_DLLEXPORT int build_merged_vamana_index(std::string base_file, diskann::
                                                 uint32_t num_threads, bool use_filters = false,
                                                 const std::string &label_file = std::string(""),
                                                 const std::string &labels_to_medoids_file = std::string(""),
-                                                const std::string &universal_label = "", const uint32_t Lf = 0);
+                                                const std::string &universal_label = "", const uint32_t Lf = 0,
+                                                const bool kmeans_parallel_seeding = false);
 
 template <typename T, typename LabelT>
 DISKANN_DLLEXPORT uint32_t optimize_beamwidth(std::unique_ptr<diskann::PQFlashIndex<T, LabelT>> &_pFlashIndex,
@@ -103,6 +115,7 @@ DISKANN_DLLEXPORT int build_disk_index(
 template <typename T>
 DISKANN_DLLEXPORT void create_disk_layout(const std::string base_file, const std::string mem_index_file,
                                           const std::string output_file,
-                                          const std::string reorder_data_file = std::string(""));
+                                          const std::string reorder_data_file = std::string(""),
+                                          const bool reorder_layout = false);
 
 } // namespace diskann
@@ -22,6 +22,11 @@ template <typename T> class Distance
     // distance comparison function
     DISKANN_DLLEXPORT virtual float compare(const T *a, const T *b, uint32_t length) const = 0;
 
+    // Compares b against each of num_queries queries, writing dists[i] = compare(queries[i], b). Implementations
+    // tile over the queries so b is read from memory once; the default just calls compare() per query.
+    DISKANN_DLLEXPORT virtual void compare_batch(const T *const *queries, uint32_t num_queries, const T *b,
+                                                 uint32_t length, float *dists) const;
+
     // Needed only for COSINE-BYTE and INNER_PRODUCT-BYTE
     DISKANN_DLLEXPORT virtual float compare(const T *a, const T *b, const float normA, const float normB,
                                             uint32_t length) const;
@@ -120,6 +125,8 @@ class DistanceL2Float : public Distance<float>
 #else
     DISKANN_DLLEXPORT virtual float compare(const float *a, const float *b, uint32_t size) const __attribute__((hot));
 #endif
+    DISKANN_DLLEXPORT virtual void compare_batch(const float *const *queries, uint32_t num_queries, const float *b,
+                                                 uint32_t size, float *dists) const override;
 };
 
 class AVXDistanceL2Float : public Distance<float>
@@ -199,6 +206,8 @@ class AVXDistanceInnerProductFloat : public Distance<float>
     {
     }
     DISKANN_DLLEXPORT virtual float compare(const float *a, const float *b, uint32_t length) const;
+    DISKANN_DLLEXPORT virtual void compare_batch(const float *const *queries, uint32_t num_queries, const float *b,
+                                                 uint32_t length, float *dists) const override;
 };
 
 class AVXNormalizedCosineDistanceFloat : public Distance<float>
@@ -219,6 +228,13 @@ class AVXNormalizedCosineDistanceFloat : public Distance<float>
         // This will ensure that cosine is between -1 and 1.
         return 1.0f + _innerProduct.compare(a, b, length);
     }
+    DISKANN_DLLEXPORT virtual void compare_batch(const float *const *queries, uint32_t num_queries, const float *b,
+                                                 uint32_t length, float *dists) const override
+    {
+        _innerProduct.compare_batch(queries, num_queries, b, length, dists);
+        for (uint32_t i = 0; i < num_queries; i++)
+            dists[i] += 1.0f;
+    }
     DISKANN_DLLEXPORT virtual uint32_t post_normalization_dimension(uint32_t orig_dimension) const override;
 
     DISKANN_DLLEXPORT virtual bool preprocessing_required() const;
@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "windows_customizations.h"
+
+namespace diskann
+{
+
+// Page size policy for large, long-lived buffers (vector data, PQ codes, node caches, query scratch). Random
+// accesses into a buffer of many gigabytes miss the TLB on almost every touch with 4 KB pages; 2 MB or 1 GB pages
+// cut the page walks. Modes other than NONE are ignored where the platform has no equivalent.
+enum class HugePageMode
+{
+    NONE,         // base pages
+    TRANSPARENT,  // 2 MB aligned buffers marked with madvise(MADV_HUGEPAGE) for the kernel to back with THP
+    EXPLICIT_2MB, // mmap(MAP_HUGETLB) from the preallocated 2 MB pool; TRANSPARENT when the pool is exhausted
+    EXPLICIT_1GB  // mmap(MAP_HUGETLB) from the preallocated 1 GB pool; TRANSPARENT when the pool is exhausted
+};
+
+DISKANN_DLLEXPORT HugePageMode get_huge_page_mode(const std::string &name);
+
+struct AllocatorStats
+{
+    uint64_t n_allocations = 0;    // live allocations
+    uint64_t bytes = 0;            // live bytes, after rounding to the page size
+    uint64_t peak_bytes = 0;       // high-water mark of bytes
+    uint64_t huge_page_bytes = 0;  // live bytes on explicit or transparent hugepages
+    uint64_t n_huge_fallbacks = 0; // explicit hugepage requests that fell back to transparent pages
+};
+
+// Applies to allocations made after the call; buffers allocated before keep their pages.
+DISKANN_DLLEXPORT void set_huge_page_mode(HugePageMode mode);
+DISKANN_DLLEXPORT HugePageMode get_huge_page_mode();
+DISKANN_DLLEXPORT AllocatorStats get_allocator_stats();
+
+// Allocates size bytes aligned to align (at most 4096) for a large buffer, following the huge page mode for sizes
+// of at least defaults::HUGE_PAGE_MIN_ALLOC_BYTES. The memory is not initialized; free it with free_large.
+DISKANN_DLLEXPORT void alloc_large(void **ptr, size_t size, size_t align);
+DISKANN_DLLEXPORT void free_large(void *ptr);
+
+// Bump allocator over one alloc_large block, so the many small buffers of a query scratch share pages (and a
+// hugepage, when enabled) instead of each taking its own. Buffers live until the arena is destroyed.
+class ScratchArena
+{
+  public:
+    DISKANN_DLLEXPORT explicit ScratchArena(size_t capacity);
+    DISKANN_DLLEXPORT ~ScratchArena();
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    // throws if the arena cannot fit size more bytes at the given alignment
+    DISKANN_DLLEXPORT void *allocate(size_t size, size_t align);
+
+    template <typename U> U *allocate_array(size_t count, size_t align)
+    {
+        return (U *)allocate(count * sizeof(U), align);
+    }
+
+    // bytes to reserve for a buffer of size bytes carved at the given alignment
+    static size_t footprint(size_t size, size_t align)
+    {
+        return size + align - 1;
+    }
+
+  private:
+    char *_buf = nullptr;
+    size_t _capacity = 0;
+    size_t _used = 0;
+};
+
+} // namespace diskann
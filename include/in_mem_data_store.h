@@ -55,6 +55,8 @@ template <typename data_t> class InMemDataStore : public AbstractDataStore<data_
                               AbstractScratch<data_t> *scratch) const override;
     virtual void get_distance(const data_t *preprocessed_query, const std::vector<location_t> &ids,
                               std::vector<float> &distances, AbstractScratch<data_t> *scratch_space) const override;
+    virtual void get_distance_batch(const data_t *const *preprocessed_queries, const uint32_t num_queries,
+                                    const location_t loc, float *distances) const override;
 
     virtual location_t calculate_medoid() const override;
 
@@ -63,6 +65,10 @@ template <typename data_t> class InMemDataStore : public AbstractDataStore<data_
     virtual size_t get_alignment_factor() const override;
 
   protected:
+    // for subclasses that supply the vectors themselves; leaves _data null instead of allocating capacity rows
+    InMemDataStore(const location_t capacity, const size_t dim, std::unique_ptr<Distance<data_t>> distance_fn,
+                   const bool allocate_data);
+
     virtual location_t expand(const location_t new_size) override;
     virtual location_t shrink(const location_t new_size) override;
 
@@ -71,7 +77,7 @@ template <typename data_t> class InMemDataStore : public AbstractDataStore<data_
     virtual location_t load_impl(AlignedFileReader &reader);
 #endif
 
-  private:
+  protected:
     data_t *_data = nullptr;
 
     size_t _aligned_dim;
@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "abstract_graph_store.h"
+
+// uint32 words per 64-byte cache line; slots are padded to a whole number of lines
+#define FLAT_GRAPH_SLOT_ALIGN_WORDS 16
+
+namespace diskann
+{
+
+// Graph store that keeps every adjacency list in one fixed-stride slot of a single cache-line-aligned buffer:
+// [degree][neighbours...] padded to a multiple of 64 bytes. Avoids a heap allocation and vector header per node
+// and keeps a node's degree and neighbours on the same lines. The stride is sized for the reserve degree given at
+// construction (or the largest degree in a loaded graph); adding past it throws.
+//
+// Slots never move except on resize, so each carries a version, seqlock style: writers (serialised by the caller's
+// node lock) make it odd while they rewrite the slot, and copy_neighbours retries until it sees the same even
+// version on both sides of its copy. Searches thus read lists without taking node locks.
+class InMemFlatGraphStore : public AbstractGraphStore
+{
+  public:
+    InMemFlatGraphStore(const size_t total_pts, const size_t reserve_graph_degree);
+    ~InMemFlatGraphStore();
+
+    // returns tuple of <nodes_read, start, num_frozen_points>
+    virtual std::tuple<uint32_t, uint32_t, size_t> load(const std::string &index_path_prefix,
+                                                        const size_t num_points) override;
+    virtual int store(const std::string &index_path_prefix, const size_t num_points, const size_t num_frozen_points,
+                      const uint32_t start) override;
+
+    virtual NeighbourList get_neighbours(const location_t i) const override;
+    virtual bool lock_free_reads() const override;
+    virtual void copy_neighbours(const location_t i, std::vector<location_t> &neighbours) const override;
+    virtual void add_neighbour(const location_t i, location_t neighbour_id) override;
+    virtual void clear_neighbours(const location_t i) override;
+    virtual void swap_neighbours(const location_t a, location_t b) override;
+
+    virtual void set_neighbours(const location_t i, std::vector<location_t> &neighbors) override;
+
+    virtual size_t resize_graph(const size_t new_size) override;
+    virtual void clear_graph() override;
+
+    virtual size_t get_max_range_of_graph() override;
+    virtual uint32_t get_max_observed_degree() override;
+
+  protected:
+    virtual std::tuple<uint32_t, uint32_t, size_t> load_impl(const std::string &filename, size_t expected_num_points);
+
+    int save_graph(const std::string &index_path_prefix, const size_t active_points, const size_t num_frozen_points,
+                   const uint32_t start);
+
+  protected:
+    inline uint32_t *slot(const location_t i) const
+    {
+        return _slots + (size_t)i * _stride;
+    }
+    // reallocates to num_slots slots of max_degree neighbours each, keeping existing lists
+    void relayout(size_t num_slots, size_t max_degree);
+
+    inline void begin_write(const location_t i)
+    {
+        if (_versions != nullptr)
+        {
+            _versions[i].store(_versions[i].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+    }
+    inline void end_write(const location_t i)
+    {
+        if (_versions != nullptr)
+            _versions[i].fetch_add(1, std::memory_order_release);
+    }
+
+    size_t _max_range_of_graph = 0;
+    uint32_t _max_observed_degree = 0;
+
+    uint32_t *_slots = nullptr;
+    size_t _num_slots = 0;
+    size_t _stride = 0;     // uint32 words per slot, including the degree word
+    size_t _max_degree = 0; // neighbours that fit in a slot
+
+    // one per slot, odd while the slot is being written; null for slots mapped read-only from a file
+    std::unique_ptr<std::atomic<uint32_t>[]> _versions;
+};
+
+} // namespace diskann
@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "abstract_graph_store.h"
+#include "locking.h"
+#include "tsl/robin_set.h"
+#include "windows_customizations.h"
+
+namespace diskann
+{
+
+// Reverse adjacency of a dynamic index's graph: for every location, the locations whose adjacency lists contain it.
+// Index keeps it in step with each incremental graph update, so consolidate_deletes only visits the nodes that point
+// at deleted ones instead of every location. Lists are guarded by striped locks; callers may take them while holding
+// an Index node lock, never the other way round.
+class InNeighborIndex
+{
+  public:
+    DISKANN_DLLEXPORT InNeighborIndex(const size_t num_points);
+
+    // discard the current contents and reverse the first num_points adjacency lists of graph_store
+    DISKANN_DLLEXPORT void build(const AbstractGraphStore &graph_store, const size_t num_points,
+                                 const uint32_t num_threads);
+    DISKANN_DLLEXPORT void resize(const size_t num_points);
+
+    // the adjacency list of location changed from old_nbrs to new_nbrs
+    DISKANN_DLLEXPORT void update(const uint32_t location, const NeighbourList &old_nbrs,
+                                  const std::vector<uint32_t> &new_nbrs);
+    DISKANN_DLLEXPORT void add_edge(const uint32_t from, const uint32_t to);
+
+    // every location with an edge into one of locations, without duplicates
+    DISKANN_DLLEXPORT std::vector<uint32_t> get_in_neighbors(const tsl::robin_set<uint32_t> &locations);
+
+    DISKANN_DLLEXPORT size_t memory_in_bytes() const;
+
+  private:
+    void remove_edge(const uint32_t from, const uint32_t to);
+    non_recursive_mutex &lock_for(const uint32_t location)
+    {
+        return _locks[location & (NUM_LOCK_STRIPES - 1)];
+    }
+
+    static const uint32_t NUM_LOCK_STRIPES = 4096;
+
+    std::vector<std::vector<uint32_t>> _in_nbrs;
+    std::vector<non_recursive_mutex> _locks;
+    std::atomic<size_t> _num_edges{0};
+};
+
+} // namespace diskann
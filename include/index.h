@@ -20,11 +20,15 @@
 #include "scratch.h"
 #include "in_mem_data_store.h"
 #include "in_mem_graph_store.h"
+#include "in_neighbor_index.h"
 #include "abstract_index.h"
 
 #include "quantized_distance.h"
 #include "pq_data_store.h"
 
+#include <condition_variable>
+#include <thread>
+
 #define OVERHEAD_FACTOR 1.1
 #define EXPAND_IF_FULL 0
 #define DEFAULT_MAXC 750
@@ -125,6 +129,8 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
     // For FastL2 search on a static index, we interleave the data with graph
     DISKANN_DLLEXPORT void optimize_index_layout();
 
+    DISKANN_DLLEXPORT void set_visited_set_type(VisitedSetType type);
+
     // For FastL2 search on optimized layout
     DISKANN_DLLEXPORT void search_with_optimized_layout(const T *query, size_t K, size_t L, uint32_t *indices);
 
@@ -134,6 +140,24 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
     DISKANN_DLLEXPORT std::pair<uint32_t, uint32_t> search(const T *query, const size_t K, const uint32_t L,
                                                            IDType *indices, float *distances = nullptr);
 
+    // Searches num_queries queries, query i at queries + i * query_stride, writing K results per query at
+    // indices + i * K. Each thread walks batch_size queries in lockstep: a round expands the closest unexpanded
+    // node of every query in the group, and each neighbour vector is then fetched once and compared against all
+    // queries that reached it. Results match calling search() on each query.
+    template <typename IDType>
+    DISKANN_DLLEXPORT void batch_search(const T *queries, const size_t num_queries, const size_t query_stride,
+                                        const size_t K, const uint32_t L, IDType *indices, float *distances = nullptr,
+                                        uint32_t *cmps = nullptr,
+                                        const uint32_t batch_size = defaults::QUERY_BATCH_SIZE);
+
+    // Returns the points within range of query (in the index's distance; for inner product, the negated product),
+    // closest first. Starts as a search with min_l_search and, while at least half of the list is in range,
+    // doubles the list up to max_l_search, continuing the same walk rather than starting over.
+    template <typename IDType>
+    DISKANN_DLLEXPORT size_t range_search(const T *query, const double range, const uint32_t min_l_search,
+                                          const uint32_t max_l_search, std::vector<IDType> &indices,
+                                          std::vector<float> &distances);
+
     // Initialize space for res_vectors before calling.
     DISKANN_DLLEXPORT size_t search_with_tags(const T *query, const uint64_t K, const uint32_t L, TagT *tags,
                                               float *distances, std::vector<T *> &res_vectors, bool use_filters = false,
@@ -168,6 +192,15 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
     // alongside inserts and lazy deletes, else it acquires _update_lock
     DISKANN_DLLEXPORT consolidation_report consolidate_deletes(const IndexWriteParameters &parameters);
 
+    // Consolidate on a background thread instead: take a batch of pending deletes, visit the affected nodes in
+    // slices with a pause between them, then release the batch's slots under a short _tag_lock. Inserts, deletes and
+    // searches continue throughout; save and resize wait for the current batch. Needs _conc_consolidate.
+    DISKANN_DLLEXPORT void start_background_consolidation(const IndexWriteParameters &parameters,
+                                                          const BackgroundConsolidationParams &background_params);
+    // Stops after the current slice; an unfinished batch stays in the delete set for the next consolidation.
+    DISKANN_DLLEXPORT void stop_background_consolidation();
+    DISKANN_DLLEXPORT consolidation_progress get_consolidation_progress();
+
     DISKANN_DLLEXPORT void prune_all_neighbors(const uint32_t max_degree, const uint32_t max_occlusion,
                                                const float alpha);
 
@@ -206,6 +239,9 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
 
     virtual std::pair<uint32_t, uint32_t> _search(const DataType &query, const size_t K, const uint32_t L,
                                                   std::any &indices, float *distances = nullptr) override;
+    virtual void _batch_search(const DataType &queries, const size_t num_queries, const size_t query_stride,
+                               const size_t K, const uint32_t L, std::any &indices, float *distances,
+                               uint32_t *cmps) override;
     virtual std::pair<uint32_t, uint32_t> _search_with_filters(const DataType &query,
                                                                const std::string &filter_label_raw, const size_t K,
                                                                const uint32_t L, std::any &indices,
@@ -248,6 +284,13 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
     uint32_t calculate_entry_point();
 
     void parse_label_file(const std::string &label_file, size_t &num_pts_labels);
+    // fills _location_to_label_bits from _location_to_labels if the index is static and its labels fit
+    void build_label_bitsets();
+    // labels as a bitset of _label_bitset_words words; labels past its end are dropped, as no point carries them
+    void get_label_bits(const std::vector<LabelT> &labels, uint64_t *bits) const;
+    // detect_common_filters with incoming_labels also given as label bits, or null to intersect the label lists
+    bool detect_common_filters(uint32_t point_id, bool search_invocation, const std::vector<LabelT> &incoming_labels,
+                               const uint64_t *incoming_bits) const;
 
     std::unordered_map<std::string, LabelT> load_label_map(const std::string &map_file);
 
@@ -255,10 +298,13 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
     // with iterate_to_fixed_point.
     std::vector<uint32_t> get_init_ids();
 
-    // The query to use is placed in scratch->aligned_query
+    // The query to use is placed in scratch->aligned_query. Expands until the closest Lindex candidates are all
+    // expanded, holding up to list_capacity (at least Lindex) of them; called again with empty init_ids and a larger
+    // Lindex, it resumes the walk left in scratch.
     std::pair<uint32_t, uint32_t> iterate_to_fixed_point(InMemQueryScratch<T> *scratch, const uint32_t Lindex,
                                                          const std::vector<uint32_t> &init_ids, bool use_filter,
-                                                         const std::vector<LabelT> &filters, bool search_invocation);
+                                                         const std::vector<LabelT> &filters, bool search_invocation,
+                                                         const uint32_t list_capacity = 0);
 
     void search_for_point_and_prune(int location, uint32_t Lindex, std::vector<uint32_t> &pruned_list,
                                     InMemQueryScratch<T> *scratch, bool use_filter = false,
@@ -311,6 +357,18 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
     void process_delete(const tsl::robin_set<uint32_t> &old_delete_set, size_t loc, const uint32_t range,
                         const uint32_t maxc, const float alpha, InMemQueryScratch<T> *scratch);
 
+    // One batch of background consolidation. Returns the number of slots released.
+    size_t consolidate_delete_batch(const IndexWriteParameters &parameters,
+                                    const BackgroundConsolidationParams &background_params);
+
+    // Replace the adjacency list of location, keeping _in_neighbors in step.
+    // Acquire _locks[location] before calling.
+    void update_neighbours(const uint32_t location, std::vector<uint32_t> &neighbours);
+
+    // Rebuild _in_neighbors from the whole graph, after bulk changes that bypass update_neighbours.
+    // No-op unless in-neighbor tracking is enabled. Acquire exclusive _update_lock before calling.
+    void rebuild_in_neighbors();
+
     void initialize_query_scratch(uint32_t num_threads, uint32_t search_l, uint32_t indexing_l, uint32_t r,
                                   uint32_t maxc, size_t dim);
 
@@ -379,6 +437,11 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
     // Location to label is only updated during insert_point(), all other reads are protected by
     // default as a location can only be released at end of consolidate deletes
     std::vector<std::vector<LabelT>> _location_to_labels;
+    // For static indexes whose labels are all below 64 * defaults::MAX_LABEL_BITSET_WORDS, the labels of location i
+    // as a bitset in words [i * _label_bitset_words, (i + 1) * _label_bitset_words), so filter checks are a few
+    // ANDs; empty otherwise
+    std::vector<uint64_t> _location_to_label_bits;
+    uint32_t _label_bitset_words = 0;
     tsl::robin_set<LabelT> _labels;
     std::string _labels_file;
     std::unordered_map<LabelT, uint32_t> _label_to_start_id;
@@ -398,6 +461,7 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
 
     // Query scratch data structures
     ConcurrentQueue<InMemQueryScratch<T> *> _query_scratch;
+    VisitedSetType _visited_set_type = VisitedSetType::AUTO;
 
     // Flags for PQ based distance calculation
     bool _pq_dist = false;
@@ -430,6 +494,10 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
     bool _is_saved = false;         // Checking if the index is already saved.
     bool _conc_consolidate = false; // use _lock while searching
 
+    // reverse edges of the graph for consolidate_deletes; null unless tracking is enabled, and while building
+    bool _track_in_neighbors = false;
+    std::unique_ptr<InNeighborIndex> _in_neighbors;
+
     // Acquire locks in the order below when acquiring multiple locks
     std::shared_timed_mutex // RW mutex between save/load (exclusive lock) and
         _update_lock;       // search/inserts/deletes/consolidate (shared lock)
@@ -443,6 +511,13 @@ template <typename T, typename TagT = uint32_t, typename LabelT = uint32_t> clas
     // Per node lock, cardinality=_max_points + _num_frozen_points
     std::vector<non_recursive_mutex> _locks;
 
+    // Background consolidation service; _consolidation_mutex guards _consolidation_progress
+    std::thread _consolidation_thread;
+    std::atomic<bool> _stop_consolidation{false};
+    std::mutex _consolidation_mutex;
+    std::condition_variable _consolidation_cv;
+    consolidation_progress _consolidation_progress;
+
     static const float INDEX_GROWTH_FACTOR;
 };
 } // namespace diskann
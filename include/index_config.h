@@ -7,12 +7,15 @@ namespace diskann
 {
 enum class DataStoreStrategy
 {
-    MEMORY
+    MEMORY,
+    MMAP // read-only, searched in place from a mapped aligned copy of the data file (MmapDataStore)
 };
 
 enum class GraphStoreStrategy
 {
-    MEMORY
+    MEMORY,
+    FLAT, // fixed-stride adjacency slots in one buffer (InMemFlatGraphStore)
+    MMAP  // read-only flat slots searched in place from a mapped file (MmapGraphStore)
 };
 
 struct IndexConfig
@@ -28,12 +31,17 @@ struct IndexConfig
     bool enable_tags;
     bool pq_dist_build;
     bool concurrent_consolidate;
+    // keep a reverse-edge index so consolidate_deletes visits only nodes pointing at deleted ones (InNeighborIndex)
+    bool track_in_neighbors;
     bool use_opq;
     bool filtered_index;
 
     size_t num_pq_chunks;
     size_t num_frozen_pts;
 
+    // MmapFlags for the MMAP data and graph strategies
+    uint32_t mmap_flags;
+
     std::string label_type;
     std::string tag_type;
     std::string data_type;
@@ -49,12 +57,14 @@ struct IndexConfig
                 bool pq_dist_build, bool concurrent_consolidate, bool use_opq, bool filtered_index,
                 std::string &data_type, const std::string &tag_type, const std::string &label_type,
                 std::shared_ptr<IndexWriteParameters> index_write_params,
-                std::shared_ptr<IndexSearchParams> index_search_params)
+                std::shared_ptr<IndexSearchParams> index_search_params, uint32_t mmap_flags,
+                bool track_in_neighbors)
         : data_strategy(data_strategy), graph_strategy(graph_strategy), metric(metric), dimension(dimension),
           max_points(max_points), dynamic_index(dynamic_index), enable_tags(enable_tags), pq_dist_build(pq_dist_build),
-          concurrent_consolidate(concurrent_consolidate), use_opq(use_opq), filtered_index(filtered_index),
-          num_pq_chunks(num_pq_chunks), num_frozen_pts(num_frozen_points), label_type(label_type), tag_type(tag_type),
-          data_type(data_type), index_write_params(index_write_params), index_search_params(index_search_params)
+          concurrent_consolidate(concurrent_consolidate), track_in_neighbors(track_in_neighbors), use_opq(use_opq),
+          filtered_index(filtered_index), num_pq_chunks(num_pq_chunks), num_frozen_pts(num_frozen_points),
+          mmap_flags(mmap_flags), label_type(label_type), tag_type(tag_type), data_type(data_type),
+          index_write_params(index_write_params), index_search_params(index_search_params)
     {
     }
 
@@ -84,6 +94,12 @@ class IndexConfigBuilder
         return *this;
     }
 
+    IndexConfigBuilder &with_mmap_flags(uint32_t mmap_flags)
+    {
+        this->_mmap_flags = mmap_flags;
+        return *this;
+    }
+
     IndexConfigBuilder &with_dimension(size_t dimension)
     {
         this->_dimension = dimension;
@@ -120,6 +136,12 @@ class IndexConfigBuilder
         return *this;
     }
 
+    IndexConfigBuilder &with_in_neighbor_tracking(bool track_in_neighbors)
+    {
+        this->_track_in_neighbors = track_in_neighbors;
+        return *this;
+    }
+
     IndexConfigBuilder &is_use_opq(bool use_opq)
     {
         this->_use_opq = use_opq;
@@ -222,7 +244,7 @@ class IndexConfigBuilder
         return IndexConfig(_data_strategy, _graph_strategy, _metric, _dimension, _max_points, _num_pq_chunks,
                            _num_frozen_pts, _dynamic_index, _enable_tags, _pq_dist_build, _concurrent_consolidate,
                            _use_opq, _filtered_index, _data_type, _tag_type, _label_type, _index_write_params,
-                           _index_search_params);
+                           _index_search_params, _mmap_flags, _track_in_neighbors);
     }
 
     IndexConfigBuilder(const IndexConfigBuilder &) = delete;
@@ -240,11 +262,13 @@ class IndexConfigBuilder
     bool _enable_tags = false;
     bool _pq_dist_build = false;
     bool _concurrent_consolidate = false;
+    bool _track_in_neighbors = false;
     bool _use_opq = false;
     bool _filtered_index{defaults::HAS_LABELS};
 
     size_t _num_pq_chunks = 0;
     size_t _num_frozen_pts{defaults::NUM_FROZEN_POINTS_STATIC};
+    uint32_t _mmap_flags = 0;
 
     std::string _label_type{"uint32"};
     std::string _tag_type{"uint32"};
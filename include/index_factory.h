@@ -3,6 +3,9 @@
 #include "index.h"
 #include "abstract_graph_store.h"
 #include "in_mem_graph_store.h"
+#include "in_mem_flat_graph_store.h"
+#include "mmap_graph_store.h"
+#include "mmap_data_store.h"
 #include "pq_data_store.h"
 
 namespace diskann
@@ -14,12 +17,13 @@ class IndexFactory
     DISKANN_DLLEXPORT std::unique_ptr<AbstractIndex> create_instance();
 
     DISKANN_DLLEXPORT static std::unique_ptr<AbstractGraphStore> construct_graphstore(
-        const GraphStoreStrategy stratagy, const size_t size, const size_t reserve_graph_degree);
+        const GraphStoreStrategy stratagy, const size_t size, const size_t reserve_graph_degree,
+        const uint32_t mmap_flags = MMAP_DEFAULT);
 
     template <typename T>
-    DISKANN_DLLEXPORT static std::shared_ptr<AbstractDataStore<T>> construct_datastore(DataStoreStrategy stratagy,
-                                                                                       size_t num_points,
-                                                                                       size_t dimension, Metric m);
+    DISKANN_DLLEXPORT static std::shared_ptr<AbstractDataStore<T>> construct_datastore(
+        DataStoreStrategy stratagy, size_t num_points, size_t dimension, Metric m,
+        const uint32_t mmap_flags = MMAP_DEFAULT);
     // For now PQDataStore incorporates within itself all variants of quantization that we support. In the
     // future it may be necessary to introduce an AbstractPQDataStore class to spearate various quantization
     // flavours.
@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+#if !defined(_WINDOWS) && defined(USE_IO_URING)
+
+#include "aligned_file_reader.h"
+
+// AlignedFileReader backed by io_uring. Each registered thread owns a ring
+// with the index file registered as a fixed file; its handle is stored in the
+// opaque IOContext. Buffers passed to register_buffer() are read into with
+// READ_FIXED, and SQPOLL can be requested to avoid submission syscalls.
+class IoUringAlignedFileReader : public AlignedFileReader
+{
+  private:
+    FileHandle file_desc;
+    bool use_sqpoll;
+    io_context_t bad_ctx = (io_context_t)-1;
+
+  public:
+    IoUringAlignedFileReader(bool use_sqpoll = false);
+    ~IoUringAlignedFileReader();
+
+    IOContext &get_ctx();
+
+    // register thread-id for a context
+    void register_thread();
+
+    // de-register thread-id for a context
+    void deregister_thread();
+    void deregister_all_threads();
+
+    // Open & close ops
+    // Blocking calls
+    void open(const std::string &fname);
+    void close();
+
+    // process batch of aligned requests in parallel
+    // NOTE :: blocking call
+    void read(std::vector<AlignedRead> &read_reqs, IOContext &ctx, bool async = false);
+
+    // issue reads without waiting; reap them with get_completed
+    bool supports_async_reads();
+    void submit_reads(std::vector<AlignedRead> &read_reqs, IOContext &ctx);
+    void get_completed(IOContext &ctx, uint64_t min_completions, std::vector<void *> &completed_bufs);
+
+    void register_buffer(IOContext &ctx, void *buf, uint64_t len);
+};
+
+#endif
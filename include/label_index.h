@@ -0,0 +1,120 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "tsl/robin_map.h"
+#include "windows_customizations.h"
+
+namespace diskann
+{
+
+// How the labels of a filter combine: a point matches if it carries any of them, or all of them
+enum class LabelMatch
+{
+    ANY,
+    ALL
+};
+
+template <typename LabelT> struct LabelFilter
+{
+    LabelFilter() = default;
+    explicit LabelFilter(const LabelT &label) : labels(1, label)
+    {
+    }
+    LabelFilter(const std::vector<LabelT> &labels, const LabelMatch match) : labels(labels), match(match)
+    {
+    }
+
+    std::vector<LabelT> labels;
+    LabelMatch match = LabelMatch::ANY;
+};
+
+template <typename LabelT> class LabelIndex;
+
+// A LabelFilter resolved against a LabelIndex for one query, so checking a point costs a bit test or a binary
+// search per filter label instead of a scan of the point's labels. Points carrying the universal label match
+// every filter.
+class LabelMatcher
+{
+  public:
+    bool matches(const uint32_t point) const;
+    // upper bound on the number of matching points: the sum of the label counts for ANY, the smallest for ALL
+    size_t max_matches() const
+    {
+        return _max_matches;
+    }
+
+  private:
+    template <typename LabelT> friend class LabelIndex;
+
+    struct Posting
+    {
+        std::vector<uint32_t> points; // ascending; empty when dense
+        std::vector<uint64_t> bits;   // one bit per point; empty when sparse
+        size_t count = 0;
+
+        bool contains(const uint32_t point) const;
+    };
+
+    std::vector<const Posting *> _postings;
+    const Posting *_universal = nullptr;
+    bool _match_all = false;
+    size_t _max_matches = 0;
+};
+
+inline bool LabelMatcher::Posting::contains(const uint32_t point) const
+{
+    if (!bits.empty())
+        return (bits[point >> 6] >> (point & 63)) & 1;
+    return std::binary_search(points.begin(), points.end(), point);
+}
+
+inline bool LabelMatcher::matches(const uint32_t point) const
+{
+    if (_universal != nullptr && _universal->contains(point))
+        return true;
+    if (_match_all)
+    {
+        for (auto posting : _postings)
+            if (!posting->contains(point))
+                return false;
+        return !_postings.empty();
+    }
+    for (auto posting : _postings)
+        if (posting->contains(point))
+            return true;
+    return false;
+}
+
+// Which points carry each label. A label's points are kept as a sorted list, or as a bitmap over all points once
+// that is smaller (more than one point in 32 carries it), roaring style at whole-index granularity.
+template <typename LabelT> class LabelIndex
+{
+  public:
+    // labels of point i are pts_to_labels[offsets[i]] .. pts_to_labels[offsets[i] + counts[i] - 1]
+    DISKANN_DLLEXPORT void build(const size_t num_points, const uint32_t *offsets, const uint32_t *counts,
+                                 const LabelT *pts_to_labels);
+
+    // labels the index has never seen match nothing; universal_label may be null
+    DISKANN_DLLEXPORT LabelMatcher compile(const LabelFilter<LabelT> &filter, const LabelT *universal_label) const;
+
+    // the points matching matcher, ascending
+    DISKANN_DLLEXPORT void get_matching_points(const LabelMatcher &matcher, std::vector<uint32_t> &points) const;
+
+    DISKANN_DLLEXPORT size_t num_labels() const;
+    DISKANN_DLLEXPORT size_t memory_in_bytes() const;
+
+  private:
+    const LabelMatcher::Posting *find(const LabelT &label) const;
+
+    size_t _num_points = 0;
+    tsl::robin_map<LabelT, uint32_t> _label_to_posting;
+    std::vector<LabelMatcher::Posting> _postings;
+};
+
+} // namespace diskann
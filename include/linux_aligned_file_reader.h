@@ -34,6 +34,11 @@ class LinuxAlignedFileReader : public AlignedFileReader
     // process batch of aligned requests in parallel
     // NOTE :: blocking call
     void read(std::vector<AlignedRead> &read_reqs, IOContext &ctx, bool async = false);
+
+    // issue reads without waiting; reap them with get_completed
+    bool supports_async_reads();
+    void submit_reads(std::vector<AlignedRead> &read_reqs, IOContext &ctx);
+    void get_completed(IOContext &ctx, uint64_t min_completions, std::vector<void *> &completed_bufs);
 };
 
 #endif
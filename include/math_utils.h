@@ -79,9 +79,24 @@ float lloyds_iter(float *data, size_t num_points, size_t dim, float *centers, si
 float run_lloyds(float *data, size_t num_points, size_t dim, float *centers, const size_t num_centers,
                  const size_t max_reps, std::vector<size_t> *closest_docs, uint32_t *closest_center);
 
+// Mini-batch k-means (Sculley, 2010): each step assigns batch_size points sampled from data to their closest
+// centers and moves every center towards its points by a step that shrinks as the center absorbs more of them. Runs
+// for at most max_reps passes' worth of batches, stopping earlier once the smoothed batch residual stops improving.
+// Each step costs batch_size / num_points of a Lloyd's iteration. centers must be initialized; if closest_center is
+// not NULL, it receives the final closest center of every point.
+float run_minibatch_kmeans(float *data, size_t num_points, size_t dim, float *centers, const size_t num_centers,
+                           const size_t batch_size, const size_t max_reps, uint32_t *closest_center);
+
 // assumes already memory allocated for pivot_data as new
 // float[num_centers*dim] and select randomly num_centers points as pivots
 void selecting_pivots(float *data, size_t num_points, size_t dim, float *pivot_data, size_t num_centers);
 
 void kmeanspp_selecting_pivots(float *data, size_t num_points, size_t dim, float *pivot_data, size_t num_centers);
+
+// Selects num_centers initial pivots with k-means||, which seeds about as well as k-means++ but in a few parallel
+// passes over the data instead of one serial pass per center, and has no limit on num_points, where
+// kmeanspp_selecting_pivots falls back to random pivots above 8388608 points. It computes several times as many
+// distances as k-means++, so it is opt-in: only an optimized BLAS on many cores makes it the faster of the two.
+void kmeans_parallel_selecting_pivots(float *data, size_t num_points, size_t dim, float *pivot_data,
+                                      size_t num_centers);
 } // namespace kmeans
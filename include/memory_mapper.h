@@ -13,10 +13,19 @@
 #else
 #include <Windows.h>
 #endif
+#include <cstdint>
 #include <string>
 
 namespace diskann
 {
+// hints for read-only index mappings; ignored where the platform has no equivalent
+enum MmapFlags : uint32_t
+{
+    MMAP_DEFAULT = 0,
+    MMAP_POPULATE = 1,  // fault the whole file in at map time instead of on first access
+    MMAP_HUGEPAGES = 2, // ask for transparent hugepages (effective on hugetlbfs/tmpfs or kernels with file THP)
+};
+
 class MemoryMapper
 {
   private:
@@ -34,6 +43,8 @@ class MemoryMapper
   public:
     MemoryMapper(const char *filename);
     MemoryMapper(const std::string &filename);
+    // maps filename read-only with the given MmapFlags; throws if the file cannot be mapped
+    MemoryMapper(const std::string &filename, uint32_t flags);
 
     char *getBuf();
     size_t getFileSize();
@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+#pragma once
+
+#include <memory>
+
+#include "in_mem_data_store.h"
+#include "memory_mapper.h"
+
+namespace diskann
+{
+// Read-only data store that searches the vectors in place from a mapped file instead of copying them into process
+// memory. load() maps <data file>.mmap, converting the .data file into that aligned layout first if the copy is
+// missing or older than the source; processes mapping the same file share its page cache. Anything that would
+// modify the vectors throws.
+template <typename data_t> class MmapDataStore : public InMemDataStore<data_t>
+{
+  public:
+    MmapDataStore(const location_t capacity, const size_t dim, std::unique_ptr<Distance<data_t>> distance_fn,
+                  const uint32_t mmap_flags);
+    virtual ~MmapDataStore();
+
+    virtual location_t load(const std::string &filename) override;
+
+    virtual void populate_data(const data_t *vectors, const location_t num_pts) override;
+    virtual void populate_data(const std::string &filename, const size_t offset) override;
+
+    virtual void set_vector(const location_t i, const data_t *const vector) override;
+
+    virtual void move_vectors(const location_t old_location_start, const location_t new_location_start,
+                              const location_t num_points) override;
+    virtual void copy_vectors(const location_t from_loc, const location_t to_loc, const location_t num_points) override;
+
+  protected:
+    // before load() these only record the capacity, so sizing the index for the file does not allocate it
+    virtual location_t expand(const location_t new_size) override;
+    virtual location_t shrink(const location_t new_size) override;
+
+  private:
+    void convert_data_file(const std::string &data_file, const std::string &mmap_file);
+    void throw_read_only(const std::string &operation) const;
+
+    uint32_t _mmap_flags;
+    std::unique_ptr<MemoryMapper> _mapper;
+};
+
+} // namespace diskann
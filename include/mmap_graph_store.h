@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <memory>
+
+#include "in_mem_flat_graph_store.h"
+#include "memory_mapper.h"
+
+namespace diskann
+{
+
+// Read-only flat graph store whose slots are searched in place from a mapped file. load() maps <graph file>.mmap,
+// converting the variable-length graph file into fixed-stride slots first if the copy is missing or older than the
+// source; processes mapping the same file share its page cache. Anything that would modify the graph throws.
+class MmapGraphStore : public InMemFlatGraphStore
+{
+  public:
+    MmapGraphStore(const size_t total_pts, const size_t reserve_graph_degree, const uint32_t mmap_flags);
+    ~MmapGraphStore();
+
+    virtual std::tuple<uint32_t, uint32_t, size_t> load(const std::string &index_path_prefix,
+                                                        const size_t num_points) override;
+
+    // nothing writes the slots, so readers never need node locks
+    virtual bool lock_free_reads() const override;
+
+    virtual void add_neighbour(const location_t i, location_t neighbour_id) override;
+    virtual void clear_neighbours(const location_t i) override;
+    virtual void swap_neighbours(const location_t a, location_t b) override;
+    virtual void set_neighbours(const location_t i, std::vector<location_t> &neighbors) override;
+
+    // before load() this only records the size, so sizing the index for the file does not allocate slots
+    virtual size_t resize_graph(const size_t new_size) override;
+    virtual void clear_graph() override;
+
+  private:
+    void convert_graph_file(const std::string &graph_file, const std::string &mmap_file);
+    void throw_read_only(const std::string &operation) const;
+
+    uint32_t _mmap_flags;
+    std::unique_ptr<MemoryMapper> _mapper;
+};
+
+} // namespace diskann
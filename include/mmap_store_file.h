@@ -0,0 +1,107 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+
+#include "ann_exception.h"
+
+// Files read by the mapped stores are the regular index files converted to their in-memory layout: a one-page
+// header followed by fixed-stride rows, so the payload starts page-aligned and every row keeps the alignment it has
+// in memory. The mapped copy sits next to its source as <source>.mmap.
+#define MMAP_STORE_HEADER_SIZE 4096
+#define MMAP_STORE_VERSION 1
+#define MMAP_DATA_MAGIC 0x5441444d4d4e4e41ULL  // "ANNMMDAT"
+#define MMAP_GRAPH_MAGIC 0x5048474d4d4e4e41ULL // "ANNMMGHP"
+
+namespace diskann
+{
+
+struct MmapStoreHeader
+{
+    uint64_t magic;
+    uint64_t version;
+    // size and modification time of the source file, to notice when the index was saved again
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t num_rows;   // points for data, nodes for the graph
+    uint64_t row_stride; // elements per row, including padding
+    uint64_t elem_size;
+    uint64_t dim;                 // data: vector dimension; graph: neighbours that fit in a row
+    uint64_t max_observed_degree; // graph only
+    uint64_t start;               // graph only
+    uint64_t num_frozen_pts;      // graph only
+};
+
+inline std::string get_mmap_store_file(const std::string &source_file)
+{
+    return source_file + ".mmap";
+}
+
+inline void get_mmap_store_source_stamp(const std::string &source_file, uint64_t &size, int64_t &mtime)
+{
+    struct stat st;
+    if (stat(source_file.c_str(), &st) != 0)
+    {
+        throw ANNException("Could not stat " + source_file, -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    size = (uint64_t)st.st_size;
+    mtime = (int64_t)st.st_mtime;
+}
+
+// true if mmap_file exists, has the expected magic and version and was converted from the current source_file
+inline bool read_mmap_store_header(const std::string &mmap_file, const std::string &source_file, uint64_t magic,
+                                   MmapStoreHeader &header)
+{
+    std::ifstream in(mmap_file, std::ios::binary);
+    if (!in.is_open())
+        return false;
+    memset(&header, 0, sizeof(header));
+    in.read((char *)&header, sizeof(header));
+    if (!in || header.magic != magic || header.version != MMAP_STORE_VERSION)
+        return false;
+
+    uint64_t source_size;
+    int64_t source_mtime;
+    get_mmap_store_source_stamp(source_file, source_size, source_mtime);
+    return header.source_size == source_size && header.source_mtime == source_mtime;
+}
+
+inline void write_mmap_store_header(std::ofstream &out, const MmapStoreHeader &header)
+{
+    char page[MMAP_STORE_HEADER_SIZE];
+    memset(page, 0, sizeof(page));
+    memcpy(page, &header, sizeof(header));
+    out.seekp(0, out.beg);
+    out.write(page, sizeof(page));
+}
+
+// Conversions write to a temporary name and rename it into place, so a process mapping the file never sees a
+// partial copy and concurrent conversions by several processes are harmless.
+inline std::string get_mmap_store_temp_file(const std::string &mmap_file)
+{
+    std::random_device rd;
+    return mmap_file + ".tmp" + std::to_string(rd());
+}
+
+inline void publish_mmap_store_file(const std::string &temp_file, const std::string &mmap_file)
+{
+#ifdef _WINDOWS
+    std::remove(mmap_file.c_str());
+#endif
+    if (std::rename(temp_file.c_str(), mmap_file.c_str()) != 0)
+    {
+        std::remove(temp_file.c_str());
+        throw ANNException("Could not rename " + temp_file + " to " + mmap_file, -1, __FUNCSIG__, __FILE__,
+                           __LINE__);
+    }
+}
+
+} // namespace diskann
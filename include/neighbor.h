@@ -104,11 +104,38 @@ class NeighborPriorityQueue
         return _data[pre];
     }
 
+    // Marks the unexpanded item with this id as expanded, as if closest_unexpanded() had
+    // returned it. Returns false if the id is not in the set or is already expanded.
+    bool mark_expanded(unsigned id)
+    {
+        for (size_t i = _cur; i < _size; i++)
+        {
+            if (_data[i].id != id)
+                continue;
+            if (_data[i].expanded)
+                return false;
+            _data[i].expanded = true;
+            while (_cur < _size && _data[_cur].expanded)
+            {
+                _cur++;
+            }
+            return true;
+        }
+        return false;
+    }
+
     bool has_unexpanded_node() const
     {
         return _cur < _size;
     }
 
+    // Whether one of the closest limit items is unexpanded. A search can hold more candidates than it expands and
+    // raise limit later to carry on from where it stopped.
+    bool has_unexpanded_node(size_t limit) const
+    {
+        return _cur < (std::min)(_size, limit);
+    }
+
     size_t size() const
     {
         return _size;
@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "tsl/robin_map.h"
+#include "windows_customizations.h"
+
+namespace diskann
+{
+
+// Concurrent cache of raw disk node records (coords followed by [NNBRS][NBRS]) filled while searching, under a
+// fixed memory budget. Ids are hashed to shards; each shard evicts with CLOCK and guards admission with a small
+// count-min frequency sketch (TinyLFU): a node read from disk only displaces the CLOCK victim if it has been
+// requested more often recently. The sketch is periodically halved, so the cache follows a drifting query mix.
+class NodeCache
+{
+  public:
+    DISKANN_DLLEXPORT NodeCache(uint64_t budget_bytes, uint64_t node_len, uint32_t num_shards = 64);
+
+    // Runs fn(char *node_buf) on the cached record for id while it is pinned and marks it as recently used;
+    // returns false if id is not cached. Either way the request counts towards admission.
+    template <typename Fn> bool access(uint32_t id, Fn &&fn)
+    {
+        Shard &shard = *_shards[shard_of(id)];
+        bool hit = false;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto iter = shard.slot_of.find(id);
+            if (iter != shard.slot_of.end())
+            {
+                shard.referenced[iter->second].store(1, std::memory_order_relaxed);
+                fn(shard.records.data() + (uint64_t)iter->second * _node_len);
+                hit = true;
+            }
+        }
+        record_request(shard, id);
+        return hit;
+    }
+
+    // offers a node record just read from disk; copied in if the admission policy accepts it
+    DISKANN_DLLEXPORT void admit(uint32_t id, const char *node_buf);
+
+    DISKANN_DLLEXPORT uint64_t capacity() const;
+    DISKANN_DLLEXPORT uint64_t size() const;
+
+  private:
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::vector<char> records;
+        tsl::robin_map<uint32_t, uint32_t> slot_of;
+        std::vector<uint32_t> slot_to_id;
+        std::unique_ptr<std::atomic<uint8_t>[]> referenced;
+        uint32_t num_used = 0;
+        uint32_t hand = 0;
+
+        // count-min sketch of recent requests: SKETCH_DEPTH rows of saturating 8-bit counters
+        std::unique_ptr<std::atomic<uint8_t>[]> sketch;
+        std::atomic<uint64_t> num_requests{0};
+    };
+
+    uint32_t shard_of(uint32_t id) const;
+    void record_request(Shard &shard, uint32_t id);
+    uint32_t estimate(const Shard &shard, uint32_t id) const;
+    void age_sketch(Shard &shard);
+
+    uint64_t _node_len;
+    uint32_t _slots_per_shard;
+    uint64_t _sketch_width; // power of 2
+    uint64_t _sample_size;  // requests per shard between sketch halvings
+    std::vector<std::unique_ptr<Shard>> _shards;
+};
+
+} // namespace diskann
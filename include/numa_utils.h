@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "windows_customizations.h"
+
+namespace diskann
+{
+
+// NUMA topology as the OS reports it (/sys/devices/system/node on Linux). Hosts without NUMA information, and
+// other platforms, appear as a single node holding every CPU.
+class NumaTopology
+{
+  public:
+    DISKANN_DLLEXPORT static const NumaTopology &get();
+
+    uint32_t num_nodes() const
+    {
+        return (uint32_t)_node_cpus.size();
+    }
+    const std::vector<uint32_t> &node_cpus(const uint32_t node) const
+    {
+        return _node_cpus[node];
+    }
+    // node of the CPU the calling thread is running on
+    DISKANN_DLLEXPORT uint32_t current_node() const;
+
+  private:
+    NumaTopology();
+
+    std::vector<std::vector<uint32_t>> _node_cpus;
+    std::vector<uint32_t> _cpu_to_node;
+};
+
+// Node whose memory holds the page containing addr, or -1 when that is unknown (the page was never touched, or
+// the platform cannot tell).
+DISKANN_DLLEXPORT int32_t numa_node_of(const void *addr);
+
+// Restricts the calling thread to the CPUs of node, so its first-touch allocations land in that node's memory.
+// Returns false where thread affinity is unsupported.
+DISKANN_DLLEXPORT bool pin_current_thread_to_numa_node(const uint32_t node);
+
+// Pins the threads of a num_threads OpenMP team round-robin over the NUMA nodes, thread i to node
+// i % num_nodes. OpenMP reuses its threads across parallel regions, so later regions of the same size keep the
+// placement. Returns false where thread affinity is unsupported.
+DISKANN_DLLEXPORT bool pin_omp_threads_to_numa_nodes(const uint32_t num_threads);
+
+} // namespace diskann
@@ -47,6 +47,23 @@ class IndexSearchParams
     const uint32_t num_search_threads;       // search threads
 };
 
+class BackgroundConsolidationParams
+{
+  public:
+    BackgroundConsolidationParams(const uint32_t deletes_per_batch = defaults::CONSOLIDATE_DELETES_PER_BATCH,
+                                  const uint32_t nodes_per_slice = defaults::CONSOLIDATE_NODES_PER_SLICE,
+                                  const uint32_t slice_pause_ms = defaults::CONSOLIDATE_SLICE_PAUSE_MS,
+                                  const uint32_t idle_poll_ms = defaults::CONSOLIDATE_IDLE_POLL_MS)
+        : deletes_per_batch(deletes_per_batch), nodes_per_slice(nodes_per_slice), slice_pause_ms(slice_pause_ms),
+          idle_poll_ms(idle_poll_ms)
+    {
+    }
+    const uint32_t deletes_per_batch; // ignored without in-neighbor tracking: each batch takes every pending delete
+    const uint32_t nodes_per_slice;   // nodes visited between pauses
+    const uint32_t slice_pause_ms;    // pause after each slice, letting inserts and searches through
+    const uint32_t idle_poll_ms;      // how often to look for new deletes when there are none
+};
+
 class IndexWriteParametersBuilder
 {
     /**
@@ -40,10 +40,13 @@ int shard_data_into_clusters_only_ids(const std::string data_file, float *pivots
 template <typename T>
 int retrieve_shard_data_from_ids(const std::string data_file, std::string idmap_filename, std::string data_filename);
 
+// kmeans_parallel_seeding picks the initial centers with k-means|| instead of k-means++; it only pays off with an
+// optimized BLAS on many cores, and is slower than k-means++ otherwise.
 template <typename T>
 int partition(const std::string data_file, const float sampling_rate, size_t num_centers, size_t max_k_means_reps,
-              const std::string prefix_path, size_t k_base);
+              const std::string prefix_path, size_t k_base, const bool kmeans_parallel_seeding = false);
 
 template <typename T>
 int partition_with_ram_budget(const std::string data_file, const double sampling_rate, double ram_budget,
-                              size_t graph_degree, const std::string prefix_path, size_t k_base);
+                              size_t graph_degree, const std::string prefix_path, size_t k_base,
+                              const bool kmeans_parallel_seeding = false);
@@ -18,21 +18,37 @@
 
 namespace diskann
 {
+// why a disk search stopped expanding candidates
+enum class SearchStopReason : uint8_t
+{
+    LIST_EXHAUSTED, // every candidate in the list was expanded
+    IO_LIMIT,       // the io_limit was reached first
+    TOP_K_STABLE    // adaptive search: the top k did not change for the configured number of hops
+};
+
 struct QueryStats
 {
     float total_us = 0; // total time to process query in micros
     float io_us = 0;    // total time spent in IO
     float cpu_us = 0;   // total time spent in CPU
 
-    unsigned n_4k = 0;         // # of 4kB reads
-    unsigned n_8k = 0;         // # of 8kB reads
-    unsigned n_12k = 0;        // # of 12kB reads
-    unsigned n_ios = 0;        // total # of IOs issued
-    unsigned read_size = 0;    // total # of bytes read
-    unsigned n_cmps_saved = 0; // # cmps saved
-    unsigned n_cmps = 0;       // # cmps
-    unsigned n_cache_hits = 0; // # cache_hits
-    unsigned n_hops = 0;       // # search hops
+    unsigned n_4k = 0;                   // # of 4kB reads
+    unsigned n_8k = 0;                   // # of 8kB reads
+    unsigned n_12k = 0;                  // # of 12kB reads
+    unsigned n_ios = 0;                  // total # of IOs issued
+    unsigned read_size = 0;              // total # of bytes read
+    unsigned n_cmps_saved = 0;           // # cmps saved
+    unsigned n_cmps = 0;                 // # cmps
+    unsigned n_cache_hits = 0;           // # cache_hits
+    unsigned n_hops = 0;                 // # search hops
+    unsigned n_dyn_cache_hits = 0;       // # nodes served by the dynamic node cache
+    unsigned n_dyn_cache_misses = 0;     // # dynamic node cache lookups that went to disk
+    unsigned n_colocated_expansions = 0; // # nodes expanded from a sector read for a neighbour
+    unsigned n_filter_scanned = 0;       // # points scanned by a filtered brute-force search
+    unsigned beam_width = 0;             // beam width of the last hop; grows during an adaptive search
+
+    bool adaptive_search = false; // adaptive beam width and early termination were enabled
+    SearchStopReason stop_reason = SearchStopReason::LIST_EXHAUSTED;
 };
 
 template <typename T>
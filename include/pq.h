@@ -59,13 +59,34 @@ void aggregate_coords(const unsigned *ids, const uint64_t n_ids, const uint8_t *
 void pq_dist_lookup(const uint8_t *pq_ids, const size_t n_pts, const size_t pq_nchunks, const float *pq_dists,
                     float *dists_out);
 
+// Transposed variants: codes are gathered in blocks of PQ_TRANSPOSE_BLOCK points, laid out as
+// [block][chunk][lane], so that one chunk's codes for a whole block are contiguous and the lookup can widen
+// and gather them with SIMD. out / pq_ids must hold n_ids rounded up to a whole block.
+void aggregate_coords_transposed(const std::vector<unsigned> &ids, const uint8_t *all_coords, const uint64_t ndims,
+                                 uint8_t *out);
+
+void aggregate_coords_transposed(const unsigned *ids, const uint64_t n_ids, const uint8_t *all_coords,
+                                 const uint64_t ndims, uint8_t *out);
+
+void pq_dist_lookup_transposed(const uint8_t *pq_ids, const size_t n_pts, const size_t pq_nchunks,
+                               const float *pq_dists, std::vector<float> &dists_out);
+
+void pq_dist_lookup_transposed(const uint8_t *pq_ids, const size_t n_pts, const size_t pq_nchunks,
+                               const float *pq_dists, float *dists_out);
+
+// Chunks are trained concurrently when there are at least as many as threads. kmeans_batch_size > 0 trains each
+// chunk with mini-batch k-means on batches of that many points instead of full Lloyd's iterations, which is much
+// cheaper for very large training samples at a small loss in quantization quality. kmeans_parallel_seeding picks
+// each chunk's initial pivots with k-means|| instead of k-means++ (see kmeans_parallel_selecting_pivots).
 DISKANN_DLLEXPORT int generate_pq_pivots(const float *const train_data, size_t num_train, unsigned dim,
                                          unsigned num_centers, unsigned num_pq_chunks, unsigned max_k_means_reps,
-                                         std::string pq_pivots_path, bool make_zero_mean = false);
+                                         std::string pq_pivots_path, bool make_zero_mean = false,
+                                         unsigned kmeans_batch_size = 0, bool kmeans_parallel_seeding = false);
 
 DISKANN_DLLEXPORT int generate_opq_pivots(const float *train_data, size_t num_train, unsigned dim, unsigned num_centers,
                                           unsigned num_pq_chunks, std::string opq_pivots_path,
-                                          bool make_zero_mean = false);
+                                          bool make_zero_mean = false, unsigned kmeans_batch_size = 0,
+                                          bool kmeans_parallel_seeding = false);
 
 DISKANN_DLLEXPORT int generate_pq_pivots_simplified(const float *train_data, size_t num_train, size_t dim,
                                                     size_t num_pq_chunks, std::vector<float> &pivot_data_vector);
@@ -83,11 +104,12 @@ DISKANN_DLLEXPORT int generate_pq_data_from_pivots_simplified(const float *data,
 template <typename T>
 void generate_disk_quantized_data(const std::string &data_file_to_use, const std::string &disk_pq_pivots_path,
                                   const std::string &disk_pq_compressed_vectors_path,
-                                  const diskann::Metric compareMetric, const double p_val, size_t &disk_pq_dims);
+                                  const diskann::Metric compareMetric, const double p_val, size_t &disk_pq_dims,
+                                  const bool kmeans_parallel_seeding = false);
 
 template <typename T>
 void generate_quantized_data(const std::string &data_file_to_use, const std::string &pq_pivots_path,
                              const std::string &pq_compressed_vectors_path, const diskann::Metric compareMetric,
                              const double p_val, const uint64_t num_pq_chunks, const bool use_opq,
-                             const std::string &codebook_prefix = "");
+                             const std::string &codebook_prefix = "", const bool kmeans_parallel_seeding = false);
 } // namespace diskann
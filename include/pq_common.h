@@ -9,6 +9,8 @@
 #define NUM_KMEANS_REPS_PQ 12
 #define MAX_PQ_TRAINING_SET_SIZE 256000
 #define MAX_PQ_CHUNKS 512
+// points per block in the transposed code layout used by pq_dist_lookup_transposed
+#define PQ_TRANSPOSE_BLOCK 32
 
 namespace diskann
 {
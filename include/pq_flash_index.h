@@ -3,10 +3,13 @@
 
 #pragma once
 #include "common_includes.h"
+#include <functional>
 
 #include "aligned_file_reader.h"
 #include "concurrent_queue.h"
+#include "label_index.h"
 #include "neighbor.h"
+#include "node_cache.h"
 #include "parameters.h"
 #include "percentile_stats.h"
 #include "pq.h"
@@ -58,6 +61,19 @@ template <typename T, typename LabelT = uint32_t> class PQFlashIndex
                                                                    std::vector<uint32_t> &node_list);
 #endif
 
+    // Keeps an adaptive cache of nodes read during search, in up to budget_bytes, on top of any static cache
+    // loaded with load_cache_list. Call after load() and before searching; 0 disables it.
+    DISKANN_DLLEXPORT void enable_dynamic_cache(uint64_t budget_bytes);
+
+    // Copies the PQ codes and the static node cache into the memory of every other NUMA node, and has each query
+    // read the copy local to the CPU it runs on. Pays off with search threads pinned to nodes (see
+    // pin_omp_threads_to_numa_nodes), at the cost of one copy per extra node. Call after load_cache_list and
+    // before searching; does nothing on a single-node host.
+    DISKANN_DLLEXPORT void replicate_for_numa();
+
+    // Chooses how each search thread tracks visited nodes (see VisitedSetType); AUTO selects HASH. Call before load().
+    DISKANN_DLLEXPORT void set_visited_set_type(VisitedSetType type);
+
     DISKANN_DLLEXPORT void cache_bfs_levels(uint64_t num_nodes_to_cache, std::vector<uint32_t> &node_list,
                                             const bool shuffle = false);
 
@@ -70,19 +86,58 @@ template <typename T, typename LabelT = uint32_t> class PQFlashIndex
                                               const bool use_filter, const LabelT &filter_label,
                                               const bool use_reorder_data = false, QueryStats *stats = nullptr);
 
+    // use_reorder_data reranks the best k_search * reorder_multiplier candidates with the full-precision vectors
+    // stored next to a disk-PQ index; indexes whose nodes hold full-precision vectors already return exact distances.
     DISKANN_DLLEXPORT void cached_beam_search(const T *query, const uint64_t k_search, const uint64_t l_search,
                                               uint64_t *res_ids, float *res_dists, const uint64_t beam_width,
                                               const uint32_t io_limit, const bool use_reorder_data = false,
-                                              QueryStats *stats = nullptr);
+                                              QueryStats *stats = nullptr,
+                                              const uint32_t reorder_multiplier = FULL_PRECISION_REORDER_MULTIPLIER);
 
     DISKANN_DLLEXPORT void cached_beam_search(const T *query, const uint64_t k_search, const uint64_t l_search,
                                               uint64_t *res_ids, float *res_dists, const uint64_t beam_width,
                                               const bool use_filter, const LabelT &filter_label,
                                               const uint32_t io_limit, const bool use_reorder_data = false,
-                                              QueryStats *stats = nullptr);
+                                              QueryStats *stats = nullptr,
+                                              const uint32_t reorder_multiplier = FULL_PRECISION_REORDER_MULTIPLIER);
+
+    // Returns the k_search nearest points matching filter. Filters that few points can match (see
+    // set_filter_brute_force_threshold) are answered by scanning the matching points instead of walking the graph.
+    DISKANN_DLLEXPORT void cached_beam_search(const T *query, const uint64_t k_search, const uint64_t l_search,
+                                              uint64_t *res_ids, float *res_dists, const uint64_t beam_width,
+                                              const LabelFilter<LabelT> &filter, const uint32_t io_limit,
+                                              const bool use_reorder_data = false, QueryStats *stats = nullptr,
+                                              const uint32_t reorder_multiplier = FULL_PRECISION_REORDER_MULTIPLIER);
+
+    // Searches num_queries queries (stored query_aligned_dim apart) on the calling thread, keeping up to
+    // max_concurrent_queries of them in flight at once: reads for all active queries share one submission and
+    // each completion advances whichever query owns it, so one thread keeps the device busy while queries wait on
+    // I/O. Results go to res_ids/res_dists at k_search stride, stats (if given) to stats[query], and
+    // on_query_done(query) fires as each query finishes. Each query stops issuing reads after io_limit of them, as
+    // in cached_beam_search. Unfiltered, without reordering; requires a reader with asynchronous reads.
+    DISKANN_DLLEXPORT void multiplexed_beam_search(const T *queries, const uint64_t num_queries,
+                                                   const uint64_t query_aligned_dim, const uint64_t k_search,
+                                                   const uint64_t l_search, uint64_t *res_ids, float *res_dists,
+                                                   const uint64_t beam_width, const uint32_t io_limit,
+                                                   const uint32_t max_concurrent_queries,
+                                                   QueryStats *stats = nullptr,
+                                                   const std::function<void(uint64_t)> &on_query_done = nullptr);
 
     DISKANN_DLLEXPORT LabelT get_converted_label(const std::string &filter_label);
+    // "a&b&c" matches points carrying all of the labels, "a|b|c" points carrying any of them
+    DISKANN_DLLEXPORT LabelFilter<LabelT> get_converted_filter(const std::string &filter);
+
+    // Filtered searches whose labels match at most selectivity * #points points (or l_search, if more) scan those
+    // points rather than the graph. 0 disables the scan.
+    DISKANN_DLLEXPORT void set_filter_brute_force_threshold(float selectivity);
 
+    // Adaptive search (non-pipelined only) starts each query at the requested beam width and doubles it, up to
+    // max_beam_width, after every hop that leaves the top k unchanged; the query stops once the top k has held for
+    // stable_hops hops in a row. 0 stable_hops turns it off.
+    DISKANN_DLLEXPORT void set_adaptive_search(uint32_t stable_hops,
+                                               uint32_t max_beam_width = defaults::ADAPTIVE_SEARCH_MAX_BEAM_WIDTH);
+
+    // all points within range, growing the candidate list from min_l_search towards max_l_search in place
     DISKANN_DLLEXPORT uint32_t range_search(const T *query1, const double range, const uint64_t min_l_search,
                                             const uint64_t max_l_search, std::vector<uint64_t> &indices,
                                             std::vector<float> &distances, const uint64_t min_beam_width,
@@ -90,6 +145,11 @@ template <typename T, typename LabelT = uint32_t> class PQFlashIndex
 
     DISKANN_DLLEXPORT uint64_t get_data_dim();
 
+    // Pipelined search keeps up to beam_width reads in flight and expands each
+    // node as soon as its read completes, instead of waiting for the whole beam.
+    // Requires a reader with asynchronous reads.
+    DISKANN_DLLEXPORT void set_pipelined_search(bool enable);
+
     std::shared_ptr<AlignedFileReader> &reader;
 
     DISKANN_DLLEXPORT diskann::Metric get_metric();
@@ -115,7 +175,6 @@ template <typename T, typename LabelT = uint32_t> class PQFlashIndex
     DISKANN_DLLEXPORT void set_universal_label(const LabelT &label);
 
   private:
-    DISKANN_DLLEXPORT inline bool point_has_label(uint32_t point_id, LabelT label_id);
     std::unordered_map<std::string, LabelT> load_label_map(std::basic_istream<char> &infile);
     DISKANN_DLLEXPORT void parse_label_file(std::basic_istream<char> &infile, size_t &num_pts_labels);
     DISKANN_DLLEXPORT void get_label_file_metadata(const std::string &fileContent, uint32_t &num_pts,
@@ -124,6 +183,83 @@ template <typename T, typename LabelT = uint32_t> class PQFlashIndex
                                                   const uint32_t nthreads);
     void reset_stream_for_reading(std::basic_istream<char> &infile);
 
+    // per-query search steps shared by cached_beam_search and multiplexed_beam_search
+
+    // read slots in sector_scratch owned by one pipelined query
+    struct PipelineState
+    {
+        std::vector<uint32_t> free_slots;
+        std::vector<uint32_t> slot_to_id;
+        uint64_t slot_len = 0;
+        uint64_t n_in_flight = 0;
+        uint32_t num_ios = 0;
+
+        void reset(const uint64_t max_reads_in_flight, const uint64_t read_len);
+    };
+
+    // per-hop buffers of a non-pipelined query, kept across hops to avoid reallocating
+    struct BeamState
+    {
+        std::vector<uint32_t> frontier;
+        std::vector<std::pair<uint32_t, char *>> frontier_nhoods;
+        std::vector<AlignedRead> frontier_read_reqs;
+        std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t *>>> cached_nhoods;
+
+        void reserve(const uint64_t beam_width);
+    };
+
+    // copies/normalizes the query into scratch and builds its PQ distance table; returns the query norm
+    float init_query(const T *query, SSDQueryScratch<T> *query_scratch);
+    void compute_pq_dists(SSDQueryScratch<T> *query_scratch, const uint32_t *ids, const uint64_t n_ids,
+                          float *dists_out);
+    // graph search behind the public cached_beam_search overloads; filter and matcher are null when unfiltered
+    // n_reorder is the number of candidates reranked with full-precision vectors, 0 for none
+    void beam_search(const T *query, const uint64_t k_search, const uint64_t l_search, uint64_t *res_ids,
+                     float *res_dists, const uint64_t beam_width, const LabelFilter<LabelT> *filter,
+                     const LabelMatcher *matcher, const uint32_t io_limit, const uint64_t n_reorder,
+                     QueryStats *stats);
+    // ranks every point matching matcher by PQ distance and reads the best l_search for full-precision distances
+    void filtered_scan(SSDQueryScratch<T> *query_scratch, IOContext &ctx, const LabelMatcher &matcher,
+                       const uint64_t l_search, const uint32_t io_limit, QueryStats *stats);
+    // seeds retset/visited with the best starting medoid, for filtered searches the best medoid of a filter label
+    void seed_search(SSDQueryScratch<T> *query_scratch, const uint64_t l_search, const LabelFilter<LabelT> *filter,
+                     const LabelMatcher *matcher);
+    void expand_node(SSDQueryScratch<T> *query_scratch, const uint32_t node_id, T *node_fp_coords,
+                     const uint64_t nnbrs, uint32_t *node_nbrs, const LabelMatcher *filter, QueryStats *stats);
+    // expands a raw node record (coords, then [NNBRS][NBRS]) from disk or the dynamic cache
+    void expand_node_record(SSDQueryScratch<T> *query_scratch, const uint32_t node_id, char *node_disk_buf,
+                            const LabelMatcher *filter, QueryStats *stats);
+    // expands a node from a freshly read sector and offers it to the dynamic cache
+    void expand_disk_node(SSDQueryScratch<T> *query_scratch, const uint32_t node_id, char *sector_buf,
+                          const LabelMatcher *filter, QueryStats *stats);
+    // expands unexpanded retset neighbours of node_id that were loaded in the same sector
+    void expand_colocated_nodes(SSDQueryScratch<T> *query_scratch, const uint32_t node_id, char *sector_buf,
+                                const LabelMatcher *filter, QueryStats *stats);
+    // expands node_id from the dynamic cache if it is there; counts the hit or miss
+    bool expand_dynamic_cached_node(SSDQueryScratch<T> *query_scratch, const uint32_t node_id,
+                                    const LabelMatcher *filter, QueryStats *stats);
+    // appends reads for the closest unexpanded candidates to read_reqs while slots are free
+    void issue_pipelined_reads(SSDQueryScratch<T> *query_scratch, PipelineState &state, const uint32_t io_limit,
+                               const LabelMatcher *filter, QueryStats *stats, std::vector<AlignedRead> &read_reqs);
+    void complete_pipelined_read(SSDQueryScratch<T> *query_scratch, PipelineState &state, char *buf,
+                                 const LabelMatcher *filter, QueryStats *stats);
+    // one hop: reads and expands the beam_width closest unexpanded candidates among the first list_size of retset;
+    // returns the number of reads issued
+    uint32_t expand_beam(SSDQueryScratch<T> *query_scratch, IOContext &ctx, BeamState &beam, const uint64_t beam_width,
+                         const uint64_t list_size, const LabelMatcher *filter, QueryStats *stats);
+    // recomputes the distances of the best n_reorder candidates from the full-precision reorder vectors
+    void rerank_full_precision(SSDQueryScratch<T> *query_scratch, IOContext &ctx, const uint64_t n_reorder,
+                               QueryStats *stats);
+    // the calling query's NUMA-local copy of the PQ codes and of node cache entries; the originals when the index
+    // is not replicated
+    const uint8_t *local_pq_codes(const SSDQueryScratch<T> *query_scratch) const;
+    T *local_cached_coords(const SSDQueryScratch<T> *query_scratch, T *coords) const;
+    uint32_t *local_cached_nbrs(const SSDQueryScratch<T> *query_scratch, uint32_t *nbrs) const;
+    void free_numa_replicas();
+    // sorts, reranks the best n_reorder candidates, and writes the top k_search results
+    void finish_query(SSDQueryScratch<T> *query_scratch, IOContext &ctx, const uint64_t k_search, uint64_t *indices,
+                      float *distances, const float query_norm, const uint64_t n_reorder, QueryStats *stats);
+
     // sector # on disk where node_id is present with in the graph part
     DISKANN_DLLEXPORT uint64_t get_node_sector(uint64_t node_id);
 
@@ -153,6 +289,10 @@ template <typename T, typename LabelT = uint32_t> class PQFlashIndex
     uint64_t _nnodes_per_sector = 0; // 0 for multi-sector nodes, >0 for multi-node sectors
     uint64_t _max_degree = 0;
 
+    // disk location of each node for graph-ordered layouts (see create_disk_layout); empty when nodes are stored
+    // in id order
+    std::vector<uint32_t> _id_to_location;
+
     // Data used for searching with re-order vectors
     uint64_t _ndims_reorder_vecs = 0;
     uint64_t _reorder_data_start_sector = 0;
@@ -212,16 +352,34 @@ template <typename T, typename LabelT = uint32_t> class PQFlashIndex
     // coord_cache; The T* in coord_cache are offsets into coord_cache_buf
     T *_coord_cache_buf = nullptr;
     tsl::robin_map<uint32_t, T *> _coord_cache;
+    size_t _num_cached_nodes = 0;
+
+    // per NUMA node copies of the PQ codes and cache buffers; empty unless replicate_for_numa was called
+    struct NumaReplica
+    {
+        uint8_t *pq_codes = nullptr;
+        uint32_t *nhood_cache_buf = nullptr;
+        T *coord_cache_buf = nullptr;
+    };
+    std::vector<NumaReplica> _numa_replicas;
+
+    // adaptive cache filled during search; null unless enabled
+    std::unique_ptr<NodeCache> _dynamic_cache;
 
     // thread-specific scratch
     ConcurrentQueue<SSDThreadData<T> *> _thread_data;
+    // extra per-query scratch for multiplexed search, grown on demand
+    ConcurrentQueue<SSDQueryScratch<T> *> _query_scratch_pool;
     uint64_t _max_nthreads;
     bool _load_flag = false;
     bool _count_visited_nodes = false;
+    VisitedSetType _visited_set_type = VisitedSetType::HASH;
+    bool _use_pipelined_search = false;
     bool _reorder_data_exists = false;
     uint64_t _reoreder_data_offset = 0;
 
     // filter support
+    // the labels of point i are _pts_to_labels[_pts_to_label_offsets[i]], ... (_pts_to_label_counts[i] of them)
     uint32_t *_pts_to_label_offsets = nullptr;
     uint32_t *_pts_to_label_counts = nullptr;
     LabelT *_pts_to_labels = nullptr;
@@ -233,6 +391,11 @@ template <typename T, typename LabelT = uint32_t> class PQFlashIndex
     tsl::robin_map<uint32_t, uint32_t> _dummy_to_real_map;
     tsl::robin_map<uint32_t, std::vector<uint32_t>> _real_to_dummy_map;
     std::unordered_map<std::string, LabelT> _label_map;
+    // points by label, built at load from the labels above
+    LabelIndex<LabelT> _label_index;
+    float _filter_brute_force_selectivity = defaults::FILTER_BRUTE_FORCE_SELECTIVITY;
+    uint32_t _adaptive_stable_hops = 0;
+    uint32_t _adaptive_max_beam_width = defaults::ADAPTIVE_SEARCH_MAX_BEAM_WIDTH;
 
 #ifdef EXEC_ENV_OLS
     // Set to a larger value than the actual header to accommodate
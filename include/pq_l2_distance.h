@@ -52,7 +52,8 @@ template <typename data_t> class PQL2Distance : public QuantizedDistance<data_t>
     // called at each iteration of the graph walk. NOTE: This function expects
     // 1. the query to be preprocessed using preprocess_query()
     // 2. the scratch object to contain the quantized vectors corresponding to ids
-    // in aligned_pq_coord_scratch. Done by calling aggregate_coords()
+    // in aligned_pq_coord_scratch, in the transposed block layout written by
+    // aggregate_coords_transposed()
     //
     virtual void preprocessed_distance(PQScratch<data_t> &pq_scratch, const uint32_t id_count,
                                        float *dists_out) override;
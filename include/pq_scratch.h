@@ -2,6 +2,7 @@
 #include <cstdint>
 #include "pq_common.h"
 #include "utils.h"
+#include "huge_page_allocator.h"
 
 namespace diskann
 {
@@ -15,9 +16,16 @@ template <typename T> class PQScratch
     float *rotated_query = nullptr;
     float *aligned_query_float = nullptr;
 
-    PQScratch(size_t graph_degree, size_t aligned_dim);
+    // buffers come from arena, and live as long as it does, when one is given
+    PQScratch(size_t graph_degree, size_t aligned_dim, ScratchArena *arena = nullptr);
     void initialize(size_t dim, const T *query, const float norm = 1.0f);
     virtual ~PQScratch();
+
+    // arena bytes taken by PQScratch(graph_degree, aligned_dim, arena)
+    static size_t arena_size(size_t graph_degree, size_t aligned_dim);
+
+  private:
+    bool _owns_buffers = true;
 };
 
 } // namespace diskann
\ No newline at end of file
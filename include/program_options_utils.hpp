@@ -77,5 +77,13 @@ const char *UNIVERSAL_LABEL =
     "in the labels file instead of listing all labels for a node.  DiskANN will not automatically assign a "
     "universal label to a node.";
 const char *FILTERED_LBUILD = "Build complexity for filtered points, higher value results in better graphs";
+const char *FLAT_GRAPH_DESCRIPTION = "Keep the graph in fixed-stride slots of one buffer instead of a vector per node. "
+                                     "Saves memory and improves locality on large indexes, and lets searches on a "
+                                     "dynamic index read neighbour lists without taking node locks.  Default value: "
+                                     "false";
+const char *MMAP_DESCRIPTION =
+    "Search a static index in place from memory-mapped files instead of loading it. The data and graph are "
+    "converted once to <file>.mmap next to the index; later loads are near-instant and processes on one host share "
+    "the page cache.  Default value: false";
 
 } // namespace program_options_utils
@@ -12,7 +12,15 @@ namespace diskann
 static const std::string VECTOR_KEY = "query", K_KEY = "k", INDICES_KEY = "indices", DISTANCES_KEY = "distances",
                          TAGS_KEY = "tags", QUERY_ID_KEY = "query_id", ERROR_MESSAGE_KEY = "error", L_KEY = "Ls",
                          TIME_TAKEN_KEY = "time_taken_in_us", PARTITION_KEY = "partition",
+                         STAGE_TIMES_KEY = "stage_times_in_us", PARSE_TIME_KEY = "parse", QUEUE_TIME_KEY = "queue",
+                         SEARCH_TIME_KEY = "search", SHARD_SEARCH_TIMES_KEY = "shard_search",
+                         AGGREGATE_TIME_KEY = "aggregate", BATCH_SIZE_KEY = "batch_size",
                          UNKNOWN_ERROR = "unknown_error";
 const unsigned int DEFAULT_L = 100;
+// Each shard searches the requests queued on it as one batch of at most this many queries
+const unsigned int DEFAULT_MAX_BATCH_SIZE = 32;
+// How long a shard holds the oldest queued request waiting for the batch to fill. 0 batches only the requests that
+// queued up while the previous batch was searching, which adds no latency at low load.
+const unsigned int DEFAULT_BATCH_WINDOW_US = 0;
 
 } // namespace diskann
\ No newline at end of file
@@ -0,0 +1,154 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <restapi/search_wrapper.h>
+
+namespace diskann
+{
+// What one shard returns for one request, with the time it spent queued on and searched by that shard
+struct ShardResult
+{
+    SearchResult result;
+    uint64_t queue_time_in_us;
+    uint64_t search_time_in_us;
+    unsigned int batch_size;
+};
+
+class QueryBatcherBase
+{
+  public:
+    virtual ~QueryBatcherBase() = default;
+};
+
+// Coalesces the requests sent to one shard into batches. A worker thread takes the oldest queued request, waits at
+// most batch_window for up to max_batch_size requests to queue behind it, and searches those with the same
+// dimensions, K and Ls as one BaseSearch::search_batch call. Every shard has its own worker, so a request submitted
+// to all shards is searched by all of them at once.
+template <typename T> class QueryBatcher : public QueryBatcherBase
+{
+  public:
+    QueryBatcher(BaseSearch &searcher, const unsigned int max_batch_size, const std::chrono::microseconds batch_window)
+        : _searcher(searcher), _max_batch_size(max_batch_size == 0 ? 1 : max_batch_size), _batch_window(batch_window),
+          _worker(&QueryBatcher::run, this)
+    {
+    }
+
+    ~QueryBatcher()
+    {
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            _stop = true;
+        }
+        _cv.notify_one();
+        _worker.join();
+    }
+
+    // query must stay valid until the returned future is ready
+    std::future<ShardResult> submit(const T *query, const unsigned int dimensions, const unsigned int K,
+                                    const unsigned int Ls)
+    {
+        PendingQuery pending{query, dimensions, K, Ls, std::chrono::steady_clock::now(), std::promise<ShardResult>()};
+        std::future<ShardResult> result = pending.promise.get_future();
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            _pending.push_back(std::move(pending));
+        }
+        _cv.notify_one();
+        return result;
+    }
+
+  private:
+    struct PendingQuery
+    {
+        const T *query;
+        unsigned int dimensions, K, Ls;
+        std::chrono::steady_clock::time_point enqueued;
+        std::promise<ShardResult> promise;
+    };
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(_lock);
+        while (true)
+        {
+            _cv.wait(lock, [this] { return _stop || !_pending.empty(); });
+            if (_pending.empty())
+                return;
+            _cv.wait_until(lock, _pending.front().enqueued + _batch_window,
+                           [this] { return _stop || _pending.size() >= _max_batch_size; });
+
+            const PendingQuery &oldest = _pending.front();
+            const unsigned int dimensions = oldest.dimensions, K = oldest.K, Ls = oldest.Ls;
+            std::vector<PendingQuery> batch;
+            for (auto iter = _pending.begin(); iter != _pending.end() && batch.size() < _max_batch_size;)
+            {
+                if (iter->dimensions == dimensions && iter->K == K && iter->Ls == Ls)
+                {
+                    batch.push_back(std::move(*iter));
+                    iter = _pending.erase(iter);
+                }
+                else
+                    iter++;
+            }
+
+            lock.unlock();
+            search(batch, dimensions, K, Ls);
+            lock.lock();
+        }
+    }
+
+    void search(std::vector<PendingQuery> &batch, const unsigned int dimensions, const unsigned int K,
+                const unsigned int Ls)
+    {
+        std::vector<const T *> queries;
+        for (const auto &pending : batch)
+            queries.push_back(pending.query);
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<SearchResult> results;
+        try
+        {
+            results = _searcher.search_batch(queries.data(), (unsigned int)batch.size(), dimensions, K, Ls);
+        }
+        catch (...)
+        {
+            for (auto &pending : batch)
+                pending.promise.set_exception(std::current_exception());
+            return;
+        }
+        const uint64_t search_time =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            const uint64_t queue_time =
+                std::chrono::duration_cast<std::chrono::microseconds>(start - batch[i].enqueued).count();
+            batch[i].promise.set_value(
+                ShardResult{std::move(results[i]), queue_time, search_time, (unsigned int)batch.size()});
+        }
+    }
+
+    BaseSearch &_searcher;
+    const unsigned int _max_batch_size;
+    const std::chrono::microseconds _batch_window;
+
+    std::mutex _lock;
+    std::condition_variable _cv;
+    std::list<PendingQuery> _pending;
+    bool _stop = false;
+
+    // last, so the queue and lock exist before the worker starts
+    std::thread _worker;
+};
+} // namespace diskann
@@ -102,9 +102,41 @@ class BaseSearch
         throw SearchNotImplementedException("uint8_t");
     }
 
+    // Searches num_queries queries sharing dimensions, K and Ls; result i answers queries[i]. Searchers override
+    // these to run the batch in parallel and share work across it; the defaults search the queries one by one.
+    virtual std::vector<SearchResult> search_batch(const float *const *queries, const unsigned int num_queries,
+                                                   const unsigned int dimensions, const unsigned int K,
+                                                   const unsigned int Ls)
+    {
+        return search_each(queries, num_queries, dimensions, K, Ls);
+    }
+    virtual std::vector<SearchResult> search_batch(const int8_t *const *queries, const unsigned int num_queries,
+                                                   const unsigned int dimensions, const unsigned int K,
+                                                   const unsigned int Ls)
+    {
+        return search_each(queries, num_queries, dimensions, K, Ls);
+    }
+    virtual std::vector<SearchResult> search_batch(const uint8_t *const *queries, const unsigned int num_queries,
+                                                   const unsigned int dimensions, const unsigned int K,
+                                                   const unsigned int Ls)
+    {
+        return search_each(queries, num_queries, dimensions, K, Ls);
+    }
+
     void lookup_tags(const unsigned K, const unsigned *indices, std::string *ret_tags);
 
   protected:
+    template <typename T>
+    std::vector<SearchResult> search_each(const T *const *queries, const unsigned int num_queries,
+                                          const unsigned int dimensions, const unsigned int K, const unsigned int Ls)
+    {
+        std::vector<SearchResult> results;
+        results.reserve(num_queries);
+        for (unsigned int i = 0; i < num_queries; i++)
+            results.push_back(search(queries[i], dimensions, K, Ls));
+        return results;
+    }
+
     bool _tags_enabled;
     std::vector<std::string> _tags_str;
 };
@@ -118,6 +150,11 @@ template <typename T> class InMemorySearch : public BaseSearch
 
     SearchResult search(const T *query, const unsigned int dimensions, const unsigned int K, const unsigned int Ls);
 
+    // Index::batch_search walks the queries in lockstep groups, so each neighbour vector it fetches is compared
+    // against every query in the group that reached it
+    std::vector<SearchResult> search_batch(const T *const *queries, const unsigned int num_queries,
+                                           const unsigned int dimensions, const unsigned int K, const unsigned int Ls);
+
   private:
     unsigned int _dimensions, _numPoints;
     std::unique_ptr<diskann::Index<T>> _index;
@@ -132,8 +169,12 @@ template <typename T> class PQFlashSearch : public BaseSearch
 
     SearchResult search(const T *query, const unsigned int dimensions, const unsigned int K, const unsigned int Ls);
 
+    std::vector<SearchResult> search_batch(const T *const *queries, const unsigned int num_queries,
+                                           const unsigned int dimensions, const unsigned int K, const unsigned int Ls);
+
   private:
     unsigned int _dimensions, _numPoints;
+    unsigned int _num_threads;
     std::unique_ptr<diskann::PQFlashIndex<T>> _index;
     std::shared_ptr<AlignedFileReader> reader;
 };
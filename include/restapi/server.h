@@ -4,6 +4,7 @@
 #pragma once
 
 #include <restapi/common.h>
+#include <restapi/query_batcher.h>
 #include <cpprest/http_listener.h>
 
 namespace diskann
@@ -12,7 +13,8 @@ class Server
 {
   public:
     Server(web::uri &url, std::vector<std::unique_ptr<diskann::BaseSearch>> &multi_searcher,
-           const std::string &typestring);
+           const std::string &typestring, const unsigned int max_batch_size = DEFAULT_MAX_BATCH_SIZE,
+           const unsigned int batch_window_us = DEFAULT_BATCH_WINDOW_US);
     virtual ~Server();
 
     pplx::task<void> open();
@@ -20,6 +22,7 @@ class Server
 
   protected:
     template <class T> void handle_post(web::http::http_request message);
+    template <class T> void start_batchers(const unsigned int max_batch_size, const unsigned int batch_window_us);
 
     template <typename T>
     web::json::value toJsonArray(const std::vector<T> &v, std::function<web::json::value(const T &)> valConverter);
@@ -41,5 +44,7 @@ class Server
     std::unique_ptr<web::http::experimental::listener::http_listener> _listener;
     const bool _multi_search;
     std::vector<std::unique_ptr<diskann::BaseSearch>> _multi_searcher;
+    // one per searcher, a QueryBatcher of the server's data type
+    std::vector<std::unique_ptr<QueryBatcherBase>> _batchers;
 };
 } // namespace diskann
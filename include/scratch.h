@@ -3,10 +3,9 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
-#include "boost_dynamic_bitset_fwd.h"
-// #include "boost/dynamic_bitset.hpp"
 #include "tsl/robin_set.h"
 #include "tsl/robin_map.h"
 #include "tsl/sparse_map.h"
@@ -16,6 +15,8 @@
 #include "neighbor.h"
 #include "defaults.h"
 #include "concurrent_queue.h"
+#include "visited_set.h"
+#include "huge_page_allocator.h"
 
 namespace diskann
 {
@@ -65,13 +66,13 @@ template <typename T> class InMemQueryScratch : public AbstractScratch<T>
     {
         return _occlude_factor;
     }
-    inline tsl::robin_set<uint32_t> &inserted_into_pool_rs()
+    inline VisitedSet &inserted_into_pool()
     {
-        return _inserted_into_pool_rs;
+        return _inserted_into_pool;
     }
-    inline boost::dynamic_bitset<> &inserted_into_pool_bs()
+    inline BatchVisitedSet &batch_visited()
     {
-        return *_inserted_into_pool_bs;
+        return _batch_visited;
     }
     inline std::vector<uint32_t> &id_scratch()
     {
@@ -93,6 +94,10 @@ template <typename T> class InMemQueryScratch : public AbstractScratch<T>
     {
         return _occlude_list_output;
     }
+    inline std::vector<uint32_t> &nbr_copy()
+    {
+        return _nbr_copy;
+    }
 
   private:
     uint32_t _L;
@@ -113,13 +118,11 @@ template <typename T> class InMemQueryScratch : public AbstractScratch<T>
     // _occlude_factor is initialized to maxc size
     std::vector<float> _occlude_factor;
 
-    // Capacity initialized to 20L
-    tsl::robin_set<uint32_t> _inserted_into_pool_rs;
+    // Configured by the index on first use; a hash set is given capacity 20L
+    VisitedSet _inserted_into_pool;
 
-    // Use a pointer here to allow for forward declaration of dynamic_bitset
-    // in public headers to avoid making boost a dependency for clients
-    // of DiskANN.
-    boost::dynamic_bitset<> *_inserted_into_pool_bs;
+    // Configured by Index::batch_search on first use and kept for later batches
+    BatchVisitedSet _batch_visited;
 
     // _id_scratch.size() must be > R*GRAPH_SLACK_FACTOR for iterate_to_fp
     std::vector<uint32_t> _id_scratch;
@@ -132,6 +135,9 @@ template <typename T> class InMemQueryScratch : public AbstractScratch<T>
     tsl::robin_set<uint32_t> _expanded_nodes_set;
     std::vector<Neighbor> _expanded_nghrs_vec;
     std::vector<uint32_t> _occlude_list_output;
+
+    // adjacency list copied out of the graph store by a lock-free read in iterate_to_fixed_point
+    std::vector<uint32_t> _nbr_copy;
 };
 
 //
@@ -145,8 +151,9 @@ template <typename T> class SSDQueryScratch : public AbstractScratch<T>
 
     char *sector_scratch = nullptr; // MUST BE AT LEAST [MAX_N_SECTOR_READS * SECTOR_LEN]
     size_t sector_idx = 0;          // index of next [SECTOR_LEN] scratch to use
+    uint32_t numa_node = 0;         // NUMA node whose copy of the index data the current query reads
 
-    tsl::robin_set<size_t> visited;
+    VisitedSet visited; // configured by the index after construction
     NeighborPriorityQueue retset;
     std::vector<Neighbor> full_retset;
 
@@ -154,6 +161,11 @@ template <typename T> class SSDQueryScratch : public AbstractScratch<T>
     ~SSDQueryScratch();
 
     void reset();
+
+  private:
+    // backs coord_scratch, sector_scratch, the aligned query and the PQ scratch, so a thread's search buffers
+    // share pages (hugepages, when enabled)
+    std::unique_ptr<ScratchArena> _arena;
 };
 
 template <typename T> class SSDThreadData
@@ -472,6 +472,33 @@ inline void load_bin(const std::string &bin_file, T *&data, size_t &npts, size_t
     diskann::cout << "done." << std::endl;
 }
 
+// Like load_bin, but into data the caller has allocated for the npts x dim entries the file must hold.
+template <typename T>
+inline void load_bin_into(const std::string &bin_file, T *data, const size_t npts, const size_t dim,
+                          size_t offset = 0)
+{
+    diskann::cout << "Reading bin file " << bin_file.c_str() << " ..." << std::endl;
+    std::ifstream reader;
+    reader.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+    try
+    {
+        reader.open(bin_file, std::ios::binary);
+        int npts_i32, dim_i32;
+        reader.seekg(offset, reader.beg);
+        reader.read((char *)&npts_i32, sizeof(int));
+        reader.read((char *)&dim_i32, sizeof(int));
+        if ((size_t)npts_i32 != npts || (size_t)dim_i32 != dim)
+            throw ANNException("Unexpected dimensions in " + bin_file, -1, __FUNCSIG__, __FILE__, __LINE__);
+        reader.read((char *)data, npts * dim * sizeof(T));
+    }
+    catch (std::system_error &e)
+    {
+        throw FileException(bin_file, e, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    diskann::cout << "done." << std::endl;
+}
+
 inline void wait_for_keystroke()
 {
     int a;
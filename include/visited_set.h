@@ -0,0 +1,298 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "tsl/robin_set.h"
+#include "ann_exception.h"
+
+// indexes up to this many points default to the epoch array (2 bytes per point per thread); beyond it
+// AUTO falls back to the hash set
+#define MAX_POINTS_FOR_EPOCH_VISITED 10000000
+// bits per expected visited node in the Bloom filter; with two probes this gives ~1.5% false positives
+#define VISITED_BLOOM_BITS_PER_NODE 16
+
+namespace diskann
+{
+
+enum class VisitedSetType
+{
+    AUTO,  // EPOCH when the in-memory index is small enough, HASH otherwise; always HASH for the disk index
+    HASH,  // robin_set of ids; memory proportional to the nodes visited
+    EPOCH, // one uint16 tag per point; clear() bumps the epoch
+    BLOOM  // fixed-size Bloom filter sized from the expected visit count; may skip a few unvisited nodes
+};
+
+inline VisitedSetType get_visited_set_type(const std::string &name)
+{
+    if (name == "auto")
+        return VisitedSetType::AUTO;
+    if (name == "hash")
+        return VisitedSetType::HASH;
+    if (name == "epoch")
+        return VisitedSetType::EPOCH;
+    if (name == "bloom")
+        return VisitedSetType::BLOOM;
+    throw ANNException("Unknown visited set type " + name + ". Use auto, hash, epoch or bloom.", -1, __FUNCSIG__,
+                       __FILE__, __LINE__);
+}
+
+// Per-thread set of node ids seen during one search. The backing store is chosen once in configure(); insert()
+// is on the hot path of every neighbor expansion, so it is kept inline.
+class VisitedSet
+{
+  public:
+    // num_points: ids must be below this; expected_visits: sizing hint for the hash set and Bloom filter.
+    // Can be called again when the index grows; the contents are cleared.
+    void configure(VisitedSetType type, size_t num_points, size_t expected_visits)
+    {
+        _requested_type = type;
+        if (type == VisitedSetType::AUTO)
+            type = num_points <= MAX_POINTS_FOR_EPOCH_VISITED ? VisitedSetType::EPOCH : VisitedSetType::HASH;
+        _type = type;
+        switch (_type)
+        {
+        case VisitedSetType::EPOCH:
+            if (_tags.size() < num_points)
+                _tags.resize(num_points, 0);
+            break;
+        case VisitedSetType::BLOOM: {
+            size_t num_words = 1;
+            while (num_words * 64 < (std::max)(expected_visits, (size_t)64) * VISITED_BLOOM_BITS_PER_NODE)
+                num_words <<= 1;
+            _bloom.resize(num_words);
+            _bloom_mask = num_words - 1;
+            break;
+        }
+        default:
+            _set.reserve(expected_visits);
+            break;
+        }
+        _num_points = num_points;
+        _expected_visits = expected_visits;
+        clear();
+    }
+
+    // returns true if id was not in the set
+    inline bool insert(uint32_t id)
+    {
+        switch (_type)
+        {
+        case VisitedSetType::EPOCH:
+            if (_tags[id] == _epoch)
+                return false;
+            _tags[id] = _epoch;
+            return true;
+        case VisitedSetType::BLOOM: {
+            uint64_t h = hash(id);
+            uint64_t &word = _bloom[h & _bloom_mask];
+            uint64_t bits = (1ULL << ((h >> 52) & 63)) | (1ULL << ((h >> 58) & 63));
+            if ((word & bits) == bits)
+                return false;
+            word |= bits;
+            return true;
+        }
+        default:
+            return _set.insert(id).second;
+        }
+    }
+
+    inline bool contains(uint32_t id) const
+    {
+        switch (_type)
+        {
+        case VisitedSetType::EPOCH:
+            return _tags[id] == _epoch;
+        case VisitedSetType::BLOOM: {
+            uint64_t h = hash(id);
+            uint64_t bits = (1ULL << ((h >> 52) & 63)) | (1ULL << ((h >> 58) & 63));
+            return (_bloom[h & _bloom_mask] & bits) == bits;
+        }
+        default:
+            return _set.find(id) != _set.end();
+        }
+    }
+
+    void clear()
+    {
+        switch (_type)
+        {
+        case VisitedSetType::EPOCH:
+            // tags from older epochs never match; only a wrap-around needs a real reset
+            if (++_epoch == 0)
+            {
+                std::fill(_tags.begin(), _tags.end(), (uint16_t)0);
+                _epoch = 1;
+            }
+            break;
+        case VisitedSetType::BLOOM:
+            memset(_bloom.data(), 0, _bloom.size() * sizeof(uint64_t));
+            break;
+        default:
+            _set.clear();
+            break;
+        }
+    }
+
+    // the type passed to configure(), before AUTO is resolved
+    VisitedSetType requested_type() const
+    {
+        return _requested_type;
+    }
+
+    VisitedSetType type() const
+    {
+        return _type;
+    }
+
+    size_t num_points() const
+    {
+        return _num_points;
+    }
+
+    size_t expected_visits() const
+    {
+        return _expected_visits;
+    }
+
+  private:
+    static inline uint64_t hash(uint32_t id)
+    {
+        uint64_t h = (uint64_t)id * 0x9E3779B97F4A7C15ULL;
+        return h ^ (h >> 29);
+    }
+
+    VisitedSetType _requested_type = VisitedSetType::HASH;
+    VisitedSetType _type = VisitedSetType::HASH;
+    size_t _num_points = 0;
+    size_t _expected_visits = 0;
+
+    tsl::robin_set<uint32_t> _set;
+
+    std::vector<uint16_t> _tags;
+    uint16_t _epoch = 0;
+
+    std::vector<uint64_t> _bloom;
+    uint64_t _bloom_mask = 0;
+};
+
+// Visited sets for a batch of queries searched together by one thread. With EPOCH the batch shares one array with
+// an entry per point: the batch's epoch followed by a bit per query, so a point costs 4 + 4 * ceil(batch_size / 32)
+// bytes instead of 2 bytes for every query. The other types keep one small VisitedSet per query.
+class BatchVisitedSet
+{
+  public:
+    // Can be called again when the index grows or the batch size changes; the contents are cleared.
+    void configure(VisitedSetType type, size_t num_points, size_t expected_visits, uint32_t batch_size)
+    {
+        _requested_type = type;
+        if (type == VisitedSetType::AUTO)
+            type = num_points <= MAX_POINTS_FOR_EPOCH_VISITED ? VisitedSetType::EPOCH : VisitedSetType::HASH;
+        _type = type;
+        if (_type == VisitedSetType::EPOCH)
+        {
+            _entry_words = 1 + (batch_size + 31) / 32;
+            _entries.assign(num_points * _entry_words, 0);
+            _epoch = 0;
+            _sets.clear();
+        }
+        else
+        {
+            std::vector<uint32_t>().swap(_entries);
+            _sets.resize(batch_size);
+            for (auto &set : _sets)
+                set.configure(_type, num_points, expected_visits);
+        }
+        _num_points = num_points;
+        _expected_visits = expected_visits;
+        _batch_size = batch_size;
+        clear();
+    }
+
+    // empties the set of every query in the batch
+    void clear()
+    {
+        if (_type == VisitedSetType::EPOCH)
+        {
+            // entries from older epochs are treated as empty; only a wrap-around needs a real reset
+            if (++_epoch == 0)
+            {
+                std::fill(_entries.begin(), _entries.end(), 0);
+                _epoch = 1;
+            }
+        }
+        else
+        {
+            for (auto &set : _sets)
+                set.clear();
+        }
+    }
+
+    // returns true if id was not in the set of query b
+    inline bool insert(uint32_t b, uint32_t id)
+    {
+        if (_type == VisitedSetType::EPOCH)
+        {
+            uint32_t *entry = _entries.data() + (size_t)id * _entry_words;
+            if (entry[0] != _epoch)
+            {
+                entry[0] = _epoch;
+                std::fill(entry + 1, entry + _entry_words, 0);
+            }
+            uint32_t &word = entry[1 + (b >> 5)];
+            const uint32_t bit = 1U << (b & 31);
+            if (word & bit)
+                return false;
+            word |= bit;
+            return true;
+        }
+        return _sets[b].insert(id);
+    }
+
+    // the type passed to configure(), before AUTO is resolved
+    VisitedSetType requested_type() const
+    {
+        return _requested_type;
+    }
+
+    VisitedSetType type() const
+    {
+        return _type;
+    }
+
+    size_t num_points() const
+    {
+        return _num_points;
+    }
+
+    size_t expected_visits() const
+    {
+        return _expected_visits;
+    }
+
+    uint32_t batch_size() const
+    {
+        return _batch_size;
+    }
+
+  private:
+    VisitedSetType _requested_type = VisitedSetType::HASH;
+    VisitedSetType _type = VisitedSetType::HASH;
+    size_t _num_points = 0;
+    size_t _expected_visits = 0;
+    uint32_t _batch_size = 0;
+
+    std::vector<VisitedSet> _sets;
+
+    std::vector<uint32_t> _entries;
+    size_t _entry_words = 1;
+    uint32_t _epoch = 0;
+};
+
+} // namespace diskann
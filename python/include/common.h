@@ -4,6 +4,8 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdexcept>
+#include <string>
 #include <utility>
 
 #include <pybind11/pybind11.h>
@@ -21,4 +23,23 @@ typedef uint32_t DynamicIdType;
 
 template <class IdType> using NeighborsAndDistances = std::pair<py::array_t<IdType>, py::array_t<float>>;
 
+// Caller-supplied result buffers for the *_into searches. They are written in place, so the bindings take them
+// without conversion and they must already be C-contiguous and shaped (num_queries, knn).
+template <class IdType> using IdsOut = py::array_t<IdType, py::array::c_style>;
+using DistancesOut = py::array_t<float, py::array::c_style>;
+
+template <class IdType>
+inline void check_result_buffers(const IdsOut<IdType> &ids, const DistancesOut &dists, const uint64_t num_queries,
+                                 const uint64_t knn)
+{
+    const auto has_shape = [num_queries, knn](const py::array &buffer) {
+        return buffer.ndim() == 2 && (uint64_t)buffer.shape(0) == num_queries && (uint64_t)buffer.shape(1) == knn;
+    };
+    if (!has_shape(ids) || !has_shape(dists))
+    {
+        throw std::invalid_argument("result buffers must have shape (" + std::to_string(num_queries) + ", " +
+                                    std::to_string(knn) + ")");
+    }
+}
+
 }; // namespace diskannpy
@@ -40,6 +40,9 @@ class DynamicMemoryIndex
     NeighborsAndDistances<DynamicIdType> batch_search(py::array_t<DT, py::array::c_style | py::array::forcecast> &queries,
                                             uint64_t num_queries, uint64_t knn, uint64_t complexity,
                                             uint32_t num_threads);
+    void batch_search_into(py::array_t<DT, py::array::c_style | py::array::forcecast> &queries, uint64_t num_queries,
+                           uint64_t knn, uint64_t complexity, uint32_t num_threads, IdsOut<DynamicIdType> &ids,
+                           DistancesOut &dists);
     void consolidate_delete();
     size_t num_points();
 
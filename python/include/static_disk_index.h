@@ -46,6 +46,10 @@ template <typename DT> class StaticDiskIndex
         py::array_t<DT, py::array::c_style | py::array::forcecast> &queries, uint64_t num_queries, uint64_t knn,
         uint64_t complexity, uint64_t beam_width, uint32_t num_threads);
 
+    void batch_search_into(py::array_t<DT, py::array::c_style | py::array::forcecast> &queries, uint64_t num_queries,
+                           uint64_t knn, uint64_t complexity, uint64_t beam_width, uint32_t num_threads,
+                           IdsOut<StaticIdType> &ids, DistancesOut &dists);
+
   private:
     std::shared_ptr<AlignedFileReader> _reader;
     diskann::PQFlashIndex<DT> _index;
@@ -34,6 +34,10 @@ template <typename DT> class StaticMemoryIndex
         py::array_t<DT, py::array::c_style | py::array::forcecast> &queries, uint64_t num_queries, uint64_t knn,
         uint64_t complexity, uint32_t num_threads);
 
+    void batch_search_into(py::array_t<DT, py::array::c_style | py::array::forcecast> &queries, uint64_t num_queries,
+                           uint64_t knn, uint64_t complexity, uint32_t num_threads, IdsOut<StaticIdType> &ids,
+                           DistancesOut &dists);
+
   private:
     diskann::Index<DT, StaticIdType, filterT> _index;
 };
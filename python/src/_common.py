@@ -2,7 +2,9 @@
 # Licensed under the MIT license.
 
 import os
+import threading
 import warnings
+from concurrent.futures import Executor, ThreadPoolExecutor
 from enum import Enum
 from pathlib import Path
 from typing import Literal, NamedTuple, Optional, Tuple, Type, Union
@@ -66,7 +68,7 @@ def _castable_dtype_or_raise(
     data: Union[VectorLike, VectorLikeBatch, VectorIdentifierBatch], expected: np.dtype
 ) -> np.ndarray:
     if isinstance(data, np.ndarray) and np.can_cast(data.dtype, expected):
-        return data.astype(expected, casting="safe")
+        return data.astype(expected, casting="safe", copy=False)
     else:
         raise TypeError(
             f"expecting a numpy ndarray of dtype {expected}, not a {type(data)}"
@@ -77,6 +79,59 @@ def _assert_2d(vectors: np.ndarray, name: str):
     _assert(len(vectors.shape) == 2, f"{name} must be 2d numpy array")
 
 
+def _valid_result_buffers(
+    identifiers_out: Optional[np.ndarray],
+    distances_out: Optional[np.ndarray],
+    num_queries: int,
+    k_neighbors: int,
+) -> bool:
+    """
+    Checks caller supplied result buffers for a batch search. The native code writes into them in place, so they are
+    never cast or copied; returns False when neither buffer was provided.
+    """
+    if identifiers_out is None and distances_out is None:
+        return False
+    _assert(
+        identifiers_out is not None and distances_out is not None,
+        "identifiers_out and distances_out must be provided together",
+    )
+    for buffer, name, dtype in (
+        (identifiers_out, "identifiers_out", np.uint32),
+        (distances_out, "distances_out", np.float32),
+    ):
+        _assert(
+            isinstance(buffer, np.ndarray) and buffer.dtype == dtype,
+            f"{name} must be a numpy ndarray of dtype {np.dtype(dtype).name}",
+        )
+        _assert(
+            buffer.shape == (num_queries, k_neighbors),
+            f"{name} must have shape {(num_queries, k_neighbors)}, not {buffer.shape}",
+        )
+        _assert(
+            buffer.flags.c_contiguous and buffer.flags.writeable,
+            f"{name} must be C-contiguous and writeable",
+        )
+    return True
+
+
+_default_executor_lock = threading.Lock()
+_default_executor_instance: Optional[ThreadPoolExecutor] = None
+
+
+def _default_executor() -> Executor:
+    """
+    Shared thread pool behind the *_async search methods when the caller does not pass one. The native searches
+    release the GIL, so requests submitted here run concurrently.
+    """
+    global _default_executor_instance
+    with _default_executor_lock:
+        if _default_executor_instance is None:
+            _default_executor_instance = ThreadPoolExecutor(
+                max_workers=os.cpu_count(), thread_name_prefix="diskannpy"
+            )
+        return _default_executor_instance
+
+
 __MAX_UINT32_VAL = 4_294_967_295
 
 
@@ -3,6 +3,7 @@
 
 import os
 import warnings
+from concurrent.futures import Executor, Future
 from pathlib import Path
 from typing import Optional
 
@@ -27,9 +28,11 @@ from ._common import (
     _assert_is_nonnegative_uint32,
     _assert_is_positive_uint32,
     _castable_dtype_or_raise,
+    _default_executor,
     _ensure_index_metadata,
     _valid_index_prefix,
     _valid_metric,
+    _valid_result_buffers,
     _write_index_metadata,
 )
 from ._diskannpy import defaults
@@ -318,6 +321,8 @@ class DynamicMemoryIndex:
         k_neighbors: int,
         complexity: int,
         num_threads: int,
+        identifiers_out: Optional[np.ndarray] = None,
+        distances_out: Optional[np.ndarray] = None,
     ) -> QueryResponseBatch:
         """
         Searches the index by a batch of query vectors.
@@ -332,6 +337,10 @@ class DynamicMemoryIndex:
         - **complexity**: Size of distance ordered list of candidate neighbors to use while searching. List size
           increases accuracy at the cost of latency. Must be at least k_neighbors in size.
         - **num_threads**: Number of threads to use when searching this index. (>= 0), 0 = num_threads in system
+        - **identifiers_out**: Optional preallocated np.uint32 array of shape (number of queries, k_neighbors) the
+          identifiers are written into. Must be given together with ``distances_out``. Both must be C-contiguous and
+          writeable; they are filled in place and returned, so reusing them across calls avoids per-call allocation.
+        - **distances_out**: Optional preallocated np.float32 array of the same shape for the distances.
         """
         _queries = _castable_dtype_or_raise(queries, expected=self._vector_dtype)
         _assert_2d(_queries, "queries")
@@ -352,6 +361,17 @@ class DynamicMemoryIndex:
             complexity = k_neighbors
 
         num_queries, dim = queries.shape
+        if _valid_result_buffers(identifiers_out, distances_out, num_queries, k_neighbors):
+            self._index.batch_search_into(
+                queries=_queries,
+                num_queries=num_queries,
+                knn=k_neighbors,
+                complexity=complexity,
+                num_threads=num_threads,
+                ids=identifiers_out,
+                dists=distances_out,
+            )
+            return QueryResponseBatch(identifiers=identifiers_out, distances=distances_out)
         neighbors, distances = self._index.batch_search(
             queries=_queries,
             num_queries=num_queries,
@@ -361,6 +381,38 @@ class DynamicMemoryIndex:
         )
         return QueryResponseBatch(identifiers=neighbors, distances=distances)
 
+    def batch_search_async(
+        self,
+        queries: VectorLikeBatch,
+        k_neighbors: int,
+        complexity: int,
+        num_threads: int,
+        identifiers_out: Optional[np.ndarray] = None,
+        distances_out: Optional[np.ndarray] = None,
+        executor: Optional[Executor] = None,
+    ) -> "Future[QueryResponseBatch]":
+        """
+        Submits `batch_search` to an executor and returns a `concurrent.futures.Future` for its QueryResponseBatch.
+
+        The native search releases the GIL, so several batches submitted this way run concurrently with each other
+        and with the calling thread. Each batch still uses up to ``num_threads`` search threads; when many batches
+        are in flight, lower ``num_threads`` so their sum stays near the core count.
+
+        ### Parameters
+        Same as `batch_search`, plus:
+        - **executor**: The `concurrent.futures.Executor` to run the search on. Defaults to a thread pool shared by
+          all diskannpy indices.
+        """
+        return (executor or _default_executor()).submit(
+            self.batch_search,
+            queries=queries,
+            k_neighbors=k_neighbors,
+            complexity=complexity,
+            num_threads=num_threads,
+            identifiers_out=identifiers_out,
+            distances_out=distances_out,
+        )
+
     def save(self, save_path: str, index_prefix: str = "ann"):
         """
         Saves this index to file.
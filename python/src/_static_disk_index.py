@@ -3,6 +3,7 @@
 
 import os
 import warnings
+from concurrent.futures import Executor, Future
 from typing import Optional
 
 import numpy as np
@@ -22,9 +23,11 @@ from ._common import (
     _assert_is_nonnegative_uint32,
     _assert_is_positive_uint32,
     _castable_dtype_or_raise,
+    _default_executor,
     _ensure_index_metadata,
     _valid_index_prefix,
     _valid_metric,
+    _valid_result_buffers,
 )
 
 __ALL__ = ["StaticDiskIndex"]
@@ -153,6 +156,8 @@ class StaticDiskIndex:
         complexity: int,
         num_threads: int,
         beam_width: int = 2,
+        identifiers_out: Optional[np.ndarray] = None,
+        distances_out: Optional[np.ndarray] = None,
     ) -> QueryResponseBatch:
         """
         Searches the index by a batch of query vectors.
@@ -173,6 +178,10 @@ class StaticDiskIndex:
           throughput with a fixed SSD IOps rating, use W=1. For best latency, use W=4,8 or higher complexity search.
           Specifying 0 will optimize the beamwidth depending on the number of threads performing search, but will
           involve some tuning overhead.
+        - **identifiers_out**: Optional preallocated np.uint32 array of shape (number of queries, k_neighbors) the
+          identifiers are written into. Must be given together with ``distances_out``. Both must be C-contiguous and
+          writeable; they are filled in place and returned, so reusing them across calls avoids per-call allocation.
+        - **distances_out**: Optional preallocated np.float32 array of the same shape for the distances.
         """
         _queries = _castable_dtype_or_raise(queries, expected=self._vector_dtype)
         _assert_2d(_queries, "queries")
@@ -188,6 +197,18 @@ class StaticDiskIndex:
             complexity = k_neighbors
 
         num_queries, dim = _queries.shape
+        if _valid_result_buffers(identifiers_out, distances_out, num_queries, k_neighbors):
+            self._index.batch_search_into(
+                queries=_queries,
+                num_queries=num_queries,
+                knn=k_neighbors,
+                complexity=complexity,
+                beam_width=beam_width,
+                num_threads=num_threads,
+                ids=identifiers_out,
+                dists=distances_out,
+            )
+            return QueryResponseBatch(identifiers=identifiers_out, distances=distances_out)
         neighbors, distances = self._index.batch_search(
             queries=_queries,
             num_queries=num_queries,
@@ -197,3 +218,37 @@ class StaticDiskIndex:
             num_threads=num_threads,
         )
         return QueryResponseBatch(identifiers=neighbors, distances=distances)
+
+    def batch_search_async(
+        self,
+        queries: VectorLikeBatch,
+        k_neighbors: int,
+        complexity: int,
+        num_threads: int,
+        beam_width: int = 2,
+        identifiers_out: Optional[np.ndarray] = None,
+        distances_out: Optional[np.ndarray] = None,
+        executor: Optional[Executor] = None,
+    ) -> "Future[QueryResponseBatch]":
+        """
+        Submits `batch_search` to an executor and returns a `concurrent.futures.Future` for its QueryResponseBatch.
+
+        The native search releases the GIL, so several batches submitted this way run concurrently with each other
+        and with the calling thread. Each batch still uses up to ``num_threads`` search threads; when many batches
+        are in flight, lower ``num_threads`` so their sum stays near the core count.
+
+        ### Parameters
+        Same as `batch_search`, plus:
+        - **executor**: The `concurrent.futures.Executor` to run the search on. Defaults to a thread pool shared by
+          all diskannpy indices.
+        """
+        return (executor or _default_executor()).submit(
+            self.batch_search,
+            queries=queries,
+            k_neighbors=k_neighbors,
+            complexity=complexity,
+            num_threads=num_threads,
+            beam_width=beam_width,
+            identifiers_out=identifiers_out,
+            distances_out=distances_out,
+        )
@@ -76,7 +76,9 @@ template <class DT>
 int DynamicMemoryIndex<DT>::insert(const py::array_t<DT, py::array::c_style | py::array::forcecast> &vector,
                                    const DynamicIdType id)
 {
-    return _index.insert_point(vector.data(), id);
+    const DT *vector_data = vector.data();
+    py::gil_scoped_release release;
+    return _index.insert_point(vector_data, id);
 }
 
 template <class DT>
@@ -85,16 +87,25 @@ py::array_t<int> DynamicMemoryIndex<DT>::batch_insert(
     py::array_t<DynamicIdType, py::array::c_style | py::array::forcecast> &ids, const int32_t num_inserts,
     const int num_threads)
 {
-    if (num_threads == 0)
-        omp_set_num_threads(omp_get_num_procs());
-    else
-        omp_set_num_threads(num_threads);
     py::array_t<int> insert_retvals(num_inserts);
 
-#pragma omp parallel for schedule(dynamic, 1) default(none) shared(num_inserts, insert_retvals, vectors, ids)
-    for (int32_t i = 0; i < num_inserts; i++)
+    const DT *vector_data = vectors.data();
+    const uint64_t vector_stride = vectors.shape(1);
+    const DynamicIdType *id_data = ids.data();
+    int *retvals = insert_retvals.mutable_data();
     {
-        insert_retvals.mutable_data()[i] = _index.insert_point(vectors.data(i), *(ids.data(i)));
+        py::gil_scoped_release release;
+        if (num_threads == 0)
+            omp_set_num_threads(omp_get_num_procs());
+        else
+            omp_set_num_threads(num_threads);
+
+#pragma omp parallel for schedule(dynamic, 1) default(none)                                                            \
+    shared(num_inserts, retvals, vector_data, vector_stride, id_data)
+        for (int32_t i = 0; i < num_inserts; i++)
+        {
+            retvals[i] = _index.insert_point(vector_data + i * vector_stride, id_data[i]);
+        }
     }
 
     return insert_retvals;
@@ -120,8 +131,14 @@ NeighborsAndDistances<DynamicIdType> DynamicMemoryIndex<DT>::search(
 {
     py::array_t<DynamicIdType> ids(knn);
     py::array_t<float> dists(knn);
-    std::vector<DT *> empty_vector;
-    _index.search_with_tags(query.data(), knn, complexity, ids.mutable_data(), dists.mutable_data(), empty_vector);
+    const DT *query_data = query.data();
+    DynamicIdType *ids_out = ids.mutable_data();
+    float *dists_out = dists.mutable_data();
+    {
+        py::gil_scoped_release release;
+        std::vector<DT *> empty_vector;
+        _index.search_with_tags(query_data, knn, complexity, ids_out, dists_out, empty_vector);
+    }
     return std::make_pair(ids, dists);
 }
 
@@ -130,28 +147,46 @@ NeighborsAndDistances<DynamicIdType> DynamicMemoryIndex<DT>::batch_search(
     py::array_t<DT, py::array::c_style | py::array::forcecast> &queries, const uint64_t num_queries, const uint64_t knn,
     const uint64_t complexity, const uint32_t num_threads)
 {
-    py::array_t<DynamicIdType> ids({num_queries, knn});
-    py::array_t<float> dists({num_queries, knn});
-    std::vector<DT *> empty_vector;
+    IdsOut<DynamicIdType> ids({num_queries, knn});
+    DistancesOut dists({num_queries, knn});
+    batch_search_into(queries, num_queries, knn, complexity, num_threads, ids, dists);
+    return std::make_pair(ids, dists);
+}
+
+template <class DT>
+void DynamicMemoryIndex<DT>::batch_search_into(py::array_t<DT, py::array::c_style | py::array::forcecast> &queries,
+                                               const uint64_t num_queries, const uint64_t knn,
+                                               const uint64_t complexity, const uint32_t num_threads,
+                                               IdsOut<DynamicIdType> &ids, DistancesOut &dists)
+{
+    check_result_buffers(ids, dists, num_queries, knn);
 
+    const DT *query_data = queries.data();
+    const uint64_t query_stride = queries.shape(1);
+    DynamicIdType *ids_out = ids.mutable_data();
+    float *dists_out = dists.mutable_data();
+
+    py::gil_scoped_release release;
     if (num_threads == 0)
         omp_set_num_threads(omp_get_num_procs());
     else
         omp_set_num_threads(static_cast<int32_t>(num_threads));
 
-#pragma omp parallel for schedule(dynamic, 1) default(none)                                                            \
-    shared(num_queries, queries, knn, complexity, ids, dists, empty_vector)
-    for (int64_t i = 0; i < (int64_t)num_queries; i++)
+#pragma omp parallel default(none) shared(num_queries, query_data, query_stride, knn, complexity, ids_out, dists_out)
     {
-        _index.search_with_tags(queries.data(i), knn, complexity, ids.mutable_data(i), dists.mutable_data(i),
-                                empty_vector);
+        std::vector<DT *> empty_vector;
+#pragma omp for schedule(dynamic, 1)
+        for (int64_t i = 0; i < (int64_t)num_queries; i++)
+        {
+            _index.search_with_tags(query_data + i * query_stride, knn, complexity, ids_out + i * knn,
+                                    dists_out + i * knn, empty_vector);
+        }
     }
-
-    return std::make_pair(ids, dists);
 }
 
 template <class DT> void DynamicMemoryIndex<DT>::consolidate_delete()
 {
+    py::gil_scoped_release release;
     _index.consolidate_deletes(_write_parameters);
 }
 
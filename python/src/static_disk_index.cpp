@@ -61,16 +61,17 @@ NeighborsAndDistances<StaticIdType> StaticDiskIndex<DT>::search(
     py::array_t<StaticIdType> ids(knn);
     py::array_t<float> dists(knn);
 
-    std::vector<uint32_t> u32_ids(knn);
-    std::vector<uint64_t> u64_ids(knn);
-    diskann::QueryStats stats;
-
-    _index.cached_beam_search(query.data(), knn, complexity, u64_ids.data(), dists.mutable_data(), beam_width, false,
-                              &stats);
-
-    auto r = ids.mutable_unchecked<1>();
-    for (uint64_t i = 0; i < knn; ++i)
-        r(i) = (unsigned)u64_ids[i];
+    const DT *query_data = query.data();
+    StaticIdType *ids_out = ids.mutable_data();
+    float *dists_out = dists.mutable_data();
+    {
+        py::gil_scoped_release release;
+        std::vector<uint64_t> u64_ids(knn);
+        diskann::QueryStats stats;
+        _index.cached_beam_search(query_data, knn, complexity, u64_ids.data(), dists_out, beam_width, false, &stats);
+        for (uint64_t i = 0; i < knn; ++i)
+            ids_out[i] = (StaticIdType)u64_ids[i];
+    }
 
     return std::make_pair(ids, dists);
 }
@@ -80,27 +81,44 @@ NeighborsAndDistances<StaticIdType> StaticDiskIndex<DT>::batch_search(
     py::array_t<DT, py::array::c_style | py::array::forcecast> &queries, const uint64_t num_queries, const uint64_t knn,
     const uint64_t complexity, const uint64_t beam_width, const uint32_t num_threads)
 {
-    py::array_t<StaticIdType> ids({num_queries, knn});
-    py::array_t<float> dists({num_queries, knn});
+    IdsOut<StaticIdType> ids({num_queries, knn});
+    DistancesOut dists({num_queries, knn});
+    batch_search_into(queries, num_queries, knn, complexity, beam_width, num_threads, ids, dists);
+    return std::make_pair(ids, dists);
+}
 
-    omp_set_num_threads(num_threads);
+template <typename DT>
+void StaticDiskIndex<DT>::batch_search_into(py::array_t<DT, py::array::c_style | py::array::forcecast> &queries,
+                                            const uint64_t num_queries, const uint64_t knn, const uint64_t complexity,
+                                            const uint64_t beam_width, const uint32_t num_threads,
+                                            IdsOut<StaticIdType> &ids, DistancesOut &dists)
+{
+    check_result_buffers(ids, dists, num_queries, knn);
+    const uint32_t _num_threads = num_threads != 0 ? num_threads : omp_get_num_procs();
+
+    // everything touching python objects happens before the GIL is released
+    const DT *query_data = queries.data();
+    const uint64_t query_stride = queries.shape(1);
+    StaticIdType *ids_out = ids.mutable_data();
+    float *dists_out = dists.mutable_data();
 
-    std::vector<uint64_t> u64_ids(knn * num_queries);
+    py::gil_scoped_release release;
+    omp_set_num_threads(static_cast<int32_t>(_num_threads));
 
-#pragma omp parallel for schedule(dynamic, 1) default(none)                                                            \
-    shared(num_queries, queries, knn, complexity, u64_ids, dists, beam_width)
-    for (int64_t i = 0; i < (int64_t)num_queries; i++)
+    // the index reports 64-bit ids; each thread narrows its own rows straight into the result buffer
+#pragma omp parallel default(none)                                                                                     \
+    shared(num_queries, query_data, query_stride, knn, complexity, ids_out, dists_out, beam_width)
     {
-        _index.cached_beam_search(queries.data(i), knn, complexity, u64_ids.data() + i * knn, dists.mutable_data(i),
-                                  beam_width);
+        std::vector<uint64_t> u64_ids(knn);
+#pragma omp for schedule(dynamic, 1)
+        for (int64_t i = 0; i < (int64_t)num_queries; i++)
+        {
+            _index.cached_beam_search(query_data + i * query_stride, knn, complexity, u64_ids.data(),
+                                      dists_out + i * knn, beam_width);
+            for (uint64_t j = 0; j < knn; ++j)
+                ids_out[i * knn + j] = (StaticIdType)u64_ids[j];
+        }
     }
-
-    auto r = ids.mutable_unchecked();
-    for (uint64_t i = 0; i < num_queries; ++i)
-        for (uint64_t j = 0; j < knn; ++j)
-            r(i, j) = (uint32_t)u64_ids[i * knn + j];
-
-    return std::make_pair(ids, dists);
 }
 
 template class StaticDiskIndex<float>;
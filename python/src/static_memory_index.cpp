@@ -46,8 +46,13 @@ NeighborsAndDistances<StaticIdType> StaticMemoryIndex<DT>::search(
 {
     py::array_t<StaticIdType> ids(knn);
     py::array_t<float> dists(knn);
-    std::vector<DT *> empty_vector;
-    _index.search(query.data(), knn, complexity, ids.mutable_data(), dists.mutable_data());
+    const DT *query_data = query.data();
+    StaticIdType *ids_out = ids.mutable_data();
+    float *dists_out = dists.mutable_data();
+    {
+        py::gil_scoped_release release;
+        _index.search(query_data, knn, complexity, ids_out, dists_out);
+    }
     return std::make_pair(ids, dists);
 }
 
@@ -58,8 +63,13 @@ NeighborsAndDistances<StaticIdType> StaticMemoryIndex<DT>::search_with_filter(
 {
     py::array_t<StaticIdType> ids(knn);
     py::array_t<float> dists(knn);
-    std::vector<DT *> empty_vector;
-    _index.search_with_filters(query.data(), filter, knn, complexity, ids.mutable_data(), dists.mutable_data());
+    const DT *query_data = query.data();
+    StaticIdType *ids_out = ids.mutable_data();
+    float *dists_out = dists.mutable_data();
+    {
+        py::gil_scoped_release release;
+        _index.search_with_filters(query_data, filter, knn, complexity, ids_out, dists_out);
+    }
     return std::make_pair(ids, dists);
 }
 
@@ -68,20 +78,29 @@ NeighborsAndDistances<StaticIdType> StaticMemoryIndex<DT>::batch_search(
     py::array_t<DT, py::array::c_style | py::array::forcecast> &queries, const uint64_t num_queries, const uint64_t knn,
     const uint64_t complexity, const uint32_t num_threads)
 {
-    const uint32_t _num_threads = num_threads != 0 ? num_threads : omp_get_num_procs();
-    py::array_t<StaticIdType> ids({num_queries, knn});
-    py::array_t<float> dists({num_queries, knn});
-    std::vector<DT *> empty_vector;
+    IdsOut<StaticIdType> ids({num_queries, knn});
+    DistancesOut dists({num_queries, knn});
+    batch_search_into(queries, num_queries, knn, complexity, num_threads, ids, dists);
+    return std::make_pair(ids, dists);
+}
 
-    omp_set_num_threads(static_cast<int32_t>(_num_threads));
+template <typename DT>
+void StaticMemoryIndex<DT>::batch_search_into(py::array_t<DT, py::array::c_style | py::array::forcecast> &queries,
+                                              const uint64_t num_queries, const uint64_t knn,
+                                              const uint64_t complexity, const uint32_t num_threads,
+                                              IdsOut<StaticIdType> &ids, DistancesOut &dists)
+{
+    check_result_buffers(ids, dists, num_queries, knn);
+    const uint32_t _num_threads = num_threads != 0 ? num_threads : omp_get_num_procs();
 
-#pragma omp parallel for schedule(dynamic, 1) default(none) shared(num_queries, queries, knn, complexity, ids, dists)
-    for (int64_t i = 0; i < (int64_t)num_queries; i++)
-    {
-        _index.search(queries.data(i), knn, complexity, ids.mutable_data(i), dists.mutable_data(i));
-    }
+    const DT *query_data = queries.data();
+    const uint64_t query_stride = queries.shape(1);
+    StaticIdType *ids_out = ids.mutable_data();
+    float *dists_out = dists.mutable_data();
 
-    return std::make_pair(ids, dists);
+    py::gil_scoped_release release;
+    omp_set_num_threads(static_cast<int32_t>(_num_threads));
+    _index.batch_search(query_data, num_queries, query_stride, knn, complexity, ids_out, dists_out);
 }
 
 template class StaticMemoryIndex<float>;
@@ -101,6 +101,63 @@ class TestStaticMemoryIndex(unittest.TestCase):
                 self.assertEqual(ids.shape[0], k)
                 self.assertEqual(dists.shape[0], k)
 
+    def test_result_buffers_and_async(self):
+        metric, dtype, query_vectors, index_vectors, ann_dir, vector_bin_file, _ = self._test_matrix[0]
+        index = dap.StaticMemoryIndex(
+            index_directory=ann_dir,
+            num_threads=16,
+            initial_search_complexity=32,
+        )
+        k = 5
+        expected_ids, expected_dists = index.batch_search(
+            query_vectors, k_neighbors=k, complexity=32, num_threads=16
+        )
+
+        ids_out = np.zeros((query_vectors.shape[0], k), dtype=np.uint32)
+        dists_out = np.zeros((query_vectors.shape[0], k), dtype=np.float32)
+        ids, dists = index.batch_search(
+            query_vectors,
+            k_neighbors=k,
+            complexity=32,
+            num_threads=16,
+            identifiers_out=ids_out,
+            distances_out=dists_out,
+        )
+        self.assertIs(ids, ids_out)
+        self.assertIs(dists, dists_out)
+        np.testing.assert_array_equal(ids_out, expected_ids)
+        np.testing.assert_array_equal(dists_out, expected_dists)
+
+        futures = [
+            index.batch_search_async(query_vectors, k_neighbors=k, complexity=32, num_threads=2)
+            for _ in range(4)
+        ]
+        for future in futures:
+            np.testing.assert_array_equal(future.result().identifiers, expected_ids)
+
+        with self.assertRaises(ValueError):
+            index.batch_search(
+                query_vectors, k_neighbors=k, complexity=32, num_threads=16, identifiers_out=ids_out
+            )
+        with self.assertRaises(ValueError):
+            index.batch_search(
+                query_vectors,
+                k_neighbors=k,
+                complexity=32,
+                num_threads=16,
+                identifiers_out=ids_out.astype(np.int64),
+                distances_out=dists_out,
+            )
+        with self.assertRaises(ValueError):
+            index.batch_search(
+                query_vectors,
+                k_neighbors=k + 1,
+                complexity=32,
+                num_threads=16,
+                identifiers_out=ids_out,
+                distances_out=dists_out,
+            )
+
     def test_value_ranges_ctor(self):
         (
             metric,
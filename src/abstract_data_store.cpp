@@ -39,6 +39,15 @@ template <typename data_t> location_t AbstractDataStore<data_t>::resize(const lo
     }
 }
 
+template <typename data_t>
+void AbstractDataStore<data_t>::get_distance_batch(const data_t *const *preprocessed_queries,
+                                                   const uint32_t num_queries, const location_t loc,
+                                                   float *distances) const
+{
+    for (uint32_t i = 0; i < num_queries; i++)
+        distances[i] = get_distance(preprocessed_queries[i], loc);
+}
+
 template DISKANN_DLLEXPORT class AbstractDataStore<float>;
 template DISKANN_DLLEXPORT class AbstractDataStore<int8_t>;
 template DISKANN_DLLEXPORT class AbstractDataStore<uint8_t>;
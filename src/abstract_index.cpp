@@ -22,6 +22,15 @@ std::pair<uint32_t, uint32_t> AbstractIndex::search(const data_type *query, cons
     return _search(any_query, K, L, any_indices, distances);
 }
 
+template <typename data_type, typename IDType>
+void AbstractIndex::batch_search(const data_type *queries, const size_t num_queries, const size_t query_stride,
+                                 const size_t K, const uint32_t L, IDType *indices, float *distances, uint32_t *cmps)
+{
+    auto any_indices = std::any(indices);
+    auto any_queries = std::any(queries);
+    _batch_search(any_queries, num_queries, query_stride, K, L, any_indices, distances, cmps);
+}
+
 template <typename data_type, typename tag_type>
 size_t AbstractIndex::search_with_tags(const data_type *query, const uint64_t K, const uint32_t L, tag_type *tags,
                                        float *distances, std::vector<data_type *> &res_vectors, bool use_filters,
@@ -155,6 +164,26 @@ template DISKANN_DLLEXPORT std::pair<uint32_t, uint32_t> AbstractIndex::search<u
 template DISKANN_DLLEXPORT std::pair<uint32_t, uint32_t> AbstractIndex::search<int8_t, uint64_t>(
     const int8_t *query, const size_t K, const uint32_t L, uint64_t *indices, float *distances);
 
+template DISKANN_DLLEXPORT void AbstractIndex::batch_search<float, uint32_t>(
+    const float *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps);
+template DISKANN_DLLEXPORT void AbstractIndex::batch_search<uint8_t, uint32_t>(
+    const uint8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps);
+template DISKANN_DLLEXPORT void AbstractIndex::batch_search<int8_t, uint32_t>(
+    const int8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps);
+
+template DISKANN_DLLEXPORT void AbstractIndex::batch_search<float, uint64_t>(
+    const float *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps);
+template DISKANN_DLLEXPORT void AbstractIndex::batch_search<uint8_t, uint64_t>(
+    const uint8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps);
+template DISKANN_DLLEXPORT void AbstractIndex::batch_search<int8_t, uint64_t>(
+    const int8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps);
+
 template DISKANN_DLLEXPORT std::pair<uint32_t, uint32_t> AbstractIndex::search_with_filters<uint32_t>(
     const DataType &query, const std::string &raw_label, const size_t K, const uint32_t L, uint32_t *indices,
     float *distances);
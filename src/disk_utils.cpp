@@ -10,7 +10,9 @@
 #include "logger.h"
 #include "disk_utils.h"
 #include "cached_io.h"
+#include "concurrent_queue.h"
 #include "index.h"
+#include "memory_mapper.h"
 #include "mkl.h"
 #include "omp.h"
 #include "percentile_stats.h"
@@ -19,6 +21,9 @@
 #include "timer.h"
 #include "tsl/robin_set.h"
 
+#include <functional>
+#include <thread>
+
 namespace diskann
 {
 
@@ -630,7 +635,7 @@ int build_merged_vamana_index(std::string base_file, diskann::Metric compareMetr
                               std::string medoids_file, std::string centroids_file, size_t build_pq_bytes, bool use_opq,
                               uint32_t num_threads, bool use_filters, const std::string &label_file,
                               const std::string &labels_to_medoids_file, const std::string &universal_label,
-                              const uint32_t Lf)
+                              const uint32_t Lf, const bool kmeans_parallel_seeding)
 {
     size_t base_num, base_dim;
     diskann::get_bin_metadata(base_file, base_num, base_dim);
@@ -687,8 +692,8 @@ int build_merged_vamana_index(std::string base_file, diskann::Metric compareMetr
     std::string merged_index_prefix = mem_index_path + "_tempFiles";
 
     Timer timer;
-    int num_parts =
-        partition_with_ram_budget<T>(base_file, sampling_rate, ram_budget, 2 * R / 3, merged_index_prefix, 2);
+    int num_parts = partition_with_ram_budget<T>(base_file, sampling_rate, ram_budget, 2 * R / 3, merged_index_prefix,
+                                                 2, kmeans_parallel_seeding);
     diskann::cout << timer.elapsed_seconds_for_step("partitioning data ") << std::endl;
 
     std::string cur_centroid_filepath = merged_index_prefix + "_centroids.bin";
@@ -843,16 +848,530 @@ uint32_t optimize_beamwidth(std::unique_ptr<diskann::PQFlashIndex<T, LabelT>> &p
     return best_bw;
 }
 
+// Greedy sector packing: each sector starts from the next unplaced node in BFS order from the medoid and is
+// filled with the unplaced neighbours that have the most edges into the sector so far, so that a hop into the
+// sector tends to find its next hops already loaded. Returns the node id stored at each location.
+std::vector<uint32_t> pack_sectors_by_graph(const uint32_t *graph_slots, const uint64_t npts, const uint64_t slot_width,
+                                            const uint32_t medoid, const uint64_t nnodes_per_sector)
+{
+    std::vector<uint32_t> loc_to_id;
+    loc_to_id.reserve(npts);
+    std::vector<bool> placed(npts, false), enqueued(npts, false);
+
+    // BFS frontier used to pick sector seeds; ids unreachable from the medoid are picked up by the scan
+    std::vector<uint32_t> bfs_queue;
+    bfs_queue.reserve(npts);
+    uint64_t bfs_head = 0, scan_pos = 0;
+    bfs_queue.push_back(medoid);
+    enqueued[medoid] = true;
+
+    tsl::robin_map<uint32_t, uint32_t> candidate_scores;
+    auto place = [&](uint32_t id) {
+        placed[id] = true;
+        loc_to_id.push_back(id);
+        const uint32_t *slot = graph_slots + id * slot_width;
+        for (uint32_t j = 1; j <= slot[0]; j++)
+        {
+            uint32_t nbr = slot[j];
+            if (!enqueued[nbr])
+            {
+                enqueued[nbr] = true;
+                bfs_queue.push_back(nbr);
+            }
+            if (!placed[nbr])
+                candidate_scores[nbr]++;
+        }
+    };
+
+    while (loc_to_id.size() < npts)
+    {
+        candidate_scores.clear();
+        uint64_t sector_end = (std::min)((uint64_t)loc_to_id.size() + nnodes_per_sector, npts);
+        while (loc_to_id.size() < sector_end)
+        {
+            // best connected candidate, or a fresh seed once the sector's neighbourhood is exhausted
+            uint32_t best_id = 0, best_score = 0;
+            for (auto iter = candidate_scores.begin(); iter != candidate_scores.end(); iter++)
+            {
+                if (!placed[iter->first] && iter->second > best_score)
+                {
+                    best_id = iter->first;
+                    best_score = iter->second;
+                }
+            }
+            if (best_score > 0)
+            {
+                candidate_scores.erase(best_id);
+                place(best_id);
+                continue;
+            }
+
+            while (bfs_head < bfs_queue.size() && placed[bfs_queue[bfs_head]])
+                bfs_head++;
+            if (bfs_head == bfs_queue.size())
+            {
+                while (placed[scan_pos])
+                    scan_pos++;
+                enqueued[scan_pos] = true;
+                bfs_queue.push_back((uint32_t)scan_pos);
+            }
+            place(bfs_queue[bfs_head++]);
+        }
+    }
+    return loc_to_id;
+}
+
+// Writes a disk index front to back in whole sectors and reports progress. On Linux the file is opened with O_DIRECT
+// where the file system allows it, so writing a layout much larger than RAM does not evict the page cache; buffers
+// must then be SECTOR_LEN aligned.
+class DiskLayoutWriter
+{
+  public:
+    DiskLayoutWriter(const std::string &filename, const uint64_t total_sectors)
+        : _filename(filename), _total_sectors(total_sectors)
+    {
+#ifdef _WINDOWS
+        _writer.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        try
+        {
+            _writer.open(filename, std::ios::binary | std::ios::out | std::ios::trunc);
+        }
+        catch (std::system_error &e)
+        {
+            throw FileException(filename, e, __FUNCSIG__, __FILE__, __LINE__);
+        }
+#else
+#ifdef O_DIRECT
+        _fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        _direct = _fd >= 0;
+#endif
+        if (_fd < 0)
+            _fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (_fd < 0)
+        {
+            throw ANNException("Could not open " + filename + " for writing: " + std::string(strerror(errno)), -1,
+                               __FUNCSIG__, __FILE__, __LINE__);
+        }
+#endif
+    }
+
+    ~DiskLayoutWriter()
+    {
+#ifndef _WINDOWS
+        if (_fd >= 0)
+            ::close(_fd);
+#endif
+    }
+
+    void write(const char *buf, const uint64_t num_sectors)
+    {
+        const uint64_t num_bytes = num_sectors * defaults::SECTOR_LEN;
+#ifdef _WINDOWS
+        _writer.write(buf, num_bytes);
+#else
+        const uint64_t offset = _sectors_written * defaults::SECTOR_LEN;
+        uint64_t done = 0;
+        while (done < num_bytes)
+        {
+            ssize_t ret = ::pwrite(_fd, buf + done, num_bytes - done, offset + done);
+            if (ret < 0 && errno == EINTR)
+                continue;
+#ifdef O_DIRECT
+            if (ret < 0 && errno == EINVAL && _direct)
+            { // some file systems accept O_DIRECT at open but not on write
+                fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) & ~O_DIRECT);
+                _direct = false;
+                continue;
+            }
+#endif
+            if (ret < 0)
+            {
+                throw ANNException("Failed writing " + _filename + ": " + std::string(strerror(errno)), -1,
+                                   __FUNCSIG__, __FILE__, __LINE__);
+            }
+            done += (uint64_t)ret;
+        }
+#endif
+        _sectors_written += num_sectors;
+
+        // report every 10% of the file
+        uint64_t pct = _total_sectors > 0 ? _sectors_written * 100 / _total_sectors : 100;
+        if (pct >= _next_report_pct)
+        {
+            double secs = _timer.elapsed_seconds();
+            diskann::cout << "Wrote " << _sectors_written << " of " << _total_sectors << " sectors (" << pct << "%), "
+                          << (secs > 0 ? _sectors_written * defaults::SECTOR_LEN / secs / (1 << 20) : 0.0) << " MB/s"
+                          << std::endl;
+            _next_report_pct = (pct / 10 + 1) * 10;
+        }
+    }
+
+    void close()
+    {
+#ifdef _WINDOWS
+        _writer.close();
+#else
+        if (_fd >= 0 && ::close(_fd) != 0)
+        {
+            _fd = -1;
+            throw ANNException("Failed closing " + _filename + ": " + std::string(strerror(errno)), -1, __FUNCSIG__,
+                               __FILE__, __LINE__);
+        }
+        _fd = -1;
+#endif
+    }
+
+  private:
+    std::string _filename;
+#ifdef _WINDOWS
+    std::ofstream _writer;
+#else
+    int _fd = -1;
+    bool _direct = false;
+#endif
+    uint64_t _total_sectors;
+    uint64_t _sectors_written = 0;
+    uint64_t _next_report_pct = 10;
+    Timer _timer;
+};
+
+// Nodes per block of the layout pipeline: as many whole sectors as fit in LAYOUT_BLOCK_BYTES, never more than npts.
+uint64_t disk_layout_block_nodes(const uint64_t npts, const uint64_t max_node_len, const uint64_t nnodes_per_sector)
+{
+    const uint64_t node_sectors =
+        nnodes_per_sector > 0 ? 1 : DIV_ROUND_UP(max_node_len, (uint64_t)defaults::SECTOR_LEN);
+    const uint64_t block_nodes = (std::max)((uint64_t)1, LAYOUT_BLOCK_BYTES / (node_sectors * defaults::SECTOR_LEN)) *
+                                 (nnodes_per_sector > 0 ? nnodes_per_sector : 1);
+    return (std::min)(block_nodes, (std::max)(npts, (uint64_t)1));
+}
+
+// One block of consecutive locations moving through the layout pipeline. The reader stage stages its input in
+// coords, nnbrs and nbrs (id order) or records (graph order); the assembly stage turns that into sectors.
+template <typename T> struct DiskLayoutBlock
+{
+    uint64_t first_node = 0;
+    uint64_t num_nodes = 0;
+    std::vector<T> coords;       // num_nodes x ndims
+    std::vector<uint32_t> nnbrs; // degree of each node, capped at the graph width
+    std::vector<uint32_t> nbrs;  // num_nodes x width
+    std::vector<char> records;   // num_nodes records of a location followed by the node as laid out in its sector
+    char *sectors = nullptr;     // assembled output, SECTOR_LEN aligned
+    uint64_t num_sectors = 0;
+};
+
+// Writes npts nodes in blocks of disk_layout_block_nodes locations. A reader thread fills each block with
+// read_block, OpenMP threads build its sectors with assemble_block and a writer thread writes them out, so reading,
+// assembly and I/O overlap. Blocks arrive at both callbacks in location order. LAYOUT_PIPELINE_DEPTH blocks are
+// recycled between the stages, which bounds memory.
+template <typename T>
+void run_disk_layout_pipeline(DiskLayoutWriter &writer, const uint64_t npts, const uint64_t max_node_len,
+                              const uint64_t nnodes_per_sector,
+                              const std::function<void(DiskLayoutBlock<T> &)> &read_block,
+                              const std::function<void(DiskLayoutBlock<T> &)> &assemble_block)
+{
+    const uint64_t nsectors_per_node =
+        nnodes_per_sector > 0 ? 0 : DIV_ROUND_UP(max_node_len, (uint64_t)defaults::SECTOR_LEN);
+    const uint64_t block_nodes = disk_layout_block_nodes(npts, max_node_len, nnodes_per_sector);
+    const uint64_t block_sectors =
+        nnodes_per_sector > 0 ? DIV_ROUND_UP(block_nodes, nnodes_per_sector) : block_nodes * nsectors_per_node;
+    const uint64_t num_blocks = DIV_ROUND_UP(npts, block_nodes);
+
+    std::vector<DiskLayoutBlock<T>> blocks(LAYOUT_PIPELINE_DEPTH);
+    ConcurrentQueue<DiskLayoutBlock<T> *> free_blocks(nullptr), read_blocks(nullptr), assembled_blocks(nullptr);
+    for (auto &block : blocks)
+    {
+        alloc_aligned((void **)&block.sectors, block_sectors * defaults::SECTOR_LEN, defaults::SECTOR_LEN);
+        DiskLayoutBlock<T> *block_ptr = &block;
+        free_blocks.push(block_ptr);
+    }
+
+    std::atomic<bool> failed(false);
+    std::exception_ptr reader_error, assembly_error, writer_error;
+    auto wait_and_pop = [&failed](ConcurrentQueue<DiskLayoutBlock<T> *> &queue) {
+        DiskLayoutBlock<T> *block = queue.pop();
+        while (block == nullptr && !failed)
+        {
+            queue.wait_for_push_notify();
+            block = queue.pop();
+        }
+        return block;
+    };
+
+    std::thread reader([&]() {
+        try
+        {
+            for (uint64_t b = 0; b < num_blocks; b++)
+            {
+                DiskLayoutBlock<T> *block = wait_and_pop(free_blocks);
+                if (block == nullptr)
+                    return;
+                block->first_node = b * block_nodes;
+                block->num_nodes = (std::min)(block_nodes, npts - block->first_node);
+                block->num_sectors = nnodes_per_sector > 0 ? DIV_ROUND_UP(block->num_nodes, nnodes_per_sector)
+                                                           : block->num_nodes * nsectors_per_node;
+                read_block(*block);
+                read_blocks.push(block);
+                read_blocks.push_notify_all();
+            }
+        }
+        catch (...)
+        {
+            reader_error = std::current_exception();
+            failed = true;
+        }
+    });
+
+    std::thread writer_thread([&]() {
+        try
+        {
+            for (uint64_t b = 0; b < num_blocks; b++)
+            {
+                DiskLayoutBlock<T> *block = wait_and_pop(assembled_blocks);
+                if (block == nullptr)
+                    return;
+                writer.write(block->sectors, block->num_sectors);
+                free_blocks.push(block);
+                free_blocks.push_notify_all();
+            }
+        }
+        catch (...)
+        {
+            writer_error = std::current_exception();
+            failed = true;
+        }
+    });
+
+    try
+    {
+        for (uint64_t b = 0; b < num_blocks; b++)
+        {
+            DiskLayoutBlock<T> *block = wait_and_pop(read_blocks);
+            if (block == nullptr)
+                break;
+            assemble_block(*block);
+            assembled_blocks.push(block);
+            assembled_blocks.push_notify_all();
+        }
+    }
+    catch (...)
+    {
+        assembly_error = std::current_exception();
+        failed = true;
+    }
+
+    reader.join();
+    writer_thread.join();
+    for (auto &block : blocks)
+        aligned_free(block.sectors);
+
+    for (auto &error : {reader_error, assembly_error, writer_error})
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+// Writes the nodes of base_file and the graph in mem_index_file in id order through the layout pipeline.
+template <typename T>
+void write_disk_layout_in_id_order(const std::string &base_file, const std::string &mem_index_file,
+                                   DiskLayoutWriter &writer, const uint64_t npts, const uint64_t ndims,
+                                   const uint32_t width, const uint64_t max_node_len, const uint64_t nnodes_per_sector)
+{
+    const uint64_t block_nodes = disk_layout_block_nodes(npts, max_node_len, nnodes_per_sector);
+    const uint64_t nsectors_per_node =
+        nnodes_per_sector > 0 ? 0 : DIV_ROUND_UP(max_node_len, (uint64_t)defaults::SECTOR_LEN);
+    const size_t read_blk_size = 64 * 1024 * 1024;
+    cached_ifstream base_reader(base_file, read_blk_size);
+    cached_ifstream graph_reader(mem_index_file, read_blk_size);
+    char header[24];
+    base_reader.read(header, 2 * sizeof(uint32_t));
+    graph_reader.read(header, 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t));
+    std::vector<uint32_t> extra_nbrs;
+
+    auto read_block = [&](DiskLayoutBlock<T> &block) {
+        block.coords.resize(block_nodes * ndims);
+        block.nnbrs.resize(block_nodes);
+        block.nbrs.resize(block_nodes * width);
+        base_reader.read((char *)block.coords.data(), block.num_nodes * ndims * sizeof(T));
+        for (uint64_t i = 0; i < block.num_nodes; i++)
+        {
+            uint32_t nnbrs;
+            graph_reader.read((char *)&nnbrs, sizeof(uint32_t));
+            assert(nnbrs > 0);
+            block.nnbrs[i] = (std::min)(nnbrs, width);
+            graph_reader.read((char *)(block.nbrs.data() + i * width), block.nnbrs[i] * sizeof(uint32_t));
+            if (nnbrs > width)
+            {
+                extra_nbrs.resize(nnbrs - width);
+                graph_reader.read((char *)extra_nbrs.data(), extra_nbrs.size() * sizeof(uint32_t));
+            }
+        }
+    };
+
+    auto assemble_block = [&](DiskLayoutBlock<T> &block) {
+        // a unit is one sector of small nodes or all the sectors of one large node
+        const uint64_t unit_nodes = nnodes_per_sector > 0 ? nnodes_per_sector : 1;
+        const uint64_t unit_bytes = (nnodes_per_sector > 0 ? 1 : nsectors_per_node) * defaults::SECTOR_LEN;
+        const uint64_t num_units = nnodes_per_sector > 0 ? block.num_sectors : block.num_nodes;
+#pragma omp parallel for schedule(static)
+        for (int64_t unit = 0; unit < (int64_t)num_units; unit++)
+        {
+            char *unit_buf = block.sectors + unit * unit_bytes;
+            memset(unit_buf, 0, unit_bytes);
+            uint64_t unit_end = (std::min)((unit + 1) * unit_nodes, block.num_nodes);
+            for (uint64_t i = unit * unit_nodes; i < unit_end; i++)
+            {
+                char *node_buf = unit_buf + (i - unit * unit_nodes) * max_node_len;
+                memcpy(node_buf, block.coords.data() + i * ndims, ndims * sizeof(T));
+                *(uint32_t *)(node_buf + ndims * sizeof(T)) = block.nnbrs[i];
+                memcpy(node_buf + ndims * sizeof(T) + sizeof(uint32_t), block.nbrs.data() + i * width,
+                       block.nnbrs[i] * sizeof(uint32_t));
+            }
+        }
+    };
+
+    run_disk_layout_pipeline<T>(writer, npts, max_node_len, nnodes_per_sector, read_block, assemble_block);
+}
+
+// Writes the nodes in the locality order of pack_sectors_by_graph without holding the graph or the vectors in memory.
+// The graph is copied to fixed-width rows in a temporary file and mapped, so the packing pass can follow edges. One
+// sequential pass over the base file then routes each node, assembled and tagged with its location, to the bucket
+// holding its pipeline block. Buckets are regions of a second temporary file and fill through small write buffers;
+// the layout pipeline then reads the buckets back in order and scatters each into its sectors. Only the permutation
+// stays in memory, and the base file, the graph and the nodes are each read once.
+template <typename T>
+void write_disk_layout_in_graph_order(const std::string &base_file, std::ifstream &vamana_reader,
+                                      const std::string &output_file, const std::string &layout_file,
+                                      DiskLayoutWriter &writer, const uint64_t npts, const uint64_t ndims,
+                                      const uint32_t width, const uint32_t medoid, const uint64_t max_node_len,
+                                      const uint64_t nnodes_per_sector)
+{
+    const std::string slots_file = output_file + "_graph_slots.tmp";
+    const std::string buckets_file = output_file + "_layout_buckets.tmp";
+    const uint64_t slot_width = (uint64_t)width + 1;
+    const size_t read_blk_size = 64 * 1024 * 1024;
+
+    try
+    {
+        {
+            std::ofstream slots_writer(slots_file, std::ios::binary | std::ios::trunc);
+            std::vector<uint32_t> slot(slot_width);
+            std::vector<uint32_t> extra_nbrs;
+            for (uint64_t i = 0; i < npts; i++)
+            {
+                uint32_t nnbrs;
+                vamana_reader.read((char *)&nnbrs, sizeof(uint32_t));
+                assert(nnbrs > 0);
+                slot[0] = (std::min)(nnbrs, width);
+                vamana_reader.read((char *)(slot.data() + 1), slot[0] * sizeof(uint32_t));
+                std::fill(slot.begin() + 1 + slot[0], slot.end(), 0);
+                if (nnbrs > width)
+                {
+                    extra_nbrs.resize(nnbrs - width);
+                    vamana_reader.read((char *)extra_nbrs.data(), extra_nbrs.size() * sizeof(uint32_t));
+                }
+                slots_writer.write((char *)slot.data(), slot_width * sizeof(uint32_t));
+            }
+            if (!slots_writer)
+                throw ANNException("Failed writing " + slots_file, -1, __FUNCSIG__, __FILE__, __LINE__);
+        }
+        MemoryMapper slots_mapper(slots_file, MMAP_DEFAULT);
+        const uint32_t *graph_slots = (const uint32_t *)slots_mapper.getBuf();
+
+        Timer layout_timer;
+        std::vector<uint32_t> loc_to_id =
+            pack_sectors_by_graph(graph_slots, npts, slot_width, medoid, nnodes_per_sector);
+        std::vector<uint32_t> id_to_loc(npts);
+        for (uint64_t loc = 0; loc < npts; loc++)
+            id_to_loc[loc_to_id[loc]] = (uint32_t)loc;
+        loc_to_id = std::vector<uint32_t>();
+        diskann::cout << layout_timer.elapsed_seconds_for_step("computing graph-ordered layout") << std::endl;
+
+        // a record is a node's location followed by the node as it is laid out in its sector; a bucket holds the
+        // records of one pipeline block
+        const uint64_t record_len = sizeof(uint32_t) + max_node_len;
+        const uint64_t bucket_nodes = disk_layout_block_nodes(npts, max_node_len, nnodes_per_sector);
+        const uint64_t num_buckets = DIV_ROUND_UP(npts, bucket_nodes);
+        const uint64_t buffer_records = (std::max)((uint64_t)1, LAYOUT_WINDOW_BYTES / num_buckets / record_len);
+        {
+            std::vector<char> buffers(num_buckets * buffer_records * record_len);
+            std::vector<uint64_t> buffered(num_buckets, 0), flushed(num_buckets, 0);
+            std::ofstream buckets_writer(buckets_file, std::ios::binary | std::ios::trunc);
+            auto flush = [&](const uint64_t bucket) {
+                buckets_writer.seekp((bucket * bucket_nodes + flushed[bucket]) * record_len, buckets_writer.beg);
+                buckets_writer.write(buffers.data() + bucket * buffer_records * record_len,
+                                     buffered[bucket] * record_len);
+                flushed[bucket] += buffered[bucket];
+                buffered[bucket] = 0;
+            };
+
+            cached_ifstream base_reader(base_file, read_blk_size);
+            char header[2 * sizeof(uint32_t)];
+            base_reader.read(header, sizeof(header));
+            for (uint64_t id = 0; id < npts; id++)
+            {
+                const uint32_t loc = id_to_loc[id];
+                const uint64_t bucket = loc / bucket_nodes;
+                char *record = buffers.data() + (bucket * buffer_records + buffered[bucket]) * record_len;
+                char *node_buf = record + sizeof(uint32_t);
+                const uint32_t *slot = graph_slots + id * slot_width;
+                memset(record, 0, record_len);
+                *(uint32_t *)record = loc;
+                base_reader.read(node_buf, ndims * sizeof(T));
+                memcpy(node_buf + ndims * sizeof(T), slot, (1 + (uint64_t)slot[0]) * sizeof(uint32_t));
+                if (++buffered[bucket] == buffer_records)
+                    flush(bucket);
+            }
+            for (uint64_t bucket = 0; bucket < num_buckets; bucket++)
+            {
+                if (buffered[bucket] > 0)
+                    flush(bucket);
+            }
+            if (!buckets_writer)
+                throw ANNException("Failed writing " + buckets_file, -1, __FUNCSIG__, __FILE__, __LINE__);
+        }
+        diskann::cout << layout_timer.elapsed_seconds_for_step("routing nodes to their sectors") << std::endl;
+
+        // buckets are stored in block order, so the pipeline reads them back sequentially
+        std::ifstream buckets_reader(buckets_file, std::ios::binary);
+        auto read_block = [&](DiskLayoutBlock<T> &block) {
+            block.records.resize(bucket_nodes * record_len);
+            buckets_reader.read(block.records.data(), block.num_nodes * record_len);
+            if (!buckets_reader)
+                throw ANNException("Failed reading " + buckets_file, -1, __FUNCSIG__, __FILE__, __LINE__);
+        };
+        auto assemble_block = [&](DiskLayoutBlock<T> &block) {
+            memset(block.sectors, 0, block.num_sectors * defaults::SECTOR_LEN);
+#pragma omp parallel for schedule(static)
+            for (int64_t i = 0; i < (int64_t)block.num_nodes; i++)
+            {
+                const char *record = block.records.data() + i * record_len;
+                const uint64_t offset = *(const uint32_t *)record - block.first_node;
+                memcpy(block.sectors + (offset / nnodes_per_sector) * defaults::SECTOR_LEN +
+                           (offset % nnodes_per_sector) * max_node_len,
+                       record + sizeof(uint32_t), max_node_len);
+            }
+        };
+        run_disk_layout_pipeline<T>(writer, npts, max_node_len, nnodes_per_sector, read_block, assemble_block);
+        diskann::save_bin<uint32_t>(layout_file, id_to_loc.data(), npts, 1);
+    }
+    catch (...)
+    {
+        std::remove(slots_file.c_str());
+        std::remove(buckets_file.c_str());
+        throw;
+    }
+    std::remove(slots_file.c_str());
+    std::remove(buckets_file.c_str());
+}
+
 template <typename T>
 void create_disk_layout(const std::string base_file, const std::string mem_index_file, const std::string output_file,
-                        const std::string reorder_data_file)
+                        const std::string reorder_data_file, const bool reorder_layout)
 {
     uint32_t npts, ndims;
 
-    // amount to read or write in one shot
-    size_t read_blk_size = 64 * 1024 * 1024;
-    size_t write_blk_size = read_blk_size;
-    cached_ifstream base_reader(base_file, read_blk_size);
+    std::ifstream base_reader(base_file, std::ios::binary);
     base_reader.read((char *)&npts, sizeof(uint32_t));
     base_reader.read((char *)&ndims, sizeof(uint32_t));
 
@@ -889,11 +1408,10 @@ void create_disk_layout(const std::string base_file, const std::string mem_index
         }
     }
 
-    // create cached reader + writer
+    // the graph header is read here; the nodes are streamed below
     size_t actual_file_size = get_file_size(mem_index_file);
     diskann::cout << "Vamana index file size=" << actual_file_size << std::endl;
     std::ifstream vamana_reader(mem_index_file, std::ios::binary);
-    cached_ofstream diskann_writer(output_file, write_blk_size);
 
     // metadata: width, medoid
     uint32_t width_u32, medoid_u32;
@@ -927,13 +1445,6 @@ void create_disk_layout(const std::string base_file, const std::string mem_index
     diskann::cout << "max_node_len: " << max_node_len << "B" << std::endl;
     diskann::cout << "nnodes_per_sector: " << nnodes_per_sector << "B" << std::endl;
 
-    // defaults::SECTOR_LEN buffer for each sector
-    std::unique_ptr<char[]> sector_buf = std::make_unique<char[]>(defaults::SECTOR_LEN);
-    std::unique_ptr<char[]> multisector_buf = std::make_unique<char[]>(ROUND_UP(max_node_len, defaults::SECTOR_LEN));
-    std::unique_ptr<char[]> node_buf = std::make_unique<char[]>(max_node_len);
-    uint32_t &nnbrs = *(uint32_t *)(node_buf.get() + ndims_64 * sizeof(T));
-    uint32_t *nhood_buf = (uint32_t *)(node_buf.get() + (ndims_64 * sizeof(T)) + sizeof(uint32_t));
-
     // number of sectors (1 for meta data)
     uint64_t n_sectors = nnodes_per_sector > 0 ? ROUND_UP(npts_64, nnodes_per_sector) / nnodes_per_sector
                                                : npts_64 * DIV_ROUND_UP(max_node_len, defaults::SECTOR_LEN);
@@ -964,132 +1475,55 @@ void create_disk_layout(const std::string base_file, const std::string mem_index
     }
     output_file_meta.push_back(disk_index_file_size);
 
-    diskann_writer.write(sector_buf.get(), defaults::SECTOR_LEN);
-
-    std::unique_ptr<T[]> cur_node_coords = std::make_unique<T[]>(ndims_64);
-    diskann::cout << "# sectors: " << n_sectors << std::endl;
-    uint64_t cur_node_id = 0;
-
-    if (nnodes_per_sector > 0)
-    { // Write multiple nodes per sector
-        for (uint64_t sector = 0; sector < n_sectors; sector++)
-        {
-            if (sector % 100000 == 0)
-            {
-                diskann::cout << "Sector #" << sector << "written" << std::endl;
-            }
-            memset(sector_buf.get(), 0, defaults::SECTOR_LEN);
-            for (uint64_t sector_node_id = 0; sector_node_id < nnodes_per_sector && cur_node_id < npts_64;
-                 sector_node_id++)
-            {
-                memset(node_buf.get(), 0, max_node_len);
-                // read cur node's nnbrs
-                vamana_reader.read((char *)&nnbrs, sizeof(uint32_t));
-
-                // sanity checks on nnbrs
-                assert(nnbrs > 0);
-                assert(nnbrs <= width_u32);
-
-                // read node's nhood
-                vamana_reader.read((char *)nhood_buf, (std::min)(nnbrs, width_u32) * sizeof(uint32_t));
-                if (nnbrs > width_u32)
-                {
-                    vamana_reader.seekg((nnbrs - width_u32) * sizeof(uint32_t), vamana_reader.cur);
-                }
-
-                // write coords of node first
-                //  T *node_coords = data + ((uint64_t) ndims_64 * cur_node_id);
-                base_reader.read((char *)cur_node_coords.get(), sizeof(T) * ndims_64);
-                memcpy(node_buf.get(), cur_node_coords.get(), ndims_64 * sizeof(T));
-
-                // write nnbrs
-                *(uint32_t *)(node_buf.get() + ndims_64 * sizeof(T)) = (std::min)(nnbrs, width_u32);
+    // aligned staging buffer of whole sectors for the header and the reorder data
+    const uint64_t chunk_sectors = (std::max)((uint64_t)1, LAYOUT_BLOCK_BYTES / defaults::SECTOR_LEN);
+    char *chunk_buf = nullptr;
+    alloc_aligned((void **)&chunk_buf, chunk_sectors * defaults::SECTOR_LEN, defaults::SECTOR_LEN);
+    std::unique_ptr<char, decltype(&aligned_free)> chunk_buf_owner(chunk_buf, &aligned_free);
 
-                // write nhood next
-                memcpy(node_buf.get() + ndims_64 * sizeof(T) + sizeof(uint32_t), nhood_buf,
-                       (std::min)(nnbrs, width_u32) * sizeof(uint32_t));
+    DiskLayoutWriter diskann_writer(output_file, n_sectors + n_reorder_sectors + 1);
+    memset(chunk_buf, 0, defaults::SECTOR_LEN);
+    diskann_writer.write(chunk_buf, 1);
 
-                // get offset into sector_buf
-                char *sector_node_buf = sector_buf.get() + (sector_node_id * max_node_len);
+    diskann::cout << "# sectors: " << n_sectors << std::endl;
 
-                // copy node buf into sector_node_buf
-                memcpy(sector_node_buf, node_buf.get(), max_node_len);
-                cur_node_id++;
-            }
-            // flush sector to disk
-            diskann_writer.write(sector_buf.get(), defaults::SECTOR_LEN);
-        }
+    std::string layout_file = output_file + "_layout.bin";
+    if (reorder_layout && nnodes_per_sector == 0)
+        diskann::cout << "Each node spans whole sectors, so reordering cannot improve locality. Keeping id order."
+                      << std::endl;
+    if (file_exists(layout_file))
+        std::remove(layout_file.c_str());
+
+    if (reorder_layout && nnodes_per_sector > 0)
+    { // Write multiple nodes per sector, in graph order
+        write_disk_layout_in_graph_order<T>(base_file, vamana_reader, output_file, layout_file, diskann_writer,
+                                            npts_64, ndims_64, width_u32, medoid_u32, max_node_len,
+                                            nnodes_per_sector);
     }
     else
-    { // Write multi-sector nodes
-        uint64_t nsectors_per_node = DIV_ROUND_UP(max_node_len, defaults::SECTOR_LEN);
-        for (uint64_t i = 0; i < npts_64; i++)
-        {
-            if ((i * nsectors_per_node) % 100000 == 0)
-            {
-                diskann::cout << "Sector #" << i * nsectors_per_node << "written" << std::endl;
-            }
-            memset(multisector_buf.get(), 0, nsectors_per_node * defaults::SECTOR_LEN);
-
-            memset(node_buf.get(), 0, max_node_len);
-            // read cur node's nnbrs
-            vamana_reader.read((char *)&nnbrs, sizeof(uint32_t));
-
-            // sanity checks on nnbrs
-            assert(nnbrs > 0);
-            assert(nnbrs <= width_u32);
-
-            // read node's nhood
-            vamana_reader.read((char *)nhood_buf, (std::min)(nnbrs, width_u32) * sizeof(uint32_t));
-            if (nnbrs > width_u32)
-            {
-                vamana_reader.seekg((nnbrs - width_u32) * sizeof(uint32_t), vamana_reader.cur);
-            }
-
-            // write coords of node first
-            //  T *node_coords = data + ((uint64_t) ndims_64 * cur_node_id);
-            base_reader.read((char *)cur_node_coords.get(), sizeof(T) * ndims_64);
-            memcpy(multisector_buf.get(), cur_node_coords.get(), ndims_64 * sizeof(T));
-
-            // write nnbrs
-            *(uint32_t *)(multisector_buf.get() + ndims_64 * sizeof(T)) = (std::min)(nnbrs, width_u32);
-
-            // write nhood next
-            memcpy(multisector_buf.get() + ndims_64 * sizeof(T) + sizeof(uint32_t), nhood_buf,
-                   (std::min)(nnbrs, width_u32) * sizeof(uint32_t));
-
-            // flush sector to disk
-            diskann_writer.write(multisector_buf.get(), nsectors_per_node * defaults::SECTOR_LEN);
-        }
+    { // Write nodes in id order, several per sector or each over whole sectors
+        write_disk_layout_in_id_order<T>(base_file, mem_index_file, diskann_writer, npts_64, ndims_64, width_u32,
+                                         max_node_len, nnodes_per_sector);
     }
 
     if (append_reorder_data)
     {
         diskann::cout << "Index written. Appending reorder data..." << std::endl;
 
+        // the vectors of a sector are contiguous in the reorder file, so each sector is one read
         auto vec_len = ndims_reorder_file * sizeof(float);
-        std::unique_ptr<char[]> vec_buf = std::make_unique<char[]>(vec_len);
-
-        for (uint64_t sector = 0; sector < n_reorder_sectors; sector++)
+        uint64_t vecs_left = npts_64;
+        for (uint64_t sector = 0; sector < n_reorder_sectors; sector += chunk_sectors)
         {
-            if (sector % 100000 == 0)
+            uint64_t num_chunk_sectors = (std::min)(chunk_sectors, n_reorder_sectors - sector);
+            memset(chunk_buf, 0, num_chunk_sectors * defaults::SECTOR_LEN);
+            for (uint64_t s = 0; s < num_chunk_sectors; s++)
             {
-                diskann::cout << "Reorder data Sector #" << sector << "written" << std::endl;
+                uint64_t sector_vecs = (std::min)(n_data_nodes_per_sector, vecs_left);
+                reorder_data_reader.read(chunk_buf + s * defaults::SECTOR_LEN, sector_vecs * vec_len);
+                vecs_left -= sector_vecs;
             }
-
-            memset(sector_buf.get(), 0, defaults::SECTOR_LEN);
-
-            for (uint64_t sector_node_id = 0; sector_node_id < n_data_nodes_per_sector && sector_node_id < npts_64;
-                 sector_node_id++)
-            {
-                memset(vec_buf.get(), 0, vec_len);
-                reorder_data_reader.read(vec_buf.get(), vec_len);
-
-                // copy node buf into sector_node_buf
-                memcpy(sector_buf.get() + (sector_node_id * vec_len), vec_buf.get(), vec_len);
-            }
-            // flush sector to disk
-            diskann_writer.write(sector_buf.get(), defaults::SECTOR_LEN);
+            diskann_writer.write(chunk_buf, num_chunk_sectors);
         }
     }
     diskann_writer.close();
@@ -1111,7 +1545,7 @@ int build_disk_index(const char *dataFilePath, const char *indexFilePath, const
     {
         param_list.push_back(cur_param);
     }
-    if (param_list.size() < 5 || param_list.size() > 9)
+    if (param_list.size() < 5 || param_list.size() > 11)
     {
         diskann::cout << "Correct usage of parameters is R (max degree)\n"
                          "L (indexing list size, better if >= R)\n"
@@ -1124,7 +1558,11 @@ int build_disk_index(const char *dataFilePath, const char *indexFilePath, const
                          ": optional paramter, use only when using disk PQ\n"
                          "build_PQ_byte (number of PQ bytes for inde build; set 0 to use "
                          "full precision vectors)\n"
-                         "QD Quantized Dimension to overwrite the derived dim from B "
+                         "QD Quantized Dimension to overwrite the derived dim from B\n"
+                         "reorder_layout (set 1 to order nodes on disk by graph locality"
+                         ": optional parameter)\n"
+                         "kmeans_parallel (set 1 to seed the partitioning and PQ k-means with "
+                         "k-means||: optional parameter)"
                       << std::endl;
         return -1;
     }
@@ -1168,6 +1606,18 @@ int build_disk_index(const char *dataFilePath, const char *indexFilePath, const
         build_pq_bytes = atoi(param_list[7].c_str());
     }
 
+    bool reorder_layout = false;
+    if (param_list.size() >= 10 && 1 == atoi(param_list[9].c_str()))
+    {
+        reorder_layout = true;
+    }
+
+    bool kmeans_parallel_seeding = false;
+    if (param_list.size() >= 11 && 1 == atoi(param_list[10].c_str()))
+    {
+        kmeans_parallel_seeding = true;
+    }
+
     std::string base_file(dataFilePath);
     std::string data_file_to_use = base_file;
     std::string labels_file_original = label_file;
@@ -1292,7 +1742,7 @@ int build_disk_index(const char *dataFilePath, const char *indexFilePath, const
     if (use_disk_pq)
     {
         generate_disk_quantized_data<T>(data_file_to_use, disk_pq_pivots_path, disk_pq_compressed_vectors_path,
-                                        compareMetric, p_val, disk_pq_dims);
+                                        compareMetric, p_val, disk_pq_dims, kmeans_parallel_seeding);
     }
     size_t num_pq_chunks = (size_t)(std::floor)(uint64_t(final_index_ram_limit / points_num));
 
@@ -1312,7 +1762,7 @@ int build_disk_index(const char *dataFilePath, const char *indexFilePath, const
                   << std::endl;
 
     generate_quantized_data<T>(data_file_to_use, pq_pivots_path, pq_compressed_vectors_path, compareMetric, p_val,
-                               num_pq_chunks, use_opq, codebook_prefix);
+                               num_pq_chunks, use_opq, codebook_prefix, kmeans_parallel_seeding);
     diskann::cout << timer.elapsed_seconds_for_step("generating quantized data") << std::endl;
 
 // Gopal. Splitting diskann_dll into separate DLLs for search and build.
@@ -1325,21 +1775,24 @@ int build_disk_index(const char *dataFilePath, const char *indexFilePath, const
     diskann::build_merged_vamana_index<T, LabelT>(data_file_to_use.c_str(), diskann::Metric::L2, L, R, p_val,
                                                   indexing_ram_budget, mem_index_path, medoids_path, centroids_path,
                                                   build_pq_bytes, use_opq, num_threads, use_filters, labels_file_to_use,
-                                                  labels_to_medoids_path, universal_label, Lf);
+                                                  labels_to_medoids_path, universal_label, Lf,
+                                                  kmeans_parallel_seeding);
     diskann::cout << timer.elapsed_seconds_for_step("building merged vamana index") << std::endl;
 
     timer.reset();
     if (!use_disk_pq)
     {
-        diskann::create_disk_layout<T>(data_file_to_use.c_str(), mem_index_path, disk_index_path);
+        diskann::create_disk_layout<T>(data_file_to_use.c_str(), mem_index_path, disk_index_path, "",
+                                       reorder_layout);
     }
     else
     {
         if (!reorder_data)
-            diskann::create_disk_layout<uint8_t>(disk_pq_compressed_vectors_path, mem_index_path, disk_index_path);
+            diskann::create_disk_layout<uint8_t>(disk_pq_compressed_vectors_path, mem_index_path, disk_index_path, "",
+                                                 reorder_layout);
         else
             diskann::create_disk_layout<uint8_t>(disk_pq_compressed_vectors_path, mem_index_path, disk_index_path,
-                                                 data_file_to_use.c_str());
+                                                 data_file_to_use.c_str(), reorder_layout);
     }
     diskann::cout << timer.elapsed_seconds_for_step("generating disk layout") << std::endl;
 
@@ -1379,14 +1832,17 @@ int build_disk_index(const char *dataFilePath, const char *indexFilePath, const
 template DISKANN_DLLEXPORT void create_disk_layout<int8_t>(const std::string base_file,
                                                            const std::string mem_index_file,
                                                            const std::string output_file,
-                                                           const std::string reorder_data_file);
+                                                           const std::string reorder_data_file,
+                                                           const bool reorder_layout);
 template DISKANN_DLLEXPORT void create_disk_layout<uint8_t>(const std::string base_file,
                                                             const std::string mem_index_file,
                                                             const std::string output_file,
-                                                            const std::string reorder_data_file);
+                                                            const std::string reorder_data_file,
+                                                           const bool reorder_layout);
 template DISKANN_DLLEXPORT void create_disk_layout<float>(const std::string base_file, const std::string mem_index_file,
                                                           const std::string output_file,
-                                                          const std::string reorder_data_file);
+                                                          const std::string reorder_data_file,
+                                                          const bool reorder_layout);
 
 template DISKANN_DLLEXPORT int8_t *load_warmup<int8_t>(const std::string &cache_warmup_file, uint64_t &warmup_num,
                                                        uint64_t warmup_dim, uint64_t warmup_aligned_dim);
@@ -1475,31 +1931,37 @@ template DISKANN_DLLEXPORT int build_merged_vamana_index<int8_t, uint32_t>(
     std::string base_file, diskann::Metric compareMetric, uint32_t L, uint32_t R, double sampling_rate,
     double ram_budget, std::string mem_index_path, std::string medoids_path, std::string centroids_file,
     size_t build_pq_bytes, bool use_opq, uint32_t num_threads, bool use_filters, const std::string &label_file,
-    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf);
+    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf,
+    const bool kmeans_parallel_seeding);
 template DISKANN_DLLEXPORT int build_merged_vamana_index<float, uint32_t>(
     std::string base_file, diskann::Metric compareMetric, uint32_t L, uint32_t R, double sampling_rate,
     double ram_budget, std::string mem_index_path, std::string medoids_path, std::string centroids_file,
     size_t build_pq_bytes, bool use_opq, uint32_t num_threads, bool use_filters, const std::string &label_file,
-    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf);
+    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf,
+    const bool kmeans_parallel_seeding);
 template DISKANN_DLLEXPORT int build_merged_vamana_index<uint8_t, uint32_t>(
     std::string base_file, diskann::Metric compareMetric, uint32_t L, uint32_t R, double sampling_rate,
     double ram_budget, std::string mem_index_path, std::string medoids_path, std::string centroids_file,
     size_t build_pq_bytes, bool use_opq, uint32_t num_threads, bool use_filters, const std::string &label_file,
-    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf);
+    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf,
+    const bool kmeans_parallel_seeding);
 // Label=16_t
 template DISKANN_DLLEXPORT int build_merged_vamana_index<int8_t, uint16_t>(
     std::string base_file, diskann::Metric compareMetric, uint32_t L, uint32_t R, double sampling_rate,
     double ram_budget, std::string mem_index_path, std::string medoids_path, std::string centroids_file,
     size_t build_pq_bytes, bool use_opq, uint32_t num_threads, bool use_filters, const std::string &label_file,
-    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf);
+    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf,
+    const bool kmeans_parallel_seeding);
 template DISKANN_DLLEXPORT int build_merged_vamana_index<float, uint16_t>(
     std::string base_file, diskann::Metric compareMetric, uint32_t L, uint32_t R, double sampling_rate,
     double ram_budget, std::string mem_index_path, std::string medoids_path, std::string centroids_file,
     size_t build_pq_bytes, bool use_opq, uint32_t num_threads, bool use_filters, const std::string &label_file,
-    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf);
+    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf,
+    const bool kmeans_parallel_seeding);
 template DISKANN_DLLEXPORT int build_merged_vamana_index<uint8_t, uint16_t>(
     std::string base_file, diskann::Metric compareMetric, uint32_t L, uint32_t R, double sampling_rate,
     double ram_budget, std::string mem_index_path, std::string medoids_path, std::string centroids_file,
     size_t build_pq_bytes, bool use_opq, uint32_t num_threads, bool use_filters, const std::string &label_file,
-    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf);
+    const std::string &labels_to_medoids_file, const std::string &universal_label, const uint32_t Lf,
+    const bool kmeans_parallel_seeding);
 }; // namespace diskann
@@ -31,6 +31,14 @@ float Distance<T>::compare(const T *a, const T *b, const float normA, const floa
     throw std::logic_error("This function is not implemented.");
 }
 
+template <typename T>
+void Distance<T>::compare_batch(const T *const *queries, uint32_t num_queries, const T *b, uint32_t length,
+                                float *dists) const
+{
+    for (uint32_t i = 0; i < num_queries; i++)
+        dists[i] = compare(queries[i], b, length);
+}
+
 template <typename T> uint32_t Distance<T>::post_normalization_dimension(uint32_t orig_dimension) const
 {
     return orig_dimension;
@@ -220,6 +228,46 @@ float DistanceL2Float::compare(const float *a, const float *b, uint32_t size) co
     return result;
 }
 
+// Four queries per pass share each 8-float load of b; the vector is streamed once per group of four instead of
+// once per query.
+void DistanceL2Float::compare_batch(const float *const *queries, uint32_t num_queries, const float *b, uint32_t size,
+                                    float *dists) const
+{
+    uint32_t i = 0;
+#ifdef USE_AVX2
+    uint32_t niters = size / 8;
+    for (; i + 4 <= num_queries; i += 4)
+    {
+        const float *q0 = queries[i], *q1 = queries[i + 1], *q2 = queries[i + 2], *q3 = queries[i + 3];
+        __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+        __m256 sum2 = _mm256_setzero_ps(), sum3 = _mm256_setzero_ps();
+        for (uint32_t j = 0; j < niters; j++)
+        {
+            __m256 b_vec = _mm256_loadu_ps(b + 8 * j);
+            __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(q0 + 8 * j), b_vec);
+            __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(q1 + 8 * j), b_vec);
+            __m256 d2 = _mm256_sub_ps(_mm256_loadu_ps(q2 + 8 * j), b_vec);
+            __m256 d3 = _mm256_sub_ps(_mm256_loadu_ps(q3 + 8 * j), b_vec);
+            sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+            sum1 = _mm256_fmadd_ps(d1, d1, sum1);
+            sum2 = _mm256_fmadd_ps(d2, d2, sum2);
+            sum3 = _mm256_fmadd_ps(d3, d3, sum3);
+        }
+        dists[i] = _mm256_reduce_add_ps(sum0);
+        dists[i + 1] = _mm256_reduce_add_ps(sum1);
+        dists[i + 2] = _mm256_reduce_add_ps(sum2);
+        dists[i + 3] = _mm256_reduce_add_ps(sum3);
+        for (uint32_t k = 8 * niters; k < size; k++)
+        {
+            for (uint32_t t = 0; t < 4; t++)
+                dists[i + t] += (queries[i + t][k] - b[k]) * (queries[i + t][k] - b[k]);
+        }
+    }
+#endif
+    for (; i < num_queries; i++)
+        dists[i] = compare(queries[i], b, size);
+}
+
 template <typename T> float SlowDistanceL2<T>::compare(const T *a, const T *b, uint32_t length) const
 {
     float result = 0.0f;
@@ -561,6 +609,38 @@ float AVXDistanceInnerProductFloat::compare(const float *a, const float *b, uint
     return -result;
 }
 
+void AVXDistanceInnerProductFloat::compare_batch(const float *const *queries, uint32_t num_queries, const float *b,
+                                                 uint32_t size, float *dists) const
+{
+    uint32_t i = 0;
+    uint32_t niters = size / 8;
+    for (; i + 4 <= num_queries; i += 4)
+    {
+        const float *q0 = queries[i], *q1 = queries[i + 1], *q2 = queries[i + 2], *q3 = queries[i + 3];
+        __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+        __m256 sum2 = _mm256_setzero_ps(), sum3 = _mm256_setzero_ps();
+        for (uint32_t j = 0; j < niters; j++)
+        {
+            __m256 b_vec = _mm256_loadu_ps(b + 8 * j);
+            sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(q0 + 8 * j), b_vec));
+            sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(q1 + 8 * j), b_vec));
+            sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(_mm256_loadu_ps(q2 + 8 * j), b_vec));
+            sum3 = _mm256_add_ps(sum3, _mm256_mul_ps(_mm256_loadu_ps(q3 + 8 * j), b_vec));
+        }
+        float result[4] = {_mm256_reduce_add_ps(sum0), _mm256_reduce_add_ps(sum1), _mm256_reduce_add_ps(sum2),
+                           _mm256_reduce_add_ps(sum3)};
+        for (uint32_t k = 8 * niters; k < size; k++)
+        {
+            for (uint32_t t = 0; t < 4; t++)
+                result[t] += queries[i + t][k] * b[k];
+        }
+        for (uint32_t t = 0; t < 4; t++)
+            dists[i + t] = -result[t];
+    }
+    for (; i < num_queries; i++)
+        dists[i] = compare(queries[i], b, size);
+}
+
 uint32_t AVXNormalizedCosineDistanceFloat::post_normalization_dimension(uint32_t orig_dimension) const
 {
     return orig_dimension;
@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "huge_page_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+#ifndef _WINDOWS
+#include <sys/mman.h>
+#else
+#include <malloc.h>
+#endif
+
+#include "ann_exception.h"
+#include "defaults.h"
+#include "logger.h"
+
+#ifndef _WINDOWS
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+#endif
+
+#define HUGE_PAGE_2MB (2ULL << 20)
+#define HUGE_PAGE_1GB (1ULL << 30)
+#define BASE_PAGE_SIZE 4096ULL
+
+namespace diskann
+{
+
+namespace
+{
+struct Allocation
+{
+    size_t size;
+    bool mapped; // from mmap rather than aligned_alloc
+    bool huge;
+};
+
+// Large allocations are few and long-lived, so one locked map of them costs nothing measurable and lets free_large
+// tell mmap'd blocks from heap ones.
+std::mutex allocations_lock;
+std::unordered_map<void *, Allocation> allocations;
+AllocatorStats stats;
+std::atomic<HugePageMode> huge_page_mode(HugePageMode::NONE);
+
+size_t round_up(size_t size, size_t align)
+{
+    return (size + align - 1) / align * align;
+}
+
+void *alloc_heap(size_t size, size_t align)
+{
+#ifndef _WINDOWS
+    return ::aligned_alloc(align, size);
+#else
+    return ::_aligned_malloc(size, align);
+#endif
+}
+
+#ifndef _WINDOWS
+void *alloc_transparent(size_t size)
+{
+    void *ptr = ::aligned_alloc(HUGE_PAGE_2MB, size);
+    if (ptr != nullptr)
+        madvise(ptr, size, MADV_HUGEPAGE); // a hint; base pages are used if THP is disabled
+    return ptr;
+}
+#endif
+} // namespace
+
+HugePageMode get_huge_page_mode(const std::string &name)
+{
+    if (name == "none")
+        return HugePageMode::NONE;
+    if (name == "transparent")
+        return HugePageMode::TRANSPARENT;
+    if (name == "2mb")
+        return HugePageMode::EXPLICIT_2MB;
+    if (name == "1gb")
+        return HugePageMode::EXPLICIT_1GB;
+    throw ANNException("Unknown huge page mode " + name + ". Use none, transparent, 2mb or 1gb.", -1, __FUNCSIG__,
+                       __FILE__, __LINE__);
+}
+
+void set_huge_page_mode(HugePageMode mode)
+{
+    huge_page_mode.store(mode);
+}
+
+HugePageMode get_huge_page_mode()
+{
+    return huge_page_mode.load();
+}
+
+AllocatorStats get_allocator_stats()
+{
+    std::lock_guard<std::mutex> guard(allocations_lock);
+    return stats;
+}
+
+void alloc_large(void **ptr, size_t size, size_t align)
+{
+    *ptr = nullptr;
+    if (align == 0 || align > BASE_PAGE_SIZE || (align & (align - 1)) != 0)
+        throw ANNException("alloc_large needs a power of two alignment of at most 4096", -1, __FUNCSIG__, __FILE__,
+                           __LINE__);
+
+    const HugePageMode mode = size < defaults::HUGE_PAGE_MIN_ALLOC_BYTES ? HugePageMode::NONE : get_huge_page_mode();
+    Allocation allocation{round_up((std::max)(size, (size_t)1), align), false, false};
+    bool fell_back = false;
+
+#ifndef _WINDOWS
+    if (mode == HugePageMode::EXPLICIT_2MB || mode == HugePageMode::EXPLICIT_1GB)
+    {
+        const size_t page = mode == HugePageMode::EXPLICIT_1GB ? HUGE_PAGE_1GB : HUGE_PAGE_2MB;
+        const int page_flag = mode == HugePageMode::EXPLICIT_1GB ? MAP_HUGE_1GB : MAP_HUGE_2MB;
+        const size_t mapped_size = round_up(size, page);
+        void *mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | page_flag, -1, 0);
+        if (mapped != MAP_FAILED)
+        {
+            *ptr = mapped;
+            allocation = Allocation{mapped_size, true, true};
+        }
+        else
+            fell_back = true;
+    }
+    if (*ptr == nullptr && mode != HugePageMode::NONE)
+    {
+        allocation.size = round_up(size, HUGE_PAGE_2MB);
+        *ptr = alloc_transparent(allocation.size);
+        allocation.huge = true;
+    }
+#else
+    (void)mode; // large pages on Windows need the lock-pages privilege; base pages are used
+#endif
+    if (*ptr == nullptr)
+    {
+        allocation = Allocation{round_up((std::max)(size, (size_t)1), align), false, false};
+        *ptr = alloc_heap(allocation.size, align);
+    }
+    if (*ptr == nullptr)
+        throw ANNException("Memory allocation failed", -1, __FUNCSIG__, __FILE__, __LINE__);
+
+    std::lock_guard<std::mutex> guard(allocations_lock);
+    if (fell_back && stats.n_huge_fallbacks++ == 0)
+    {
+        diskann::cout << "Explicit hugepages unavailable (see /proc/sys/vm/nr_hugepages), using transparent "
+                         "hugepages instead"
+                      << std::endl;
+    }
+    allocations.emplace(*ptr, allocation);
+    stats.n_allocations++;
+    stats.bytes += allocation.size;
+    stats.peak_bytes = (std::max)(stats.peak_bytes, stats.bytes);
+    if (allocation.huge)
+        stats.huge_page_bytes += allocation.size;
+}
+
+void free_large(void *ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    Allocation allocation;
+    {
+        std::lock_guard<std::mutex> guard(allocations_lock);
+        auto iter = allocations.find(ptr);
+        if (iter == allocations.end())
+            throw ANNException("free_large called on memory not from alloc_large", -1, __FUNCSIG__, __FILE__,
+                               __LINE__);
+        allocation = iter->second;
+        allocations.erase(iter);
+        stats.n_allocations--;
+        stats.bytes -= allocation.size;
+        if (allocation.huge)
+            stats.huge_page_bytes -= allocation.size;
+    }
+
+#ifndef _WINDOWS
+    if (allocation.mapped)
+        munmap(ptr, allocation.size);
+    else
+        ::free(ptr);
+#else
+    ::_aligned_free(ptr);
+#endif
+}
+
+ScratchArena::ScratchArena(size_t capacity) : _capacity(capacity)
+{
+    alloc_large((void **)&_buf, capacity, BASE_PAGE_SIZE);
+}
+
+ScratchArena::~ScratchArena()
+{
+    free_large(_buf);
+}
+
+void *ScratchArena::allocate(size_t size, size_t align)
+{
+    const size_t start = round_up((size_t)_buf + _used, align) - (size_t)_buf;
+    if (start + size > _capacity)
+        throw ANNException("ScratchArena capacity exceeded", -1, __FUNCSIG__, __FILE__, __LINE__);
+    _used = start + size;
+    return _buf + start;
+}
+
+} // namespace diskann
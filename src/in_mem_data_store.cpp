@@ -6,6 +6,7 @@
 #include "in_mem_data_store.h"
 
 #include "utils.h"
+#include "huge_page_allocator.h"
 
 namespace diskann
 {
@@ -13,18 +14,28 @@ namespace diskann
 template <typename data_t>
 InMemDataStore<data_t>::InMemDataStore(const location_t num_points, const size_t dim,
                                        std::unique_ptr<Distance<data_t>> distance_fn)
+    : InMemDataStore(num_points, dim, std::move(distance_fn), true)
+{
+}
+
+template <typename data_t>
+InMemDataStore<data_t>::InMemDataStore(const location_t num_points, const size_t dim,
+                                       std::unique_ptr<Distance<data_t>> distance_fn, const bool allocate_data)
     : AbstractDataStore<data_t>(num_points, dim), _distance_fn(std::move(distance_fn))
 {
     _aligned_dim = ROUND_UP(dim, _distance_fn->get_required_alignment());
-    alloc_aligned(((void **)&_data), this->_capacity * _aligned_dim * sizeof(data_t), 8 * sizeof(data_t));
-    std::memset(_data, 0, this->_capacity * _aligned_dim * sizeof(data_t));
+    if (allocate_data)
+    {
+        alloc_large(((void **)&_data), this->_capacity * _aligned_dim * sizeof(data_t), 8 * sizeof(data_t));
+        std::memset(_data, 0, this->_capacity * _aligned_dim * sizeof(data_t));
+    }
 }
 
 template <typename data_t> InMemDataStore<data_t>::~InMemDataStore()
 {
     if (_data != nullptr)
     {
-        aligned_free(this->_data);
+        free_large(this->_data);
     }
 }
 
@@ -56,7 +67,8 @@ template <typename data_t> location_t InMemDataStore<data_t>::load_impl(AlignedF
         stream << "ERROR: Driver requests loading " << this->_dim << " dimension,"
                << "but file has " << file_dim << " dimension." << std::endl;
         diskann::cerr << stream.str() << std::endl;
-        aligned_free(_data);
+        free_large(_data);
+        _data = nullptr;
         throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
     }
 
@@ -78,7 +90,8 @@ template <typename data_t> location_t InMemDataStore<data_t>::load_impl(const st
         std::stringstream stream;
         stream << "ERROR: data file " << filename << " does not exist." << std::endl;
         diskann::cerr << stream.str() << std::endl;
-        aligned_free(_data);
+        free_large(_data);
+        _data = nullptr;
         throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
     }
     diskann::get_bin_metadata(filename, file_num_points, file_dim);
@@ -89,7 +102,8 @@ template <typename data_t> location_t InMemDataStore<data_t>::load_impl(const st
         stream << "ERROR: Driver requests loading " << this->_dim << " dimension,"
                << "but file has " << file_dim << " dimension." << std::endl;
         diskann::cerr << stream.str() << std::endl;
-        aligned_free(_data);
+        free_large(_data);
+        _data = nullptr;
         throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
     }
 
@@ -229,6 +243,14 @@ void InMemDataStore<data_t>::get_distance(const data_t *preprocessed_query, cons
     }
 }
 
+template <typename data_t>
+void InMemDataStore<data_t>::get_distance_batch(const data_t *const *preprocessed_queries, const uint32_t num_queries,
+                                                const location_t loc, float *distances) const
+{
+    _distance_fn->compare_batch(preprocessed_queries, num_queries, _data + loc * _aligned_dim,
+                                (uint32_t)this->_aligned_dim, distances);
+}
+
 template <typename data_t> location_t InMemDataStore<data_t>::expand(const location_t new_size)
 {
     if (new_size == this->capacity())
@@ -242,15 +264,11 @@ template <typename data_t> location_t InMemDataStore<data_t>::expand(const locat
            << this->capacity() << ")" << std::endl;
         throw diskann::ANNException(ss.str(), -1);
     }
-#ifndef _WINDOWS
     data_t *new_data;
-    alloc_aligned((void **)&new_data, new_size * _aligned_dim * sizeof(data_t), 8 * sizeof(data_t));
+    alloc_large((void **)&new_data, new_size * _aligned_dim * sizeof(data_t), 8 * sizeof(data_t));
     memcpy(new_data, _data, this->capacity() * _aligned_dim * sizeof(data_t));
-    aligned_free(_data);
+    free_large(_data);
     _data = new_data;
-#else
-    realloc_aligned((void **)&_data, new_size * _aligned_dim * sizeof(data_t), 8 * sizeof(data_t));
-#endif
     this->_capacity = new_size;
     return this->_capacity;
 }
@@ -268,15 +286,11 @@ template <typename data_t> location_t InMemDataStore<data_t>::shrink(const locat
            << this->capacity() << ")" << std::endl;
         throw diskann::ANNException(ss.str(), -1);
     }
-#ifndef _WINDOWS
     data_t *new_data;
-    alloc_aligned((void **)&new_data, new_size * _aligned_dim * sizeof(data_t), 8 * sizeof(data_t));
+    alloc_large((void **)&new_data, new_size * _aligned_dim * sizeof(data_t), 8 * sizeof(data_t));
     memcpy(new_data, _data, new_size * _aligned_dim * sizeof(data_t));
-    aligned_free(_data);
+    free_large(_data);
     _data = new_data;
-#else
-    realloc_aligned((void **)&_data, new_size * _aligned_dim * sizeof(data_t), 8 * sizeof(data_t));
-#endif
     this->_capacity = new_size;
     return this->_capacity;
 }
@@ -0,0 +1,291 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "in_mem_flat_graph_store.h"
+#include "utils.h"
+
+#include <algorithm>
+
+namespace diskann
+{
+InMemFlatGraphStore::InMemFlatGraphStore(const size_t total_pts, const size_t reserve_graph_degree)
+    : AbstractGraphStore(total_pts, reserve_graph_degree)
+{
+    // inter_insert lets a list grow to just under GRAPH_SLACK_FACTOR * R and then adds one more,
+    // which can exceed the truncated reserve degree by one
+    relayout(total_pts, reserve_graph_degree == 0 ? 0 : reserve_graph_degree + 1);
+}
+
+InMemFlatGraphStore::~InMemFlatGraphStore()
+{
+    clear_graph();
+}
+
+std::tuple<uint32_t, uint32_t, size_t> InMemFlatGraphStore::load(const std::string &index_path_prefix,
+                                                                 const size_t num_points)
+{
+    return load_impl(index_path_prefix, num_points);
+}
+
+int InMemFlatGraphStore::store(const std::string &index_path_prefix, const size_t num_points,
+                               const size_t num_frozen_points, const uint32_t start)
+{
+    return save_graph(index_path_prefix, num_points, num_frozen_points, start);
+}
+
+NeighbourList InMemFlatGraphStore::get_neighbours(const location_t i) const
+{
+    const uint32_t *s = slot(i);
+    return NeighbourList(s + 1, s[0]);
+}
+
+bool InMemFlatGraphStore::lock_free_reads() const
+{
+    return _versions != nullptr;
+}
+
+void InMemFlatGraphStore::copy_neighbours(const location_t i, std::vector<location_t> &neighbours) const
+{
+    const uint32_t *s = slot(i);
+    if (_versions == nullptr)
+    {
+        neighbours.assign(s + 1, s + 1 + s[0]);
+        return;
+    }
+
+    const std::atomic<uint32_t> &version = _versions[i];
+    while (true)
+    {
+        const uint32_t before = version.load(std::memory_order_acquire);
+        if (before & 1)
+            continue; // a writer is mid-update; updates are a few hundred bytes at most
+        // a degree torn by a concurrent write is discarded below, but must not take the copy past the slot
+        const size_t degree = (std::min)((size_t)((const volatile uint32_t *)s)[0], _max_degree);
+        neighbours.resize(degree);
+        memcpy(neighbours.data(), s + 1, degree * sizeof(location_t));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version.load(std::memory_order_relaxed) == before)
+            return;
+    }
+}
+
+void InMemFlatGraphStore::add_neighbour(const location_t i, location_t neighbour_id)
+{
+    uint32_t *s = slot(i);
+    if (s[0] >= _max_degree)
+    {
+        throw ANNException("InMemFlatGraphStore: node " + std::to_string(i) + " already has the maximum " +
+                               std::to_string(_max_degree) + " neighbours",
+                           -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    begin_write(i);
+    s[1 + s[0]] = neighbour_id;
+    s[0]++;
+    end_write(i);
+    if (_max_observed_degree < s[0])
+    {
+        _max_observed_degree = s[0];
+    }
+}
+
+void InMemFlatGraphStore::clear_neighbours(const location_t i)
+{
+    begin_write(i);
+    slot(i)[0] = 0;
+    end_write(i);
+}
+
+void InMemFlatGraphStore::swap_neighbours(const location_t a, location_t b)
+{
+    if (a == b)
+        return;
+    uint32_t *sa = slot(a);
+    uint32_t *sb = slot(b);
+    begin_write(a);
+    begin_write(b);
+    std::swap_ranges(sa, sa + 1 + (std::max)(sa[0], sb[0]), sb);
+    end_write(b);
+    end_write(a);
+}
+
+void InMemFlatGraphStore::set_neighbours(const location_t i, std::vector<location_t> &neighbours)
+{
+    if (neighbours.size() > _max_degree)
+    {
+        throw ANNException("InMemFlatGraphStore: " + std::to_string(neighbours.size()) + " neighbours for node " +
+                               std::to_string(i) + " exceed the slot size of " + std::to_string(_max_degree),
+                           -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    uint32_t *s = slot(i);
+    begin_write(i);
+    s[0] = (uint32_t)neighbours.size();
+    if (!neighbours.empty())
+        memcpy(s + 1, neighbours.data(), neighbours.size() * sizeof(location_t));
+    end_write(i);
+    if (_max_observed_degree < neighbours.size())
+    {
+        _max_observed_degree = (uint32_t)(neighbours.size());
+    }
+}
+
+size_t InMemFlatGraphStore::resize_graph(const size_t new_size)
+{
+    relayout(new_size, _max_degree);
+    set_total_points(new_size);
+    return _num_slots;
+}
+
+void InMemFlatGraphStore::clear_graph()
+{
+    if (_slots != nullptr)
+    {
+        aligned_free(_slots);
+        _slots = nullptr;
+    }
+    _versions.reset();
+    _num_slots = 0;
+}
+
+void InMemFlatGraphStore::relayout(size_t num_slots, size_t max_degree)
+{
+    size_t stride = ROUND_UP(1 + max_degree, FLAT_GRAPH_SLOT_ALIGN_WORDS);
+    if (num_slots == _num_slots && stride == _stride)
+        return;
+
+    uint32_t *new_slots = nullptr;
+    std::unique_ptr<std::atomic<uint32_t>[]> new_versions;
+    if (num_slots > 0)
+    {
+        // resizing excludes readers, so versions can restart from zero
+        new_versions.reset(new std::atomic<uint32_t>[num_slots]());
+        alloc_aligned((void **)&new_slots, num_slots * stride * sizeof(uint32_t), 64);
+        size_t num_copied = (std::min)(num_slots, _num_slots);
+        for (size_t i = 0; i < num_copied; i++)
+        {
+            const uint32_t *old_slot = slot((location_t)i);
+            memcpy(new_slots + i * stride, old_slot, (1 + (size_t)old_slot[0]) * sizeof(uint32_t));
+        }
+        for (size_t i = num_copied; i < num_slots; i++)
+            new_slots[i * stride] = 0;
+    }
+
+    clear_graph();
+    _slots = new_slots;
+    _versions = std::move(new_versions);
+    _num_slots = num_slots;
+    _stride = stride;
+    _max_degree = max_degree;
+}
+
+std::tuple<uint32_t, uint32_t, size_t> InMemFlatGraphStore::load_impl(const std::string &filename,
+                                                                      size_t expected_num_points)
+{
+    size_t expected_file_size;
+    size_t file_frozen_pts;
+    uint32_t start;
+    size_t file_offset = 0; // will need this for single file format support
+
+    std::ifstream in;
+    in.exceptions(std::ios::badbit | std::ios::failbit);
+    in.open(filename, std::ios::binary);
+    in.seekg(file_offset, in.beg);
+    in.read((char *)&expected_file_size, sizeof(size_t));
+    in.read((char *)&_max_observed_degree, sizeof(uint32_t));
+    in.read((char *)&start, sizeof(uint32_t));
+    in.read((char *)&file_frozen_pts, sizeof(size_t));
+    size_t vamana_metadata_size = sizeof(size_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(size_t);
+
+    diskann::cout << "From graph header, expected_file_size: " << expected_file_size
+                  << ", _max_observed_degree: " << _max_observed_degree << ", _start: " << start
+                  << ", file_frozen_pts: " << file_frozen_pts << std::endl;
+
+    diskann::cout << "Loading vamana graph " << filename << " into flat slots..." << std::flush;
+
+    // grow the slots to hold the largest list in the file, and the graph if the file has more points
+    size_t num_slots = (std::max)(get_total_points(), expected_num_points);
+    if (num_slots != _num_slots || _max_degree < _max_observed_degree)
+    {
+        relayout(num_slots, (std::max)(_max_degree, (size_t)_max_observed_degree));
+        set_total_points(num_slots);
+    }
+
+    size_t bytes_read = vamana_metadata_size;
+    size_t cc = 0;
+    uint32_t nodes_read = 0;
+    while (bytes_read != expected_file_size)
+    {
+        uint32_t k;
+        in.read((char *)&k, sizeof(uint32_t));
+
+        if (k == 0)
+        {
+            diskann::cerr << "ERROR: Point found with no out-neighbours, point#" << nodes_read << std::endl;
+        }
+        if (nodes_read >= _num_slots || k > _max_degree)
+        {
+            throw ANNException("Graph file " + filename + " has more points or a larger degree than its header",
+                               -1, __FUNCSIG__, __FILE__, __LINE__);
+        }
+
+        uint32_t *s = slot(nodes_read);
+        s[0] = k;
+        in.read((char *)(s + 1), k * sizeof(uint32_t));
+        cc += k;
+        ++nodes_read;
+        bytes_read += sizeof(uint32_t) * ((size_t)k + 1);
+        if (nodes_read % 10000000 == 0)
+            diskann::cout << "." << std::flush;
+        if (k > _max_range_of_graph)
+        {
+            _max_range_of_graph = k;
+        }
+    }
+
+    diskann::cout << "done. Index has " << nodes_read << " nodes and " << cc << " out-edges, _start is set to " << start
+                  << std::endl;
+    return std::make_tuple(nodes_read, start, file_frozen_pts);
+}
+
+int InMemFlatGraphStore::save_graph(const std::string &index_path_prefix, const size_t num_points,
+                                    const size_t num_frozen_points, const uint32_t start)
+{
+    std::ofstream out;
+    open_file_to_write(out, index_path_prefix);
+
+    size_t file_offset = 0;
+    out.seekp(file_offset, out.beg);
+    size_t index_size = 24;
+    uint32_t max_degree = 0;
+    out.write((char *)&index_size, sizeof(uint64_t));
+    out.write((char *)&_max_observed_degree, sizeof(uint32_t));
+    uint32_t ep_u32 = start;
+    out.write((char *)&ep_u32, sizeof(uint32_t));
+    out.write((char *)&num_frozen_points, sizeof(size_t));
+
+    // Note: num_points = _nd + _num_frozen_points
+    for (uint32_t i = 0; i < num_points; i++)
+    {
+        // degree word and neighbours are contiguous, so each list is written as-is
+        const uint32_t *s = slot(i);
+        out.write((char *)s, (s[0] + 1) * sizeof(uint32_t));
+        max_degree = s[0] > max_degree ? s[0] : max_degree;
+        index_size += (size_t)(sizeof(uint32_t) * (s[0] + 1));
+    }
+    out.seekp(file_offset, out.beg);
+    out.write((char *)&index_size, sizeof(uint64_t));
+    out.write((char *)&max_degree, sizeof(uint32_t));
+    out.close();
+    return (int)index_size;
+}
+
+size_t InMemFlatGraphStore::get_max_range_of_graph()
+{
+    return _max_range_of_graph;
+}
+
+uint32_t InMemFlatGraphStore::get_max_observed_degree()
+{
+    return _max_observed_degree;
+}
+
+} // namespace diskann
@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <algorithm>
+
+#include "in_neighbor_index.h"
+#include "omp.h"
+
+namespace diskann
+{
+
+InNeighborIndex::InNeighborIndex(const size_t num_points) : _in_nbrs(num_points), _locks(NUM_LOCK_STRIPES)
+{
+}
+
+void InNeighborIndex::build(const AbstractGraphStore &graph_store, const size_t num_points,
+                            const uint32_t num_threads)
+{
+    _in_nbrs.clear();
+    _in_nbrs.resize(num_points);
+    _num_edges = 0;
+
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 2048)
+    for (int64_t loc = 0; loc < (int64_t)num_points; loc++)
+    {
+        for (auto nbr : graph_store.get_neighbours((location_t)loc))
+            add_edge((uint32_t)loc, nbr);
+    }
+}
+
+void InNeighborIndex::resize(const size_t num_points)
+{
+    _in_nbrs.resize(num_points);
+}
+
+void InNeighborIndex::update(const uint32_t location, const NeighbourList &old_nbrs,
+                             const std::vector<uint32_t> &new_nbrs)
+{
+    // lists are at most a few hundred long, so linear membership tests beat building sets
+    for (auto nbr : old_nbrs)
+    {
+        if (std::find(new_nbrs.begin(), new_nbrs.end(), nbr) == new_nbrs.end())
+            remove_edge(location, nbr);
+    }
+    for (auto nbr : new_nbrs)
+    {
+        if (std::find(old_nbrs.begin(), old_nbrs.end(), nbr) == old_nbrs.end())
+            add_edge(location, nbr);
+    }
+}
+
+void InNeighborIndex::add_edge(const uint32_t from, const uint32_t to)
+{
+    LockGuard guard(lock_for(to));
+    _in_nbrs[to].push_back(from);
+    _num_edges++;
+}
+
+void InNeighborIndex::remove_edge(const uint32_t from, const uint32_t to)
+{
+    LockGuard guard(lock_for(to));
+    auto &in_nbrs = _in_nbrs[to];
+    auto iter = std::find(in_nbrs.begin(), in_nbrs.end(), from);
+    if (iter != in_nbrs.end())
+    {
+        *iter = in_nbrs.back();
+        in_nbrs.pop_back();
+        _num_edges--;
+    }
+}
+
+std::vector<uint32_t> InNeighborIndex::get_in_neighbors(const tsl::robin_set<uint32_t> &locations)
+{
+    tsl::robin_set<uint32_t> in_nbrs;
+    for (auto loc : locations)
+    {
+        LockGuard guard(lock_for(loc));
+        in_nbrs.insert(_in_nbrs[loc].begin(), _in_nbrs[loc].end());
+    }
+    return std::vector<uint32_t>(in_nbrs.begin(), in_nbrs.end());
+}
+
+size_t InNeighborIndex::memory_in_bytes() const
+{
+    // counts stored entries rather than vector capacities, so it stays O(1) on large indexes
+    return _in_nbrs.capacity() * sizeof(std::vector<uint32_t>) + _locks.size() * sizeof(non_recursive_mutex) +
+           _num_edges.load() * sizeof(uint32_t);
+}
+
+} // namespace diskann
@@ -23,8 +23,6 @@
 
 #include "index.h"
 
-#define MAX_POINTS_FOR_USING_BITSET 10000000
-
 namespace diskann
 {
 // Initialize an index with metric m, load the data of type T with filename
@@ -38,7 +36,8 @@ Index<T, TagT, LabelT>::Index(const IndexConfig &index_config, std::shared_ptr<A
       _enable_tags(index_config.enable_tags), _indexingMaxC(DEFAULT_MAXC), _query_scratch(nullptr),
       _pq_dist(index_config.pq_dist_build), _use_opq(index_config.use_opq),
       _filtered_index(index_config.filtered_index), _num_pq_chunks(index_config.num_pq_chunks),
-      _delete_set(new tsl::robin_set<uint32_t>), _conc_consolidate(index_config.concurrent_consolidate)
+      _delete_set(new tsl::robin_set<uint32_t>), _conc_consolidate(index_config.concurrent_consolidate),
+      _track_in_neighbors(index_config.track_in_neighbors)
 {
     if (_dynamic_index && !_enable_tags)
     {
@@ -77,6 +76,8 @@ Index<T, TagT, LabelT>::Index(const IndexConfig &index_config, std::shared_ptr<A
     _graph_store = std::move(graph_store);
 
     _locks = std::vector<non_recursive_mutex>(total_internal_points);
+    if (_track_in_neighbors)
+        _in_neighbors = std::make_unique<InNeighborIndex>(total_internal_points);
     if (_enable_tags)
     {
         _location_to_tag.reserve(total_internal_points);
@@ -158,6 +159,9 @@ Index<T, TagT, LabelT>::Index(Metric m, const size_t dim, const size_t max_point
 
 template <typename T, typename TagT, typename LabelT> Index<T, TagT, LabelT>::~Index()
 {
+    // the service takes the locks below, so stop it before acquiring them
+    stop_background_consolidation();
+
     // Ensure that no other activity is happening before dtor()
     std::unique_lock<std::shared_timed_mutex> ul(_update_lock);
     std::unique_lock<std::shared_timed_mutex> cl(_consolidate_lock);
@@ -390,6 +394,7 @@ void Index<T, TagT, LabelT>::save(const char *filename, bool compact_before_save
     // If frozen points were temporarily compacted to _nd, move back to
     // _max_points.
     reposition_frozen_point_to_end();
+    rebuild_in_neighbors();
 
     diskann::cout << "Time taken for save: " << timer.elapsed() / 1000000.0 << "s." << std::endl;
 }
@@ -643,6 +648,7 @@ void Index<T, TagT, LabelT>::load(const char *filename, uint32_t num_threads, ui
     }
 
     reposition_frozen_point_to_end();
+    rebuild_in_neighbors();
     diskann::cout << "Num frozen points:" << _num_frozen_pts << " _nd: " << _nd << " _start: " << _start
                   << " size(_location_to_tag): " << _location_to_tag.size()
                   << " size(_tag_to_location):" << _tag_to_location.size() << " Max points: " << _max_points
@@ -761,43 +767,100 @@ template <typename T, typename TagT, typename LabelT>
 bool Index<T, TagT, LabelT>::detect_common_filters(uint32_t point_id, bool search_invocation,
                                                    const std::vector<LabelT> &incoming_labels)
 {
-    auto &curr_node_labels = _location_to_labels[point_id];
-    std::vector<LabelT> common_filters;
-    std::set_intersection(incoming_labels.begin(), incoming_labels.end(), curr_node_labels.begin(),
-                          curr_node_labels.end(), std::back_inserter(common_filters));
-    if (common_filters.size() > 0)
+    return detect_common_filters(point_id, search_invocation, incoming_labels, nullptr);
+}
+
+template <typename T, typename TagT, typename LabelT>
+bool Index<T, TagT, LabelT>::detect_common_filters(uint32_t point_id, bool search_invocation,
+                                                   const std::vector<LabelT> &incoming_labels,
+                                                   const uint64_t *incoming_bits) const
+{
+    auto has_universal = [this](const uint64_t *bits) {
+        return (uint64_t)_universal_label < 64 * (uint64_t)_label_bitset_words &&
+               ((bits[_universal_label / 64] >> (_universal_label % 64)) & 1);
+    };
+
+    if (incoming_bits != nullptr)
     {
-        // This is to reduce the repetitive calls. If common_filters size is > 0 ,
-        // we dont need to check further for universal label
-        return true;
+        const uint64_t *curr_node_bits = _location_to_label_bits.data() + (size_t)point_id * _label_bitset_words;
+        uint64_t common = 0;
+        for (uint32_t w = 0; w < _label_bitset_words; w++)
+            common |= curr_node_bits[w] & incoming_bits[w];
+        if (common != 0)
+            return true;
+        if (!_use_universal_label)
+            return false;
+        return has_universal(curr_node_bits) || (!search_invocation && has_universal(incoming_bits));
+    }
+
+    // both label lists are sorted: stop at the first label they share
+    auto &curr_node_labels = _location_to_labels[point_id];
+    auto in_iter = incoming_labels.begin();
+    auto curr_iter = curr_node_labels.begin();
+    while (in_iter != incoming_labels.end() && curr_iter != curr_node_labels.end())
+    {
+        if (*in_iter < *curr_iter)
+            ++in_iter;
+        else if (*curr_iter < *in_iter)
+            ++curr_iter;
+        else
+            return true;
     }
     if (_use_universal_label)
     {
-        if (!search_invocation)
-        {
-            if (std::find(incoming_labels.begin(), incoming_labels.end(), _universal_label) != incoming_labels.end() ||
-                std::find(curr_node_labels.begin(), curr_node_labels.end(), _universal_label) != curr_node_labels.end())
-                common_filters.push_back(_universal_label);
-        }
-        else
-        {
-            if (std::find(curr_node_labels.begin(), curr_node_labels.end(), _universal_label) != curr_node_labels.end())
-                common_filters.push_back(_universal_label);
-        }
+        if (std::find(curr_node_labels.begin(), curr_node_labels.end(), _universal_label) != curr_node_labels.end())
+            return true;
+        if (!search_invocation &&
+            std::find(incoming_labels.begin(), incoming_labels.end(), _universal_label) != incoming_labels.end())
+            return true;
+    }
+    return false;
+}
+
+template <typename T, typename TagT, typename LabelT>
+void Index<T, TagT, LabelT>::get_label_bits(const std::vector<LabelT> &labels, uint64_t *bits) const
+{
+    std::fill(bits, bits + _label_bitset_words, 0);
+    for (auto label : labels)
+    {
+        if ((uint64_t)label < 64 * (uint64_t)_label_bitset_words)
+            bits[label / 64] |= 1ULL << (label % 64);
     }
-    return (common_filters.size() > 0);
+}
+
+template <typename T, typename TagT, typename LabelT> void Index<T, TagT, LabelT>::build_label_bitsets()
+{
+    _location_to_label_bits.clear();
+    _label_bitset_words = 0;
+    // dynamic indexes take new labels with each insert, so they keep to the label lists
+    if (_dynamic_index)
+        return;
+
+    uint64_t max_label = 0;
+    for (auto label : _labels)
+        max_label = (std::max)(max_label, (uint64_t)label);
+    if (max_label >= 64 * (uint64_t)defaults::MAX_LABEL_BITSET_WORDS)
+        return;
+
+    _label_bitset_words = (uint32_t)(max_label / 64 + 1);
+    _location_to_label_bits.resize(_location_to_labels.size() * _label_bitset_words);
+    for (size_t i = 0; i < _location_to_labels.size(); i++)
+        get_label_bits(_location_to_labels[i], _location_to_label_bits.data() + i * _label_bitset_words);
+    diskann::cout << "Using " << _label_bitset_words << "-word label bitsets for filter checks" << std::endl;
 }
 
 template <typename T, typename TagT, typename LabelT>
 std::pair<uint32_t, uint32_t> Index<T, TagT, LabelT>::iterate_to_fixed_point(
     InMemQueryScratch<T> *scratch, const uint32_t Lsize, const std::vector<uint32_t> &init_ids, bool use_filter,
-    const std::vector<LabelT> &filter_labels, bool search_invocation)
+    const std::vector<LabelT> &filter_labels, bool search_invocation, const uint32_t list_capacity)
 {
     std::vector<Neighbor> &expanded_nodes = scratch->pool();
     NeighborPriorityQueue &best_L_nodes = scratch->best_l_nodes();
-    best_L_nodes.reserve(Lsize);
-    tsl::robin_set<uint32_t> &inserted_into_pool_rs = scratch->inserted_into_pool_rs();
-    boost::dynamic_bitset<> &inserted_into_pool_bs = scratch->inserted_into_pool_bs();
+    // without init_ids, a walk left in scratch by an earlier call carries on with its candidates and visited set
+    const bool resume = init_ids.empty() && best_L_nodes.size() > 0;
+    const uint32_t capacity = (std::max)(Lsize, list_capacity);
+    best_L_nodes.reserve(capacity);
+    VisitedSet &inserted_into_pool = scratch->inserted_into_pool();
     std::vector<uint32_t> &id_scratch = scratch->id_scratch();
     std::vector<float> &dist_scratch = scratch->dist_scratch();
     assert(id_scratch.size() == 0);
@@ -806,39 +869,39 @@ std::pair<uint32_t, uint32_t> Index<T, TagT, LabelT>::iterate_to_fixed_point(
 
     float *pq_dists = nullptr;
 
-    _pq_data_store->preprocess_query(aligned_query, scratch);
-
-    if (expanded_nodes.size() > 0 || id_scratch.size() > 0)
+    if (!resume)
     {
-        throw ANNException("ERROR: Clear scratch space before passing.", -1, __FUNCSIG__, __FILE__, __LINE__);
-    }
+        _pq_data_store->preprocess_query(aligned_query, scratch);
 
-    // Decide whether to use bitset or robin set to mark visited nodes
-    auto total_num_points = _max_points + _num_frozen_pts;
-    bool fast_iterate = total_num_points <= MAX_POINTS_FOR_USING_BITSET;
+        if (expanded_nodes.size() > 0 || id_scratch.size() > 0)
+        {
+            throw ANNException("ERROR: Clear scratch space before passing.", -1, __FUNCSIG__, __FILE__, __LINE__);
+        }
 
-    if (fast_iterate)
-    {
-        if (inserted_into_pool_bs.size() < total_num_points)
+        // (Re)configure the visited set if the index grew, L grew or a different type was requested
+        auto total_num_points = _max_points + _num_frozen_pts;
+        if (inserted_into_pool.num_points() < total_num_points ||
+            inserted_into_pool.expected_visits() < 20 * capacity ||
+            inserted_into_pool.requested_type() != _visited_set_type)
         {
-            // hopefully using 2X will reduce the number of allocations.
-            auto resize_size =
-                2 * total_num_points > MAX_POINTS_FOR_USING_BITSET ? MAX_POINTS_FOR_USING_BITSET : 2 * total_num_points;
-            inserted_into_pool_bs.resize(resize_size);
+            inserted_into_pool.configure(_visited_set_type, total_num_points, 20 * (size_t)capacity);
         }
     }
 
-    // Lambda to determine if a node has been visited
-    auto is_not_visited = [this, fast_iterate, &inserted_into_pool_bs, &inserted_into_pool_rs](const uint32_t id) {
-        return fast_iterate ? inserted_into_pool_bs[id] == 0
-                            : inserted_into_pool_rs.find(id) == inserted_into_pool_rs.end();
-    };
-
     // Lambda to batch compute query<-> node distances in PQ space
     auto compute_dists = [this, scratch, pq_dists](const std::vector<uint32_t> &ids, std::vector<float> &dists_out) {
         _pq_data_store->get_distance(scratch->aligned_query(), ids, dists_out, scratch);
     };
 
+    // the filter as label bits, once per walk rather than once per neighbour
+    uint64_t filter_bits[defaults::MAX_LABEL_BITSET_WORDS];
+    const uint64_t *filter_bits_ptr = nullptr;
+    if (use_filter && _label_bitset_words > 0)
+    {
+        get_label_bits(filter_labels, filter_bits);
+        filter_bits_ptr = filter_bits;
+    }
+
     // Initialize the candidate pool with starting points
     for (auto id : init_ids)
     {
@@ -851,21 +914,12 @@ std::pair<uint32_t, uint32_t> Index<T, TagT, LabelT>::iterate_to_fixed_point(
 
         if (use_filter)
         {
-            if (!detect_common_filters(id, search_invocation, filter_labels))
+            if (!detect_common_filters(id, search_invocation, filter_labels, filter_bits_ptr))
                 continue;
         }
 
-        if (is_not_visited(id))
+        if (inserted_into_pool.insert(id))
         {
-            if (fast_iterate)
-            {
-                inserted_into_pool_bs[id] = 1;
-            }
-            else
-            {
-                inserted_into_pool_rs.insert(id);
-            }
-
             float distance;
             uint32_t ids[] = {id};
             float distances[] = {std::numeric_limits<float>::max()};
@@ -880,7 +934,7 @@ std::pair<uint32_t, uint32_t> Index<T, TagT, LabelT>::iterate_to_fixed_point(
     uint32_t hops = 0;
     uint32_t cmps = 0;
 
-    while (best_L_nodes.has_unexpanded_node())
+    while (best_L_nodes.has_unexpanded_node(Lsize))
     {
         auto nbr = best_L_nodes.closest_unexpanded();
         auto n = nbr.id;
@@ -903,63 +957,45 @@ std::pair<uint32_t, uint32_t> Index<T, TagT, LabelT>::iterate_to_fixed_point(
             }
         }
 
-        // Find which of the nodes in des have not been visited before
+        // Find which of the nodes in des have not been visited before, marking them visited
         id_scratch.clear();
         dist_scratch.clear();
-        if (_dynamic_index)
-        {
-            LockGuard guard(_locks[n]);
-            for (auto id : _graph_store->get_neighbours(n))
-            {
-                assert(id < _max_points + _num_frozen_pts);
+        auto queue_unvisited = [&](const location_t id) {
+            assert(id < _max_points + _num_frozen_pts);
 
-                if (use_filter)
-                {
-                    // NOTE: NEED TO CHECK IF THIS CORRECT WITH NEW LOCKS.
-                    if (!detect_common_filters(id, search_invocation, filter_labels))
-                        continue;
-                }
+            if (use_filter)
+            {
+                // NOTE: NEED TO CHECK IF THIS CORRECT WITH NEW LOCKS.
+                if (!detect_common_filters(id, search_invocation, filter_labels, filter_bits_ptr))
+                    return;
+            }
 
-                if (is_not_visited(id))
-                {
-                    id_scratch.push_back(id);
-                }
+            if (inserted_into_pool.insert(id))
+            {
+                id_scratch.push_back(id);
             }
+        };
+        if (_graph_store->lock_free_reads())
+        {
+            std::vector<location_t> &nbrs = scratch->nbr_copy();
+            _graph_store->copy_neighbours(n, nbrs);
+            for (auto id : nbrs)
+                queue_unvisited(id);
+        }
+        else if (_dynamic_index)
+        {
+            LockGuard guard(_locks[n]);
+            for (auto id : _graph_store->get_neighbours(n))
+                queue_unvisited(id);
         }
         else
         {
             _locks[n].lock();
-            auto nbrs = _graph_store->get_neighbours(n);
+            auto nbrs_view = _graph_store->get_neighbours(n);
+            std::vector<location_t> nbrs(nbrs_view.begin(), nbrs_view.end());
             _locks[n].unlock();
             for (auto id : nbrs)
-            {
-                assert(id < _max_points + _num_frozen_pts);
-
-                if (use_filter)
-                {
-                    // NOTE: NEED TO CHECK IF THIS CORRECT WITH NEW LOCKS.
-                    if (!detect_common_filters(id, search_invocation, filter_labels))
-                        continue;
-                }
-
-                if (is_not_visited(id))
-                {
-                    id_scratch.push_back(id);
-                }
-            }
-        }
-
-        // Mark nodes visited
-        for (auto id : id_scratch)
-        {
-            if (fast_iterate)
-            {
-                inserted_into_pool_bs[id] = 1;
-            }
-            else
-            {
-                inserted_into_pool_rs.insert(id);
-            }
+                queue_unvisited(id);
         }
 
         assert(dist_scratch.capacity() >= id_scratch.size());
@@ -1113,15 +1149,26 @@ void Index<T, TagT, LabelT>::occlude_list(const uint32_t location, std::vector<N
                     uint32_t b = iter2->id;
                     if (_location_to_labels.size() < b || _location_to_labels.size() < a)
                         continue;
-                    for (auto &x : _location_to_labels[b])
+                    if (_label_bitset_words > 0)
+                    {
+                        // b's labels must be a subset of a's
+                        const uint64_t *a_bits = _location_to_label_bits.data() + (size_t)a * _label_bitset_words;
+                        const uint64_t *b_bits = _location_to_label_bits.data() + (size_t)b * _label_bitset_words;
+                        for (uint32_t w = 0; w < _label_bitset_words; w++)
+                            prune_allowed = prune_allowed && (b_bits[w] & ~a_bits[w]) == 0;
+                    }
+                    else
                     {
-                        if (std::find(_location_to_labels[a].begin(), _location_to_labels[a].end(), x) ==
-                            _location_to_labels[a].end())
+                        for (auto &x : _location_to_labels[b])
                         {
-                            prune_allowed = false;
+                            if (std::find(_location_to_labels[a].begin(), _location_to_labels[a].end(), x) ==
+                                _location_to_labels[a].end())
+                            {
+                                prune_allowed = false;
+                            }
+                            if (!prune_allowed)
+                                break;
                         }
-                        if (!prune_allowed)
-                            break;
                     }
                 }
                 if (!prune_allowed)
@@ -1214,19 +1261,21 @@ void Index<T, TagT, LabelT>::inter_insert(uint32_t n, std::vector<uint32_t> &pru
         bool prune_needed = false;
         {
             LockGuard guard(_locks[des]);
-            auto &des_pool = _graph_store->get_neighbours(des);
+            auto des_pool = _graph_store->get_neighbours(des);
             if (std::find(des_pool.begin(), des_pool.end(), n) == des_pool.end())
             {
                 if (des_pool.size() < (uint64_t)(defaults::GRAPH_SLACK_FACTOR * range))
                 {
                     // des_pool.emplace_back(n);
+                    if (_in_neighbors != nullptr)
+                        _in_neighbors->add_edge(des, n);
                     _graph_store->add_neighbour(des, n);
                     prune_needed = false;
                 }
                 else
                 {
                     copy_of_neighbors.reserve(des_pool.size() + 1);
-                    copy_of_neighbors = des_pool;
+                    copy_of_neighbors.assign(des_pool.begin(), des_pool.end());
                     copy_of_neighbors.push_back(n);
                     prune_needed = true;
                 }
@@ -1256,7 +1305,7 @@ void Index<T, TagT, LabelT>::inter_insert(uint32_t n, std::vector<uint32_t> &pru
             {
                 LockGuard guard(_locks[des]);
 
-                _graph_store->set_neighbours(des, new_out_neighbors);
+                update_neighbours(des, new_out_neighbors);
             }
         }
     }
@@ -1413,12 +1462,13 @@ void Index<T, TagT, LabelT>::prune_all_neighbors(const uint32_t max_degree, cons
     }
 
     diskann::cout << "Prune time : " << timer.elapsed() / 1000 << "ms" << std::endl;
+    rebuild_in_neighbors();
     size_t max = 0, min = 1 << 30, total = 0, cnt = 0;
     for (size_t i = 0; i < _max_points + _num_frozen_pts; i++)
     {
         if (i < _nd || i >= _max_points)
         {
-            const std::vector<uint32_t> &pool = _graph_store->get_neighbours((location_t)i);
+            auto pool = _graph_store->get_neighbours((location_t)i);
             max = (std::max)(max, pool.size());
             min = (std::min)(min, pool.size());
             total += pool.size();
@@ -1542,12 +1592,15 @@ void Index<T, TagT, LabelT>::build_with_data_populated(const std::vector<TagT> &
     }
 
     generate_frozen_point();
+    // link() rewrites every list, so reverse the finished graph instead of tracking each update
+    _in_neighbors.reset();
     link();
+    rebuild_in_neighbors();
 
     size_t max = 0, min = SIZE_MAX, total = 0, cnt = 0;
     for (size_t i = 0; i < _nd; i++)
     {
-        auto &pool = _graph_store->get_neighbours((location_t)i);
+        auto pool = _graph_store->get_neighbours((location_t)i);
         max = std::max(max, pool.size());
         min = std::min(min, pool.size());
         total += pool.size();
@@ -1840,6 +1893,7 @@ void Index<T, TagT, LabelT>::parse_label_file(const std::string &label_file, siz
     }
     num_points = (size_t)line_cnt;
     diskann::cout << "Identified " << _labels.size() << " distinct label(s)" << std::endl;
+    build_label_bitsets();
 }
 
 template <typename T, typename TagT, typename LabelT>
@@ -2018,6 +2072,372 @@ std::pair<uint32_t, uint32_t> Index<T, TagT, LabelT>::search(const T *query, con
     return retval;
 }
 
+template <typename T, typename TagT, typename LabelT>
+template <typename IdType>
+size_t Index<T, TagT, LabelT>::range_search(const T *query, const double range, const uint32_t min_l_search,
+                                            const uint32_t max_l_search, std::vector<IdType> &indices,
+                                            std::vector<float> &distances)
+{
+    if (min_l_search == 0 || min_l_search > max_l_search)
+    {
+        throw ANNException("Range search needs 0 < min_l_search <= max_l_search", -1, __FUNCSIG__, __FILE__,
+                           __LINE__);
+    }
+
+    ScratchStoreManager<InMemQueryScratch<T>> manager(_query_scratch);
+    auto scratch = manager.scratch_space();
+    if (max_l_search > scratch->get_L())
+        scratch->resize_for_new_L(max_l_search);
+
+    const std::vector<LabelT> unused_filter_label;
+    const std::vector<uint32_t> init_ids = get_init_ids();
+    const std::vector<uint32_t> resume_ids;
+
+    std::shared_lock<std::shared_timed_mutex> lock(_update_lock);
+
+    _data_store->preprocess_query(query, scratch);
+
+    // Each round is a search with twice the list of the last, but it only expands what the last one did not reach,
+    // as the candidates beyond the old list are still held.
+    NeighborPriorityQueue &best_L_nodes = scratch->best_l_nodes();
+    uint32_t L = min_l_search;
+    iterate_to_fixed_point(scratch, L, init_ids, false, unused_filter_label, true, max_l_search);
+    while (L <= max_l_search / 2)
+    {
+        size_t in_range = 0;
+        for (size_t i = 0; i < (std::min)(best_L_nodes.size(), (size_t)L); i++)
+        {
+            if (best_L_nodes[i].distance <= (float)range)
+                in_range++;
+        }
+        if (in_range < L / 2)
+            break;
+        L *= 2;
+        iterate_to_fixed_point(scratch, L, resume_ids, false, unused_filter_label, true, max_l_search);
+    }
+
+    indices.clear();
+    distances.clear();
+    for (size_t i = 0; i < best_L_nodes.size() && best_L_nodes[i].distance <= (float)range; i++)
+    {
+        if (best_L_nodes[i].id < _max_points)
+        {
+            indices.push_back((IdType)best_L_nodes[i].id);
+            distances.push_back(best_L_nodes[i].distance);
+        }
+    }
+    return indices.size();
+}
+
+template <typename T, typename TagT, typename LabelT>
+void Index<T, TagT, LabelT>::_batch_search(const DataType &queries, const size_t num_queries,
+                                           const size_t query_stride, const size_t K, const uint32_t L,
+                                           std::any &indices, float *distances, uint32_t *cmps)
+{
+    try
+    {
+        auto typed_queries = std::any_cast<const T *>(queries);
+        if (typeid(uint32_t *) == indices.type())
+        {
+            auto u32_ptr = std::any_cast<uint32_t *>(indices);
+            this->batch_search(typed_queries, num_queries, query_stride, K, L, u32_ptr, distances, cmps);
+        }
+        else if (typeid(uint64_t *) == indices.type())
+        {
+            auto u64_ptr = std::any_cast<uint64_t *>(indices);
+            this->batch_search(typed_queries, num_queries, query_stride, K, L, u64_ptr, distances, cmps);
+        }
+        else
+        {
+            throw ANNException("Error: indices type can only be uint64_t or uint32_t.", -1);
+        }
+    }
+    catch (const std::bad_any_cast &e)
+    {
+        throw ANNException("Error: bad any cast while performing _batch_search() " + std::string(e.what()), -1);
+    }
+    catch (const std::exception &e)
+    {
+        throw ANNException("Error: " + std::string(e.what()), -1);
+    }
+}
+
+template <typename T, typename TagT, typename LabelT>
+template <typename IdType>
+void Index<T, TagT, LabelT>::batch_search(const T *queries, const size_t num_queries, const size_t query_stride,
+                                          const size_t K, const uint32_t L, IdType *indices, float *distances,
+                                          uint32_t *cmps, const uint32_t batch_size)
+{
+    if (K > (uint64_t)L)
+    {
+        throw ANNException("Set L to a value of at least K", -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    if (batch_size == 0)
+    {
+        throw ANNException("batch_size must be at least 1", -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    if (_pq_dist)
+    {
+        // PQ distances come from a per-query lookup table, so there is no base vector to share between queries
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int64_t i = 0; i < (int64_t)num_queries; i++)
+        {
+            auto retval = search(queries + i * query_stride, K, L, indices + i * K,
+                                 distances == nullptr ? nullptr : distances + i * K);
+            if (cmps != nullptr)
+                cmps[i] = retval.second;
+        }
+        return;
+    }
+
+    const std::vector<uint32_t> init_ids = get_init_ids();
+
+    std::shared_lock<std::shared_timed_mutex> lock(_update_lock);
+
+    const size_t dim = _data_store->get_dims();
+    const size_t aligned_dim = _data_store->get_aligned_dim();
+    const size_t total_num_points = _max_points + _num_frozen_pts;
+    const int64_t num_batches = (int64_t)DIV_ROUND_UP(num_queries, (size_t)batch_size);
+    enum : uint8_t
+    {
+        REQUEST_SINGLE,
+        REQUEST_GROUP_HEAD,
+        REQUEST_GROUP_MEMBER
+    };
+
+#pragma omp parallel
+    {
+        // per-thread state for one batch of queries
+        std::vector<T *> batch_queries(batch_size, nullptr);
+        std::vector<NeighborPriorityQueue> best_L_nodes(batch_size);
+        std::vector<uint32_t> batch_cmps(batch_size);
+        for (uint32_t b = 0; b < batch_size; b++)
+        {
+            alloc_aligned((void **)&batch_queries[b], aligned_dim * sizeof(T), 8 * sizeof(T));
+            memset(batch_queries[b], 0, aligned_dim * sizeof(T));
+            best_L_nodes[b].reserve(L);
+        }
+
+        // Unvisited neighbours found by one round of expansions, grouped by query: query b's requests are
+        // [request_begin[b], request_begin[b + 1]). Requests for the same id from several queries are chained
+        // through request_next, and the shared vector is compared against all of them in one pass.
+        std::vector<location_t> request_ids;
+        std::vector<uint32_t> request_owners;
+        std::vector<float> request_dists;
+        std::vector<uint32_t> request_next;
+        std::vector<uint8_t> request_state; // REQUEST_SINGLE, REQUEST_GROUP_HEAD or REQUEST_GROUP_MEMBER
+        std::vector<size_t> request_begin(batch_size + 1);
+        std::vector<const T *> group_queries(batch_size);
+        std::vector<uint32_t> group_requests(batch_size);
+        std::vector<float> group_dists(batch_size);
+        std::vector<location_t> single_ids;
+        std::vector<float> single_dists;
+        std::vector<location_t> nbrs;
+
+        // open-addressed table from id to the first and last request for it in the current round; slots are
+        // live only when their stamp matches the round, so the table is never cleared between rounds
+        std::vector<location_t> table_ids;
+        std::vector<uint32_t> table_first, table_last, table_stamp;
+        uint32_t table_shift = 32, round = 0;
+
+#pragma omp for schedule(dynamic, 1)
+        for (int64_t batch = 0; batch < num_batches; batch++)
+        {
+            const size_t first = (size_t)batch * batch_size;
+            const uint32_t n = (uint32_t)(std::min)((size_t)batch_size, num_queries - first);
+
+            // the visited sets live in the query scratch so that they are allocated once, not on every call; the
+            // scratch is taken per batch so a thread waiting for one never holds up the loop's closing barrier
+            ScratchStoreManager<InMemQueryScratch<T>> manager(_query_scratch);
+            BatchVisitedSet &visited = manager.scratch_space()->batch_visited();
+            if (visited.num_points() < total_num_points || visited.expected_visits() < 20 * (size_t)L ||
+                visited.requested_type() != _visited_set_type || visited.batch_size() != batch_size)
+            {
+                visited.configure(_visited_set_type, total_num_points, 20 * (size_t)L, batch_size);
+            }
+            else
+            {
+                visited.clear();
+            }
+
+            for (uint32_t b = 0; b < n; b++)
+            {
+                memcpy(batch_queries[b], queries + (first + b) * query_stride, dim * sizeof(T));
+                best_L_nodes[b].clear();
+                batch_cmps[b] = 0;
+                for (auto id : init_ids)
+                {
+                    if (visited.insert(b, id))
+                        best_L_nodes[b].insert(Neighbor(id, _data_store->get_distance(batch_queries[b], id)));
+                }
+            }
+
+            bool expanded = true;
+            while (expanded)
+            {
+                // expand the closest unexpanded candidate of every query that still has one
+                expanded = false;
+                request_ids.clear();
+                request_owners.clear();
+                for (uint32_t b = 0; b < n; b++)
+                {
+                    request_begin[b] = request_ids.size();
+                    if (!best_L_nodes[b].has_unexpanded_node())
+                        continue;
+                    expanded = true;
+                    auto node = best_L_nodes[b].closest_unexpanded().id;
+                    if (_graph_store->lock_free_reads())
+                    {
+                        _graph_store->copy_neighbours(node, nbrs);
+                    }
+                    else
+                    {
+                        LockGuard guard(_locks[node]);
+                        auto nbrs_view = _graph_store->get_neighbours(node);
+                        nbrs.assign(nbrs_view.begin(), nbrs_view.end());
+                    }
+                    for (auto id : nbrs)
+                    {
+                        assert(id < total_num_points);
+                        if (visited.insert(b, id))
+                        {
+                            request_ids.push_back(id);
+                            request_owners.push_back(b);
+                        }
+                    }
+                }
+                request_begin[n] = request_ids.size();
+                const size_t num_requests = request_ids.size();
+                if (num_requests == 0)
+                    continue;
+
+                // find the ids requested by more than one query
+                if (((size_t)1 << (32 - table_shift)) < 2 * num_requests)
+                {
+                    while (((size_t)1 << (32 - table_shift)) < 2 * num_requests)
+                        table_shift--;
+                    const size_t table_size = (size_t)1 << (32 - table_shift);
+                    table_ids.resize(table_size);
+                    table_first.resize(table_size);
+                    table_last.resize(table_size);
+                    table_stamp.assign(table_size, 0);
+                    round = 0;
+                }
+                if (++round == 0)
+                {
+                    std::fill(table_stamp.begin(), table_stamp.end(), 0);
+                    round = 1;
+                }
+                const uint32_t table_mask = (uint32_t)table_ids.size() - 1;
+                request_dists.resize(num_requests);
+                request_next.assign(num_requests, std::numeric_limits<uint32_t>::max());
+                request_state.assign(num_requests, REQUEST_SINGLE);
+                bool any_shared = false;
+                for (uint32_t r = 0; r < (uint32_t)num_requests; r++)
+                {
+                    const location_t id = request_ids[r];
+                    uint32_t slot = (uint32_t)(id * 2654435769u) >> table_shift;
+                    while (table_stamp[slot] == round && table_ids[slot] != id)
+                        slot = (slot + 1) & table_mask;
+                    if (table_stamp[slot] != round)
+                    {
+                        table_stamp[slot] = round;
+                        table_ids[slot] = id;
+                        table_first[slot] = r;
+                        table_last[slot] = r;
+                    }
+                    else
+                    {
+                        request_state[table_first[slot]] = REQUEST_GROUP_HEAD;
+                        request_state[r] = REQUEST_GROUP_MEMBER;
+                        request_next[table_last[slot]] = r;
+                        table_last[slot] = r;
+                        any_shared = true;
+                    }
+                }
+
+                // shared ids: read each vector once and compare it against every query that reached it
+                for (uint32_t r = 0; any_shared && r < (uint32_t)num_requests; r++)
+                {
+                    if (request_state[r] != REQUEST_GROUP_HEAD)
+                        continue;
+                    uint32_t m = 0;
+                    for (uint32_t g = r; g != std::numeric_limits<uint32_t>::max(); g = request_next[g], m++)
+                    {
+                        group_requests[m] = g;
+                        group_queries[m] = batch_queries[request_owners[g]];
+                    }
+                    _data_store->get_distance_batch(group_queries.data(), m, request_ids[r], group_dists.data());
+                    for (uint32_t j = 0; j < m; j++)
+                        request_dists[group_requests[j]] = group_dists[j];
+                }
+
+                // the rest are computed per query as in search()
+                for (uint32_t b = 0; b < n; b++)
+                {
+                    single_ids.clear();
+                    for (size_t r = request_begin[b]; r < request_begin[b + 1]; r++)
+                    {
+                        if (request_state[r] == REQUEST_SINGLE)
+                            single_ids.push_back(request_ids[r]);
+                    }
+                    single_dists.resize(single_ids.size());
+                    if (!single_ids.empty())
+                        _data_store->get_distance(batch_queries[b], single_ids.data(), (uint32_t)single_ids.size(),
+                                                  single_dists.data(), nullptr);
+
+                    size_t next_single = 0;
+                    for (size_t r = request_begin[b]; r < request_begin[b + 1]; r++)
+                    {
+                        const float dist =
+                            request_state[r] == REQUEST_SINGLE ? single_dists[next_single++] : request_dists[r];
+                        best_L_nodes[b].insert(Neighbor(request_ids[r], dist));
+                    }
+                    batch_cmps[b] += (uint32_t)(request_begin[b + 1] - request_begin[b]);
+                }
+            }
+
+            for (uint32_t b = 0; b < n; b++)
+            {
+                const size_t q = first + b;
+                IdType *q_indices = indices + q * K;
+                float *q_distances = distances == nullptr ? nullptr : distances + q * K;
+                size_t pos = 0;
+                for (size_t i = 0; i < best_L_nodes[b].size() && pos < K; ++i)
+                {
+                    if (best_L_nodes[b][i].id < _max_points)
+                    {
+                        q_indices[pos] = (IdType)best_L_nodes[b][i].id;
+                        if (q_distances != nullptr)
+                        {
+#ifdef EXEC_ENV_OLS
+                            // DLVS expects negative distances
+                            q_distances[pos] = best_L_nodes[b][i].distance;
+#else
+                            q_distances[pos] = _dist_metric == diskann::Metric::INNER_PRODUCT
+                                                   ? -1 * best_L_nodes[b][i].distance
+                                                   : best_L_nodes[b][i].distance;
+#endif
+                        }
+                        pos++;
+                    }
+                }
+                if (pos < K)
+                {
+                    diskann::cerr << "Found pos: " << pos << "fewer than K elements " << K << " for query " << q
+                                  << std::endl;
+                }
+                if (cmps != nullptr)
+                    cmps[q] = batch_cmps[b];
+            }
+        }
+
+        for (uint32_t b = 0; b < batch_size; b++)
+            aligned_free(batch_queries[b]);
+    }
+}
+
 template <typename T, typename TagT, typename LabelT>
 std::pair<uint32_t, uint32_t> Index<T, TagT, LabelT>::_search_with_filters(const DataType &query,
                                                                            const std::string &raw_label, const size_t K,
@@ -2306,13 +2726,20 @@ inline void Index<T, TagT, LabelT>::process_delete(const tsl::robin_set<uint32_t
     // If this condition were not true, deadlock could result
     assert(old_delete_set.find((uint32_t)loc) == old_delete_set.end());
 
+    const bool lock_free_reads = _graph_store->lock_free_reads();
     std::vector<uint32_t> adj_list;
+    if (lock_free_reads)
+    {
+        _graph_store->copy_neighbours((location_t)loc, adj_list);
+    }
+    else
     {
         // Acquire and release lock[loc] before acquiring locks for neighbors
         std::unique_lock<non_recursive_mutex> adj_list_lock;
         if (_conc_consolidate)
             adj_list_lock = std::unique_lock<non_recursive_mutex>(_locks[loc]);
-        adj_list = _graph_store->get_neighbours((location_t)loc);
+        auto nbrs = _graph_store->get_neighbours((location_t)loc);
+        adj_list.assign(nbrs.begin(), nbrs.end());
     }
 
     bool modify = false;
@@ -2326,12 +2753,23 @@ inline void Index<T, TagT, LabelT>::process_delete(const tsl::robin_set<uint32_t
         {
             modify = true;
 
-            std::unique_lock<non_recursive_mutex> ngh_lock;
-            if (_conc_consolidate)
-                ngh_lock = std::unique_lock<non_recursive_mutex>(_locks[ngh]);
-            for (auto j : _graph_store->get_neighbours((location_t)ngh))
-                if (j != loc && old_delete_set.find(j) == old_delete_set.end())
-                    expanded_nodes_set.insert(j);
+            if (lock_free_reads)
+            {
+                std::vector<uint32_t> &ngh_list = scratch->nbr_copy();
+                _graph_store->copy_neighbours((location_t)ngh, ngh_list);
+                for (auto j : ngh_list)
+                    if (j != loc && old_delete_set.find(j) == old_delete_set.end())
+                        expanded_nodes_set.insert(j);
+            }
+            else
+            {
+                std::unique_lock<non_recursive_mutex> ngh_lock;
+                if (_conc_consolidate)
+                    ngh_lock = std::unique_lock<non_recursive_mutex>(_locks[ngh]);
+                for (auto j : _graph_store->get_neighbours((location_t)ngh))
+                    if (j != loc && old_delete_set.find(j) == old_delete_set.end())
+                        expanded_nodes_set.insert(j);
+            }
         }
     }
 
@@ -2339,10 +2777,10 @@ inline void Index<T, TagT, LabelT>::process_delete(const tsl::robin_set<uint32_t
     {
         if (expanded_nodes_set.size() <= range)
         {
+            std::vector<uint32_t> &new_out_neighbors = scratch->occlude_list_output();
+            new_out_neighbors.assign(expanded_nodes_set.begin(), expanded_nodes_set.end());
             std::unique_lock<non_recursive_mutex> adj_list_lock(_locks[loc]);
-            _graph_store->clear_neighbours((location_t)loc);
-            for (auto &ngh : expanded_nodes_set)
-                _graph_store->add_neighbour((location_t)loc, ngh);
+            update_neighbours((uint32_t)loc, new_out_neighbors);
         }
         else
         {
@@ -2357,11 +2795,34 @@ inline void Index<T, TagT, LabelT>::process_delete(const tsl::robin_set<uint32_t
             occlude_list((uint32_t)loc, expanded_nghrs_vec, alpha, range, maxc, occlude_list_output, scratch,
                          &old_delete_set);
             std::unique_lock<non_recursive_mutex> adj_list_lock(_locks[loc]);
-            _graph_store->set_neighbours((location_t)loc, occlude_list_output);
+            update_neighbours((uint32_t)loc, occlude_list_output);
         }
     }
 }
 
+template <typename T, typename TagT, typename LabelT>
+void Index<T, TagT, LabelT>::update_neighbours(const uint32_t location, std::vector<uint32_t> &neighbours)
+{
+    if (_in_neighbors != nullptr)
+        _in_neighbors->update(location, _graph_store->get_neighbours((location_t)location), neighbours);
+    _graph_store->set_neighbours((location_t)location, neighbours);
+}
+
+template <typename T, typename TagT, typename LabelT> void Index<T, TagT, LabelT>::rebuild_in_neighbors()
+{
+    if (!_track_in_neighbors)
+        return;
+
+    diskann::Timer timer;
+    const size_t total_internal_points = _max_points + _num_frozen_pts;
+    if (_in_neighbors == nullptr)
+        _in_neighbors = std::make_unique<InNeighborIndex>(total_internal_points);
+    _in_neighbors->build(*_graph_store, total_internal_points,
+                         _indexingThreads == 0 ? omp_get_num_procs() : _indexingThreads);
+    diskann::cout << "In-neighbor index rebuilt in " << timer.elapsed_seconds() << "s, using "
+                  << _in_neighbors->memory_in_bytes() / (1024 * 1024) << "MB" << std::endl;
+}
+
 // Returns number of live points left after consolidation
 template <typename T, typename TagT, typename LabelT>
 consolidation_report Index<T, TagT, LabelT>::consolidate_deletes(const IndexWriteParameters &params)
@@ -2426,10 +2887,38 @@ consolidation_report Index<T, TagT, LabelT>::consolidate_deletes(const IndexWrit
 
     uint32_t num_calls_to_process_delete = 0;
     diskann::Timer timer;
-#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 8192) reduction(+ : num_calls_to_process_delete)
-    for (int64_t loc = 0; loc < (int64_t)_max_points; loc++)
+    if (_in_neighbors != nullptr)
     {
-        if (old_delete_set->find((uint32_t)loc) == old_delete_set->end() && !_empty_slots.is_in_set((uint32_t)loc))
+        // process_delete only changes nodes with a deleted out-neighbor, so visiting those is enough
+        std::vector<uint32_t> affected = _in_neighbors->get_in_neighbors(*old_delete_set);
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64) reduction(+ : num_calls_to_process_delete)
+        for (int64_t i = 0; i < (int64_t)affected.size(); i++)
+        {
+            const uint32_t loc = affected[i];
+            if (old_delete_set->find(loc) == old_delete_set->end() &&
+                (loc >= _max_points || !_empty_slots.is_in_set(loc)))
+            {
+                ScratchStoreManager<InMemQueryScratch<T>> manager(_query_scratch);
+                auto scratch = manager.scratch_space();
+                process_delete(*old_delete_set, loc, range, maxc, alpha, scratch);
+                num_calls_to_process_delete += 1;
+            }
+        }
+    }
+    else
+    {
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 8192) reduction(+ : num_calls_to_process_delete)
+        for (int64_t loc = 0; loc < (int64_t)_max_points; loc++)
+        {
+            if (old_delete_set->find((uint32_t)loc) == old_delete_set->end() && !_empty_slots.is_in_set((uint32_t)loc))
+            {
+                ScratchStoreManager<InMemQueryScratch<T>> manager(_query_scratch);
+                auto scratch = manager.scratch_space();
+                process_delete(*old_delete_set, loc, range, maxc, alpha, scratch);
+                num_calls_to_process_delete += 1;
+            }
+        }
+        for (int64_t loc = _max_points; loc < (int64_t)(_max_points + _num_frozen_pts); loc++)
         {
             ScratchStoreManager<InMemQueryScratch<T>> manager(_query_scratch);
             auto scratch = manager.scratch_space();
@@ -2437,13 +2926,6 @@ consolidation_report Index<T, TagT, LabelT>::consolidate_deletes(const IndexWrit
             num_calls_to_process_delete += 1;
         }
     }
-    for (int64_t loc = _max_points; loc < (int64_t)(_max_points + _num_frozen_pts); loc++)
-    {
-        ScratchStoreManager<InMemQueryScratch<T>> manager(_query_scratch);
-        auto scratch = manager.scratch_space();
-        process_delete(*old_delete_set, loc, range, maxc, alpha, scratch);
-        num_calls_to_process_delete += 1;
-    }
 
     std::unique_lock<std::shared_timed_mutex> tl(_tag_lock);
     size_t ret_nd = release_locations(*old_delete_set);
@@ -2453,6 +2935,7 @@ consolidation_report Index<T, TagT, LabelT>::consolidate_deletes(const IndexWrit
     std::shared_lock<std::shared_timed_mutex> dl(_delete_lock);
     size_t delete_set_size = _delete_set->size();
     size_t old_delete_set_size = old_delete_set->size();
+    size_t in_neighbor_index_bytes = _in_neighbors != nullptr ? _in_neighbors->memory_in_bytes() : 0;
 
     if (!_conc_consolidate)
     {
@@ -2463,7 +2946,212 @@ consolidation_report Index<T, TagT, LabelT>::consolidate_deletes(const IndexWrit
     diskann::cout << " done in " << duration << " seconds." << std::endl;
     return consolidation_report(diskann::consolidation_report::status_code::SUCCESS, ret_nd, max_points,
                                 empty_slots_size, old_delete_set_size, delete_set_size, num_calls_to_process_delete,
-                                duration);
+                                duration, in_neighbor_index_bytes);
+}
+
+template <typename T, typename TagT, typename LabelT>
+void Index<T, TagT, LabelT>::start_background_consolidation(const IndexWriteParameters &parameters,
+                                                            const BackgroundConsolidationParams &background_params)
+{
+    if (!_enable_tags)
+        throw diskann::ANNException("Point tag array not instantiated", -1, __FUNCSIG__, __FILE__, __LINE__);
+    if (!_conc_consolidate)
+        throw diskann::ANNException("Background consolidation needs an index built with concurrent consolidation", -1,
+                                    __FUNCSIG__, __FILE__, __LINE__);
+    bool running;
+    {
+        std::lock_guard<std::mutex> guard(_consolidation_mutex);
+        running = _consolidation_progress._running;
+    }
+    if (running)
+        throw diskann::ANNException("Background consolidation is already running", -1, __FUNCSIG__, __FILE__,
+                                    __LINE__);
+    // a service that stopped on an error has exited but is still joinable
+    if (_consolidation_thread.joinable())
+        _consolidation_thread.join();
+
+    {
+        std::lock_guard<std::mutex> guard(_consolidation_mutex);
+        _consolidation_progress = consolidation_progress();
+        _consolidation_progress._running = true;
+    }
+    _stop_consolidation = false;
+
+    _consolidation_thread = std::thread([this, parameters, background_params]() {
+        while (!_stop_consolidation)
+        {
+            size_t released = 0;
+            try
+            {
+                released = consolidate_delete_batch(parameters, background_params);
+            }
+            catch (const std::exception &e)
+            {
+                diskann::cerr << "Background consolidation stopped: " << e.what() << std::endl;
+                std::lock_guard<std::mutex> guard(_consolidation_mutex);
+                _consolidation_progress._error = e.what();
+                break;
+            }
+
+            if (released == 0)
+            {
+                std::unique_lock<std::mutex> lock(_consolidation_mutex);
+                _consolidation_cv.wait_for(lock, std::chrono::milliseconds(background_params.idle_poll_ms),
+                                           [this]() { return _stop_consolidation.load(); });
+            }
+        }
+        std::lock_guard<std::mutex> guard(_consolidation_mutex);
+        _consolidation_progress._running = false;
+        _consolidation_progress._batch_deletes = 0;
+        _consolidation_progress._batch_nodes_done = 0;
+        _consolidation_progress._batch_nodes_total = 0;
+    });
+}
+
+template <typename T, typename TagT, typename LabelT> void Index<T, TagT, LabelT>::stop_background_consolidation()
+{
+    if (!_consolidation_thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> guard(_consolidation_mutex);
+        _stop_consolidation = true;
+    }
+    _consolidation_cv.notify_all();
+    _consolidation_thread.join();
+}
+
+template <typename T, typename TagT, typename LabelT>
+consolidation_progress Index<T, TagT, LabelT>::get_consolidation_progress()
+{
+    size_t pending_deletes;
+    {
+        std::shared_lock<std::shared_timed_mutex> dl(_delete_lock);
+        pending_deletes = _delete_set->size();
+    }
+    std::lock_guard<std::mutex> guard(_consolidation_mutex);
+    consolidation_progress progress = _consolidation_progress;
+    progress._pending_deletes = pending_deletes;
+    return progress;
+}
+
+template <typename T, typename TagT, typename LabelT>
+size_t Index<T, TagT, LabelT>::consolidate_delete_batch(const IndexWriteParameters &parameters,
+                                                        const BackgroundConsolidationParams &background_params)
+{
+    // Shared _update_lock for the whole batch keeps save, load and resize out until its slots are released.
+    std::shared_lock<std::shared_timed_mutex> ul(_update_lock);
+    std::unique_lock<std::shared_timed_mutex> cl(_consolidate_lock, std::defer_lock);
+    if (!cl.try_lock())
+        return 0; // a foreground consolidate_deletes or compaction is running
+
+    // The batch stays in _delete_set until its slots are released, so counts seen by other callers stay consistent
+    // and a stopped batch is simply picked up again.
+    tsl::robin_set<uint32_t> batch;
+    {
+        std::shared_lock<std::shared_timed_mutex> dl(_delete_lock);
+        const size_t max_batch =
+            _in_neighbors != nullptr ? (std::max)(background_params.deletes_per_batch, 1u) : _delete_set->size();
+        batch.reserve((std::min)(max_batch, _delete_set->size()));
+        for (auto loc : *_delete_set)
+        {
+            if (batch.size() >= max_batch)
+                break;
+            batch.insert(loc);
+        }
+    }
+    if (batch.empty())
+        return 0;
+    if (batch.find(_start) != batch.end())
+        throw diskann::ANNException("ERROR: start node has been deleted", -1, __FUNCSIG__, __FILE__, __LINE__);
+
+    diskann::Timer timer;
+    const uint32_t range = parameters.max_degree;
+    const uint32_t maxc = parameters.max_occlusion_size;
+    const float alpha = parameters.alpha;
+    const uint32_t num_threads = parameters.num_threads == 0 ? omp_get_num_procs() : parameters.num_threads;
+    const size_t nodes_per_slice = (std::max)(background_params.nodes_per_slice, 1u);
+
+    // visits nodes in slices with a pause after each; false if the service was stopped part way
+    auto visit_nodes = [&](const std::vector<uint32_t> *nodes, const size_t num_nodes) {
+        {
+            std::lock_guard<std::mutex> guard(_consolidation_mutex);
+            _consolidation_progress._batch_deletes = batch.size();
+            _consolidation_progress._batch_nodes_done = 0;
+            _consolidation_progress._batch_nodes_total = num_nodes;
+        }
+        for (size_t slice_start = 0; slice_start < num_nodes; slice_start += nodes_per_slice)
+        {
+            if (_stop_consolidation)
+                return false;
+
+            const size_t slice_end = (std::min)(slice_start + nodes_per_slice, num_nodes);
+            uint32_t num_calls_to_process_delete = 0;
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64) reduction(+ : num_calls_to_process_delete)
+            for (int64_t i = (int64_t)slice_start; i < (int64_t)slice_end; i++)
+            {
+                const uint32_t loc = nodes != nullptr ? (*nodes)[i] : (uint32_t)i;
+                if (batch.find(loc) == batch.end() && (loc >= _max_points || !_empty_slots.is_in_set(loc)))
+                {
+                    ScratchStoreManager<InMemQueryScratch<T>> manager(_query_scratch);
+                    auto scratch = manager.scratch_space();
+                    process_delete(batch, loc, range, maxc, alpha, scratch);
+                    num_calls_to_process_delete += 1;
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> guard(_consolidation_mutex);
+                _consolidation_progress._batch_nodes_done = slice_end;
+                _consolidation_progress._num_calls_to_process_delete += num_calls_to_process_delete;
+            }
+            if (background_params.slice_pause_ms > 0 && slice_end < num_nodes)
+                std::this_thread::sleep_for(std::chrono::milliseconds(background_params.slice_pause_ms));
+        }
+        return true;
+    };
+
+    if (_in_neighbors != nullptr)
+    {
+        std::vector<uint32_t> affected = _in_neighbors->get_in_neighbors(batch);
+        if (!visit_nodes(&affected, affected.size()))
+            return 0;
+
+        // inter_insert prunes outside the node lock, so a concurrent insert can write back an edge into the batch
+        // after its source was visited; the in-neighbor index sees that edge, so sweep the few stragglers up
+        for (uint32_t pass = 0; pass < 3; pass++)
+        {
+            std::vector<uint32_t> stragglers;
+            for (auto loc : _in_neighbors->get_in_neighbors(batch))
+                if (batch.find(loc) == batch.end())
+                    stragglers.push_back(loc);
+            if (stragglers.empty())
+                break;
+            if (!visit_nodes(&stragglers, stragglers.size()))
+                return 0;
+        }
+    }
+    else if (!visit_nodes(nullptr, _max_points + _num_frozen_pts))
+    {
+        return 0;
+    }
+
+    // nothing points at the batch any more; the exclusive locks are held only for the release itself
+    {
+        std::unique_lock<std::shared_timed_mutex> tl(_tag_lock);
+        std::unique_lock<std::shared_timed_mutex> dl(_delete_lock);
+        for (auto loc : batch)
+            _delete_set->erase(loc);
+        release_locations(batch);
+    }
+
+    std::lock_guard<std::mutex> guard(_consolidation_mutex);
+    _consolidation_progress._batch_deletes = 0;
+    _consolidation_progress._batch_nodes_done = 0;
+    _consolidation_progress._batch_nodes_total = 0;
+    _consolidation_progress._batches_completed++;
+    _consolidation_progress._slots_released += batch.size();
+    _consolidation_progress._last_batch_secs = timer.elapsed_seconds();
+    return batch.size();
 }
 
 template <typename T, typename TagT, typename LabelT> void Index<T, TagT, LabelT>::compact_frozen_point()
@@ -2472,6 +3160,7 @@ template <typename T, typename TagT, typename LabelT> void Index<T, TagT, LabelT
     {
         reposition_points((uint32_t)_max_points, (uint32_t)_nd, (uint32_t)_num_frozen_pts);
         _start = (uint32_t)_nd;
+        rebuild_in_neighbors();
 
         if (_filtered_index && _dynamic_index)
         {
@@ -2613,6 +3302,7 @@ template <typename T, typename TagT, typename LabelT> void Index<T, TagT, LabelT
         _empty_slots.insert((uint32_t)i);
     }
     _data_compacted = true;
+    rebuild_in_neighbors();
     diskann::cout << "Time taken for compact_data: " << timer.elapsed() / 1000000. << "s." << std::endl;
 }
 
@@ -2694,7 +3384,7 @@ void Index<T, TagT, LabelT>::reposition_points(uint32_t old_location_start, uint
     std::vector<location_t> updated_neighbours_location;
     for (uint32_t i = 0; i < _max_points + _num_frozen_pts; i++)
     {
-        auto &i_neighbours = _graph_store->get_neighbours((location_t)i);
+        auto i_neighbours = _graph_store->get_neighbours((location_t)i);
         std::vector<location_t> i_neighbours_copy(i_neighbours.begin(), i_neighbours.end());
         for (auto &loc : i_neighbours_copy)
         {
@@ -2807,6 +3497,7 @@ template <typename T, typename TagT, typename LabelT> void Index<T, TagT, LabelT
     {
         _empty_slots.insert((uint32_t)i);
     }
+    rebuild_in_neighbors();
 
     auto stop = std::chrono::high_resolution_clock::now();
     diskann::cout << "Resizing took: " << std::chrono::duration<double>(stop - start).count() << "s" << std::endl;
@@ -2884,6 +3575,8 @@ int Index<T, TagT, LabelT>::insert_point(const T *point, const TagT tag, const s
         }
 
         _location_to_labels[location] = labels;
+        // filter checks intersect sorted label lists
+        std::sort(_location_to_labels[location].begin(), _location_to_labels[location].end());
 
         for (LabelT label : labels)
         {
@@ -2985,7 +3678,6 @@ int Index<T, TagT, LabelT>::insert_point(const T *point, const TagT tag, const s
             tlock.lock();
 
         LockGuard guard(_locks[location]);
-        _graph_store->clear_neighbours(location);
 
         std::vector<uint32_t> neighbor_links;
         for (auto link : pruned_list)
@@ -2995,7 +3687,7 @@ int Index<T, TagT, LabelT>::insert_point(const T *point, const TagT tag, const s
                     continue;
             neighbor_links.emplace_back(link);
         }
-        _graph_store->set_neighbours(location, neighbor_links);
+        update_neighbours(location, neighbor_links);
         assert(_graph_store->get_neighbours(location).size() <= _indexingRange);
 
         if (_conc_consolidate)
@@ -3180,6 +3872,12 @@ template <typename T, typename TagT, typename LabelT> void Index<T, TagT, LabelT
 }
 
 // REFACTOR: This should be an OptimizedDataStore class
+template <typename T, typename TagT, typename LabelT>
+void Index<T, TagT, LabelT>::set_visited_set_type(VisitedSetType type)
+{
+    _visited_set_type = type;
+}
+
 template <typename T, typename TagT, typename LabelT> void Index<T, TagT, LabelT>::optimize_index_layout()
 { // use after build or load
     if (_dynamic_index)
@@ -3212,6 +3910,7 @@ template <typename T, typename TagT, typename LabelT> void Index<T, TagT, LabelT
     }
     _graph_store->clear_graph();
     _graph_store->resize_graph(0);
+    _in_neighbors.reset();
     delete[] cur_vec;
 }
 
@@ -3444,6 +4143,152 @@ template DISKANN_DLLEXPORT std::pair<uint32_t, uint32_t> Index<int8_t, uint32_t,
 template DISKANN_DLLEXPORT std::pair<uint32_t, uint32_t> Index<int8_t, uint32_t, uint16_t>::search<uint32_t>(
     const int8_t *query, const size_t K, const uint32_t L, uint32_t *indices, float *distances);
 
+template DISKANN_DLLEXPORT void Index<float, uint64_t, uint32_t>::batch_search<uint64_t>(
+    const float *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<float, uint64_t, uint32_t>::batch_search<uint32_t>(
+    const float *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<uint8_t, uint64_t, uint32_t>::batch_search<uint64_t>(
+    const uint8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<uint8_t, uint64_t, uint32_t>::batch_search<uint32_t>(
+    const uint8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<int8_t, uint64_t, uint32_t>::batch_search<uint64_t>(
+    const int8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<int8_t, uint64_t, uint32_t>::batch_search<uint32_t>(
+    const int8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<float, uint32_t, uint32_t>::batch_search<uint64_t>(
+    const float *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<float, uint32_t, uint32_t>::batch_search<uint32_t>(
+    const float *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<uint8_t, uint32_t, uint32_t>::batch_search<uint64_t>(
+    const uint8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<uint8_t, uint32_t, uint32_t>::batch_search<uint32_t>(
+    const uint8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<int8_t, uint32_t, uint32_t>::batch_search<uint64_t>(
+    const int8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<int8_t, uint32_t, uint32_t>::batch_search<uint32_t>(
+    const int8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<float, uint64_t, uint16_t>::batch_search<uint64_t>(
+    const float *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<float, uint64_t, uint16_t>::batch_search<uint32_t>(
+    const float *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<uint8_t, uint64_t, uint16_t>::batch_search<uint64_t>(
+    const uint8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<uint8_t, uint64_t, uint16_t>::batch_search<uint32_t>(
+    const uint8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<int8_t, uint64_t, uint16_t>::batch_search<uint64_t>(
+    const int8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<int8_t, uint64_t, uint16_t>::batch_search<uint32_t>(
+    const int8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<float, uint32_t, uint16_t>::batch_search<uint64_t>(
+    const float *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<float, uint32_t, uint16_t>::batch_search<uint32_t>(
+    const float *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<uint8_t, uint32_t, uint16_t>::batch_search<uint64_t>(
+    const uint8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<uint8_t, uint32_t, uint16_t>::batch_search<uint32_t>(
+    const uint8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<int8_t, uint32_t, uint16_t>::batch_search<uint64_t>(
+    const int8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint64_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+template DISKANN_DLLEXPORT void Index<int8_t, uint32_t, uint16_t>::batch_search<uint32_t>(
+    const int8_t *queries, const size_t num_queries, const size_t query_stride, const size_t K, const uint32_t L,
+    uint32_t *indices, float *distances, uint32_t *cmps, const uint32_t batch_size);
+
+template DISKANN_DLLEXPORT size_t Index<float, uint64_t, uint32_t>::range_search<uint64_t>(
+    const float *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<float, uint64_t, uint32_t>::range_search<uint32_t>(
+    const float *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<uint8_t, uint64_t, uint32_t>::range_search<uint64_t>(
+    const uint8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<uint8_t, uint64_t, uint32_t>::range_search<uint32_t>(
+    const uint8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<int8_t, uint64_t, uint32_t>::range_search<uint64_t>(
+    const int8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<int8_t, uint64_t, uint32_t>::range_search<uint32_t>(
+    const int8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<float, uint32_t, uint32_t>::range_search<uint64_t>(
+    const float *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<float, uint32_t, uint32_t>::range_search<uint32_t>(
+    const float *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<uint8_t, uint32_t, uint32_t>::range_search<uint64_t>(
+    const uint8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<uint8_t, uint32_t, uint32_t>::range_search<uint32_t>(
+    const uint8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<int8_t, uint32_t, uint32_t>::range_search<uint64_t>(
+    const int8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<int8_t, uint32_t, uint32_t>::range_search<uint32_t>(
+    const int8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<float, uint64_t, uint16_t>::range_search<uint64_t>(
+    const float *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<float, uint64_t, uint16_t>::range_search<uint32_t>(
+    const float *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<uint8_t, uint64_t, uint16_t>::range_search<uint64_t>(
+    const uint8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<uint8_t, uint64_t, uint16_t>::range_search<uint32_t>(
+    const uint8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<int8_t, uint64_t, uint16_t>::range_search<uint64_t>(
+    const int8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<int8_t, uint64_t, uint16_t>::range_search<uint32_t>(
+    const int8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<float, uint32_t, uint16_t>::range_search<uint64_t>(
+    const float *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<float, uint32_t, uint16_t>::range_search<uint32_t>(
+    const float *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<uint8_t, uint32_t, uint16_t>::range_search<uint64_t>(
+    const uint8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<uint8_t, uint32_t, uint16_t>::range_search<uint32_t>(
+    const uint8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<int8_t, uint32_t, uint16_t>::range_search<uint64_t>(
+    const int8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint64_t> &indices, std::vector<float> &distances);
+template DISKANN_DLLEXPORT size_t Index<int8_t, uint32_t, uint16_t>::range_search<uint32_t>(
+    const int8_t *query, const double range, const uint32_t min_l_search, const uint32_t max_l_search,
+    std::vector<uint32_t> &indices, std::vector<float> &distances);
+
 template DISKANN_DLLEXPORT std::pair<uint32_t, uint32_t> Index<float, uint64_t, uint16_t>::search_with_filters<
     uint64_t>(const float *query, const uint16_t &filter_label, const size_t K, const uint32_t L, uint64_t *indices,
               float *distances);
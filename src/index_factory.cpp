@@ -34,6 +34,20 @@ void IndexFactory::check_config()
                                -1, __FUNCSIG__, __FILE__, __LINE__);
     }
 
+    if ((_config->data_strategy == DataStoreStrategy::MMAP || _config->graph_strategy == GraphStoreStrategy::MMAP) &&
+        (_config->dynamic_index || _config->pq_dist_build))
+    {
+        throw ANNException("ERROR: memory-mapped stores are read-only and need a static index built without PQ "
+                           "distances",
+                           -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    if (_config->track_in_neighbors && !_config->dynamic_index)
+    {
+        throw ANNException("ERROR: in-neighbor tracking is only useful for dynamic indexes, which support deletes", -1,
+                           __FUNCSIG__, __FILE__, __LINE__);
+    }
+
     if (_config->data_type != "float" && _config->data_type != "uint8" && _config->data_type != "int8")
     {
         throw ANNException("ERROR: invalid data type : + " + _config->data_type +
@@ -65,7 +79,7 @@ template <typename T> Distance<T> *IndexFactory::construct_inmem_distance_fn(Met
 template <typename T>
 std::shared_ptr<AbstractDataStore<T>> IndexFactory::construct_datastore(DataStoreStrategy strategy,
                                                                         size_t total_internal_points, size_t dimension,
-                                                                        Metric metric)
+                                                                        Metric metric, const uint32_t mmap_flags)
 {
     std::unique_ptr<Distance<T>> distance;
     switch (strategy)
@@ -74,6 +88,10 @@ std::shared_ptr<AbstractDataStore<T>> IndexFactory::construct_datastore(DataStor
         distance.reset(construct_inmem_distance_fn<T>(metric));
         return std::make_shared<diskann::InMemDataStore<T>>((location_t)total_internal_points, dimension,
                                                             std::move(distance));
+    case DataStoreStrategy::MMAP:
+        distance.reset(construct_inmem_distance_fn<T>(metric));
+        return std::make_shared<diskann::MmapDataStore<T>>((location_t)total_internal_points, dimension,
+                                                           std::move(distance), mmap_flags);
     default:
         break;
     }
@@ -82,12 +100,17 @@ std::shared_ptr<AbstractDataStore<T>> IndexFactory::construct_datastore(DataStor
 
 std::unique_ptr<AbstractGraphStore> IndexFactory::construct_graphstore(const GraphStoreStrategy strategy,
                                                                        const size_t size,
-                                                                       const size_t reserve_graph_degree)
+                                                                       const size_t reserve_graph_degree,
+                                                                       const uint32_t mmap_flags)
 {
     switch (strategy)
     {
     case GraphStoreStrategy::MEMORY:
         return std::make_unique<InMemGraphStore>(size, reserve_graph_degree);
+    case GraphStoreStrategy::FLAT:
+        return std::make_unique<InMemFlatGraphStore>(size, reserve_graph_degree);
+    case GraphStoreStrategy::MMAP:
+        return std::make_unique<MmapGraphStore>(size, reserve_graph_degree, mmap_flags);
     default:
         throw ANNException("Error : Current GraphStoreStratagy is not supported.", -1);
     }
@@ -121,7 +144,8 @@ std::unique_ptr<AbstractIndex> IndexFactory::create_instance()
     size_t num_points = _config->max_points + _config->num_frozen_pts;
     size_t dim = _config->dimension;
     // auto graph_store = construct_graphstore(_config->graph_strategy, num_points);
-    auto data_store = construct_datastore<data_type>(_config->data_strategy, num_points, dim, _config->metric);
+    auto data_store = construct_datastore<data_type>(_config->data_strategy, num_points, dim, _config->metric,
+                                                     _config->mmap_flags);
     std::shared_ptr<AbstractDataStore<data_type>> pq_data_store = nullptr;
 
     if (_config->data_strategy == DataStoreStrategy::MEMORY && _config->pq_dist_build)
@@ -138,7 +162,8 @@ std::unique_ptr<AbstractIndex> IndexFactory::create_instance()
         (size_t)(defaults::GRAPH_SLACK_FACTOR * 1.05 *
                  (_config->index_write_params == nullptr ? 0 : _config->index_write_params->max_degree));
     std::unique_ptr<AbstractGraphStore> graph_store =
-        construct_graphstore(_config->graph_strategy, num_points + _config->num_frozen_pts, max_reserve_degree);
+        construct_graphstore(_config->graph_strategy, num_points + _config->num_frozen_pts, max_reserve_degree,
+                             _config->mmap_flags);
 
     // REFACTOR TODO: Must construct in-memory PQDatastore if strategy == ONDISK and must construct
     // in-mem and on-disk PQDataStore if strategy == ONDISK and diskPQ is required.
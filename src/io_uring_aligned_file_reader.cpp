@@ -0,0 +1,284 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "io_uring_aligned_file_reader.h"
+
+#include <liburing.h>
+#include <sys/uio.h>
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include "tsl/robin_map.h"
+#include "utils.h"
+#define MAX_EVENTS 1024
+#define SQPOLL_IDLE_MS 2000
+
+namespace
+{
+// per-thread ring; IOContext holds a pointer to this
+struct IoUringContext
+{
+    struct io_uring ring;
+    bool fixed_file = false;     // index file registered at slot 0
+    char *fixed_buf = nullptr;   // buffer registered at slot 0, if any
+    uint64_t fixed_buf_len = 0;
+};
+
+inline IoUringContext *to_uring_ctx(io_context_t ctx)
+{
+    return reinterpret_cast<IoUringContext *>(ctx);
+}
+
+void throw_uring_error(const std::string &op, int ret)
+{
+    std::stringstream stream;
+    stream << op << " failed; returned " << ret << ": " << ::strerror(-ret);
+    throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+}
+
+// returns false if the submission queue is full
+bool prep_read(IoUringContext *uctx, int fd, const AlignedRead &req)
+{
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&uctx->ring);
+    if (sqe == nullptr)
+        return false;
+
+    char *buf = (char *)req.buf;
+    int target = uctx->fixed_file ? 0 : fd;
+    if (uctx->fixed_buf != nullptr && buf >= uctx->fixed_buf && buf + req.len <= uctx->fixed_buf + uctx->fixed_buf_len)
+        io_uring_prep_read_fixed(sqe, target, buf, (unsigned)req.len, req.offset, 0);
+    else
+        io_uring_prep_read(sqe, target, buf, (unsigned)req.len, req.offset);
+    if (uctx->fixed_file)
+        sqe->flags |= IOSQE_FIXED_FILE;
+    io_uring_sqe_set_data(sqe, buf);
+    return true;
+}
+
+// reaps whatever is in the completion queue without waiting
+uint64_t reap_completions(IoUringContext *uctx, std::vector<void *> *completed_bufs)
+{
+    struct io_uring_cqe *cqes[MAX_IO_DEPTH];
+    uint64_t n_reaped = 0;
+    unsigned n;
+    while ((n = io_uring_peek_batch_cqe(&uctx->ring, cqes, MAX_IO_DEPTH)) > 0)
+    {
+        for (unsigned i = 0; i < n; i++)
+        {
+            if (cqes[i]->res < 0)
+                throw_uring_error("io_uring read", cqes[i]->res);
+            if (completed_bufs != nullptr)
+                completed_bufs->push_back(io_uring_cqe_get_data(cqes[i]));
+        }
+        io_uring_cq_advance(&uctx->ring, n);
+        n_reaped += n;
+    }
+    return n_reaped;
+}
+} // namespace
+
+IoUringAlignedFileReader::IoUringAlignedFileReader(bool use_sqpoll) : use_sqpoll(use_sqpoll)
+{
+    this->file_desc = -1;
+}
+
+IoUringAlignedFileReader::~IoUringAlignedFileReader()
+{
+    if (this->file_desc != -1)
+    {
+        std::cerr << "close() not called" << std::endl;
+        ::close(this->file_desc);
+    }
+}
+
+io_context_t &IoUringAlignedFileReader::get_ctx()
+{
+    std::unique_lock<std::mutex> lk(ctx_mut);
+    if (ctx_map.find(std::this_thread::get_id()) == ctx_map.end())
+    {
+        std::cerr << "bad thread access; returning -1 as io_context_t" << std::endl;
+        return this->bad_ctx;
+    }
+    else
+    {
+        return ctx_map[std::this_thread::get_id()];
+    }
+}
+
+void IoUringAlignedFileReader::register_thread()
+{
+    auto my_id = std::this_thread::get_id();
+    std::unique_lock<std::mutex> lk(ctx_mut);
+    if (ctx_map.find(my_id) != ctx_map.end())
+    {
+        std::cerr << "multiple calls to register_thread from the same thread" << std::endl;
+        return;
+    }
+
+    IoUringContext *uctx = new IoUringContext();
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    if (this->use_sqpoll)
+    {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = SQPOLL_IDLE_MS;
+    }
+    int ret = io_uring_queue_init_params(MAX_EVENTS, &uctx->ring, &params);
+    if (ret != 0 && this->use_sqpoll)
+    {
+        // SQPOLL needs CAP_SYS_NICE on older kernels; fall back to a plain ring
+        diskann::cerr << "io_uring SQPOLL setup failed (" << ::strerror(-ret) << "), using an interrupt-driven ring"
+                      << std::endl;
+        memset(&params, 0, sizeof(params));
+        ret = io_uring_queue_init_params(MAX_EVENTS, &uctx->ring, &params);
+    }
+    if (ret != 0)
+    {
+        delete uctx;
+        lk.unlock();
+        throw_uring_error("io_uring_queue_init()", ret);
+    }
+
+    if (this->file_desc != -1)
+    {
+        ret = io_uring_register_files(&uctx->ring, &this->file_desc, 1);
+        uctx->fixed_file = (ret == 0);
+        if (ret != 0)
+            diskann::cerr << "io_uring_register_files() failed; returned " << ret << ": " << ::strerror(-ret)
+                          << std::endl;
+    }
+
+    diskann::cout << "allocating io_uring ctx: " << uctx << " to thread-id:" << my_id << std::endl;
+    ctx_map[my_id] = reinterpret_cast<io_context_t>(uctx);
+}
+
+void IoUringAlignedFileReader::deregister_thread()
+{
+    auto my_id = std::this_thread::get_id();
+    std::unique_lock<std::mutex> lk(ctx_mut);
+    auto iter = ctx_map.find(my_id);
+    if (iter == ctx_map.end())
+        return;
+
+    IoUringContext *uctx = to_uring_ctx(iter->second);
+    io_uring_queue_exit(&uctx->ring);
+    delete uctx;
+    ctx_map.erase(my_id);
+    std::cerr << "returned ctx from thread-id:" << my_id << std::endl;
+}
+
+void IoUringAlignedFileReader::deregister_all_threads()
+{
+    std::unique_lock<std::mutex> lk(ctx_mut);
+    for (auto x = ctx_map.begin(); x != ctx_map.end(); x++)
+    {
+        IoUringContext *uctx = to_uring_ctx(x.value());
+        io_uring_queue_exit(&uctx->ring);
+        delete uctx;
+    }
+    ctx_map.clear();
+}
+
+void IoUringAlignedFileReader::open(const std::string &fname)
+{
+    int flags = O_DIRECT | O_RDONLY | O_LARGEFILE;
+    this->file_desc = ::open(fname.c_str(), flags);
+    if (this->file_desc == -1)
+    {
+        throw diskann::ANNException("Failed to open file " + fname + ": " + ::strerror(errno), -1, __FUNCSIG__,
+                                    __FILE__, __LINE__);
+    }
+    std::cerr << "Opened file : " << fname << std::endl;
+}
+
+void IoUringAlignedFileReader::close()
+{
+    ::close(this->file_desc);
+    this->file_desc = -1;
+}
+
+void IoUringAlignedFileReader::read(std::vector<AlignedRead> &read_reqs, io_context_t &ctx, bool async)
+{
+    if (async == true)
+    {
+        diskann::cout << "Async flag ignored; use submit_reads() and get_completed() instead." << std::endl;
+    }
+    assert(this->file_desc != -1);
+    IoUringContext *uctx = to_uring_ctx(ctx);
+
+    // keep the submission queue full until every request has completed
+    uint64_t n_queued = 0, n_done = 0;
+    while (n_done < read_reqs.size())
+    {
+        while (n_queued < read_reqs.size() && prep_read(uctx, this->file_desc, read_reqs[n_queued]))
+            n_queued++;
+
+        int ret = io_uring_submit_and_wait(&uctx->ring, 1);
+        if (ret < 0)
+            throw_uring_error("io_uring_submit_and_wait()", ret);
+        n_done += reap_completions(uctx, nullptr);
+    }
+}
+
+bool IoUringAlignedFileReader::supports_async_reads()
+{
+    return true;
+}
+
+void IoUringAlignedFileReader::submit_reads(std::vector<AlignedRead> &read_reqs, io_context_t &ctx)
+{
+    assert(this->file_desc != -1);
+    IoUringContext *uctx = to_uring_ctx(ctx);
+    for (auto &req : read_reqs)
+    {
+        while (!prep_read(uctx, this->file_desc, req))
+        {
+            // submission queue is full; flush it and retry
+            int ret = io_uring_submit(&uctx->ring);
+            if (ret < 0)
+                throw_uring_error("io_uring_submit()", ret);
+        }
+    }
+    int ret = io_uring_submit(&uctx->ring);
+    if (ret < 0)
+        throw_uring_error("io_uring_submit()", ret);
+}
+
+void IoUringAlignedFileReader::get_completed(io_context_t &ctx, uint64_t min_completions,
+                                             std::vector<void *> &completed_bufs)
+{
+    IoUringContext *uctx = to_uring_ctx(ctx);
+    completed_bufs.clear();
+    if (min_completions > 0)
+    {
+        struct io_uring_cqe *cqe = nullptr;
+        int ret = io_uring_wait_cqe_nr(&uctx->ring, &cqe, (unsigned)min_completions);
+        if (ret < 0)
+            throw_uring_error("io_uring_wait_cqe_nr()", ret);
+    }
+    reap_completions(uctx, &completed_bufs);
+}
+
+void IoUringAlignedFileReader::register_buffer(io_context_t &ctx, void *buf, uint64_t len)
+{
+    IoUringContext *uctx = to_uring_ctx(ctx);
+    if (uctx->fixed_buf != nullptr)
+    {
+        diskann::cerr << "io_uring ctx already has a registered buffer; ignoring" << std::endl;
+        return;
+    }
+
+    struct iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = len;
+    int ret = io_uring_register_buffers(&uctx->ring, &iov, 1);
+    if (ret != 0)
+    {
+        // usually RLIMIT_MEMLOCK; reads still work, just without READ_FIXED
+        diskann::cerr << "io_uring_register_buffers() failed; returned " << ret << ": " << ::strerror(-ret)
+                      << std::endl;
+        return;
+    }
+    uctx->fixed_buf = (char *)buf;
+    uctx->fixed_buf_len = len;
+}
@@ -0,0 +1,183 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "label_index.h"
+
+namespace diskann
+{
+
+template <typename LabelT>
+void LabelIndex<LabelT>::build(const size_t num_points, const uint32_t *offsets, const uint32_t *counts,
+                               const LabelT *pts_to_labels)
+{
+    _num_points = num_points;
+    _label_to_posting.clear();
+    _postings.clear();
+
+    for (size_t i = 0; i < num_points; i++)
+    {
+        for (uint32_t j = 0; j < counts[i]; j++)
+        {
+            auto iter = _label_to_posting.find(pts_to_labels[offsets[i] + j]);
+            if (iter == _label_to_posting.end())
+            {
+                iter = _label_to_posting.emplace(pts_to_labels[offsets[i] + j], (uint32_t)_postings.size()).first;
+                _postings.emplace_back();
+            }
+            _postings[iter->second].count++;
+        }
+    }
+
+    // a bitmap costs num_points / 8 bytes, a list 4 bytes a point
+    const size_t num_words = (num_points + 63) / 64;
+    for (auto &posting : _postings)
+    {
+        if (posting.count * 32 > num_points)
+            posting.bits.resize(num_words, 0);
+        else
+            posting.points.reserve(posting.count);
+    }
+
+    for (size_t i = 0; i < num_points; i++)
+    {
+        for (uint32_t j = 0; j < counts[i]; j++)
+        {
+            auto &posting = _postings[_label_to_posting[pts_to_labels[offsets[i] + j]]];
+            if (!posting.bits.empty())
+                posting.bits[i >> 6] |= 1ULL << (i & 63);
+            else if (posting.points.empty() || posting.points.back() != (uint32_t)i) // a label repeated on a point
+                posting.points.push_back((uint32_t)i);
+        }
+    }
+    for (auto &posting : _postings)
+    {
+        if (posting.bits.empty())
+            posting.count = posting.points.size();
+    }
+}
+
+template <typename LabelT>
+const LabelMatcher::Posting *LabelIndex<LabelT>::find(const LabelT &label) const
+{
+    auto iter = _label_to_posting.find(label);
+    return iter == _label_to_posting.end() ? nullptr : &_postings[iter->second];
+}
+
+template <typename LabelT>
+LabelMatcher LabelIndex<LabelT>::compile(const LabelFilter<LabelT> &filter, const LabelT *universal_label) const
+{
+    LabelMatcher matcher;
+    matcher._match_all = filter.match == LabelMatch::ALL;
+    for (const auto &label : filter.labels)
+    {
+        const LabelMatcher::Posting *posting = find(label);
+        if (posting == nullptr)
+        {
+            if (matcher._match_all)
+            {
+                matcher._postings.clear();
+                break;
+            }
+            continue;
+        }
+        if (std::find(matcher._postings.begin(), matcher._postings.end(), posting) == matcher._postings.end())
+            matcher._postings.push_back(posting);
+    }
+
+    for (auto posting : matcher._postings)
+    {
+        if (matcher._match_all)
+            matcher._max_matches = (std::min)(matcher._max_matches == 0 ? posting->count : matcher._max_matches,
+                                              posting->count);
+        else
+            matcher._max_matches += posting->count;
+    }
+
+    if (universal_label != nullptr)
+    {
+        matcher._universal = find(*universal_label);
+        if (matcher._universal != nullptr)
+            matcher._max_matches += matcher._universal->count;
+    }
+    return matcher;
+}
+
+template <typename LabelT>
+void LabelIndex<LabelT>::get_matching_points(const LabelMatcher &matcher, std::vector<uint32_t> &points) const
+{
+    points.clear();
+    points.reserve(matcher.max_matches());
+
+    auto append_posting = [&](const LabelMatcher::Posting *posting) {
+        if (posting->bits.empty())
+        {
+            points.insert(points.end(), posting->points.begin(), posting->points.end());
+            return;
+        }
+        for (size_t w = 0; w < posting->bits.size(); w++)
+        {
+            const uint64_t word = posting->bits[w];
+            if (word == 0)
+                continue;
+            for (uint32_t b = 0; b < 64; b++)
+            {
+                if ((word >> b) & 1)
+                    points.push_back((uint32_t)(w * 64 + b));
+            }
+        }
+    };
+
+    if (matcher._match_all)
+    {
+        if (!matcher._postings.empty())
+        {
+            // walk the smallest posting and test the rest
+            const LabelMatcher::Posting *smallest = matcher._postings[0];
+            for (auto posting : matcher._postings)
+                if (posting->count < smallest->count)
+                    smallest = posting;
+            append_posting(smallest);
+            points.erase(std::remove_if(points.begin(), points.end(),
+                                        [&](const uint32_t point) {
+                                            for (auto posting : matcher._postings)
+                                                if (!posting->contains(point))
+                                                    return true;
+                                            return false;
+                                        }),
+                         points.end());
+        }
+    }
+    else
+    {
+        for (auto posting : matcher._postings)
+            append_posting(posting);
+    }
+
+    const bool merged = matcher._universal != nullptr || (!matcher._match_all && matcher._postings.size() > 1);
+    if (matcher._universal != nullptr)
+        append_posting(matcher._universal);
+    if (merged)
+    {
+        std::sort(points.begin(), points.end());
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+    }
+}
+
+template <typename LabelT> size_t LabelIndex<LabelT>::num_labels() const
+{
+    return _postings.size();
+}
+
+template <typename LabelT> size_t LabelIndex<LabelT>::memory_in_bytes() const
+{
+    size_t bytes = _postings.capacity() * sizeof(LabelMatcher::Posting) +
+                   _label_to_posting.bucket_count() * (sizeof(LabelT) + sizeof(uint32_t));
+    for (const auto &posting : _postings)
+        bytes += posting.points.capacity() * sizeof(uint32_t) + posting.bits.capacity() * sizeof(uint64_t);
+    return bytes;
+}
+
+template class LabelIndex<uint16_t>;
+template class LabelIndex<uint32_t>;
+
+} // namespace diskann
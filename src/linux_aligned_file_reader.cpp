@@ -226,3 +226,61 @@ void LinuxAlignedFileReader::read(std::vector<AlignedRead> &read_reqs, io_contex
     assert(this->file_desc != -1);
     execute_io(ctx, this->file_desc, read_reqs);
 }
+
+bool LinuxAlignedFileReader::supports_async_reads()
+{
+    return true;
+}
+
+void LinuxAlignedFileReader::submit_reads(std::vector<AlignedRead> &read_reqs, io_context_t &ctx)
+{
+    assert(this->file_desc != -1);
+    // the kernel copies each iocb during io_submit, so they need not outlive
+    // this call; the buf travels back to us through the event's data field
+    uint64_t n_ops = read_reqs.size();
+    std::vector<iocb_t> cb(n_ops);
+    std::vector<iocb_t *> cbs(n_ops, nullptr);
+    for (uint64_t j = 0; j < n_ops; j++)
+    {
+        io_prep_pread(cb.data() + j, this->file_desc, read_reqs[j].buf, read_reqs[j].len, read_reqs[j].offset);
+        cb[j].data = read_reqs[j].buf;
+        cbs[j] = cb.data() + j;
+    }
+
+    uint64_t n_submitted = 0;
+    while (n_submitted < n_ops)
+    {
+        int64_t ret = io_submit(ctx, (int64_t)(n_ops - n_submitted), cbs.data() + n_submitted);
+        if (ret <= 0)
+        {
+            std::cerr << "io_submit() failed; returned " << ret << ", expected=" << n_ops - n_submitted
+                      << ", ernno=" << errno << "=" << ::strerror(-ret) << std::endl;
+            exit(-1);
+        }
+        n_submitted += (uint64_t)ret;
+    }
+}
+
+void LinuxAlignedFileReader::get_completed(io_context_t &ctx, uint64_t min_completions,
+                                           std::vector<void *> &completed_bufs)
+{
+    completed_bufs.clear();
+    io_event_t evts[MAX_IO_DEPTH];
+    int64_t ret = io_getevents(ctx, (int64_t)min_completions, MAX_IO_DEPTH, evts, nullptr);
+    if (ret < (int64_t)min_completions)
+    {
+        std::cerr << "io_getevents() failed; returned " << ret << ", expected at least " << min_completions
+                  << ", ernno=" << errno << "=" << ::strerror(-ret) << std::endl;
+        exit(-1);
+    }
+    for (int64_t i = 0; i < ret; i++)
+    {
+        if ((int64_t)evts[i].res < 0)
+        {
+            std::cerr << "async read failed; returned " << (int64_t)evts[i].res << "="
+                      << ::strerror(-(int)evts[i].res) << std::endl;
+            exit(-1);
+        }
+        completed_bufs.push_back(evts[i].data);
+    }
+}
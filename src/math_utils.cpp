@@ -3,11 +3,23 @@
 
 #include <limits>
 #include <malloc.h>
+#include <memory>
+#include <random>
 #include <math_utils.h>
 #include <mkl.h>
 #include "logger.h"
 #include "utils.h"
 
+// largest points x centers distance matrix compute_closest_centers computes at once
+#define MAX_DIST_MATRIX_FLOATS ((size_t)1 << 22)
+// mini-batch k-means stops after this many batches without a new low in the smoothed residual
+#define MINIBATCH_MAX_NO_IMPROVEMENT 10
+// k-means|| sampling rounds, and the expected number of points each samples as a multiple of the centers wanted
+#define KMEANS_PARALLEL_ROUNDS 5
+#define KMEANS_PARALLEL_OVERSAMPLING 2
+// k-means++ falls back to random pivots above this many points
+#define KMEANSPP_MAX_POINTS (1 << 23)
+
 namespace math_utils
 {
 
@@ -160,7 +172,8 @@ void compute_closest_centers(float *data, size_t num_points, size_t dim, float *
     if (!is_norm_given_for_pts)
         pts_norms_squared = new float[num_points];
 
-    size_t PAR_BLOCK_SIZE = num_points;
+    // bounds the distance matrix, which callers training several k-means concurrently each allocate
+    size_t PAR_BLOCK_SIZE = (std::min)(num_points, (std::max)((size_t)1, MAX_DIST_MATRIX_FLOATS / num_centers));
     size_t N_BLOCKS =
         (num_points % PAR_BLOCK_SIZE) == 0 ? (num_points / PAR_BLOCK_SIZE) : (num_points / PAR_BLOCK_SIZE) + 1;
 
@@ -185,17 +198,15 @@ void compute_closest_centers(float *data, size_t num_points, size_t dim, float *
              j < std::min((int64_t)num_points, (int64_t)((cur_blk + 1) * PAR_BLOCK_SIZE)); j++)
         {
             for (size_t l = 0; l < k; l++)
-            {
-                size_t this_center_id = closest_centers[(j - cur_blk * PAR_BLOCK_SIZE) * k + l];
-                closest_centers_ivf[j * k + l] = (uint32_t)this_center_id;
-                if (inverted_index != NULL)
-                {
-#pragma omp critical
-                    inverted_index[this_center_id].push_back(j);
-                }
-            }
+                closest_centers_ivf[j * k + l] = closest_centers[(j - cur_blk * PAR_BLOCK_SIZE) * k + l];
         }
     }
+    // filled serially: a critical section per point serializes every thread, and all concurrent k-means runs
+    if (inverted_index != NULL)
+    {
+        for (size_t j = 0; j < num_points * k; j++)
+            inverted_index[closest_centers_ivf[j]].push_back(j / k);
+    }
     delete[] closest_centers;
     delete[] distance_matrix;
     delete[] pivs_norms_squared;
@@ -353,6 +364,62 @@ float run_lloyds(float *data, size_t num_points, size_t dim, float *centers, con
     return residual;
 }
 
+float run_minibatch_kmeans(float *data, size_t num_points, size_t dim, float *centers, const size_t num_centers,
+                           const size_t batch_size, const size_t max_reps, uint32_t *closest_center)
+{
+    const size_t cur_batch_size = (std::min)(batch_size, num_points);
+    const size_t max_steps = max_reps * DIV_ROUND_UP(num_points, cur_batch_size);
+    // batch inertia is noisy, so convergence is judged on its exponentially weighted average
+    const double smoothing = (std::min)(1.0, 2.0 * cur_batch_size / (num_points + 1));
+
+    std::random_device rd;
+    auto x = rd();
+    std::mt19937 generator(x);
+    std::uniform_int_distribution<size_t> distribution(0, num_points - 1);
+
+    std::unique_ptr<float[]> batch = std::make_unique<float[]>(cur_batch_size * dim);
+    std::unique_ptr<uint32_t[]> batch_center = std::make_unique<uint32_t[]>(cur_batch_size);
+    std::vector<size_t> center_counts(num_centers, 0);
+
+    double smoothed_inertia = 0, best_inertia = std::numeric_limits<double>::max();
+    size_t steps = 0, steps_without_improvement = 0;
+    for (; steps < max_steps && steps_without_improvement < MINIBATCH_MAX_NO_IMPROVEMENT; steps++)
+    {
+        for (size_t i = 0; i < cur_batch_size; i++)
+            std::memcpy(batch.get() + i * dim, data + distribution(generator) * dim, dim * sizeof(float));
+        math_utils::compute_closest_centers(batch.get(), cur_batch_size, dim, centers, num_centers, 1,
+                                            batch_center.get());
+
+        // each center moves towards its points with a per-center learning rate of 1 / (points it has absorbed)
+        double inertia = 0;
+        for (size_t i = 0; i < cur_batch_size; i++)
+        {
+            float *point = batch.get() + i * dim;
+            float *center = centers + (size_t)batch_center[i] * dim;
+            inertia += math_utils::calc_distance(point, center, dim);
+            const float eta = 1.0f / (float)(++center_counts[batch_center[i]]);
+            for (size_t d = 0; d < dim; d++)
+                center[d] += eta * (point[d] - center[d]);
+        }
+        inertia /= cur_batch_size;
+
+        smoothed_inertia = steps == 0 ? inertia : smoothed_inertia * (1 - smoothing) + inertia * smoothing;
+        if (smoothed_inertia < best_inertia)
+        {
+            best_inertia = smoothed_inertia;
+            steps_without_improvement = 0;
+        }
+        else
+            steps_without_improvement++;
+    }
+    diskann::cout << "Mini-batch k-means stopped after " << steps << " batches of " << cur_batch_size
+                  << " points, smoothed residual " << smoothed_inertia << std::endl;
+
+    if (closest_center != NULL)
+        math_utils::compute_closest_centers(data, num_points, dim, centers, num_centers, 1, closest_center);
+    return (float)smoothed_inertia;
+}
+
 // assumes memory allocated for pivot_data as new
 // float[num_centers*dim]
 // and select randomly num_centers points as pivots
@@ -379,7 +446,7 @@ void selecting_pivots(float *data, size_t num_points, size_t dim, float *pivot_d
 
 void kmeanspp_selecting_pivots(float *data, size_t num_points, size_t dim, float *pivot_data, size_t num_centers)
 {
-    if (num_points > 1 << 23)
+    if (num_points > KMEANSPP_MAX_POINTS)
     {
         diskann::cout << "ERROR: n_pts " << num_points
                       << " currently not supported for k-means++, maximum is "
@@ -455,4 +522,129 @@ void kmeanspp_selecting_pivots(float *data, size_t num_points, size_t dim, float
     delete[] dist;
 }
 
+// k-means|| (Bahmani et al., 2012). Where k-means++ makes num_centers sequential passes, each ending in a serial dart
+// throw over all points, this makes KMEANS_PARALLEL_ROUNDS parallel passes. Each pass samples every point
+// independently with probability proportional to its squared distance from the candidates so far, about
+// KMEANS_PARALLEL_OVERSAMPLING * num_centers points per round. The candidates, weighted by how many points are
+// closest to them, are then reduced to num_centers with weighted k-means++, which only touches the few thousand
+// candidates.
+void kmeans_parallel_selecting_pivots(float *data, size_t num_points, size_t dim, float *pivot_data,
+                                      size_t num_centers)
+{
+    const size_t oversampling = KMEANS_PARALLEL_OVERSAMPLING * num_centers;
+    if (num_points <= oversampling && num_points <= KMEANSPP_MAX_POINTS)
+    {
+        // every point would be sampled in the first round, so the candidates would be the whole data set
+        kmeanspp_selecting_pivots(data, num_points, dim, pivot_data, num_centers);
+        return;
+    }
+
+    std::random_device rd;
+    const uint32_t seed = rd();
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> int_dist(0, num_points - 1);
+
+    std::vector<size_t> candidates(1, int_dist(generator));
+    std::vector<float> dist(num_points);
+    std::vector<uint32_t> nearest(num_points, 0); // index into candidates
+#pragma omp parallel for schedule(static, 8192)
+    for (int64_t i = 0; i < (int64_t)num_points; i++)
+        dist[i] = math_utils::calc_distance(data + i * dim, data + candidates[0] * dim, dim);
+
+    std::unique_ptr<float[]> new_pivots;
+    std::unique_ptr<uint32_t[]> new_nearest = std::make_unique<uint32_t[]>(num_points);
+    for (uint32_t round = 0; round < KMEANS_PARALLEL_ROUNDS; round++)
+    {
+        double cost = 0;
+#pragma omp parallel for schedule(static, 8192) reduction(+ : cost)
+        for (int64_t i = 0; i < (int64_t)num_points; i++)
+            cost += dist[i];
+        if (cost == 0)
+            break;
+
+        std::vector<std::vector<size_t>> sampled(omp_get_max_threads());
+#pragma omp parallel
+        {
+            std::mt19937 thread_generator(seed + (round + 1) * 7919 + omp_get_thread_num());
+            std::uniform_real_distribution<double> distribution(0, 1);
+            auto &thread_sampled = sampled[omp_get_thread_num()];
+#pragma omp for schedule(static, 8192)
+            for (int64_t i = 0; i < (int64_t)num_points; i++)
+            {
+                if (distribution(thread_generator) * cost < oversampling * (double)dist[i])
+                    thread_sampled.push_back(i);
+            }
+        }
+        const size_t first_new = candidates.size();
+        for (auto &thread_sampled : sampled)
+            candidates.insert(candidates.end(), thread_sampled.begin(), thread_sampled.end());
+        const size_t num_new = candidates.size() - first_new;
+        if (num_new == 0)
+            continue;
+
+        new_pivots = std::make_unique<float[]>(num_new * dim);
+        for (size_t c = 0; c < num_new; c++)
+            std::memcpy(new_pivots.get() + c * dim, data + candidates[first_new + c] * dim, dim * sizeof(float));
+        math_utils::compute_closest_centers(data, num_points, dim, new_pivots.get(), num_new, 1, new_nearest.get());
+#pragma omp parallel for schedule(static, 8192)
+        for (int64_t i = 0; i < (int64_t)num_points; i++)
+        {
+            const float d = math_utils::calc_distance(data + i * dim, new_pivots.get() + new_nearest[i] * dim, dim);
+            if (d < dist[i])
+            {
+                dist[i] = d;
+                nearest[i] = (uint32_t)(first_new + new_nearest[i]);
+            }
+        }
+    }
+    diskann::cout << "k-means|| picked " << candidates.size() << " candidates for " << num_centers << " centers"
+                  << std::endl;
+
+    if (candidates.size() <= num_centers)
+    {
+        for (size_t c = 0; c < num_centers; c++)
+        {
+            const size_t id = c < candidates.size() ? candidates[c] : int_dist(generator);
+            std::memcpy(pivot_data + c * dim, data + id * dim, dim * sizeof(float));
+        }
+        return;
+    }
+
+    std::vector<double> weights(candidates.size(), 0);
+    for (size_t i = 0; i < num_points; i++)
+        weights[nearest[i]] += 1;
+
+    // weighted k-means++ over the candidates
+    const size_t num_candidates = candidates.size();
+    std::vector<double> cand_dist(num_candidates, std::numeric_limits<double>::max());
+    std::uniform_real_distribution<double> distribution(0, 1);
+    size_t picked = std::discrete_distribution<size_t>(weights.begin(), weights.end())(generator);
+    for (size_t c = 0; c < num_centers; c++)
+    {
+        std::memcpy(pivot_data + c * dim, data + candidates[picked] * dim, dim * sizeof(float));
+        if (c + 1 == num_centers)
+            break;
+
+        double total = 0;
+        for (size_t j = 0; j < num_candidates; j++)
+        {
+            const float d = math_utils::calc_distance(data + candidates[j] * dim, pivot_data + c * dim, dim);
+            cand_dist[j] = (std::min)(cand_dist[j], (double)d);
+            total += weights[j] * cand_dist[j];
+        }
+        if (total == 0)
+        {
+            picked = int_dist(generator) % num_candidates;
+            continue;
+        }
+        double dart = distribution(generator) * total;
+        for (picked = 0; picked + 1 < num_candidates; picked++)
+        {
+            dart -= weights[picked] * cand_dist[picked];
+            if (dart < 0)
+                break;
+        }
+    }
+}
+
 } // namespace kmeans
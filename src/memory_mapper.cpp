@@ -3,6 +3,7 @@
 
 #include "logger.h"
 #include "memory_mapper.h"
+#include "ann_exception.h"
 #include <iostream>
 #include <sstream>
 
@@ -71,6 +72,79 @@ MemoryMapper::MemoryMapper(const char *filename)
     }
 #endif
 }
+MemoryMapper::MemoryMapper(const std::string &filename, uint32_t flags) : _buf(nullptr), _fileSize(0)
+{
+    _fileName = nullptr;
+#ifndef _WINDOWS
+    _fd = open(filename.c_str(), O_RDONLY);
+    if (_fd < 0)
+    {
+        throw ANNException("Could not open " + filename + " for mapping", -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    struct stat sb;
+    if (fstat(_fd, &sb) != 0)
+    {
+        close(_fd);
+        throw ANNException("Could not stat " + filename, -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    _fileSize = sb.st_size;
+
+    int map_flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (flags & MMAP_POPULATE)
+        map_flags |= MAP_POPULATE;
+#endif
+    void *buf = mmap(NULL, _fileSize, PROT_READ, map_flags, _fd, 0);
+    if (buf == MAP_FAILED)
+    {
+        close(_fd);
+        throw ANNException("mmap of " + filename + " failed with errno " + std::to_string(errno), -1, __FUNCSIG__,
+                           __FILE__, __LINE__);
+    }
+    _buf = (char *)buf;
+#ifdef MADV_HUGEPAGE
+    if ((flags & MMAP_HUGEPAGES) && madvise(_buf, _fileSize, MADV_HUGEPAGE) != 0)
+    {
+        diskann::cout << "madvise(MADV_HUGEPAGE) not supported for " << filename << ", using base pages"
+                      << std::endl;
+    }
+#endif
+#else
+    _bareFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+    if (_bareFile == INVALID_HANDLE_VALUE)
+    {
+        throw ANNException("CreateFileA(" + filename + ") failed with error " + std::to_string(GetLastError()), -1,
+                           __FUNCSIG__, __FILE__, __LINE__);
+    }
+    _fd = CreateFileMapping(_bareFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (_fd == nullptr)
+    {
+        CloseHandle(_bareFile);
+        throw ANNException("CreateFileMapping(" + filename + ") failed with error " + std::to_string(GetLastError()),
+                           -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    _buf = (char *)MapViewOfFile(_fd, FILE_MAP_READ, 0, 0, 0);
+    if (_buf == nullptr)
+    {
+        CloseHandle(_fd);
+        CloseHandle(_bareFile);
+        throw ANNException("MapViewOfFile(" + filename + ") failed with error " + std::to_string(GetLastError()), -1,
+                           __FUNCSIG__, __FILE__, __LINE__);
+    }
+    LARGE_INTEGER fSize;
+    if (TRUE == GetFileSizeEx(_bareFile, &fSize))
+    {
+        _fileSize = fSize.QuadPart;
+    }
+    if (flags & MMAP_POPULATE)
+    {
+        WIN32_MEMORY_RANGE_ENTRY range = {_buf, _fileSize};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#endif
+}
+
 char *MemoryMapper::getBuf()
 {
     return _buf;
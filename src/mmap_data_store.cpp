@@ -0,0 +1,198 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "mmap_data_store.h"
+#include "mmap_store_file.h"
+
+#include "timer.h"
+#include "utils.h"
+
+namespace diskann
+{
+
+template <typename data_t>
+MmapDataStore<data_t>::MmapDataStore(const location_t capacity, const size_t dim,
+                                     std::unique_ptr<Distance<data_t>> distance_fn, const uint32_t mmap_flags)
+    : InMemDataStore<data_t>(capacity, dim, std::move(distance_fn), false), _mmap_flags(mmap_flags)
+{
+    // vectors come from the mapping; nothing is stored in process memory
+}
+
+template <typename data_t> MmapDataStore<data_t>::~MmapDataStore()
+{
+    // the base destructor frees _data, which here points into the mapping
+    this->_data = nullptr;
+    _mapper.reset();
+}
+
+template <typename data_t> location_t MmapDataStore<data_t>::load(const std::string &filename)
+{
+    if (!file_exists(filename))
+    {
+        std::stringstream stream;
+        stream << "ERROR: data file " << filename << " does not exist." << std::endl;
+        diskann::cerr << stream.str() << std::endl;
+        throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    const std::string mmap_file = get_mmap_store_file(filename);
+    MmapStoreHeader header;
+    if (!read_mmap_store_header(mmap_file, filename, MMAP_DATA_MAGIC, header))
+    {
+        convert_data_file(filename, mmap_file);
+        if (!read_mmap_store_header(mmap_file, filename, MMAP_DATA_MAGIC, header))
+        {
+            throw diskann::ANNException("ERROR: could not read back converted data file " + mmap_file, -1,
+                                        __FUNCSIG__, __FILE__, __LINE__);
+        }
+    }
+
+    if (header.dim != this->_dim || header.row_stride != this->_aligned_dim || header.elem_size != sizeof(data_t))
+    {
+        std::stringstream stream;
+        stream << "ERROR: " << mmap_file << " holds " << header.dim << "-dimensional vectors of " << header.elem_size
+               << " bytes with stride " << header.row_stride << ", but the index expects dimension " << this->_dim
+               << ", " << sizeof(data_t) << " bytes and stride " << this->_aligned_dim << std::endl;
+        diskann::cerr << stream.str() << std::endl;
+        throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    auto mapper = std::make_unique<MemoryMapper>(mmap_file, _mmap_flags);
+    if (mapper->getFileSize() < MMAP_STORE_HEADER_SIZE + header.num_rows * header.row_stride * sizeof(data_t))
+    {
+        throw diskann::ANNException("ERROR: " + mmap_file + " is shorter than its header says", -1, __FUNCSIG__,
+                                    __FILE__, __LINE__);
+    }
+    _mapper = std::move(mapper);
+    this->_data = (data_t *)(_mapper->getBuf() + MMAP_STORE_HEADER_SIZE);
+
+    diskann::cout << "Mapped " << header.num_rows << " vectors from " << mmap_file << std::endl;
+    return (location_t)header.num_rows;
+}
+
+template <typename data_t>
+void MmapDataStore<data_t>::convert_data_file(const std::string &data_file, const std::string &mmap_file)
+{
+    size_t npts, dim;
+    diskann::get_bin_metadata(data_file, npts, dim);
+    if (dim != this->_dim)
+    {
+        std::stringstream stream;
+        stream << "ERROR: Driver requests loading " << this->_dim << " dimension,"
+               << "but file has " << dim << " dimension." << std::endl;
+        diskann::cerr << stream.str() << std::endl;
+        throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    diskann::cout << "Converting " << data_file << " to mappable layout " << mmap_file << "..." << std::flush;
+    Timer timer;
+
+    MmapStoreHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MMAP_DATA_MAGIC;
+    header.version = MMAP_STORE_VERSION;
+    get_mmap_store_source_stamp(data_file, header.source_size, header.source_mtime);
+    header.num_rows = npts;
+    header.row_stride = this->_aligned_dim;
+    header.elem_size = sizeof(data_t);
+    header.dim = dim;
+
+    const std::string temp_file = get_mmap_store_temp_file(mmap_file);
+    try
+    {
+        std::ifstream in;
+        in.exceptions(std::ios::badbit | std::ios::failbit);
+        in.open(data_file, std::ios::binary);
+        in.seekg(2 * sizeof(uint32_t), in.beg);
+
+        std::ofstream out;
+        out.exceptions(std::ios::badbit | std::ios::failbit);
+        out.open(temp_file, std::ios::binary | std::ios::trunc);
+        write_mmap_store_header(out, header);
+
+        // copy in blocks of about 64MB, padding each vector to the aligned dimension
+        const size_t block_size = (std::max)((size_t)1, ((size_t)64 << 20) / (this->_aligned_dim * sizeof(data_t)));
+        std::vector<data_t> in_block(block_size * dim);
+        std::vector<data_t> out_block(block_size * this->_aligned_dim, 0);
+        for (size_t block_start = 0; block_start < npts; block_start += block_size)
+        {
+            const size_t block_pts = (std::min)(block_size, npts - block_start);
+            in.read((char *)in_block.data(), block_pts * dim * sizeof(data_t));
+            for (size_t i = 0; i < block_pts; i++)
+            {
+                memcpy(out_block.data() + i * this->_aligned_dim, in_block.data() + i * dim, dim * sizeof(data_t));
+            }
+            out.write((char *)out_block.data(), block_pts * this->_aligned_dim * sizeof(data_t));
+        }
+        out.close();
+    }
+    catch (std::system_error &e)
+    {
+        std::remove(temp_file.c_str());
+        throw FileException(data_file, e, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    publish_mmap_store_file(temp_file, mmap_file);
+
+    diskann::cout << "done in " << timer.elapsed_seconds() << "s" << std::endl;
+}
+
+template <typename data_t>
+void MmapDataStore<data_t>::throw_read_only(const std::string &operation) const
+{
+    throw diskann::ANNException("MmapDataStore is read-only: " + operation + " is not supported", -1, __FUNCSIG__,
+                                __FILE__, __LINE__);
+}
+
+template <typename data_t> void MmapDataStore<data_t>::populate_data(const data_t *, const location_t)
+{
+    throw_read_only("populate_data");
+}
+
+template <typename data_t> void MmapDataStore<data_t>::populate_data(const std::string &, const size_t)
+{
+    throw_read_only("populate_data");
+}
+
+template <typename data_t> void MmapDataStore<data_t>::set_vector(const location_t, const data_t *const)
+{
+    throw_read_only("set_vector");
+}
+
+template <typename data_t>
+void MmapDataStore<data_t>::move_vectors(const location_t old_location_start, const location_t new_location_start,
+                                         const location_t num_points)
+{
+    if (num_points == 0 || old_location_start == new_location_start)
+        return;
+    throw_read_only("move_vectors");
+}
+
+template <typename data_t>
+void MmapDataStore<data_t>::copy_vectors(const location_t, const location_t, const location_t num_points)
+{
+    if (num_points == 0)
+        return;
+    throw_read_only("copy_vectors");
+}
+
+template <typename data_t> location_t MmapDataStore<data_t>::expand(const location_t new_size)
+{
+    if (_mapper != nullptr && new_size != this->capacity())
+        throw_read_only("expand");
+    this->_capacity = new_size;
+    return this->_capacity;
+}
+
+template <typename data_t> location_t MmapDataStore<data_t>::shrink(const location_t new_size)
+{
+    // not shrinking a mapped store is allowed; callers check the returned capacity
+    if (_mapper == nullptr)
+        this->_capacity = new_size;
+    return this->_capacity;
+}
+
+template DISKANN_DLLEXPORT class MmapDataStore<float>;
+template DISKANN_DLLEXPORT class MmapDataStore<int8_t>;
+template DISKANN_DLLEXPORT class MmapDataStore<uint8_t>;
+
+} // namespace diskann
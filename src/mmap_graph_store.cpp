@@ -0,0 +1,192 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "mmap_graph_store.h"
+#include "mmap_store_file.h"
+#include "timer.h"
+#include "utils.h"
+
+namespace diskann
+{
+MmapGraphStore::MmapGraphStore(const size_t total_pts, const size_t reserve_graph_degree, const uint32_t mmap_flags)
+    : InMemFlatGraphStore(0, reserve_graph_degree), _mmap_flags(mmap_flags)
+{
+    set_total_points(total_pts);
+}
+
+MmapGraphStore::~MmapGraphStore()
+{
+    clear_graph();
+}
+
+std::tuple<uint32_t, uint32_t, size_t> MmapGraphStore::load(const std::string &index_path_prefix,
+                                                            const size_t num_points)
+{
+    const std::string mmap_file = get_mmap_store_file(index_path_prefix);
+    MmapStoreHeader header;
+    if (!read_mmap_store_header(mmap_file, index_path_prefix, MMAP_GRAPH_MAGIC, header))
+    {
+        convert_graph_file(index_path_prefix, mmap_file);
+        if (!read_mmap_store_header(mmap_file, index_path_prefix, MMAP_GRAPH_MAGIC, header))
+        {
+            throw ANNException("Could not read back converted graph file " + mmap_file, -1, __FUNCSIG__, __FILE__,
+                               __LINE__);
+        }
+    }
+    if (header.elem_size != sizeof(uint32_t) || header.row_stride % FLAT_GRAPH_SLOT_ALIGN_WORDS != 0)
+    {
+        throw ANNException(mmap_file + " does not hold flat graph slots", -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    auto mapper = std::make_unique<MemoryMapper>(mmap_file, _mmap_flags);
+    if (mapper->getFileSize() < MMAP_STORE_HEADER_SIZE + header.num_rows * header.row_stride * sizeof(uint32_t))
+    {
+        throw ANNException(mmap_file + " is shorter than its header says", -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    clear_graph();
+    _mapper = std::move(mapper);
+    _slots = (uint32_t *)(_mapper->getBuf() + MMAP_STORE_HEADER_SIZE);
+    _num_slots = header.num_rows;
+    _stride = header.row_stride;
+    _max_degree = header.row_stride - 1;
+    _max_observed_degree = (uint32_t)header.max_observed_degree;
+    _max_range_of_graph = header.dim;
+    set_total_points((std::max)(_num_slots, num_points));
+
+    diskann::cout << "Mapped " << header.num_rows << " graph nodes from " << mmap_file << ", _start is set to "
+                  << header.start << std::endl;
+    return std::make_tuple((uint32_t)header.num_rows, (uint32_t)header.start, (size_t)header.num_frozen_pts);
+}
+
+void MmapGraphStore::convert_graph_file(const std::string &graph_file, const std::string &mmap_file)
+{
+    diskann::cout << "Converting " << graph_file << " to mappable slots " << mmap_file << "..." << std::flush;
+    Timer timer;
+
+    MmapStoreHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MMAP_GRAPH_MAGIC;
+    header.version = MMAP_STORE_VERSION;
+    header.elem_size = sizeof(uint32_t);
+    get_mmap_store_source_stamp(graph_file, header.source_size, header.source_mtime);
+
+    const std::string temp_file = get_mmap_store_temp_file(mmap_file);
+    try
+    {
+        std::ifstream in;
+        in.exceptions(std::ios::badbit | std::ios::failbit);
+        in.open(graph_file, std::ios::binary);
+
+        size_t expected_file_size, file_frozen_pts;
+        uint32_t max_observed_degree, start;
+        in.read((char *)&expected_file_size, sizeof(size_t));
+        in.read((char *)&max_observed_degree, sizeof(uint32_t));
+        in.read((char *)&start, sizeof(uint32_t));
+        in.read((char *)&file_frozen_pts, sizeof(size_t));
+        size_t bytes_read = sizeof(size_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(size_t);
+
+        header.row_stride = ROUND_UP(1 + (size_t)max_observed_degree, FLAT_GRAPH_SLOT_ALIGN_WORDS);
+        header.max_observed_degree = max_observed_degree;
+        header.start = start;
+        header.num_frozen_pts = file_frozen_pts;
+
+        std::ofstream out;
+        out.exceptions(std::ios::badbit | std::ios::failbit);
+        out.open(temp_file, std::ios::binary | std::ios::trunc);
+        write_mmap_store_header(out, header);
+
+        std::vector<uint32_t> slot(header.row_stride);
+        while (bytes_read != expected_file_size)
+        {
+            uint32_t k;
+            in.read((char *)&k, sizeof(uint32_t));
+            if (k > header.row_stride - 1)
+            {
+                throw ANNException("Graph file " + graph_file + " has a node of degree " + std::to_string(k) +
+                                       " above the maximum " + std::to_string(max_observed_degree) + " in its header",
+                                   -1, __FUNCSIG__, __FILE__, __LINE__);
+            }
+            slot[0] = k;
+            in.read((char *)(slot.data() + 1), k * sizeof(uint32_t));
+            std::fill(slot.begin() + 1 + k, slot.end(), 0);
+            out.write((char *)slot.data(), slot.size() * sizeof(uint32_t));
+
+            header.dim = (std::max)(header.dim, (uint64_t)k);
+            header.num_rows++;
+            bytes_read += sizeof(uint32_t) * ((size_t)k + 1);
+        }
+
+        write_mmap_store_header(out, header);
+        out.close();
+    }
+    catch (std::system_error &e)
+    {
+        std::remove(temp_file.c_str());
+        throw FileException(graph_file, e, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    catch (...)
+    {
+        std::remove(temp_file.c_str());
+        throw;
+    }
+    publish_mmap_store_file(temp_file, mmap_file);
+
+    diskann::cout << "done in " << timer.elapsed_seconds() << "s" << std::endl;
+}
+
+void MmapGraphStore::throw_read_only(const std::string &operation) const
+{
+    throw ANNException("MmapGraphStore is read-only: " + operation + " is not supported", -1, __FUNCSIG__, __FILE__,
+                       __LINE__);
+}
+
+bool MmapGraphStore::lock_free_reads() const
+{
+    return true;
+}
+
+void MmapGraphStore::add_neighbour(const location_t, location_t)
+{
+    throw_read_only("add_neighbour");
+}
+
+void MmapGraphStore::clear_neighbours(const location_t)
+{
+    throw_read_only("clear_neighbours");
+}
+
+void MmapGraphStore::swap_neighbours(const location_t a, location_t b)
+{
+    if (a != b)
+        throw_read_only("swap_neighbours");
+}
+
+void MmapGraphStore::set_neighbours(const location_t, std::vector<location_t> &)
+{
+    throw_read_only("set_neighbours");
+}
+
+size_t MmapGraphStore::resize_graph(const size_t new_size)
+{
+    if (_mapper != nullptr && new_size > _num_slots)
+        throw_read_only("resize_graph");
+    set_total_points(new_size);
+    return new_size;
+}
+
+void MmapGraphStore::clear_graph()
+{
+    if (_mapper != nullptr)
+    {
+        _slots = nullptr;
+        _num_slots = 0;
+        _mapper.reset();
+    }
+    else
+    {
+        InMemFlatGraphStore::clear_graph();
+    }
+}
+
+} // namespace diskann
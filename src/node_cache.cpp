@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "node_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "ann_exception.h"
+
+#define SKETCH_DEPTH 4
+#define SKETCH_COUNTER_MAX 15
+// counters per cached slot, and requests per slot between sketch halvings
+#define SKETCH_WIDTH_PER_SLOT 4
+#define SKETCH_SAMPLE_PER_SLOT 10
+
+namespace diskann
+{
+
+namespace
+{
+inline uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline uint64_t sketch_index(uint32_t id, uint32_t row, uint64_t width)
+{
+    return row * width + (mix64(((uint64_t)row << 32) | id) & (width - 1));
+}
+} // namespace
+
+NodeCache::NodeCache(uint64_t budget_bytes, uint64_t node_len, uint32_t num_shards) : _node_len(node_len)
+{
+    if (node_len == 0 || num_shards == 0)
+    {
+        throw ANNException("NodeCache needs a non-zero node length and shard count", -1, __FUNCSIG__, __FILE__,
+                           __LINE__);
+    }
+    uint64_t total_slots = budget_bytes / node_len;
+    num_shards = (uint32_t)(std::max)((uint64_t)1, (std::min)((uint64_t)num_shards, total_slots));
+    _slots_per_shard = (uint32_t)(total_slots / num_shards);
+
+    _sketch_width = 16;
+    while (_sketch_width < (uint64_t)_slots_per_shard * SKETCH_WIDTH_PER_SLOT)
+        _sketch_width <<= 1;
+    _sample_size = (std::max)((uint64_t)64, (uint64_t)_slots_per_shard * SKETCH_SAMPLE_PER_SLOT);
+
+    for (uint32_t s = 0; s < num_shards; s++)
+    {
+        std::unique_ptr<Shard> shard(new Shard());
+        shard->records.resize((uint64_t)_slots_per_shard * node_len);
+        shard->slot_to_id.resize(_slots_per_shard);
+        shard->slot_of.reserve(_slots_per_shard);
+        shard->referenced.reset(new std::atomic<uint8_t>[_slots_per_shard]);
+        for (uint32_t i = 0; i < _slots_per_shard; i++)
+            shard->referenced[i].store(0, std::memory_order_relaxed);
+        shard->sketch.reset(new std::atomic<uint8_t>[SKETCH_DEPTH * _sketch_width]);
+        for (uint64_t i = 0; i < SKETCH_DEPTH * _sketch_width; i++)
+            shard->sketch[i].store(0, std::memory_order_relaxed);
+        _shards.emplace_back(std::move(shard));
+    }
+}
+
+uint32_t NodeCache::shard_of(uint32_t id) const
+{
+    return (uint32_t)((mix64(id) >> 32) % _shards.size());
+}
+
+void NodeCache::record_request(Shard &shard, uint32_t id)
+{
+    // counters are approximate by design, so relaxed racy increments are fine
+    for (uint32_t row = 0; row < SKETCH_DEPTH; row++)
+    {
+        auto &counter = shard.sketch[sketch_index(id, row, _sketch_width)];
+        uint8_t val = counter.load(std::memory_order_relaxed);
+        if (val < SKETCH_COUNTER_MAX)
+            counter.store(val + 1, std::memory_order_relaxed);
+    }
+    if (shard.num_requests.fetch_add(1, std::memory_order_relaxed) + 1 == _sample_size)
+        age_sketch(shard);
+}
+
+uint32_t NodeCache::estimate(const Shard &shard, uint32_t id) const
+{
+    uint32_t freq = SKETCH_COUNTER_MAX;
+    for (uint32_t row = 0; row < SKETCH_DEPTH; row++)
+        freq = (std::min)(freq, (uint32_t)shard.sketch[sketch_index(id, row, _sketch_width)].load(
+                                    std::memory_order_relaxed));
+    return freq;
+}
+
+void NodeCache::age_sketch(Shard &shard)
+{
+    for (uint64_t i = 0; i < SKETCH_DEPTH * _sketch_width; i++)
+        shard.sketch[i].store(shard.sketch[i].load(std::memory_order_relaxed) >> 1, std::memory_order_relaxed);
+    shard.num_requests.store(0, std::memory_order_relaxed);
+}
+
+void NodeCache::admit(uint32_t id, const char *node_buf)
+{
+    if (_slots_per_shard == 0)
+        return;
+    Shard &shard = *_shards[shard_of(id)];
+    uint32_t candidate_freq = estimate(shard, id);
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (shard.slot_of.find(id) != shard.slot_of.end())
+        return;
+
+    uint32_t slot;
+    if (shard.num_used < _slots_per_shard)
+    {
+        slot = shard.num_used++;
+    }
+    else
+    {
+        // CLOCK: clear reference bits until an unreferenced victim turns up; two sweeps always find one
+        for (;;)
+        {
+            slot = shard.hand;
+            shard.hand = (shard.hand + 1) % _slots_per_shard;
+            if (shard.referenced[slot].load(std::memory_order_relaxed) == 0)
+                break;
+            shard.referenced[slot].store(0, std::memory_order_relaxed);
+        }
+        // TinyLFU admission: keep the victim unless the candidate is requested more often
+        uint32_t victim = shard.slot_to_id[slot];
+        if (candidate_freq <= estimate(shard, victim))
+            return;
+        shard.slot_of.erase(victim);
+    }
+
+    memcpy(shard.records.data() + (uint64_t)slot * _node_len, node_buf, _node_len);
+    shard.slot_to_id[slot] = id;
+    shard.slot_of[id] = slot;
+    shard.referenced[slot].store(0, std::memory_order_relaxed);
+}
+
+uint64_t NodeCache::capacity() const
+{
+    return (uint64_t)_slots_per_shard * _shards.size();
+}
+
+uint64_t NodeCache::size() const
+{
+    uint64_t total = 0;
+    for (auto &shard : _shards)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        total += shard->num_used;
+    }
+    return total;
+}
+
+} // namespace diskann
@@ -0,0 +1,140 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "numa_utils.h"
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <omp.h>
+
+#ifndef _WINDOWS
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace diskann
+{
+
+namespace
+{
+// parses a sysfs cpu list such as "0-15,32-47"
+std::vector<uint32_t> parse_cpu_list(const std::string &list)
+{
+    std::vector<uint32_t> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        if (range.empty() || range == "\n")
+            continue;
+        const size_t dash = range.find('-');
+        const uint32_t first = (uint32_t)std::stoul(range.substr(0, dash));
+        const uint32_t last = dash == std::string::npos ? first : (uint32_t)std::stoul(range.substr(dash + 1));
+        for (uint32_t cpu = first; cpu <= last; cpu++)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+} // namespace
+
+NumaTopology::NumaTopology()
+{
+#ifndef _WINDOWS
+    for (uint32_t node = 0;; node++)
+    {
+        std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!cpulist.is_open())
+            break;
+        std::string list;
+        std::getline(cpulist, list);
+        _node_cpus.push_back(parse_cpu_list(list));
+    }
+#endif
+    if (_node_cpus.empty())
+    {
+        _node_cpus.emplace_back();
+        for (uint32_t cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++)
+            _node_cpus[0].push_back(cpu);
+    }
+
+    for (uint32_t node = 0; node < _node_cpus.size(); node++)
+    {
+        for (const uint32_t cpu : _node_cpus[node])
+        {
+            if (cpu >= _cpu_to_node.size())
+                _cpu_to_node.resize(cpu + 1, 0);
+            _cpu_to_node[cpu] = node;
+        }
+    }
+}
+
+const NumaTopology &NumaTopology::get()
+{
+    static const NumaTopology topology;
+    return topology;
+}
+
+uint32_t NumaTopology::current_node() const
+{
+    if (_node_cpus.size() == 1)
+        return 0;
+#ifndef _WINDOWS
+    const int cpu = sched_getcpu();
+    if (cpu >= 0 && (size_t)cpu < _cpu_to_node.size())
+        return _cpu_to_node[cpu];
+#endif
+    return 0;
+}
+
+int32_t numa_node_of(const void *addr)
+{
+    if (addr == nullptr)
+        return -1;
+    if (NumaTopology::get().num_nodes() == 1)
+        return 0;
+#if !defined(_WINDOWS) && defined(SYS_move_pages)
+    // move_pages with no target nodes only reports where each page lives
+    void *page = (void *)((uintptr_t)addr & ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1));
+    int status = -1;
+    if (syscall(SYS_move_pages, 0, 1, &page, nullptr, &status, 0) == 0 && status >= 0)
+        return status;
+#endif
+    return -1;
+}
+
+bool pin_current_thread_to_numa_node(const uint32_t node)
+{
+#ifndef _WINDOWS
+    const NumaTopology &topology = NumaTopology::get();
+    if (node >= topology.num_nodes() || topology.node_cpus(node).empty())
+        return false;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (const uint32_t cpu : topology.node_cpus(node))
+        CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+bool pin_omp_threads_to_numa_nodes(const uint32_t num_threads)
+{
+    const uint32_t num_nodes = NumaTopology::get().num_nodes();
+    std::atomic<bool> pinned(true);
+#pragma omp parallel num_threads(num_threads)
+    {
+        if (!pin_current_thread_to_numa_node((uint32_t)omp_get_thread_num() % num_nodes))
+            pinned = false;
+    }
+    return pinned;
+}
+
+} // namespace diskann
@@ -480,7 +480,7 @@ int retrieve_shard_data_from_ids(const std::string data_file, std::string idmap_
 
 template <typename T>
 int partition(const std::string data_file, const float sampling_rate, size_t num_parts, size_t max_k_means_reps,
-              const std::string prefix_path, size_t k_base)
+              const std::string prefix_path, size_t k_base, const bool kmeans_parallel_seeding)
 {
     size_t train_dim;
     size_t num_train;
@@ -503,7 +503,10 @@ int partition(const std::string data_file, const float sampling_rate, size_t num
 
     // Process Global k-means for kmeans_partitioning Step
     diskann::cout << "Processing global k-means (kmeans_partitioning Step)" << std::endl;
-    kmeans::kmeanspp_selecting_pivots(train_data_float, num_train, train_dim, pivot_data, num_parts);
+    if (kmeans_parallel_seeding)
+        kmeans::kmeans_parallel_selecting_pivots(train_data_float, num_train, train_dim, pivot_data, num_parts);
+    else
+        kmeans::kmeanspp_selecting_pivots(train_data_float, num_train, train_dim, pivot_data, num_parts);
 
     kmeans::run_lloyds(train_data_float, num_train, train_dim, pivot_data, num_parts, max_k_means_reps, NULL, NULL);
 
@@ -521,7 +524,8 @@ int partition(const std::string data_file, const float sampling_rate, size_t num
 
 template <typename T>
 int partition_with_ram_budget(const std::string data_file, const double sampling_rate, double ram_budget,
-                              size_t graph_degree, const std::string prefix_path, size_t k_base)
+                              size_t graph_degree, const std::string prefix_path, size_t k_base,
+                              const bool kmeans_parallel_seeding)
 {
     size_t train_dim;
     size_t num_train;
@@ -560,7 +564,10 @@ int partition_with_ram_budget(const std::string data_file, const double sampling
         pivot_data = new float[num_parts * train_dim];
         // Process Global k-means for kmeans_partitioning Step
         diskann::cout << "Processing global k-means (kmeans_partitioning Step)" << std::endl;
-        kmeans::kmeanspp_selecting_pivots(train_data_float, num_train, train_dim, pivot_data, num_parts);
+        if (kmeans_parallel_seeding)
+            kmeans::kmeans_parallel_selecting_pivots(train_data_float, num_train, train_dim, pivot_data, num_parts);
+        else
+            kmeans::kmeanspp_selecting_pivots(train_data_float, num_train, train_dim, pivot_data, num_parts);
 
         kmeans::run_lloyds(train_data_float, num_train, train_dim, pivot_data, num_parts, max_k_means_reps, NULL, NULL);
 
@@ -626,25 +633,29 @@ template void DISKANN_DLLEXPORT gen_random_slice<int8_t>(const std::string data_
 
 template DISKANN_DLLEXPORT int partition<int8_t>(const std::string data_file, const float sampling_rate,
                                                  size_t num_centers, size_t max_k_means_reps,
-                                                 const std::string prefix_path, size_t k_base);
+                                                 const std::string prefix_path, size_t k_base,
+                                                 const bool kmeans_parallel_seeding);
 template DISKANN_DLLEXPORT int partition<uint8_t>(const std::string data_file, const float sampling_rate,
                                                   size_t num_centers, size_t max_k_means_reps,
-                                                  const std::string prefix_path, size_t k_base);
+                                                  const std::string prefix_path, size_t k_base,
+                                                  const bool kmeans_parallel_seeding);
 template DISKANN_DLLEXPORT int partition<float>(const std::string data_file, const float sampling_rate,
                                                 size_t num_centers, size_t max_k_means_reps,
-                                                const std::string prefix_path, size_t k_base);
+                                                const std::string prefix_path, size_t k_base,
+                                                const bool kmeans_parallel_seeding);
 
 template DISKANN_DLLEXPORT int partition_with_ram_budget<int8_t>(const std::string data_file,
                                                                  const double sampling_rate, double ram_budget,
                                                                  size_t graph_degree, const std::string prefix_path,
-                                                                 size_t k_base);
+                                                                 size_t k_base, const bool kmeans_parallel_seeding);
 template DISKANN_DLLEXPORT int partition_with_ram_budget<uint8_t>(const std::string data_file,
                                                                   const double sampling_rate, double ram_budget,
                                                                   size_t graph_degree, const std::string prefix_path,
-                                                                  size_t k_base);
+                                                                  size_t k_base, const bool kmeans_parallel_seeding);
 template DISKANN_DLLEXPORT int partition_with_ram_budget<float>(const std::string data_file, const double sampling_rate,
                                                                 double ram_budget, size_t graph_degree,
-                                                                const std::string prefix_path, size_t k_base);
+                                                                const std::string prefix_path, size_t k_base,
+                                                                const bool kmeans_parallel_seeding);
 
 template DISKANN_DLLEXPORT int retrieve_shard_data_from_ids<float>(const std::string data_file,
                                                                    std::string idmap_filename,
@@ -9,6 +9,11 @@
 #include "partition.h"
 #include "math_utils.h"
 #include "tsl/robin_map.h"
+#include <future>
+#include <random>
+#ifdef USE_AVX2
+#include <immintrin.h>
+#endif
 
 // block size for reading/processing large files and matrices in blocks
 #define BLOCK_SIZE 5000000
@@ -344,6 +349,134 @@ void pq_dist_lookup(const uint8_t *pq_ids, const size_t n_pts, const size_t pq_n
     }
 }
 
+void aggregate_coords_transposed(const uint32_t *ids, const size_t n_ids, const uint8_t *all_coords,
+                                 const size_t ndims, uint8_t *out)
+{
+    if (n_ids == 0)
+        return;
+    size_t n_blocks = DIV_ROUND_UP(n_ids, PQ_TRANSPOSE_BLOCK);
+    // zero the padding lanes of the last block so that they look up valid table entries
+    memset(out + (n_blocks - 1) * ndims * PQ_TRANSPOSE_BLOCK, 0, ndims * PQ_TRANSPOSE_BLOCK * sizeof(uint8_t));
+    size_t i = 0;
+#ifdef USE_AVX2
+    // Transpose 8 points x 4 chunks at a time: gather 4 code bytes from each of 8 rows, regroup the bytes by chunk,
+    // and store 8 codes per chunk.
+    const __m256i group_by_chunk = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12,
+                                                    1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m256i join_halves = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for (; i + 8 <= n_ids; i += 8)
+    {
+        uint8_t *group_out = out + (i / PQ_TRANSPOSE_BLOCK) * ndims * PQ_TRANSPOSE_BLOCK + (i % PQ_TRANSPOSE_BLOCK);
+        __m256i rows_lo = _mm256_setr_epi64x(ids[i] * ndims, ids[i + 1] * ndims, ids[i + 2] * ndims,
+                                             ids[i + 3] * ndims);
+        __m256i rows_hi = _mm256_setr_epi64x(ids[i + 4] * ndims, ids[i + 5] * ndims, ids[i + 6] * ndims,
+                                             ids[i + 7] * ndims);
+        size_t chunk = 0;
+        for (; chunk + 4 <= ndims; chunk += 4)
+        {
+            const int *chunk_base = (const int *)(all_coords + chunk);
+            __m256i words = _mm256_set_m128i(_mm256_i64gather_epi32(chunk_base, rows_hi, 1),
+                                             _mm256_i64gather_epi32(chunk_base, rows_lo, 1));
+            words = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(words, group_by_chunk), join_halves);
+            uint64_t chunk_codes[4];
+            _mm256_storeu_si256((__m256i *)chunk_codes, words);
+            for (size_t k = 0; k < 4; k++)
+            {
+                memcpy(group_out + (chunk + k) * PQ_TRANSPOSE_BLOCK, &chunk_codes[k], sizeof(uint64_t));
+            }
+        }
+        for (; chunk < ndims; chunk++)
+        {
+            for (size_t lane = 0; lane < 8; lane++)
+            {
+                group_out[chunk * PQ_TRANSPOSE_BLOCK + lane] = all_coords[ids[i + lane] * ndims + chunk];
+            }
+        }
+    }
+#endif
+    for (; i < n_ids; i++)
+    {
+        const uint8_t *code = all_coords + ids[i] * ndims;
+        uint8_t *block_out = out + (i / PQ_TRANSPOSE_BLOCK) * ndims * PQ_TRANSPOSE_BLOCK + (i % PQ_TRANSPOSE_BLOCK);
+        for (size_t chunk = 0; chunk < ndims; chunk++)
+        {
+            block_out[chunk * PQ_TRANSPOSE_BLOCK] = code[chunk];
+        }
+    }
+}
+
+void aggregate_coords_transposed(const std::vector<uint32_t> &ids, const uint8_t *all_coords, const size_t ndims,
+                                 uint8_t *out)
+{
+    aggregate_coords_transposed(ids.data(), ids.size(), all_coords, ndims, out);
+}
+
+void pq_dist_lookup_transposed(const uint8_t *pq_ids, const size_t n_pts, const size_t pq_nchunks,
+                               const float *pq_dists, float *dists_out)
+{
+    size_t n_blocks = DIV_ROUND_UP(n_pts, PQ_TRANSPOSE_BLOCK);
+    for (size_t block = 0; block < n_blocks; block++)
+    {
+        const uint8_t *block_ids = pq_ids + block * pq_nchunks * PQ_TRANSPOSE_BLOCK;
+        size_t n_block_pts = (std::min)((size_t)PQ_TRANSPOSE_BLOCK, n_pts - block * PQ_TRANSPOSE_BLOCK);
+        float *block_out = dists_out + block * PQ_TRANSPOSE_BLOCK;
+#ifdef USE_AVX2
+        // one chunk's codes for all 32 points are contiguous: widen them 8 at a time and gather their table
+        // entries, keeping four independent accumulators in flight
+        __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+        __m256 sum2 = _mm256_setzero_ps(), sum3 = _mm256_setzero_ps();
+        for (size_t chunk = 0; chunk < pq_nchunks; chunk++)
+        {
+            const float *chunk_dists = pq_dists + 256 * chunk;
+            const uint8_t *chunk_ids = block_ids + chunk * PQ_TRANSPOSE_BLOCK;
+            __m128i codes_lo = _mm_loadu_si128((const __m128i *)chunk_ids);
+            __m128i codes_hi = _mm_loadu_si128((const __m128i *)(chunk_ids + 16));
+            sum0 = _mm256_add_ps(sum0, _mm256_i32gather_ps(chunk_dists, _mm256_cvtepu8_epi32(codes_lo), 4));
+            sum1 = _mm256_add_ps(
+                sum1, _mm256_i32gather_ps(chunk_dists, _mm256_cvtepu8_epi32(_mm_srli_si128(codes_lo, 8)), 4));
+            sum2 = _mm256_add_ps(sum2, _mm256_i32gather_ps(chunk_dists, _mm256_cvtepu8_epi32(codes_hi), 4));
+            sum3 = _mm256_add_ps(
+                sum3, _mm256_i32gather_ps(chunk_dists, _mm256_cvtepu8_epi32(_mm_srli_si128(codes_hi, 8)), 4));
+        }
+        if (n_block_pts == PQ_TRANSPOSE_BLOCK)
+        {
+            _mm256_storeu_ps(block_out, sum0);
+            _mm256_storeu_ps(block_out + 8, sum1);
+            _mm256_storeu_ps(block_out + 16, sum2);
+            _mm256_storeu_ps(block_out + 24, sum3);
+        }
+        else
+        {
+            float tail[PQ_TRANSPOSE_BLOCK];
+            _mm256_storeu_ps(tail, sum0);
+            _mm256_storeu_ps(tail + 8, sum1);
+            _mm256_storeu_ps(tail + 16, sum2);
+            _mm256_storeu_ps(tail + 24, sum3);
+            memcpy(block_out, tail, n_block_pts * sizeof(float));
+        }
+#else
+        float sums[PQ_TRANSPOSE_BLOCK] = {0};
+        for (size_t chunk = 0; chunk < pq_nchunks; chunk++)
+        {
+            const float *chunk_dists = pq_dists + 256 * chunk;
+            const uint8_t *chunk_ids = block_ids + chunk * PQ_TRANSPOSE_BLOCK;
+            for (size_t lane = 0; lane < PQ_TRANSPOSE_BLOCK; lane++)
+            {
+                sums[lane] += chunk_dists[chunk_ids[lane]];
+            }
+        }
+        memcpy(block_out, sums, n_block_pts * sizeof(float));
+#endif
+    }
+}
+
+void pq_dist_lookup_transposed(const uint8_t *pq_ids, const size_t n_pts, const size_t pq_nchunks,
+                               const float *pq_dists, std::vector<float> &dists_out)
+{
+    dists_out.resize(n_pts);
+    pq_dist_lookup_transposed(pq_ids, n_pts, pq_nchunks, pq_dists, dists_out.data());
+}
+
 // generate_pq_pivots_simplified is a simplified version of generate_pq_pivots.
 // Input is provided in the in-memory buffer train_data.
 // Output is stored in the in-memory buffer pivot_data_vector.
@@ -403,6 +536,79 @@ int generate_pq_pivots_simplified(const float *train_data, size_t num_train, siz
     return 0;
 }
 
+namespace
+{
+// Runs k-means over dimensions [chunk_begin, chunk_end) of the training points and writes the resulting pivots into
+// those columns of full_pivot_data. The pivots start from k-means++ (k-means|| with kmeans_parallel_seeding), or
+// from full_pivot_data itself when warm_start is set. A batch_size of 0 runs Lloyd's iterations over all points;
+// otherwise mini-batch k-means on batches of batch_size points, seeded from a sample of three batches.
+// closest_center, if not null, receives the final assignment of every training point.
+void train_chunk_pivots(const float *train_data, size_t num_train, size_t dim, size_t chunk_begin, size_t chunk_end,
+                        size_t num_centers, size_t max_reps, size_t batch_size, bool warm_start, float *full_pivot_data,
+                        uint32_t *closest_center, bool kmeans_parallel_seeding)
+{
+    const auto select_pivots =
+        kmeans_parallel_seeding ? kmeans::kmeans_parallel_selecting_pivots : kmeans::kmeanspp_selecting_pivots;
+    const size_t chunk_size = chunk_end - chunk_begin;
+    std::unique_ptr<float[]> cur_pivot_data = std::make_unique<float[]>(num_centers * chunk_size);
+    std::unique_ptr<float[]> cur_data = std::make_unique<float[]>(num_train * chunk_size);
+
+#pragma omp parallel for schedule(static, 65536)
+    for (int64_t j = 0; j < (int64_t)num_train; j++)
+    {
+        std::memcpy(cur_data.get() + j * chunk_size, train_data + j * dim + chunk_begin, chunk_size * sizeof(float));
+    }
+
+    if (warm_start)
+    {
+        for (size_t j = 0; j < num_centers; j++)
+        {
+            std::memcpy(cur_pivot_data.get() + j * chunk_size, full_pivot_data + j * dim + chunk_begin,
+                        chunk_size * sizeof(float));
+        }
+    }
+    else if (batch_size > 0 && 3 * batch_size < num_train)
+    {
+        const size_t num_sample = (std::max)(3 * batch_size, num_centers);
+        std::unique_ptr<float[]> sample = std::make_unique<float[]>(num_sample * chunk_size);
+        std::random_device rd;
+        std::mt19937 generator(rd());
+        std::uniform_int_distribution<size_t> distribution(0, num_train - 1);
+        for (size_t j = 0; j < num_sample; j++)
+        {
+            std::memcpy(sample.get() + j * chunk_size, cur_data.get() + distribution(generator) * chunk_size,
+                        chunk_size * sizeof(float));
+        }
+        select_pivots(sample.get(), num_sample, chunk_size, cur_pivot_data.get(), num_centers);
+    }
+    else
+    {
+        select_pivots(cur_data.get(), num_train, chunk_size, cur_pivot_data.get(), num_centers);
+    }
+
+    if (batch_size > 0)
+        kmeans::run_minibatch_kmeans(cur_data.get(), num_train, chunk_size, cur_pivot_data.get(), num_centers,
+                                     batch_size, max_reps, closest_center);
+    else
+        kmeans::run_lloyds(cur_data.get(), num_train, chunk_size, cur_pivot_data.get(), num_centers, max_reps, NULL,
+                           closest_center);
+
+    for (size_t j = 0; j < num_centers; j++)
+    {
+        std::memcpy(full_pivot_data + j * dim + chunk_begin, cur_pivot_data.get() + j * chunk_size,
+                    chunk_size * sizeof(float));
+    }
+}
+
+// Chunks are trained concurrently, one per thread, when there are enough of them to occupy every thread. k-means
+// over a few dimensions parallelizes poorly inside, so this beats handing all threads to one chunk at a time, which
+// remains the fallback for fewer chunks than threads.
+bool train_chunks_in_parallel(size_t num_pq_chunks)
+{
+    return num_pq_chunks >= (size_t)omp_get_max_threads();
+}
+} // namespace
+
 // given training data in train_data of dimensions num_train * dim, generate
 // PQ pivots using k-means algorithm to partition the co-ordinates into
 // num_pq_chunks (if it divides dimension, else rounded) chunks, and runs
@@ -410,7 +616,7 @@ int generate_pq_pivots_simplified(const float *train_data, size_t num_train, siz
 // file pq_pivots_path as a s num_centers*dim floating point binary file
 int generate_pq_pivots(const float *const passed_train_data, size_t num_train, uint32_t dim, uint32_t num_centers,
                        uint32_t num_pq_chunks, uint32_t max_k_means_reps, std::string pq_pivots_path,
-                       bool make_zero_mean)
+                       bool make_zero_mean, uint32_t kmeans_batch_size, bool kmeans_parallel_seeding)
 {
     if (num_pq_chunks > dim)
     {
@@ -512,36 +718,18 @@ int generate_pq_pivots(const float *const passed_train_data, size_t num_train, u
 
     full_pivot_data.reset(new float[num_centers * dim]);
 
-    for (size_t i = 0; i < num_pq_chunks; i++)
+#pragma omp parallel for schedule(dynamic, 1) if (train_chunks_in_parallel(num_pq_chunks))
+    for (int64_t i = 0; i < (int64_t)num_pq_chunks; i++)
     {
-        size_t cur_chunk_size = chunk_offsets[i + 1] - chunk_offsets[i];
-
-        if (cur_chunk_size == 0)
+        if (chunk_offsets[i + 1] == chunk_offsets[i])
             continue;
-        std::unique_ptr<float[]> cur_pivot_data = std::make_unique<float[]>(num_centers * cur_chunk_size);
-        std::unique_ptr<float[]> cur_data = std::make_unique<float[]>(num_train * cur_chunk_size);
-        std::unique_ptr<uint32_t[]> closest_center = std::make_unique<uint32_t[]>(num_train);
 
         diskann::cout << "Processing chunk " << i << " with dimensions [" << chunk_offsets[i] << ", "
                       << chunk_offsets[i + 1] << ")" << std::endl;
 
-#pragma omp parallel for schedule(static, 65536)
-        for (int64_t j = 0; j < (int64_t)num_train; j++)
-        {
-            std::memcpy(cur_data.get() + j * cur_chunk_size, train_data.get() + j * dim + chunk_offsets[i],
-                        cur_chunk_size * sizeof(float));
-        }
-
-        kmeans::kmeanspp_selecting_pivots(cur_data.get(), num_train, cur_chunk_size, cur_pivot_data.get(), num_centers);
-
-        kmeans::run_lloyds(cur_data.get(), num_train, cur_chunk_size, cur_pivot_data.get(), num_centers,
-                           max_k_means_reps, NULL, closest_center.get());
-
-        for (uint64_t j = 0; j < num_centers; j++)
-        {
-            std::memcpy(full_pivot_data.get() + j * dim + chunk_offsets[i], cur_pivot_data.get() + j * cur_chunk_size,
-                        cur_chunk_size * sizeof(float));
-        }
+        train_chunk_pivots(train_data.get(), num_train, dim, chunk_offsets[i], chunk_offsets[i + 1], num_centers,
+                           max_k_means_reps, kmeans_batch_size, false, full_pivot_data.get(), nullptr,
+                           kmeans_parallel_seeding);
     }
 
     std::vector<size_t> cumul_bytes(4, 0);
@@ -561,7 +749,8 @@ int generate_pq_pivots(const float *const passed_train_data, size_t num_train, u
 }
 
 int generate_opq_pivots(const float *passed_train_data, size_t num_train, uint32_t dim, uint32_t num_centers,
-                        uint32_t num_pq_chunks, std::string opq_pivots_path, bool make_zero_mean)
+                        uint32_t num_pq_chunks, std::string opq_pivots_path, bool make_zero_mean,
+                        uint32_t kmeans_batch_size, bool kmeans_parallel_seeding)
 {
     if (num_pq_chunks > dim)
     {
@@ -676,55 +865,26 @@ int generate_opq_pivots(const float *passed_train_data, size_t num_train, uint32
                     (MKL_INT)dim);
 
         // compute the PQ pivots on the rotated space
-        for (size_t i = 0; i < num_pq_chunks; i++)
+#pragma omp parallel for schedule(dynamic, 1) if (train_chunks_in_parallel(num_pq_chunks))
+        for (int64_t i = 0; i < (int64_t)num_pq_chunks; i++)
         {
-            size_t cur_chunk_size = chunk_offsets[i + 1] - chunk_offsets[i];
-
-            if (cur_chunk_size == 0)
+            if (chunk_offsets[i + 1] == chunk_offsets[i])
                 continue;
-            std::unique_ptr<float[]> cur_pivot_data = std::make_unique<float[]>(num_centers * cur_chunk_size);
-            std::unique_ptr<float[]> cur_data = std::make_unique<float[]>(num_train * cur_chunk_size);
             std::unique_ptr<uint32_t[]> closest_center = std::make_unique<uint32_t[]>(num_train);
 
             diskann::cout << "Processing chunk " << i << " with dimensions [" << chunk_offsets[i] << ", "
                           << chunk_offsets[i + 1] << ")" << std::endl;
 
-#pragma omp parallel for schedule(static, 65536)
-            for (int64_t j = 0; j < (int64_t)num_train; j++)
-            {
-                std::memcpy(cur_data.get() + j * cur_chunk_size, rotated_train_data.get() + j * dim + chunk_offsets[i],
-                            cur_chunk_size * sizeof(float));
-            }
-
-            if (rnd == 0)
-            {
-                kmeans::kmeanspp_selecting_pivots(cur_data.get(), num_train, cur_chunk_size, cur_pivot_data.get(),
-                                                  num_centers);
-            }
-            else
-            {
-                for (uint64_t j = 0; j < num_centers; j++)
-                {
-                    std::memcpy(cur_pivot_data.get() + j * cur_chunk_size,
-                                full_pivot_data.get() + j * dim + chunk_offsets[i], cur_chunk_size * sizeof(float));
-                }
-            }
-
             uint32_t num_lloyds_iters = 8;
-            kmeans::run_lloyds(cur_data.get(), num_train, cur_chunk_size, cur_pivot_data.get(), num_centers,
-                               num_lloyds_iters, NULL, closest_center.get());
-
-            for (uint64_t j = 0; j < num_centers; j++)
-            {
-                std::memcpy(full_pivot_data.get() + j * dim + chunk_offsets[i],
-                            cur_pivot_data.get() + j * cur_chunk_size, cur_chunk_size * sizeof(float));
-            }
+            train_chunk_pivots(rotated_train_data.get(), num_train, dim, chunk_offsets[i], chunk_offsets[i + 1],
+                               num_centers, num_lloyds_iters, kmeans_batch_size, rnd != 0, full_pivot_data.get(),
+                               closest_center.get(), kmeans_parallel_seeding);
 
             for (size_t j = 0; j < num_train; j++)
             {
                 std::memcpy(rotated_and_quantized_train_data.get() + j * dim + chunk_offsets[i],
-                            cur_pivot_data.get() + (size_t)closest_center[j] * cur_chunk_size,
-                            cur_chunk_size * sizeof(float));
+                            full_pivot_data.get() + (size_t)closest_center[j] * dim + chunk_offsets[i],
+                            (chunk_offsets[i + 1] - chunk_offsets[i]) * sizeof(float));
             }
         }
 
@@ -840,6 +1000,80 @@ int generate_pq_data_from_pivots_simplified(const float *data, const size_t num,
     return 0;
 }
 
+namespace
+{
+// PQ pivots laid out for encoding. The pivot matrix is stored transposed, so the nearest center search for a chunk
+// sweeps all centers of one dimension at a time over contiguous memory, which the compiler vectorizes, and the
+// squared norm of every center in every chunk is precomputed. Built once and shared by all blocks and threads.
+class ChunkPivots
+{
+  public:
+    ChunkPivots(const float *pivots, size_t num_centers, size_t dim, const uint32_t *chunk_offsets, size_t num_chunks)
+        : _num_centers(num_centers), _dim(dim), _chunk_offsets(chunk_offsets), _num_chunks(num_chunks),
+          _pivots_tr(num_centers * dim), _norms(num_chunks * num_centers, 0.0f)
+    {
+        for (size_t i = 0; i < num_chunks; i++)
+        {
+            for (size_t c = 0; c < num_centers; c++)
+            {
+                for (size_t d = chunk_offsets[i]; d < chunk_offsets[i + 1]; d++)
+                {
+                    const float v = pivots[c * dim + d];
+                    _pivots_tr[d * num_centers + c] = v;
+                    _norms[i * num_centers + c] += v * v;
+                }
+            }
+        }
+    }
+
+    // codes[j * num_chunks + i] = closest center to chunk i of point j, for all chunks of a point in one pass
+    template <typename CodeT> void encode(const float *data, size_t num_points, CodeT *codes) const
+    {
+#pragma omp parallel
+        {
+            std::vector<float> dists(_num_centers);
+#pragma omp for schedule(static, 8192)
+            for (int64_t j = 0; j < (int64_t)num_points; j++)
+            {
+                const float *point = data + j * _dim;
+                for (size_t i = 0; i < _num_chunks; i++)
+                    codes[j * _num_chunks + i] = (CodeT)closest_center(point, i, dists.data());
+            }
+        }
+    }
+
+  private:
+    // ranks centers by ||c||^2 - 2 x.c, which is ||x - c||^2 less the constant ||x||^2
+    uint32_t closest_center(const float *point, size_t chunk, float *dists) const
+    {
+        if (_chunk_offsets[chunk] == _chunk_offsets[chunk + 1])
+            return 0;
+        std::memcpy(dists, _norms.data() + chunk * _num_centers, _num_centers * sizeof(float));
+        for (size_t d = _chunk_offsets[chunk]; d < _chunk_offsets[chunk + 1]; d++)
+        {
+            const float x = -2.0f * point[d];
+            const float *centers = _pivots_tr.data() + d * _num_centers;
+            for (size_t c = 0; c < _num_centers; c++)
+                dists[c] += x * centers[c];
+        }
+        uint32_t best = 0;
+        for (uint32_t c = 1; c < _num_centers; c++)
+        {
+            if (dists[c] < dists[best])
+                best = c;
+        }
+        return best;
+    }
+
+    size_t _num_centers;
+    size_t _dim;
+    const uint32_t *_chunk_offsets;
+    size_t _num_chunks;
+    std::vector<float> _pivots_tr;
+    std::vector<float> _norms;
+};
+} // namespace
+
 // streams the base file (data_file), and computes the closest centers in each
 // chunk to generate the compressed data_file and stores it in
 // pq_compressed_vectors_path.
@@ -948,41 +1182,55 @@ int generate_pq_data_from_pivots(const std::string &data_file, uint32_t num_cent
     std::memset(block_inflated_base.get(), 0, block_size * dim * sizeof(float));
 #endif
 
-    std::unique_ptr<uint32_t[]> block_compressed_base =
-        std::make_unique<uint32_t[]>(block_size * (size_t)num_pq_chunks);
-    std::memset(block_compressed_base.get(), 0, block_size * (size_t)num_pq_chunks * sizeof(uint32_t));
-
-    std::unique_ptr<T[]> block_data_T = std::make_unique<T[]>(block_size * dim);
+    // Blocks go through a three stage pipeline: block b + 1 is read on one thread and block b - 1 written on another
+    // while block b is encoded, so the buffers that cross threads are doubled.
+    const size_t code_bytes = num_centers > 256 ? sizeof(uint32_t) : sizeof(uint8_t);
+    std::unique_ptr<T[]> block_data_T[2] = {std::make_unique<T[]>(block_size * dim),
+                                             std::make_unique<T[]>(block_size * dim)};
+    std::unique_ptr<uint8_t[]> block_compressed_base[2] = {
+        std::make_unique<uint8_t[]>(block_size * num_pq_chunks * code_bytes),
+        std::make_unique<uint8_t[]>(block_size * num_pq_chunks * code_bytes)};
     std::unique_ptr<float[]> block_data_float = std::make_unique<float[]>(block_size * dim);
-    std::unique_ptr<float[]> block_data_tmp = std::make_unique<float[]>(block_size * dim);
+    std::unique_ptr<float[]> block_data_tmp;
+    if (use_opq)
+        block_data_tmp = std::make_unique<float[]>(block_size * dim);
+
+    const ChunkPivots chunk_pivots(full_pivot_data.get(), num_centers, dim, chunk_offsets.get(), num_pq_chunks);
 
     size_t num_blocks = DIV_ROUND_UP(num_points, block_size);
+    auto block_points = [&](size_t block) {
+        return (std::min)((block + 1) * block_size, num_points) - block * block_size;
+    };
+    auto read_block = [&](size_t block) {
+        base_reader.read((char *)(block_data_T[block % 2].get()), sizeof(T) * (block_points(block) * dim));
+    };
+    auto write_block = [&](size_t block) {
+        compressed_file_writer.write((char *)(block_compressed_base[block % 2].get()),
+                                     block_points(block) * num_pq_chunks * code_bytes);
+#ifdef SAVE_INFLATED_PQ
+        inflated_file_writer.write((char *)(block_inflated_base.get()), block_points(block) * dim * sizeof(float));
+#endif
+    };
 
+    std::future<void> reader = std::async(std::launch::async, read_block, 0);
+    std::future<void> writer;
     for (size_t block = 0; block < num_blocks; block++)
     {
         size_t start_id = block * block_size;
-        size_t end_id = (std::min)((block + 1) * block_size, num_points);
-        size_t cur_blk_size = end_id - start_id;
+        size_t cur_blk_size = block_points(block);
 
-        base_reader.read((char *)(block_data_T.get()), sizeof(T) * (cur_blk_size * dim));
-        diskann::convert_types<T, float>(block_data_T.get(), block_data_tmp.get(), cur_blk_size, dim);
+        reader.get();
+        if (block + 1 < num_blocks)
+            reader = std::async(std::launch::async, read_block, block + 1);
 
-        diskann::cout << "Processing points  [" << start_id << ", " << end_id << ").." << std::flush;
+        diskann::cout << "Processing points  [" << start_id << ", " << start_id + cur_blk_size << ").." << std::flush;
 
-        for (size_t p = 0; p < cur_blk_size; p++)
-        {
-            for (uint64_t d = 0; d < dim; d++)
-            {
-                block_data_tmp[p * dim + d] -= centroid[d];
-            }
-        }
-
-        for (size_t p = 0; p < cur_blk_size; p++)
+        const T *block_data = block_data_T[block % 2].get();
+#pragma omp parallel for schedule(static, 8192)
+        for (int64_t p = 0; p < (int64_t)cur_blk_size; p++)
         {
             for (uint64_t d = 0; d < dim; d++)
-            {
-                block_data_float[p * dim + d] = block_data_tmp[p * dim + d];
-            }
+                block_data_float[p * dim + d] = (float)block_data[p * dim + d] - centroid[d];
         }
 
         if (use_opq)
@@ -992,65 +1240,41 @@ int generate_pq_data_from_pivots(const std::string &data_file, uint32_t num_cent
             cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, (MKL_INT)cur_blk_size, (MKL_INT)dim, (MKL_INT)dim,
                         1.0f, block_data_float.get(), (MKL_INT)dim, rotmat_tr.get(), (MKL_INT)dim, 0.0f,
                         block_data_tmp.get(), (MKL_INT)dim);
-            std::memcpy(block_data_float.get(), block_data_tmp.get(), cur_blk_size * dim * sizeof(float));
+            std::swap(block_data_float, block_data_tmp);
         }
 
-        for (size_t i = 0; i < num_pq_chunks; i++)
-        {
-            size_t cur_chunk_size = chunk_offsets[i + 1] - chunk_offsets[i];
-            if (cur_chunk_size == 0)
-                continue;
-
-            std::unique_ptr<float[]> cur_pivot_data = std::make_unique<float[]>(num_centers * cur_chunk_size);
-            std::unique_ptr<float[]> cur_data = std::make_unique<float[]>(cur_blk_size * cur_chunk_size);
-            std::unique_ptr<uint32_t[]> closest_center = std::make_unique<uint32_t[]>(cur_blk_size);
-
-#pragma omp parallel for schedule(static, 8192)
-            for (int64_t j = 0; j < (int64_t)cur_blk_size; j++)
-            {
-                for (size_t k = 0; k < cur_chunk_size; k++)
-                    cur_data[j * cur_chunk_size + k] = block_data_float[j * dim + chunk_offsets[i] + k];
-            }
-
-#pragma omp parallel for schedule(static, 1)
-            for (int64_t j = 0; j < (int64_t)num_centers; j++)
-            {
-                std::memcpy(cur_pivot_data.get() + j * cur_chunk_size,
-                            full_pivot_data.get() + j * dim + chunk_offsets[i], cur_chunk_size * sizeof(float));
-            }
-
-            math_utils::compute_closest_centers(cur_data.get(), cur_blk_size, cur_chunk_size, cur_pivot_data.get(),
-                                                num_centers, 1, closest_center.get());
-
-#pragma omp parallel for schedule(static, 8192)
-            for (int64_t j = 0; j < (int64_t)cur_blk_size; j++)
-            {
-                block_compressed_base[j * num_pq_chunks + i] = closest_center[j];
 #ifdef SAVE_INFLATED_PQ
-                for (size_t k = 0; k < cur_chunk_size; k++)
-                    block_inflated_base[j * dim + chunk_offsets[i] + k] =
-                        cur_pivot_data[closest_center[j] * cur_chunk_size + k] + centroid[chunk_offsets[i] + k];
+        // the inflated block buffer is not doubled, so its previous write has to finish first
+        if (writer.valid())
+            writer.get();
 #endif
-            }
-        }
-
+        uint8_t *block_codes = block_compressed_base[block % 2].get();
         if (num_centers > 256)
-        {
-            compressed_file_writer.write((char *)(block_compressed_base.get()),
-                                         cur_blk_size * num_pq_chunks * sizeof(uint32_t));
-        }
+            chunk_pivots.encode(block_data_float.get(), cur_blk_size, (uint32_t *)block_codes);
         else
+            chunk_pivots.encode(block_data_float.get(), cur_blk_size, block_codes);
+
+#ifdef SAVE_INFLATED_PQ
+#pragma omp parallel for schedule(static, 8192)
+        for (int64_t j = 0; j < (int64_t)cur_blk_size; j++)
         {
-            std::unique_ptr<uint8_t[]> pVec = std::make_unique<uint8_t[]>(cur_blk_size * num_pq_chunks);
-            diskann::convert_types<uint32_t, uint8_t>(block_compressed_base.get(), pVec.get(), cur_blk_size,
-                                                      num_pq_chunks);
-            compressed_file_writer.write((char *)(pVec.get()), cur_blk_size * num_pq_chunks * sizeof(uint8_t));
+            for (size_t i = 0; i < num_pq_chunks; i++)
+            {
+                const uint32_t center = num_centers > 256 ? ((uint32_t *)block_codes)[j * num_pq_chunks + i]
+                                                          : block_codes[j * num_pq_chunks + i];
+                for (size_t d = chunk_offsets[i]; d < chunk_offsets[i + 1]; d++)
+                    block_inflated_base[j * dim + d] = full_pivot_data[center * dim + d] + centroid[d];
+            }
         }
-#ifdef SAVE_INFLATED_PQ
-        inflated_file_writer.write((char *)(block_inflated_base.get()), cur_blk_size * dim * sizeof(float));
 #endif
+
+        if (writer.valid())
+            writer.get();
+        writer = std::async(std::launch::async, write_block, block);
         diskann::cout << ".done." << std::endl;
     }
+    if (writer.valid())
+        writer.get();
 // Gopal. Splitting diskann_dll into separate DLLs for search and build.
 // This code should only be available in the "build" DLL.
 #if defined(DISKANN_RELEASE_UNUSED_TCMALLOC_MEMORY_AT_CHECKPOINTS) && defined(DISKANN_BUILD)
@@ -1066,7 +1290,7 @@ int generate_pq_data_from_pivots(const std::string &data_file, uint32_t num_cent
 template <typename T>
 void generate_disk_quantized_data(const std::string &data_file_to_use, const std::string &disk_pq_pivots_path,
                                   const std::string &disk_pq_compressed_vectors_path, diskann::Metric compareMetric,
-                                  const double p_val, size_t &disk_pq_dims)
+                                  const double p_val, size_t &disk_pq_dims, const bool kmeans_parallel_seeding)
 {
     size_t train_size, train_dim;
     float *train_data;
@@ -1080,7 +1304,7 @@ void generate_disk_quantized_data(const std::string &data_file_to_use, const std
 
     std::cout << "Compressing base for disk-PQ into " << disk_pq_dims << " chunks " << std::endl;
     generate_pq_pivots(train_data, train_size, (uint32_t)train_dim, 256, (uint32_t)disk_pq_dims, NUM_KMEANS_REPS_PQ,
-                       disk_pq_pivots_path, false);
+                       disk_pq_pivots_path, false, 0, kmeans_parallel_seeding);
     if (compareMetric == diskann::Metric::INNER_PRODUCT)
         generate_pq_data_from_pivots<float>(data_file_to_use, 256, (uint32_t)disk_pq_dims, disk_pq_pivots_path,
                                             disk_pq_compressed_vectors_path);
@@ -1095,7 +1319,7 @@ template <typename T>
 void generate_quantized_data(const std::string &data_file_to_use, const std::string &pq_pivots_path,
                              const std::string &pq_compressed_vectors_path, diskann::Metric compareMetric,
                              const double p_val, const size_t num_pq_chunks, const bool use_opq,
-                             const std::string &codebook_prefix)
+                             const std::string &codebook_prefix, const bool kmeans_parallel_seeding)
 {
     size_t train_size, train_dim;
     float *train_data;
@@ -1114,12 +1338,12 @@ void generate_quantized_data(const std::string &data_file_to_use, const std::str
         if (!use_opq)
         {
             generate_pq_pivots(train_data, train_size, (uint32_t)train_dim, NUM_PQ_CENTROIDS, (uint32_t)num_pq_chunks,
-                               NUM_KMEANS_REPS_PQ, pq_pivots_path, make_zero_mean);
+                               NUM_KMEANS_REPS_PQ, pq_pivots_path, make_zero_mean, 0, kmeans_parallel_seeding);
         }
         else
         {
             generate_opq_pivots(train_data, train_size, (uint32_t)train_dim, NUM_PQ_CENTROIDS, (uint32_t)num_pq_chunks,
-                                pq_pivots_path, make_zero_mean);
+                                pq_pivots_path, make_zero_mean, 0, kmeans_parallel_seeding);
         }
         delete[] train_data;
     }
@@ -1153,37 +1377,42 @@ template DISKANN_DLLEXPORT void generate_disk_quantized_data<int8_t>(const std::
                                                                      const std::string &disk_pq_pivots_path,
                                                                      const std::string &disk_pq_compressed_vectors_path,
                                                                      diskann::Metric compareMetric, const double p_val,
-                                                                     size_t &disk_pq_dims);
+                                                                     size_t &disk_pq_dims,
+                                                                     const bool kmeans_parallel_seeding);
 
 template DISKANN_DLLEXPORT void generate_disk_quantized_data<uint8_t>(
     const std::string &data_file_to_use, const std::string &disk_pq_pivots_path,
     const std::string &disk_pq_compressed_vectors_path, diskann::Metric compareMetric, const double p_val,
-    size_t &disk_pq_dims);
+    size_t &disk_pq_dims, const bool kmeans_parallel_seeding);
 
 template DISKANN_DLLEXPORT void generate_disk_quantized_data<float>(const std::string &data_file_to_use,
                                                                     const std::string &disk_pq_pivots_path,
                                                                     const std::string &disk_pq_compressed_vectors_path,
                                                                     diskann::Metric compareMetric, const double p_val,
-                                                                    size_t &disk_pq_dims);
+                                                                    size_t &disk_pq_dims,
+                                                                    const bool kmeans_parallel_seeding);
 
 template DISKANN_DLLEXPORT void generate_quantized_data<int8_t>(const std::string &data_file_to_use,
                                                                 const std::string &pq_pivots_path,
                                                                 const std::string &pq_compressed_vectors_path,
                                                                 diskann::Metric compareMetric, const double p_val,
                                                                 const size_t num_pq_chunks, const bool use_opq,
-                                                                const std::string &codebook_prefix);
+                                                                const std::string &codebook_prefix,
+                                                                const bool kmeans_parallel_seeding);
 
 template DISKANN_DLLEXPORT void generate_quantized_data<uint8_t>(const std::string &data_file_to_use,
                                                                  const std::string &pq_pivots_path,
                                                                  const std::string &pq_compressed_vectors_path,
                                                                  diskann::Metric compareMetric, const double p_val,
                                                                  const size_t num_pq_chunks, const bool use_opq,
-                                                                 const std::string &codebook_prefix);
+                                                                 const std::string &codebook_prefix,
+                                                                 const bool kmeans_parallel_seeding);
 
 template DISKANN_DLLEXPORT void generate_quantized_data<float>(const std::string &data_file_to_use,
                                                                const std::string &pq_pivots_path,
                                                                const std::string &pq_compressed_vectors_path,
                                                                diskann::Metric compareMetric, const double p_val,
                                                                const size_t num_pq_chunks, const bool use_opq,
-                                                               const std::string &codebook_prefix);
+                                                               const std::string &codebook_prefix,
+                                                               const bool kmeans_parallel_seeding);
 } // namespace diskann
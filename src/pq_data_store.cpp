@@ -180,8 +180,8 @@ void PQDataStore<data_t>::get_distance(const data_t *preprocessed_query, const l
     {
         throw diskann::ANNException("PQScratch not set in scratch space.", -1);
     }
-    diskann::aggregate_coords(locations, location_count, _quantized_data, this->_num_chunks,
-                              pq_scratch->aligned_pq_coord_scratch);
+    diskann::aggregate_coords_transposed(locations, location_count, _quantized_data, this->_num_chunks,
+                                         pq_scratch->aligned_pq_coord_scratch);
     _pq_distance_fn->preprocessed_distance(*pq_scratch, location_count, distances);
 }
 
@@ -198,7 +198,8 @@ void PQDataStore<data_t>::get_distance(const data_t *preprocessed_query, const s
     {
         throw diskann::ANNException("PQScratch not set in scratch space.", -1);
     }
-    diskann::aggregate_coords(ids, _quantized_data, this->_num_chunks, pq_scratch->aligned_pq_coord_scratch);
+    diskann::aggregate_coords_transposed(ids, _quantized_data, this->_num_chunks,
+                                         pq_scratch->aligned_pq_coord_scratch);
     _pq_distance_fn->preprocessed_distance(*pq_scratch, (location_t)ids.size(), distances);
 }
 
@@ -4,6 +4,8 @@
 #include "common_includes.h"
 
 #include "timer.h"
+#include "huge_page_allocator.h"
+#include "numa_utils.h"
 #include "pq.h"
 #include "pq_scratch.h"
 #include "pq_flash_index.h"
@@ -30,7 +32,7 @@ namespace diskann
 
 template <typename T, typename LabelT>
 PQFlashIndex<T, LabelT>::PQFlashIndex(std::shared_ptr<AlignedFileReader> &fileReader, diskann::Metric m)
-    : reader(fileReader), metric(m), _thread_data(nullptr)
+    : reader(fileReader), metric(m), _thread_data(nullptr), _query_scratch_pool(nullptr)
 {
     diskann::Metric metric_to_invoke = m;
     if (m == diskann::Metric::COSINE || m == diskann::Metric::INNER_PRODUCT)
@@ -58,19 +60,17 @@ PQFlashIndex<T, LabelT>::PQFlashIndex(std::shared_ptr<AlignedFileReader> &fileRe
 template <typename T, typename LabelT> PQFlashIndex<T, LabelT>::~PQFlashIndex()
 {
 #ifndef EXEC_ENV_OLS
-    if (data != nullptr)
-    {
-        delete[] data;
-    }
+    free_large(data);
 #endif
 
     if (_centroid_data != nullptr)
         aligned_free(_centroid_data);
+    free_numa_replicas();
     // delete backing bufs for nhood and coord cache
     if (_nhood_cache_buf != nullptr)
     {
-        delete[] _nhood_cache_buf;
-        diskann::aligned_free(_coord_cache_buf);
+        free_large(_nhood_cache_buf);
+        free_large(_coord_cache_buf);
     }
 
     if (_load_flag)
@@ -78,6 +78,10 @@ template <typename T, typename LabelT> PQFlashIndex<T, LabelT>::~PQFlashIndex()
         diskann::cout << "Clearing scratch" << std::endl;
         ScratchStoreManager<SSDThreadData<T>> manager(this->_thread_data);
         manager.destroy();
+        while (!_query_scratch_pool.empty())
+        {
+            delete _query_scratch_pool.pop();
+        }
         this->reader->deregister_all_threads();
         reader->close();
     }
@@ -101,14 +105,16 @@ template <typename T, typename LabelT> PQFlashIndex<T, LabelT>::~PQFlashIndex()
 
 template <typename T, typename LabelT> inline uint64_t PQFlashIndex<T, LabelT>::get_node_sector(uint64_t node_id)
 {
-    return 1 + (_nnodes_per_sector > 0 ? node_id / _nnodes_per_sector
-                                       : node_id * DIV_ROUND_UP(_max_node_len, defaults::SECTOR_LEN));
+    uint64_t location = _id_to_location.empty() ? node_id : _id_to_location[node_id];
+    return 1 + (_nnodes_per_sector > 0 ? location / _nnodes_per_sector
+                                       : location * DIV_ROUND_UP(_max_node_len, defaults::SECTOR_LEN));
 }
 
 template <typename T, typename LabelT>
 inline char *PQFlashIndex<T, LabelT>::offset_to_node(char *sector_buf, uint64_t node_id)
 {
-    return sector_buf + (_nnodes_per_sector == 0 ? 0 : (node_id % _nnodes_per_sector) * _max_node_len);
+    uint64_t location = _id_to_location.empty() ? node_id : _id_to_location[node_id];
+    return sector_buf + (_nnodes_per_sector == 0 ? 0 : (location % _nnodes_per_sector) * _max_node_len);
 }
 
 template <typename T, typename LabelT> inline uint32_t *PQFlashIndex<T, LabelT>::offset_to_node_nhood(char *node_buf)
@@ -132,8 +138,11 @@ void PQFlashIndex<T, LabelT>::setup_thread_data(uint64_t nthreads, uint64_t visi
 #pragma omp critical
         {
             SSDThreadData<T> *data = new SSDThreadData<T>(this->_aligned_dim, visited_reserve);
+            data->scratch.visited.configure(_visited_set_type, this->_num_points, visited_reserve);
             this->reader->register_thread();
             data->ctx = this->reader->get_ctx();
+            this->reader->register_buffer(data->ctx, data->scratch.sector_scratch,
+                                          defaults::MAX_N_SECTOR_READS * defaults::SECTOR_LEN);
             this->_thread_data.push(data);
         }
     }
@@ -204,18 +213,41 @@ std::vector<bool> PQFlashIndex<T, LabelT>::read_nodes(const std::vector<uint32_t
     return retval;
 }
 
+template <typename T, typename LabelT> void PQFlashIndex<T, LabelT>::enable_dynamic_cache(uint64_t budget_bytes)
+{
+    if (budget_bytes == 0)
+    {
+        _dynamic_cache.reset();
+        return;
+    }
+    _dynamic_cache.reset(new NodeCache(budget_bytes, _max_node_len));
+    diskann::cout << "Dynamic node cache holds up to " << _dynamic_cache->capacity() << " nodes ("
+                  << budget_bytes / (1024 * 1024) << "MB)" << std::endl;
+}
+
+template <typename T, typename LabelT> void PQFlashIndex<T, LabelT>::set_visited_set_type(VisitedSetType type)
+{
+    // a disk search visits a few thousand nodes at most, so a per-thread array over every point (EPOCH) costs far
+    // more memory than it saves in hashing; AUTO therefore means HASH here
+    _visited_set_type = type == VisitedSetType::AUTO ? VisitedSetType::HASH : type;
+}
+
 template <typename T, typename LabelT> void PQFlashIndex<T, LabelT>::load_cache_list(std::vector<uint32_t> &node_list)
 {
     diskann::cout << "Loading the cache list into memory.." << std::flush;
+    // replicas copy the cache buffers, so they are stale once the cache changes
+    free_numa_replicas();
     size_t num_cached_nodes = node_list.size();
+    _num_cached_nodes = num_cached_nodes;
 
     // Allocate space for neighborhood cache
-    _nhood_cache_buf = new uint32_t[num_cached_nodes * (_max_degree + 1)];
-    memset(_nhood_cache_buf, 0, num_cached_nodes * (_max_degree + 1));
+    alloc_large((void **)&_nhood_cache_buf, num_cached_nodes * (_max_degree + 1) * sizeof(uint32_t),
+                sizeof(uint32_t));
+    memset(_nhood_cache_buf, 0, num_cached_nodes * (_max_degree + 1) * sizeof(uint32_t));
 
     // Allocate space for coordinate cache
     size_t coord_cache_buf_len = num_cached_nodes * _aligned_dim;
-    diskann::alloc_aligned((void **)&_coord_cache_buf, coord_cache_buf_len * sizeof(T), 8 * sizeof(T));
+    alloc_large((void **)&_coord_cache_buf, coord_cache_buf_len * sizeof(T), 8 * sizeof(T));
     memset(_coord_cache_buf, 0, coord_cache_buf_len * sizeof(T));
 
     size_t BLOCK_SIZE = 8;
@@ -252,6 +284,110 @@ template <typename T, typename LabelT> void PQFlashIndex<T, LabelT>::load_cache_
     diskann::cout << "..done." << std::endl;
 }
 
+template <typename T, typename LabelT> void PQFlashIndex<T, LabelT>::replicate_for_numa()
+{
+    const uint32_t num_nodes = NumaTopology::get().num_nodes();
+    free_numa_replicas();
+    if (num_nodes < 2)
+    {
+        diskann::cout << "Single NUMA node, not replicating the index" << std::endl;
+        return;
+    }
+
+    const size_t pq_codes_len = _num_points * _n_chunks;
+    const size_t nhood_cache_len = _num_cached_nodes * (_max_degree + 1) * sizeof(uint32_t);
+    const size_t coord_cache_len = _num_cached_nodes * _aligned_dim * sizeof(T);
+    diskann::cout << "Replicating " << (pq_codes_len + nhood_cache_len + coord_cache_len) / (1024 * 1024)
+                  << "MB of PQ codes and cached nodes to " << num_nodes - 1 << " more NUMA nodes.." << std::flush;
+
+    // The loaded buffers serve the node that holds them; every other node gets a copy made by a thread pinned to
+    // it, so first-touch places the pages in that node's memory.
+    int32_t home_node = numa_node_of(this->data);
+    if (home_node < 0 || (uint32_t)home_node >= num_nodes)
+        home_node = (int32_t)NumaTopology::get().current_node();
+    _numa_replicas.resize(num_nodes);
+    _numa_replicas[home_node].pq_codes = this->data;
+    _numa_replicas[home_node].nhood_cache_buf = _nhood_cache_buf;
+    _numa_replicas[home_node].coord_cache_buf = _coord_cache_buf;
+    std::vector<std::thread> copiers;
+    std::vector<std::exception_ptr> errors(num_nodes);
+    for (uint32_t node = 0; node < num_nodes; node++)
+    {
+        if (node == (uint32_t)home_node)
+            continue;
+        copiers.emplace_back([&, node]() {
+            try
+            {
+                NumaReplica &replica = _numa_replicas[node];
+                pin_current_thread_to_numa_node(node);
+                alloc_large((void **)&replica.pq_codes, pq_codes_len, 64);
+                memcpy(replica.pq_codes, this->data, pq_codes_len);
+                if (_nhood_cache_buf != nullptr)
+                {
+                    alloc_large((void **)&replica.nhood_cache_buf, nhood_cache_len, sizeof(uint32_t));
+                    memcpy(replica.nhood_cache_buf, _nhood_cache_buf, nhood_cache_len);
+                    alloc_large((void **)&replica.coord_cache_buf, coord_cache_len, 8 * sizeof(T));
+                    memcpy(replica.coord_cache_buf, _coord_cache_buf, coord_cache_len);
+                }
+            }
+            catch (...)
+            {
+                errors[node] = std::current_exception();
+            }
+        });
+    }
+    for (auto &copier : copiers)
+        copier.join();
+    for (auto &error : errors)
+    {
+        if (error != nullptr)
+        {
+            free_numa_replicas();
+            std::rethrow_exception(error);
+        }
+    }
+    diskann::cout << "..done." << std::endl;
+}
+
+template <typename T, typename LabelT> void PQFlashIndex<T, LabelT>::free_numa_replicas()
+{
+    for (auto &replica : _numa_replicas)
+    {
+        // the home node's replica is the loaded buffers themselves
+        if (replica.pq_codes == this->data)
+            continue;
+        free_large(replica.pq_codes);
+        free_large(replica.nhood_cache_buf);
+        free_large(replica.coord_cache_buf);
+    }
+    _numa_replicas.clear();
+}
+
+template <typename T, typename LabelT>
+inline const uint8_t *PQFlashIndex<T, LabelT>::local_pq_codes(const SSDQueryScratch<T> *query_scratch) const
+{
+    if (_numa_replicas.empty())
+        return this->data;
+    return _numa_replicas[query_scratch->numa_node].pq_codes;
+}
+
+template <typename T, typename LabelT>
+inline T *PQFlashIndex<T, LabelT>::local_cached_coords(const SSDQueryScratch<T> *query_scratch, T *coords) const
+{
+    if (_numa_replicas.empty())
+        return coords;
+    return _numa_replicas[query_scratch->numa_node].coord_cache_buf + (coords - _coord_cache_buf);
+}
+
+template <typename T, typename LabelT>
+inline uint32_t *PQFlashIndex<T, LabelT>::local_cached_nbrs(const SSDQueryScratch<T> *query_scratch,
+                                                            uint32_t *nbrs) const
+{
+    if (_numa_replicas.empty())
+        return nbrs;
+    return _numa_replicas[query_scratch->numa_node].nhood_cache_buf + (nbrs - _nhood_cache_buf);
+}
+
 #ifdef EXEC_ENV_OLS
 template <typename T, typename LabelT>
 void PQFlashIndex<T, LabelT>::generate_cache_list_from_sample_queries(MemoryMappedFiles &files, std::string sample_bin,
@@ -596,6 +732,40 @@ LabelT PQFlashIndex<T, LabelT>::get_converted_label(const std::string &filter_la
     throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
 }
 
+template <typename T, typename LabelT>
+LabelFilter<LabelT> PQFlashIndex<T, LabelT>::get_converted_filter(const std::string &filter)
+{
+    bool has_all = filter.find('&') != std::string::npos, has_any = filter.find('|') != std::string::npos;
+    if (has_all && has_any)
+    {
+        std::stringstream stream;
+        stream << "Filter " << filter << " mixes '&' and '|'";
+        diskann::cerr << stream.str() << std::endl;
+        throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    LabelFilter<LabelT> converted;
+    converted.match = has_all ? LabelMatch::ALL : LabelMatch::ANY;
+    std::istringstream iss(filter);
+    std::string token;
+    while (std::getline(iss, token, has_all ? '&' : '|'))
+        converted.labels.push_back(get_converted_label(token));
+    return converted;
+}
+
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::set_filter_brute_force_threshold(float selectivity)
+{
+    _filter_brute_force_selectivity = selectivity;
+}
+
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::set_adaptive_search(uint32_t stable_hops, uint32_t max_beam_width)
+{
+    _adaptive_stable_hops = stable_hops;
+    _adaptive_max_beam_width = max_beam_width;
+}
+
 template <typename T, typename LabelT>
 void PQFlashIndex<T, LabelT>::reset_stream_for_reading(std::basic_istream<char> &infile)
 {
@@ -647,23 +817,6 @@ void PQFlashIndex<T, LabelT>::get_label_file_metadata(const std::string &fileCon
                   << std::endl;
 }
 
-template <typename T, typename LabelT>
-inline bool PQFlashIndex<T, LabelT>::point_has_label(uint32_t point_id, LabelT label_id)
-{
-    uint32_t start_vec = _pts_to_label_offsets[point_id];
-    uint32_t num_lbls = _pts_to_label_counts[point_id];
-    bool ret_val = false;
-    for (uint32_t i = 0; i < num_lbls; i++)
-    {
-        if (_pts_to_labels[start_vec + i] == label_id)
-        {
-            ret_val = true;
-            break;
-        }
-    }
-    return ret_val;
-}
-
 template <typename T, typename LabelT>
 void PQFlashIndex<T, LabelT>::parse_label_file(std::basic_istream<char> &infile, size_t &num_points_labels)
 {
@@ -822,7 +975,10 @@ int PQFlashIndex<T, LabelT>::load_from_separate_paths(uint32_t num_threads, cons
 #ifdef EXEC_ENV_OLS
     diskann::load_bin<uint8_t>(files, pq_compressed_vectors, this->data, npts_u64, nchunks_u64);
 #else
-    diskann::load_bin<uint8_t>(pq_compressed_vectors, this->data, npts_u64, nchunks_u64);
+    // the codes are read at random by every search, so they go on hugepages when enabled
+    diskann::get_bin_metadata(pq_compressed_vectors, npts_u64, nchunks_u64);
+    alloc_large((void **)&this->data, npts_u64 * nchunks_u64, 64);
+    diskann::load_bin_into<uint8_t>(pq_compressed_vectors, this->data, npts_u64, nchunks_u64);
 #endif
 
     this->_num_points = npts_u64;
@@ -843,6 +999,9 @@ int PQFlashIndex<T, LabelT>::load_from_separate_paths(uint32_t num_threads, cons
 #endif
         parse_label_file(infile, num_pts_in_label_file);
         assert(num_pts_in_label_file == this->_num_points);
+        _label_index.build(num_pts_in_label_file, _pts_to_label_offsets, _pts_to_label_counts, _pts_to_labels);
+        diskann::cout << "Built label index over " << _label_index.num_labels() << " labels, using "
+                      << _label_index.memory_in_bytes() << " bytes" << std::endl;
 
 #ifndef EXEC_ENV_OLS
         infile.close();
@@ -1085,6 +1244,31 @@ int PQFlashIndex<T, LabelT>::load_from_separate_paths(uint32_t num_threads, cons
         READ_U64(index_metadata, this->_nvecs_per_sector);
     }
 
+    std::string layout_file = _disk_index_file + "_layout.bin";
+#ifdef EXEC_ENV_OLS
+    if (files.fileExists(layout_file))
+#else
+    if (file_exists(layout_file))
+#endif
+    {
+        uint32_t *id_to_location = nullptr;
+        size_t layout_npts, layout_dim;
+#ifdef EXEC_ENV_OLS
+        diskann::load_bin<uint32_t>(files, layout_file, id_to_location, layout_npts, layout_dim);
+#else
+        diskann::load_bin<uint32_t>(layout_file, id_to_location, layout_npts, layout_dim);
+#endif
+        if (layout_npts != _num_points || layout_dim != 1)
+        {
+            delete[] id_to_location;
+            throw ANNException("Layout file " + layout_file + " does not match the index", -1, __FUNCSIG__, __FILE__,
+                               __LINE__);
+        }
+        _id_to_location.assign(id_to_location, id_to_location + layout_npts);
+        delete[] id_to_location;
+        diskann::cout << "Loaded graph-ordered disk layout from " << layout_file << std::endl;
+    }
+
     diskann::cout << "Disk-Index File Meta-data: ";
     diskann::cout << "# nodes per sector: " << _nnodes_per_sector;
     diskann::cout << ", max node len (bytes): " << _max_node_len;
@@ -1256,41 +1440,167 @@ void PQFlashIndex<T, LabelT>::cached_beam_search(const T *query1, const uint64_t
 template <typename T, typename LabelT>
 void PQFlashIndex<T, LabelT>::cached_beam_search(const T *query1, const uint64_t k_search, const uint64_t l_search,
                                                  uint64_t *indices, float *distances, const uint64_t beam_width,
+                                                 const bool use_filter, const LabelT &filter_label,
                                                  const uint32_t io_limit, const bool use_reorder_data,
-                                                 QueryStats *stats)
+                                                 QueryStats *stats, const uint32_t reorder_multiplier)
 {
-    LabelT dummy_filter = 0;
-    cached_beam_search(query1, k_search, l_search, indices, distances, beam_width, false, dummy_filter, io_limit,
-                       use_reorder_data, stats);
+    if (use_filter)
+        cached_beam_search(query1, k_search, l_search, indices, distances, beam_width,
+                           LabelFilter<LabelT>(filter_label), io_limit, use_reorder_data, stats, reorder_multiplier);
+    else
+        beam_search(query1, k_search, l_search, indices, distances, beam_width, nullptr, nullptr, io_limit,
+                    use_reorder_data ? k_search * reorder_multiplier : 0, stats);
 }
 
 template <typename T, typename LabelT>
 void PQFlashIndex<T, LabelT>::cached_beam_search(const T *query1, const uint64_t k_search, const uint64_t l_search,
                                                  uint64_t *indices, float *distances, const uint64_t beam_width,
-                                                 const bool use_filter, const LabelT &filter_label,
                                                  const uint32_t io_limit, const bool use_reorder_data,
-                                                 QueryStats *stats)
+                                                 QueryStats *stats, const uint32_t reorder_multiplier)
 {
+    beam_search(query1, k_search, l_search, indices, distances, beam_width, nullptr, nullptr, io_limit,
+                use_reorder_data ? k_search * reorder_multiplier : 0, stats);
+}
 
-    uint64_t num_sector_per_nodes = DIV_ROUND_UP(_max_node_len, defaults::SECTOR_LEN);
-    if (beam_width > num_sector_per_nodes * defaults::MAX_N_SECTOR_READS)
-        throw ANNException("Beamwidth can not be higher than defaults::MAX_N_SECTOR_READS", -1, __FUNCSIG__, __FILE__,
-                           __LINE__);
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::cached_beam_search(const T *query1, const uint64_t k_search, const uint64_t l_search,
+                                                 uint64_t *indices, float *distances, const uint64_t beam_width,
+                                                 const LabelFilter<LabelT> &filter, const uint32_t io_limit,
+                                                 const bool use_reorder_data, QueryStats *stats,
+                                                 const uint32_t reorder_multiplier)
+{
+    const uint64_t n_reorder = use_reorder_data ? k_search * reorder_multiplier : 0;
+    const LabelT *universal_label = _use_universal_label ? &_universal_filter_label : nullptr;
+    LabelMatcher matcher = _label_index.compile(filter, universal_label);
+
+    // Walking the graph towards a rare label mostly visits points without it; when few points can match, ranking
+    // all of them by PQ distance is both cheaper and exact up to PQ error.
+    const uint64_t max_scanned =
+        (std::max)((uint64_t)(_filter_brute_force_selectivity * _num_points), (uint64_t)l_search);
+    if (_filter_brute_force_selectivity <= 0 || matcher.max_matches() > max_scanned)
+    {
+        beam_search(query1, k_search, l_search, indices, distances, beam_width, &filter, &matcher, io_limit,
+                    n_reorder, stats);
+        return;
+    }
 
     ScratchStoreManager<SSDThreadData<T>> manager(this->_thread_data);
     auto data = manager.scratch_space();
     IOContext &ctx = data->ctx;
     auto query_scratch = &(data->scratch);
+
+    Timer query_timer;
+    float query_norm = init_query(query1, query_scratch);
+    filtered_scan(query_scratch, ctx, matcher, l_search, io_limit, stats);
+    finish_query(query_scratch, ctx, k_search, indices, distances, query_norm, n_reorder, stats);
+
+    if (stats != nullptr)
+    {
+        stats->total_us = (float)query_timer.elapsed();
+    }
+}
+
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::filtered_scan(SSDQueryScratch<T> *query_scratch, IOContext &ctx,
+                                            const LabelMatcher &matcher, const uint64_t l_search,
+                                            const uint32_t io_limit, QueryStats *stats)
+{
+    float *dist_scratch = query_scratch->pq_scratch()->aligned_dist_scratch;
+    NeighborPriorityQueue &retset = query_scratch->retset;
+    retset.reserve(l_search);
+
+    Timer cpu_timer;
+    std::vector<uint32_t> points;
+    _label_index.get_matching_points(matcher, points);
+    // the PQ scratch holds one adjacency list worth of codes
+    for (size_t start = 0; start < points.size(); start += defaults::MAX_GRAPH_DEGREE)
+    {
+        const uint64_t n_ids = (std::min)((uint64_t)(points.size() - start), defaults::MAX_GRAPH_DEGREE);
+        compute_pq_dists(query_scratch, points.data() + start, n_ids, dist_scratch);
+        for (uint64_t i = 0; i < n_ids; i++)
+            retset.insert(Neighbor(points[start + i], dist_scratch[i]));
+    }
+    if (stats != nullptr)
+    {
+        stats->n_filter_scanned += (uint32_t)points.size();
+        stats->n_cmps += (uint32_t)points.size();
+        stats->cpu_us += (float)cpu_timer.elapsed();
+    }
+
+    // full-precision distances for the best l_search, read a sector_scratch at a time
+    const uint64_t num_sectors_per_node =
+        _nnodes_per_sector > 0 ? 1 : DIV_ROUND_UP(_max_node_len, defaults::SECTOR_LEN);
+    const uint64_t max_reads = defaults::MAX_N_SECTOR_READS / num_sectors_per_node;
+    std::vector<uint32_t> to_read;
+    std::vector<AlignedRead> read_reqs;
+    uint32_t num_ios = 0;
+    for (size_t i = 0; i < retset.size(); i++)
+    {
+        const uint32_t id = retset[i].id;
+        auto coord_iter = _coord_cache.find(id);
+        if (coord_iter != _coord_cache.end())
+        {
+            expand_node(query_scratch, id, local_cached_coords(query_scratch, coord_iter->second), 0, nullptr,
+                        &matcher, stats);
+            if (stats != nullptr)
+                stats->n_cache_hits++;
+        }
+        else if (num_ios < io_limit)
+        {
+            to_read.push_back(id);
+            num_ios++;
+        }
+    }
+
+    for (size_t start = 0; start < to_read.size(); start += max_reads)
+    {
+        const size_t n_reads = (std::min)(to_read.size() - start, (size_t)max_reads);
+        read_reqs.clear();
+        for (size_t i = 0; i < n_reads; i++)
+        {
+            read_reqs.emplace_back(get_node_sector(to_read[start + i]) * defaults::SECTOR_LEN,
+                                   num_sectors_per_node * defaults::SECTOR_LEN,
+                                   query_scratch->sector_scratch + i * num_sectors_per_node * defaults::SECTOR_LEN);
+            if (stats != nullptr)
+            {
+                stats->n_4k++;
+                stats->n_ios++;
+            }
+        }
+        Timer io_timer;
+#ifdef USE_BING_INFRA
+        reader->read(read_reqs, ctx, true); // async reader windows.
+#else
+        reader->read(read_reqs, ctx); // synchronous IO linux
+#endif
+        if (stats != nullptr)
+        {
+            stats->io_us += (float)io_timer.elapsed();
+        }
+
+        for (size_t i = 0; i < n_reads; i++)
+        {
+            char *sector_buf = query_scratch->sector_scratch + i * num_sectors_per_node * defaults::SECTOR_LEN;
+            memcpy(query_scratch->coord_scratch, offset_to_node_coords(offset_to_node(sector_buf, to_read[start + i])),
+                   _disk_bytes_per_point);
+            expand_node(query_scratch, to_read[start + i], query_scratch->coord_scratch, 0, nullptr, &matcher, stats);
+        }
+    }
+}
+
+template <typename T, typename LabelT>
+float PQFlashIndex<T, LabelT>::init_query(const T *query1, SSDQueryScratch<T> *query_scratch)
+{
     auto pq_query_scratch = query_scratch->pq_scratch();
 
     // reset query scratch
     query_scratch->reset();
+    query_scratch->numa_node = _numa_replicas.empty() ? 0 : NumaTopology::get().current_node();
 
     // copy query to thread specific aligned and allocated memory (for distance
     // calculations we need aligned data)
     float query_norm = 0;
     T *aligned_query_T = query_scratch->aligned_query_T();
-    float *query_float = pq_query_scratch->aligned_query_float;
     float *query_rotated = pq_query_scratch->rotated_query;
 
     // normalization step. for cosine, we simply normalize the query
@@ -1324,42 +1634,36 @@ void PQFlashIndex<T, LabelT>::cached_beam_search(const T *query1, const uint64_t
         pq_query_scratch->initialize(this->_data_dim, aligned_query_T);
     }
 
-    // pointers to buffers for data
-    T *data_buf = query_scratch->coord_scratch;
-    _mm_prefetch((char *)data_buf, _MM_HINT_T1);
-
-    // sector scratch
-    char *sector_scratch = query_scratch->sector_scratch;
-    uint64_t &sector_scratch_idx = query_scratch->sector_idx;
-    const uint64_t num_sectors_per_node =
-        _nnodes_per_sector > 0 ? 1 : DIV_ROUND_UP(_max_node_len, defaults::SECTOR_LEN);
-
     // query <-> PQ chunk centers distances
     _pq_table.preprocess_query(query_rotated); // center the query and rotate if
                                                // we have a rotation matrix
-    float *pq_dists = pq_query_scratch->aligned_pqtable_dist_scratch;
-    _pq_table.populate_chunk_distances(query_rotated, pq_dists);
-
-    // query <-> neighbor list
-    float *dist_scratch = pq_query_scratch->aligned_dist_scratch;
-    uint8_t *pq_coord_scratch = pq_query_scratch->aligned_pq_coord_scratch;
-
-    // lambda to batch compute query<-> node distances in PQ space
-    auto compute_dists = [this, pq_coord_scratch, pq_dists](const uint32_t *ids, const uint64_t n_ids,
-                                                            float *dists_out) {
-        diskann::aggregate_coords(ids, n_ids, this->data, this->_n_chunks, pq_coord_scratch);
-        diskann::pq_dist_lookup(pq_coord_scratch, n_ids, this->_n_chunks, pq_dists, dists_out);
-    };
-    Timer query_timer, io_timer, cpu_timer;
+    _pq_table.populate_chunk_distances(query_rotated, pq_query_scratch->aligned_pqtable_dist_scratch);
+    return query_norm;
+}
 
-    tsl::robin_set<uint64_t> &visited = query_scratch->visited;
-    NeighborPriorityQueue &retset = query_scratch->retset;
-    retset.reserve(l_search);
-    std::vector<Neighbor> &full_retset = query_scratch->full_retset;
+template <typename T, typename LabelT>
+inline void PQFlashIndex<T, LabelT>::compute_pq_dists(SSDQueryScratch<T> *query_scratch, const uint32_t *ids,
+                                                      const uint64_t n_ids, float *dists_out)
+{
+    // batch compute query<-> node distances in PQ space
+    auto pq_query_scratch = query_scratch->pq_scratch();
+    diskann::aggregate_coords_transposed(ids, n_ids, local_pq_codes(query_scratch), this->_n_chunks,
+                                         pq_query_scratch->aligned_pq_coord_scratch);
+    diskann::pq_dist_lookup_transposed(pq_query_scratch->aligned_pq_coord_scratch, n_ids, this->_n_chunks,
+                                       pq_query_scratch->aligned_pqtable_dist_scratch, dists_out);
+}
+
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::seed_search(SSDQueryScratch<T> *query_scratch, const uint64_t l_search,
+                                          const LabelFilter<LabelT> *filter, const LabelMatcher *matcher)
+{
+    float *query_float = query_scratch->pq_scratch()->aligned_query_float;
+    float *dist_scratch = query_scratch->pq_scratch()->aligned_dist_scratch;
+    query_scratch->retset.reserve(l_search);
 
     uint32_t best_medoid = 0;
     float best_dist = (std::numeric_limits<float>::max)();
-    if (!use_filter)
+    if (filter == nullptr)
     {
         for (uint64_t cur_m = 0; cur_m < _num_medoids; cur_m++)
         {
@@ -1374,246 +1678,346 @@ void PQFlashIndex<T, LabelT>::cached_beam_search(const T *query1, const uint64_t
     }
     else
     {
-        if (_filter_to_medoid_ids.find(filter_label) != _filter_to_medoid_ids.end())
+        // Prefer medoids matching the whole filter; for an ALL filter a single label's medoid may not.
+        bool found = false, found_match = false;
+        for (const auto &label : filter->labels)
         {
-            const auto &medoid_ids = _filter_to_medoid_ids[filter_label];
+            auto iter = _filter_to_medoid_ids.find(label);
+            if (iter == _filter_to_medoid_ids.end())
+                continue;
+            const auto &medoid_ids = iter->second;
             for (uint64_t cur_m = 0; cur_m < medoid_ids.size(); cur_m++)
             {
+                bool is_match = matcher->matches(medoid_ids[cur_m]);
+                if (found_match && !is_match)
+                    continue;
                 // for filtered index, we dont store global centroid data as for unfiltered index, so we use PQ distance
                 // as approximation to decide closest medoid matching the query filter.
-                compute_dists(&medoid_ids[cur_m], 1, dist_scratch);
+                compute_pq_dists(query_scratch, &medoid_ids[cur_m], 1, dist_scratch);
                 float cur_expanded_dist = dist_scratch[0];
-                if (cur_expanded_dist < best_dist)
+                if (cur_expanded_dist < best_dist || (is_match && !found_match))
                 {
                     best_medoid = medoid_ids[cur_m];
                     best_dist = cur_expanded_dist;
                 }
+                found = true;
+                found_match = found_match || is_match;
             }
         }
-        else
+        if (!found)
         {
             throw ANNException("Cannot find medoid for specified filter.", -1, __FUNCSIG__, __FILE__, __LINE__);
         }
     }
 
-    compute_dists(&best_medoid, 1, dist_scratch);
-    retset.insert(Neighbor(best_medoid, dist_scratch[0]));
-    visited.insert(best_medoid);
+    compute_pq_dists(query_scratch, &best_medoid, 1, dist_scratch);
+    query_scratch->retset.insert(Neighbor(best_medoid, dist_scratch[0]));
+    query_scratch->visited.insert(best_medoid);
+}
 
-    uint32_t cmps = 0;
-    uint32_t hops = 0;
-    uint32_t num_ios = 0;
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::expand_node(SSDQueryScratch<T> *query_scratch, const uint32_t node_id,
+                                          T *node_fp_coords, const uint64_t nnbrs, uint32_t *node_nbrs,
+                                          const LabelMatcher *filter, QueryStats *stats)
+{
+    T *aligned_query_T = query_scratch->aligned_query_T();
+    float *query_float = query_scratch->pq_scratch()->aligned_query_float;
+    float *dist_scratch = query_scratch->pq_scratch()->aligned_dist_scratch;
+    Timer cpu_timer;
 
-    // cleared every iteration
-    std::vector<uint32_t> frontier;
-    frontier.reserve(2 * beam_width);
-    std::vector<std::pair<uint32_t, char *>> frontier_nhoods;
-    frontier_nhoods.reserve(2 * beam_width);
-    std::vector<AlignedRead> frontier_read_reqs;
-    frontier_read_reqs.reserve(2 * beam_width);
-    std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t *>>> cached_nhoods;
-    cached_nhoods.reserve(2 * beam_width);
+    float cur_expanded_dist;
+    if (!_use_disk_index_pq)
+    {
+        cur_expanded_dist = _dist_cmp->compare(aligned_query_T, node_fp_coords, (uint32_t)_aligned_dim);
+    }
+    else
+    {
+        if (metric == diskann::Metric::INNER_PRODUCT)
+            cur_expanded_dist = _disk_pq_table.inner_product(query_float, (uint8_t *)node_fp_coords);
+        else
+            cur_expanded_dist = _disk_pq_table.l2_distance( // disk_pq does not support OPQ yet
+                query_float, (uint8_t *)node_fp_coords);
+    }
+    // a filtered search may pass through non-matching nodes, such as the medoid of one label of an ALL filter
+    if (filter == nullptr || filter->matches(node_id))
+        query_scratch->full_retset.push_back(Neighbor(node_id, cur_expanded_dist));
 
-    while (retset.has_unexpanded_node() && num_ios < io_limit)
-    {
-        // clear iteration state
-        frontier.clear();
-        frontier_nhoods.clear();
-        frontier_read_reqs.clear();
-        cached_nhoods.clear();
-        sector_scratch_idx = 0;
-        // find new beam
-        uint32_t num_seen = 0;
-        while (retset.has_unexpanded_node() && frontier.size() < beam_width && num_seen < beam_width)
-        {
-            auto nbr = retset.closest_unexpanded();
-            num_seen++;
-            auto iter = _nhood_cache.find(nbr.id);
-            if (iter != _nhood_cache.end())
-            {
-                cached_nhoods.push_back(std::make_pair(nbr.id, iter->second));
-                if (stats != nullptr)
-                {
-                    stats->n_cache_hits++;
-                }
-            }
-            else
-            {
-                frontier.push_back(nbr.id);
-            }
-            if (this->_count_visited_nodes)
-            {
-                reinterpret_cast<std::atomic<uint32_t> &>(this->_node_visit_counter[nbr.id].second).fetch_add(1);
-            }
-        }
+    // compute node_nbrs <-> query dist in PQ space
+    compute_pq_dists(query_scratch, node_nbrs, nnbrs, dist_scratch);
+    if (stats != nullptr)
+    {
+        stats->n_cmps += (uint32_t)nnbrs;
+        stats->cpu_us += (float)cpu_timer.elapsed();
+    }
 
-        // read nhoods of frontier ids
-        if (!frontier.empty())
+    cpu_timer.reset();
+    // process prefetch-ed nhood
+    for (uint64_t m = 0; m < nnbrs; ++m)
+    {
+        uint32_t id = node_nbrs[m];
+        if (query_scratch->visited.insert(id))
         {
-            if (stats != nullptr)
-                stats->n_hops++;
-            for (uint64_t i = 0; i < frontier.size(); i++)
-            {
-                auto id = frontier[i];
-                std::pair<uint32_t, char *> fnhood;
-                fnhood.first = id;
-                fnhood.second = sector_scratch + num_sectors_per_node * sector_scratch_idx * defaults::SECTOR_LEN;
-                sector_scratch_idx++;
-                frontier_nhoods.push_back(fnhood);
-                frontier_read_reqs.emplace_back(get_node_sector((size_t)id) * defaults::SECTOR_LEN,
-                                                num_sectors_per_node * defaults::SECTOR_LEN, fnhood.second);
-                if (stats != nullptr)
-                {
-                    stats->n_4k++;
-                    stats->n_ios++;
-                }
-                num_ios++;
-            }
-            io_timer.reset();
-#ifdef USE_BING_INFRA
-            reader->read(frontier_read_reqs, ctx,
-                         true); // asynhronous reader for Bing.
-#else
-            reader->read(frontier_read_reqs, ctx); // synchronous IO linux
-#endif
+            if (filter == nullptr && _dummy_pts.find(id) != _dummy_pts.end())
+                continue;
+
+            if (filter != nullptr && !filter->matches(id))
+                continue;
+            float dist = dist_scratch[m];
             if (stats != nullptr)
             {
-                stats->io_us += (float)io_timer.elapsed();
+                stats->n_cmps++;
             }
+
+            Neighbor nn(id, dist);
+            query_scratch->retset.insert(nn);
         }
+    }
 
-        // process cached nhoods
-        for (auto &cached_nhood : cached_nhoods)
-        {
-            auto global_cache_iter = _coord_cache.find(cached_nhood.first);
-            T *node_fp_coords_copy = global_cache_iter->second;
-            float cur_expanded_dist;
-            if (!_use_disk_index_pq)
-            {
-                cur_expanded_dist = _dist_cmp->compare(aligned_query_T, node_fp_coords_copy, (uint32_t)_aligned_dim);
-            }
-            else
-            {
-                if (metric == diskann::Metric::INNER_PRODUCT)
-                    cur_expanded_dist = _disk_pq_table.inner_product(query_float, (uint8_t *)node_fp_coords_copy);
-                else
-                    cur_expanded_dist = _disk_pq_table.l2_distance( // disk_pq does not support OPQ yet
-                        query_float, (uint8_t *)node_fp_coords_copy);
-            }
-            full_retset.push_back(Neighbor((uint32_t)cached_nhood.first, cur_expanded_dist));
+    if (stats != nullptr)
+    {
+        stats->cpu_us += (float)cpu_timer.elapsed();
+    }
+}
 
-            uint64_t nnbrs = cached_nhood.second.first;
-            uint32_t *node_nbrs = cached_nhood.second.second;
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::expand_disk_node(SSDQueryScratch<T> *query_scratch, const uint32_t node_id,
+                                               char *sector_buf, const LabelMatcher *filter, QueryStats *stats)
+{
+    char *node_disk_buf = offset_to_node(sector_buf, node_id);
+    if (_dynamic_cache != nullptr)
+        _dynamic_cache->admit(node_id, node_disk_buf);
+    expand_node_record(query_scratch, node_id, node_disk_buf, filter, stats);
+    if (_nnodes_per_sector > 1 && !_id_to_location.empty())
+        expand_colocated_nodes(query_scratch, node_id, sector_buf, filter, stats);
+}
 
-            // compute node_nbrs <-> query dists in PQ space
-            cpu_timer.reset();
-            compute_dists(node_nbrs, nnbrs, dist_scratch);
-            if (stats != nullptr)
-            {
-                stats->n_cmps += (uint32_t)nnbrs;
-                stats->cpu_us += (float)cpu_timer.elapsed();
-            }
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::expand_colocated_nodes(SSDQueryScratch<T> *query_scratch, const uint32_t node_id,
+                                                     char *sector_buf, const LabelMatcher *filter,
+                                                     QueryStats *stats)
+{
+    // With a graph-ordered layout the sector just read usually holds some of node_id's neighbours. Any of them
+    // still waiting in retset can be expanded from sector_buf now instead of costing a read later.
+    uint32_t *node_buf = offset_to_node_nhood(offset_to_node(sector_buf, node_id));
+    uint64_t nnbrs = (uint64_t)(*node_buf);
+    uint64_t sector = get_node_sector(node_id);
+    for (uint64_t m = 0; m < nnbrs; m++)
+    {
+        uint32_t nbr_id = node_buf[m + 1];
+        if (get_node_sector(nbr_id) != sector || !query_scratch->retset.mark_expanded(nbr_id))
+            continue;
+        if (stats != nullptr)
+            stats->n_colocated_expansions++;
+        expand_node_record(query_scratch, nbr_id, offset_to_node(sector_buf, nbr_id), filter, stats);
+        expand_colocated_nodes(query_scratch, nbr_id, sector_buf, filter, stats);
+    }
+}
 
-            // process prefetched nhood
-            for (uint64_t m = 0; m < nnbrs; ++m)
-            {
-                uint32_t id = node_nbrs[m];
-                if (visited.insert(id).second)
-                {
-                    if (!use_filter && _dummy_pts.find(id) != _dummy_pts.end())
-                        continue;
-
-                    if (use_filter && !(point_has_label(id, filter_label)) &&
-                        (!_use_universal_label || !point_has_label(id, _universal_filter_label)))
-                        continue;
-                    cmps++;
-                    float dist = dist_scratch[m];
-                    Neighbor nn(id, dist);
-                    retset.insert(nn);
-                }
-            }
+template <typename T, typename LabelT>
+bool PQFlashIndex<T, LabelT>::expand_dynamic_cached_node(SSDQueryScratch<T> *query_scratch, const uint32_t node_id,
+                                                         const LabelMatcher *filter, QueryStats *stats)
+{
+    if (_dynamic_cache == nullptr)
+        return false;
+    bool hit = _dynamic_cache->access(node_id, [&](char *node_disk_buf) {
+        expand_node_record(query_scratch, node_id, node_disk_buf, filter, stats);
+    });
+    if (stats != nullptr)
+    {
+        if (hit)
+            stats->n_dyn_cache_hits++;
+        else
+            stats->n_dyn_cache_misses++;
+    }
+    return hit;
+}
+
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::expand_node_record(SSDQueryScratch<T> *query_scratch, const uint32_t node_id,
+                                                 char *node_disk_buf, const LabelMatcher *filter, QueryStats *stats)
+{
+    uint32_t *node_buf = offset_to_node_nhood(node_disk_buf);
+    uint64_t nnbrs = (uint64_t)(*node_buf);
+    T *node_fp_coords = offset_to_node_coords(node_disk_buf);
+    // copy to aligned scratch for distance calculations
+    T *data_buf = query_scratch->coord_scratch;
+    memcpy(data_buf, node_fp_coords, _disk_bytes_per_point);
+    expand_node(query_scratch, node_id, data_buf, nnbrs, node_buf + 1, filter, stats);
+}
+
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::PipelineState::reset(const uint64_t max_reads_in_flight, const uint64_t read_len)
+{
+    slot_len = read_len;
+    free_slots.clear();
+    for (uint64_t slot = max_reads_in_flight; slot > 0; slot--)
+        free_slots.push_back((uint32_t)(slot - 1));
+    slot_to_id.resize(max_reads_in_flight);
+    n_in_flight = 0;
+    num_ios = 0;
+}
+
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::issue_pipelined_reads(SSDQueryScratch<T> *query_scratch, PipelineState &state,
+                                                    const uint32_t io_limit, const LabelMatcher *filter,
+                                                    QueryStats *stats, std::vector<AlignedRead> &read_reqs)
+{
+    // top up the pipeline with the closest unexpanded candidates; cached nodes are expanded on the spot
+    NeighborPriorityQueue &retset = query_scratch->retset;
+    uint64_t n_issued = 0;
+    while (retset.has_unexpanded_node() && !state.free_slots.empty() && state.num_ios < io_limit)
+    {
+        auto nbr = retset.closest_unexpanded();
+        if (this->_count_visited_nodes)
+        {
+            reinterpret_cast<std::atomic<uint32_t> &>(this->_node_visit_counter[nbr.id].second).fetch_add(1);
         }
-#ifdef USE_BING_INFRA
-        // process each frontier nhood - compute distances to unvisited nodes
-        int completedIndex = -1;
-        long requestCount = static_cast<long>(frontier_read_reqs.size());
-        // If we issued read requests and if a read is complete or there are
-        // reads in wait state, then enter the while loop.
-        while (requestCount > 0 && getNextCompletedRequest(reader, ctx, requestCount, completedIndex))
-        {
-            assert(completedIndex >= 0);
-            auto &frontier_nhood = frontier_nhoods[completedIndex];
-            (*ctx.m_pRequestsStatus)[completedIndex] = IOContext::PROCESS_COMPLETE;
-#else
-        for (auto &frontier_nhood : frontier_nhoods)
+        auto iter = _nhood_cache.find(nbr.id);
+        if (iter != _nhood_cache.end())
         {
-#endif
-            char *node_disk_buf = offset_to_node(frontier_nhood.second, frontier_nhood.first);
-            uint32_t *node_buf = offset_to_node_nhood(node_disk_buf);
-            uint64_t nnbrs = (uint64_t)(*node_buf);
-            T *node_fp_coords = offset_to_node_coords(node_disk_buf);
-            memcpy(data_buf, node_fp_coords, _disk_bytes_per_point);
-            float cur_expanded_dist;
-            if (!_use_disk_index_pq)
-            {
-                cur_expanded_dist = _dist_cmp->compare(aligned_query_T, data_buf, (uint32_t)_aligned_dim);
-            }
-            else
-            {
-                if (metric == diskann::Metric::INNER_PRODUCT)
-                    cur_expanded_dist = _disk_pq_table.inner_product(query_float, (uint8_t *)data_buf);
-                else
-                    cur_expanded_dist = _disk_pq_table.l2_distance(query_float, (uint8_t *)data_buf);
-            }
-            full_retset.push_back(Neighbor(frontier_nhood.first, cur_expanded_dist));
-            uint32_t *node_nbrs = (node_buf + 1);
-            // compute node_nbrs <-> query dist in PQ space
-            cpu_timer.reset();
-            compute_dists(node_nbrs, nnbrs, dist_scratch);
             if (stats != nullptr)
             {
-                stats->n_cmps += (uint32_t)nnbrs;
-                stats->cpu_us += (float)cpu_timer.elapsed();
+                stats->n_cache_hits++;
             }
+            auto global_cache_iter = _coord_cache.find(nbr.id);
+            expand_node(query_scratch, nbr.id, local_cached_coords(query_scratch, global_cache_iter->second),
+                        iter->second.first, local_cached_nbrs(query_scratch, iter->second.second), filter, stats);
+            continue;
+        }
+        if (expand_dynamic_cached_node(query_scratch, nbr.id, filter, stats))
+            continue;
+
+        uint32_t slot = state.free_slots.back();
+        state.free_slots.pop_back();
+        state.slot_to_id[slot] = nbr.id;
+        read_reqs.emplace_back(get_node_sector((size_t)nbr.id) * defaults::SECTOR_LEN, state.slot_len,
+                               query_scratch->sector_scratch + slot * state.slot_len);
+        if (stats != nullptr)
+        {
+            stats->n_4k++;
+            stats->n_ios++;
+        }
+        state.num_ios++;
+        n_issued++;
+    }
+    if (n_issued > 0 && stats != nullptr)
+        stats->n_hops++;
+    state.n_in_flight += n_issued;
+}
 
-            cpu_timer.reset();
-            // process prefetch-ed nhood
-            for (uint64_t m = 0; m < nnbrs; ++m)
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::complete_pipelined_read(SSDQueryScratch<T> *query_scratch, PipelineState &state,
+                                                      char *buf, const LabelMatcher *filter, QueryStats *stats)
+{
+    uint32_t slot = (uint32_t)((buf - query_scratch->sector_scratch) / state.slot_len);
+    expand_disk_node(query_scratch, state.slot_to_id[slot], buf, filter, stats);
+    state.free_slots.push_back(slot);
+    state.n_in_flight--;
+}
+
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::rerank_full_precision(SSDQueryScratch<T> *query_scratch, IOContext &ctx,
+                                                    const uint64_t n_reorder, QueryStats *stats)
+{
+    std::vector<Neighbor> &full_retset = query_scratch->full_retset;
+    char *sector_scratch = query_scratch->sector_scratch;
+
+    if (full_retset.size() > n_reorder)
+        full_retset.erase(full_retset.begin() + n_reorder, full_retset.end());
+
+    // Several reorder vectors share a sector, so candidates are grouped by sector and each sector is read once.
+    // sector_scratch holds MAX_N_SECTOR_READS sectors, which bounds a batch.
+    std::vector<std::pair<uint64_t, uint32_t>> by_sector; // (sector, position in full_retset)
+    by_sector.reserve(full_retset.size());
+    for (size_t i = 0; i < full_retset.size(); ++i)
+        by_sector.emplace_back(VECTOR_SECTOR_NO(((size_t)full_retset[i].id)), (uint32_t)i);
+    std::sort(by_sector.begin(), by_sector.end());
+
+    std::vector<AlignedRead> vec_read_reqs;
+    std::vector<size_t> sector_begin; // by_sector range of read j is [sector_begin[j], sector_begin[j + 1])
+    std::vector<void *> completed_bufs;
+    auto rerank_sector = [&](const size_t j) {
+        char *sector_buf = sector_scratch + j * defaults::SECTOR_LEN;
+        for (size_t c = sector_begin[j]; c < sector_begin[j + 1]; ++c)
+        {
+            Neighbor &nbr = full_retset[by_sector[c].second];
+            // MULTISECTORFIX
+            auto location = sector_buf + VECTOR_SECTOR_OFFSET(nbr.id);
+            nbr.distance =
+                _dist_cmp->compare(query_scratch->aligned_query_T(), (T *)location, (uint32_t)this->_data_dim);
+        }
+    };
+
+    for (size_t start = 0; start < by_sector.size();)
+    {
+        vec_read_reqs.clear();
+        sector_begin.clear();
+        size_t end = start;
+        while (end < by_sector.size() && vec_read_reqs.size() < defaults::MAX_N_SECTOR_READS)
+        {
+            sector_begin.push_back(end);
+            vec_read_reqs.emplace_back(by_sector[end].first * defaults::SECTOR_LEN, defaults::SECTOR_LEN,
+                                       sector_scratch + vec_read_reqs.size() * defaults::SECTOR_LEN);
+            const uint64_t sector = by_sector[end].first;
+            while (end < by_sector.size() && by_sector[end].first == sector)
+                end++;
+        }
+        sector_begin.push_back(end);
+        if (stats != nullptr)
+        {
+            stats->n_4k += (unsigned)vec_read_reqs.size();
+            stats->n_ios += (unsigned)vec_read_reqs.size();
+        }
+
+        Timer io_timer;
+        if (reader->supports_async_reads())
+        {
+            // rerank each sector as it lands instead of waiting for the slowest read of the batch
+            reader->submit_reads(vec_read_reqs, ctx);
+            for (size_t n_done = 0; n_done < vec_read_reqs.size();)
             {
-                uint32_t id = node_nbrs[m];
-                if (visited.insert(id).second)
+                io_timer.reset();
+                reader->get_completed(ctx, 1, completed_bufs);
+                if (stats != nullptr)
                 {
-                    if (!use_filter && _dummy_pts.find(id) != _dummy_pts.end())
-                        continue;
-
-                    if (use_filter && !(point_has_label(id, filter_label)) &&
-                        (!_use_universal_label || !point_has_label(id, _universal_filter_label)))
-                        continue;
-                    cmps++;
-                    float dist = dist_scratch[m];
-                    if (stats != nullptr)
-                    {
-                        stats->n_cmps++;
-                    }
-
-                    Neighbor nn(id, dist);
-                    retset.insert(nn);
+                    stats->io_us += (float)io_timer.elapsed();
                 }
+                for (void *buf : completed_bufs)
+                    rerank_sector(((char *)buf - sector_scratch) / defaults::SECTOR_LEN);
+                n_done += completed_bufs.size();
             }
-
+        }
+        else
+        {
+#ifdef USE_BING_INFRA
+            reader->read(vec_read_reqs, ctx, true); // async reader windows.
+#else
+            reader->read(vec_read_reqs, ctx); // synchronous IO linux
+#endif
             if (stats != nullptr)
             {
-                stats->cpu_us += (float)cpu_timer.elapsed();
+                stats->io_us += (float)io_timer.elapsed();
             }
+            for (size_t j = 0; j < vec_read_reqs.size(); ++j)
+                rerank_sector(j);
         }
-
-        hops++;
+        start = end;
     }
 
+    std::sort(full_retset.begin(), full_retset.end());
+}
+
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::finish_query(SSDQueryScratch<T> *query_scratch, IOContext &ctx,
+                                           const uint64_t k_search, uint64_t *indices, float *distances,
+                                           const float query_norm, const uint64_t n_reorder, QueryStats *stats)
+{
+    std::vector<Neighbor> &full_retset = query_scratch->full_retset;
+
     // re-sort by distance
     std::sort(full_retset.begin(), full_retset.end());
 
-    if (use_reorder_data)
+    if (n_reorder > 0)
     {
         if (!(this->_reorder_data_exists))
         {
@@ -1622,72 +2026,276 @@ void PQFlashIndex<T, LabelT>::cached_beam_search(const T *query1, const uint64_t
                                "file",
                                -1, __FUNCSIG__, __FILE__, __LINE__);
         }
+        // Nodes that store full-precision coordinates gave exact distances as they were expanded, so only indexes
+        // with disk PQ compressed nodes need the reorder vectors.
+        if (_use_disk_index_pq)
+            rerank_full_precision(query_scratch, ctx, n_reorder, stats);
+    }
+
+    // copy k_search values; a filter matching fewer points leaves the tail padded
+    for (uint64_t i = full_retset.size(); i < k_search; i++)
+    {
+        indices[i] = std::numeric_limits<uint32_t>::max();
+        if (distances != nullptr)
+            distances[i] = std::numeric_limits<float>::max();
+    }
+    for (uint64_t i = 0; i < (std::min)(k_search, (uint64_t)full_retset.size()); i++)
+    {
+        indices[i] = full_retset[i].id;
+        auto key = (uint32_t)indices[i];
+        if (_dummy_pts.find(key) != _dummy_pts.end())
+        {
+            indices[i] = _dummy_to_real_map[key];
+        }
+
+        if (distances != nullptr)
+        {
+            distances[i] = full_retset[i].distance;
+            if (metric == diskann::Metric::INNER_PRODUCT)
+            {
+                // flip the sign to convert min to max
+                distances[i] = (-distances[i]);
+                // rescale to revert back to original norms (cancelling the
+                // effect of base and query pre-processing)
+                if (_max_base_norm != 0)
+                    distances[i] *= (_max_base_norm * query_norm);
+            }
+        }
+    }
+}
 
-        std::vector<AlignedRead> vec_read_reqs;
+template <typename T, typename LabelT> void PQFlashIndex<T, LabelT>::BeamState::reserve(const uint64_t beam_width)
+{
+    frontier.reserve(2 * beam_width);
+    frontier_nhoods.reserve(2 * beam_width);
+    frontier_read_reqs.reserve(2 * beam_width);
+    cached_nhoods.reserve(2 * beam_width);
+}
 
-        if (full_retset.size() > k_search * FULL_PRECISION_REORDER_MULTIPLIER)
-            full_retset.erase(full_retset.begin() + k_search * FULL_PRECISION_REORDER_MULTIPLIER, full_retset.end());
+template <typename T, typename LabelT>
+uint32_t PQFlashIndex<T, LabelT>::expand_beam(SSDQueryScratch<T> *query_scratch, IOContext &ctx, BeamState &beam,
+                                              const uint64_t beam_width, const uint64_t list_size,
+                                              const LabelMatcher *filter, QueryStats *stats)
+{
+    NeighborPriorityQueue &retset = query_scratch->retset;
+    char *sector_scratch = query_scratch->sector_scratch;
+    uint64_t &sector_scratch_idx = query_scratch->sector_idx;
+    const uint64_t num_sectors_per_node =
+        _nnodes_per_sector > 0 ? 1 : DIV_ROUND_UP(_max_node_len, defaults::SECTOR_LEN);
+    Timer io_timer;
+    uint32_t num_ios = 0;
 
-        for (size_t i = 0; i < full_retset.size(); ++i)
+    beam.frontier.clear();
+    beam.frontier_nhoods.clear();
+    beam.frontier_read_reqs.clear();
+    beam.cached_nhoods.clear();
+    sector_scratch_idx = 0;
+    // find new beam
+    uint32_t num_seen = 0;
+    while (retset.has_unexpanded_node(list_size) && beam.frontier.size() < beam_width && num_seen < beam_width)
+    {
+        auto nbr = retset.closest_unexpanded();
+        num_seen++;
+        auto iter = _nhood_cache.find(nbr.id);
+        if (iter != _nhood_cache.end())
         {
-            // MULTISECTORFIX
-            vec_read_reqs.emplace_back(VECTOR_SECTOR_NO(((size_t)full_retset[i].id)) * defaults::SECTOR_LEN,
-                                       defaults::SECTOR_LEN, sector_scratch + i * defaults::SECTOR_LEN);
+            beam.cached_nhoods.push_back(std::make_pair(nbr.id, iter->second));
+            if (stats != nullptr)
+            {
+                stats->n_cache_hits++;
+            }
+        }
+        else if (!expand_dynamic_cached_node(query_scratch, nbr.id, filter, stats))
+        {
+            // dynamic cache hits are expanded on the spot, as the record is only pinned during the call
+            beam.frontier.push_back(nbr.id);
+        }
+        if (this->_count_visited_nodes)
+        {
+            reinterpret_cast<std::atomic<uint32_t> &>(this->_node_visit_counter[nbr.id].second).fetch_add(1);
+        }
+    }
 
+    // read nhoods of frontier ids
+    if (!beam.frontier.empty())
+    {
+        if (stats != nullptr)
+            stats->n_hops++;
+        for (uint64_t i = 0; i < beam.frontier.size(); i++)
+        {
+            auto id = beam.frontier[i];
+            std::pair<uint32_t, char *> fnhood;
+            fnhood.first = id;
+            fnhood.second = sector_scratch + num_sectors_per_node * sector_scratch_idx * defaults::SECTOR_LEN;
+            sector_scratch_idx++;
+            beam.frontier_nhoods.push_back(fnhood);
+            beam.frontier_read_reqs.emplace_back(get_node_sector((size_t)id) * defaults::SECTOR_LEN,
+                                            num_sectors_per_node * defaults::SECTOR_LEN, fnhood.second);
             if (stats != nullptr)
             {
                 stats->n_4k++;
                 stats->n_ios++;
             }
+            num_ios++;
         }
-
         io_timer.reset();
 #ifdef USE_BING_INFRA
-        reader->read(vec_read_reqs, ctx, true); // async reader windows.
+        reader->read(beam.frontier_read_reqs, ctx,
+                     true); // asynhronous reader for Bing.
 #else
-        reader->read(vec_read_reqs, ctx); // synchronous IO linux
+        reader->read(beam.frontier_read_reqs, ctx); // synchronous IO linux
 #endif
         if (stats != nullptr)
         {
-            stats->io_us += io_timer.elapsed();
-        }
-
-        for (size_t i = 0; i < full_retset.size(); ++i)
-        {
-            auto id = full_retset[i].id;
-            // MULTISECTORFIX
-            auto location = (sector_scratch + i * defaults::SECTOR_LEN) + VECTOR_SECTOR_OFFSET(id);
-            full_retset[i].distance = _dist_cmp->compare(aligned_query_T, (T *)location, (uint32_t)this->_data_dim);
+            stats->io_us += (float)io_timer.elapsed();
         }
+    }
 
-        std::sort(full_retset.begin(), full_retset.end());
+    // process cached nhoods
+    for (auto &cached_nhood : beam.cached_nhoods)
+    {
+        auto global_cache_iter = _coord_cache.find(cached_nhood.first);
+        expand_node(query_scratch, cached_nhood.first, local_cached_coords(query_scratch, global_cache_iter->second),
+                    cached_nhood.second.first, local_cached_nbrs(query_scratch, cached_nhood.second.second), filter,
+                    stats);
+    }
+#ifdef USE_BING_INFRA
+    // process each frontier nhood - compute distances to unvisited nodes
+    int completedIndex = -1;
+    long requestCount = static_cast<long>(beam.frontier_read_reqs.size());
+    // If we issued read requests and if a read is complete or there are
+    // reads in wait state, then enter the while loop.
+    while (requestCount > 0 && getNextCompletedRequest(reader, ctx, requestCount, completedIndex))
+    {
+        assert(completedIndex >= 0);
+        auto &frontier_nhood = beam.frontier_nhoods[completedIndex];
+        (*ctx.m_pRequestsStatus)[completedIndex] = IOContext::PROCESS_COMPLETE;
+#else
+    for (auto &frontier_nhood : beam.frontier_nhoods)
+    {
+#endif
+        expand_disk_node(query_scratch, frontier_nhood.first, frontier_nhood.second, filter, stats);
     }
+    return num_ios;
+}
 
-    // copy k_search values
-    for (uint64_t i = 0; i < k_search; i++)
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::beam_search(const T *query1, const uint64_t k_search, const uint64_t l_search,
+                                          uint64_t *indices, float *distances, const uint64_t beam_width,
+                                          const LabelFilter<LabelT> *filter, const LabelMatcher *matcher,
+                                          const uint32_t io_limit, const uint64_t n_reorder, QueryStats *stats)
+{
+    uint64_t num_sector_per_nodes = DIV_ROUND_UP(_max_node_len, defaults::SECTOR_LEN);
+    if (beam_width > num_sector_per_nodes * defaults::MAX_N_SECTOR_READS)
+        throw ANNException("Beamwidth can not be higher than defaults::MAX_N_SECTOR_READS", -1, __FUNCSIG__, __FILE__,
+                           __LINE__);
+
+    ScratchStoreManager<SSDThreadData<T>> manager(this->_thread_data);
+    auto data = manager.scratch_space();
+    IOContext &ctx = data->ctx;
+    auto query_scratch = &(data->scratch);
+
+    Timer query_timer, io_timer;
+    float query_norm = init_query(query1, query_scratch);
+
+    const uint64_t num_sectors_per_node =
+        _nnodes_per_sector > 0 ? 1 : DIV_ROUND_UP(_max_node_len, defaults::SECTOR_LEN);
+
+    NeighborPriorityQueue &retset = query_scratch->retset;
+    seed_search(query_scratch, l_search, filter, matcher);
+
+    uint32_t hops = 0;
+    uint32_t num_ios = 0;
+    bool top_k_stable = false;
+
+    if (_use_pipelined_search)
     {
-        indices[i] = full_retset[i].id;
-        auto key = (uint32_t)indices[i];
-        if (_dummy_pts.find(key) != _dummy_pts.end())
+        // Keep up to beam_width reads in flight. Each completed read is expanded immediately and its slot in
+        // sector_scratch is handed to the next closest unexpanded candidate, so the next hop's I/O overlaps with
+        // the distance computations of the current one rather than waiting on the slowest read of a beam.
+        std::vector<AlignedRead> frontier_read_reqs;
+        frontier_read_reqs.reserve(2 * beam_width);
+        PipelineState state;
+        state.reset((std::min)(beam_width, defaults::MAX_N_SECTOR_READS / num_sectors_per_node),
+                    num_sectors_per_node * defaults::SECTOR_LEN);
+        std::vector<void *> completed_bufs;
+
+        while (state.n_in_flight > 0 || (retset.has_unexpanded_node() && state.num_ios < io_limit))
         {
-            indices[i] = _dummy_to_real_map[key];
-        }
+            frontier_read_reqs.clear();
+            issue_pipelined_reads(query_scratch, state, io_limit, matcher, stats, frontier_read_reqs);
+            if (!frontier_read_reqs.empty())
+                reader->submit_reads(frontier_read_reqs, ctx);
+            if (state.n_in_flight == 0)
+                continue;
 
-        if (distances != nullptr)
+            // wait for at least one read, and expand everything that has landed
+            io_timer.reset();
+            reader->get_completed(ctx, 1, completed_bufs);
+            if (stats != nullptr)
+            {
+                stats->io_us += (float)io_timer.elapsed();
+            }
+            for (void *buf : completed_bufs)
+                complete_pipelined_read(query_scratch, state, (char *)buf, matcher, stats);
+            hops++;
+        }
+        if (stats != nullptr)
+            stats->beam_width = (unsigned)state.slot_to_id.size();
+    }
+    else
+    {
+        // An adaptive search treats a hop that leaves the top k unchanged as a sign of convergence: it widens the
+        // beam to expand the remaining candidates in fewer round trips, and stops after _adaptive_stable_hops such
+        // hops in a row. The k-th best distance only changes when a candidate enters the top k, so it stands in for
+        // comparing the top k ids.
+        const bool adaptive = _adaptive_stable_hops > 0;
+        const uint64_t max_beam_width =
+            adaptive ? (std::max)(beam_width, (std::min)((uint64_t)_adaptive_max_beam_width,
+                                                         defaults::MAX_N_SECTOR_READS / num_sectors_per_node))
+                     : beam_width;
+        uint64_t cur_beam_width = beam_width;
+        uint32_t stable_hops = 0;
+
+        BeamState beam;
+        beam.reserve(max_beam_width);
+        while (retset.has_unexpanded_node() && num_ios < io_limit)
         {
-            distances[i] = full_retset[i].distance;
-            if (metric == diskann::Metric::INNER_PRODUCT)
+            const float kth_dist = retset.size() >= k_search ? retset[k_search - 1].distance : -1;
+            num_ios += expand_beam(query_scratch, ctx, beam, cur_beam_width, retset.capacity(), matcher, stats);
+            hops++;
+            if (!adaptive)
+                continue;
+
+            if (retset.size() >= k_search && retset[k_search - 1].distance == kth_dist)
             {
-                // flip the sign to convert min to max
-                distances[i] = (-distances[i]);
-                // rescale to revert back to original norms (cancelling the
-                // effect of base and query pre-processing)
-                if (_max_base_norm != 0)
-                    distances[i] *= (_max_base_norm * query_norm);
+                cur_beam_width = (std::min)(cur_beam_width * 2, max_beam_width);
+                if (++stable_hops >= _adaptive_stable_hops)
+                {
+                    top_k_stable = true;
+                    break;
+                }
             }
+            else
+                stable_hops = 0;
         }
+        if (stats != nullptr)
+            stats->beam_width = (unsigned)cur_beam_width;
+    }
+
+    if (stats != nullptr)
+    {
+        stats->adaptive_search = _adaptive_stable_hops > 0 && !_use_pipelined_search;
+        if (top_k_stable)
+            stats->stop_reason = SearchStopReason::TOP_K_STABLE;
+        else if (retset.has_unexpanded_node())
+            stats->stop_reason = SearchStopReason::IO_LIMIT;
+        else
+            stats->stop_reason = SearchStopReason::LIST_EXHAUSTED;
     }
 
+    finish_query(query_scratch, ctx, k_search, indices, distances, query_norm, n_reorder, stats);
+
 #ifdef USE_BING_INFRA
     ctx.m_completeCount = 0;
 #endif
@@ -1698,47 +2306,186 @@ void PQFlashIndex<T, LabelT>::cached_beam_search(const T *query1, const uint64_t
     }
 }
 
+template <typename T, typename LabelT>
+void PQFlashIndex<T, LabelT>::multiplexed_beam_search(const T *queries, const uint64_t num_queries,
+                                                      const uint64_t query_aligned_dim, const uint64_t k_search,
+                                                      const uint64_t l_search, uint64_t *indices, float *distances,
+                                                      const uint64_t beam_width, const uint32_t io_limit,
+                                                      const uint32_t max_concurrent_queries, QueryStats *stats,
+                                                      const std::function<void(uint64_t)> &on_query_done)
+{
+    if (!reader->supports_async_reads())
+    {
+        throw ANNException("Multiplexed search requires a reader that supports asynchronous reads", -1, __FUNCSIG__,
+                           __FILE__, __LINE__);
+    }
+    const uint64_t num_sectors_per_node =
+        _nnodes_per_sector > 0 ? 1 : DIV_ROUND_UP(_max_node_len, defaults::SECTOR_LEN);
+    const uint64_t max_reads_per_query = (std::min)(beam_width, defaults::MAX_N_SECTOR_READS / num_sectors_per_node);
+    const uint64_t max_in_flight = (std::max)((uint64_t)1, MAX_IO_DEPTH / max_reads_per_query);
+    const uint64_t n_slots = (std::min)((uint64_t)(std::max)(max_concurrent_queries, 1u), max_in_flight);
+
+    // the thread data only lends its IOContext; each in-flight query gets its own scratch from the pool
+    ScratchStoreManager<SSDThreadData<T>> manager(this->_thread_data);
+    IOContext &ctx = manager.scratch_space()->ctx;
+
+    struct QuerySlot
+    {
+        SSDQueryScratch<T> *scratch = nullptr;
+        PipelineState state;
+        uint64_t query_id = 0;
+        float query_norm = 0;
+        bool active = false;
+        Timer query_timer;
+    };
+    std::vector<QuerySlot> slots(n_slots);
+    for (auto &slot : slots)
+    {
+        slot.scratch = _query_scratch_pool.pop();
+        if (slot.scratch == nullptr)
+        {
+            slot.scratch = new SSDQueryScratch<T>(this->_aligned_dim, 4096);
+            slot.scratch->visited.configure(_visited_set_type, this->_num_points, 4096);
+        }
+    }
+
+    std::vector<AlignedRead> read_reqs;
+    read_reqs.reserve(n_slots * max_reads_per_query);
+    std::vector<void *> completed_bufs;
+    uint64_t next_query = 0, n_in_flight = 0;
+    uint64_t n_active = 0;
+
+    while (next_query < num_queries || n_active > 0)
+    {
+        read_reqs.clear();
+        for (auto &slot : slots)
+        {
+            if (!slot.active && next_query < num_queries)
+            {
+                slot.query_id = next_query++;
+                slot.query_timer.reset();
+                slot.query_norm = init_query(queries + slot.query_id * query_aligned_dim, slot.scratch);
+                seed_search(slot.scratch, l_search, nullptr, nullptr);
+                slot.state.reset(max_reads_per_query, num_sectors_per_node * defaults::SECTOR_LEN);
+                slot.active = true;
+                n_active++;
+            }
+            if (!slot.active)
+                continue;
+
+            QueryStats *query_stats = stats == nullptr ? nullptr : stats + slot.query_id;
+            uint64_t n_before = slot.state.n_in_flight;
+            issue_pipelined_reads(slot.scratch, slot.state, io_limit, nullptr, query_stats, read_reqs);
+            n_in_flight += slot.state.n_in_flight - n_before;
+
+            // the query is done once nothing is in flight and nothing is left to expand, or it is out of reads
+            if (slot.state.n_in_flight == 0 &&
+                (!slot.scratch->retset.has_unexpanded_node() || slot.state.num_ios >= io_limit))
+            {
+                finish_query(slot.scratch, ctx, k_search, indices + slot.query_id * k_search,
+                             distances == nullptr ? nullptr : distances + slot.query_id * k_search, slot.query_norm,
+                             0, query_stats);
+                if (query_stats != nullptr)
+                    query_stats->total_us = (float)slot.query_timer.elapsed();
+                slot.active = false;
+                n_active--;
+                if (on_query_done)
+                    on_query_done(slot.query_id);
+            }
+        }
+
+        if (!read_reqs.empty())
+            reader->submit_reads(read_reqs, ctx);
+        if (n_in_flight == 0)
+            continue;
+
+        // reap whatever has landed and advance the queries that own those reads
+        reader->get_completed(ctx, 1, completed_bufs);
+        for (void *buf : completed_bufs)
+        {
+            char *cbuf = (char *)buf;
+            for (auto &slot : slots)
+            {
+                char *slot_begin = slot.scratch->sector_scratch;
+                if (slot.active && cbuf >= slot_begin &&
+                    cbuf < slot_begin + defaults::MAX_N_SECTOR_READS * defaults::SECTOR_LEN)
+                {
+                    complete_pipelined_read(slot.scratch, slot.state, cbuf, nullptr,
+                                            stats == nullptr ? nullptr : stats + slot.query_id);
+                    break;
+                }
+            }
+        }
+        n_in_flight -= completed_bufs.size();
+    }
+
+    for (auto &slot : slots)
+    {
+        slot.scratch->reset();
+        _query_scratch_pool.push(slot.scratch);
+    }
+}
+
 // range search returns results of all neighbors within distance of range.
-// indices and distances need to be pre-allocated of size l_search and the
-// return value is the number of matching hits.
+// The candidate list starts at min_l_search and doubles while at least half of
+// it is in range. The query's candidate list, visited set and expanded nodes
+// are kept between rounds, so a larger list only expands the nodes it adds.
+// The return value is the number of matching hits.
 template <typename T, typename LabelT>
 uint32_t PQFlashIndex<T, LabelT>::range_search(const T *query1, const double range, const uint64_t min_l_search,
                                                const uint64_t max_l_search, std::vector<uint64_t> &indices,
                                                std::vector<float> &distances, const uint64_t min_beam_width,
                                                QueryStats *stats)
 {
-    uint32_t res_count = 0;
+    if (min_l_search == 0 || max_l_search < min_l_search)
+        throw ANNException("range_search needs 0 < min_l_search <= max_l_search", -1, __FUNCSIG__, __FILE__,
+                           __LINE__);
+
+    ScratchStoreManager<SSDThreadData<T>> manager(this->_thread_data);
+    auto data = manager.scratch_space();
+    IOContext &ctx = data->ctx;
+    auto query_scratch = &(data->scratch);
 
-    bool stop_flag = false;
+    Timer query_timer;
+    float query_norm = init_query(query1, query_scratch);
+
+    // the list is sized for the last round up front; each round only expands its first l_search entries
+    NeighborPriorityQueue &retset = query_scratch->retset;
+    seed_search(query_scratch, max_l_search, nullptr, nullptr);
 
-    uint32_t l_search = (uint32_t)min_l_search; // starting size of the candidate list
-    while (!stop_flag)
+    BeamState beam;
+    uint32_t res_count = 0;
+    uint64_t l_search = min_l_search; // starting size of the candidate list
+    while (true)
     {
-        indices.resize(l_search);
-        distances.resize(l_search);
         uint64_t cur_bw = min_beam_width > (l_search / 5) ? min_beam_width : l_search / 5;
         cur_bw = (cur_bw > 100) ? 100 : cur_bw;
-        for (auto &x : distances)
-            x = std::numeric_limits<float>::max();
-        this->cached_beam_search(query1, l_search, l_search, indices.data(), distances.data(), cur_bw, false, stats);
-        for (uint32_t i = 0; i < l_search; i++)
-        {
-            if (distances[i] > (float)range)
-            {
-                res_count = i;
-                break;
-            }
-            else if (i == l_search - 1)
-                res_count = l_search;
-        }
-        if (res_count < (uint32_t)(l_search / 2.0))
-            stop_flag = true;
-        l_search = l_search * 2;
-        if (l_search > max_l_search)
-            stop_flag = true;
+        beam.reserve(cur_bw);
+        while (retset.has_unexpanded_node(l_search))
+            expand_beam(query_scratch, ctx, beam, cur_bw, l_search, nullptr, stats);
+
+        indices.resize(l_search);
+        distances.resize(l_search);
+        finish_query(query_scratch, ctx, l_search, indices.data(), distances.data(), query_norm, 0, stats);
+        res_count = 0;
+        while (res_count < l_search && distances[res_count] <= (float)range)
+            res_count++;
+
+        if (res_count < (uint32_t)(l_search / 2.0) || l_search * 2 > max_l_search)
+            break;
+        l_search *= 2;
     }
+
+#ifdef USE_BING_INFRA
+    ctx.m_completeCount = 0;
+#endif
+
     indices.resize(res_count);
     distances.resize(res_count);
+    if (stats != nullptr)
+    {
+        stats->total_us = (float)query_timer.elapsed();
+    }
     return res_count;
 }
 
@@ -1747,6 +2494,16 @@ template <typename T, typename LabelT> uint64_t PQFlashIndex<T, LabelT>::get_dat
     return _data_dim;
 }
 
+template <typename T, typename LabelT> void PQFlashIndex<T, LabelT>::set_pipelined_search(bool enable)
+{
+    if (enable && !reader->supports_async_reads())
+    {
+        throw ANNException("Pipelined search requires a reader that supports asynchronous reads", -1, __FUNCSIG__,
+                           __FILE__, __LINE__);
+    }
+    _use_pipelined_search = enable;
+}
+
 template <typename T, typename LabelT> diskann::Metric PQFlashIndex<T, LabelT>::get_metric()
 {
     return this->metric;
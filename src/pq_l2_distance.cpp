@@ -229,16 +229,16 @@ void PQL2Distance<data_t>::preprocess_query(const data_t *aligned_query, uint32_
 template <typename data_t>
 void PQL2Distance<data_t>::preprocessed_distance(PQScratch<data_t> &pq_scratch, const uint32_t n_ids, float *dists_out)
 {
-    pq_dist_lookup(pq_scratch.aligned_pq_coord_scratch, n_ids, _num_chunks, pq_scratch.aligned_pqtable_dist_scratch,
-                   dists_out);
+    pq_dist_lookup_transposed(pq_scratch.aligned_pq_coord_scratch, n_ids, _num_chunks,
+                              pq_scratch.aligned_pqtable_dist_scratch, dists_out);
 }
 
 template <typename data_t>
 void PQL2Distance<data_t>::preprocessed_distance(PQScratch<data_t> &pq_scratch, const uint32_t n_ids,
                                                  std::vector<float> &dists_out)
 {
-    pq_dist_lookup(pq_scratch.aligned_pq_coord_scratch, n_ids, _num_chunks, pq_scratch.aligned_pqtable_dist_scratch,
-                   dists_out);
+    pq_dist_lookup_transposed(pq_scratch.aligned_pq_coord_scratch, n_ids, _num_chunks,
+                              pq_scratch.aligned_pqtable_dist_scratch, dists_out);
 }
 
 template <typename data_t> float PQL2Distance<data_t>::brute_force_distance(const float *query_vec, uint8_t *base_vec)
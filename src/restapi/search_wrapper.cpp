@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+#include <cstring>
 #include <ctime>
 #include <iomanip>
 #include <omp.h>
@@ -100,7 +101,7 @@ InMemorySearch<T>::InMemorySearch(const std::string &baseFile, const std::string
 {
     size_t dimensions, total_points = 0;
     diskann::get_bin_metadata(baseFile, total_points, dimensions);
-    auto search_params = diskann::IndexSearchParams(search_l, num_threads);
+    auto search_params = std::make_shared<diskann::IndexSearchParams>(search_l, num_threads);
     _index = std::unique_ptr<diskann::Index<T>>(
         new diskann::Index<T>(m, dimensions, total_points, nullptr, search_params, 0, false));
 
@@ -134,6 +135,36 @@ SearchResult InMemorySearch<T>::search(const T *query, const unsigned int dimens
     return result;
 }
 
+template <typename T>
+std::vector<SearchResult> InMemorySearch<T>::search_batch(const T *const *queries, const unsigned int num_queries,
+                                                          const unsigned int dimensions, const unsigned int K,
+                                                          const unsigned int Ls)
+{
+    std::vector<T> packed_queries((size_t)num_queries * dimensions);
+    for (unsigned int i = 0; i < num_queries; i++)
+        std::memcpy(packed_queries.data() + (size_t)i * dimensions, queries[i], dimensions * sizeof(T));
+    std::vector<unsigned int> indices((size_t)num_queries * K);
+    std::vector<float> distances((size_t)num_queries * K);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    _index->batch_search(packed_queries.data(), num_queries, dimensions, K, Ls, indices.data(), distances.data());
+    auto duration =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - startTime)
+            .count();
+
+    std::vector<SearchResult> results;
+    results.reserve(num_queries);
+    std::vector<std::string> tags(_tags_enabled ? K : 0);
+    for (unsigned int i = 0; i < num_queries; i++)
+    {
+        if (_tags_enabled)
+            lookup_tags(K, indices.data() + (size_t)i * K, tags.data());
+        results.emplace_back(K, (unsigned int)duration, indices.data() + (size_t)i * K,
+                             distances.data() + (size_t)i * K, _tags_enabled ? tags.data() : nullptr);
+    }
+    return results;
+}
+
 template <typename T> InMemorySearch<T>::~InMemorySearch()
 {
 }
@@ -172,6 +203,7 @@ PQFlashSearch<T>::PQFlashSearch(const std::string &indexPrefix, const unsigned n
     _index->cache_bfs_levels(num_nodes_to_cache, node_list);
     _index->load_cache_list(node_list);
     omp_set_num_threads(num_threads);
+    _num_threads = num_threads;
 }
 
 template <typename T>
@@ -203,6 +235,42 @@ SearchResult PQFlashSearch<T>::search(const T *query, const unsigned int dimensi
     return result;
 }
 
+template <typename T>
+std::vector<SearchResult> PQFlashSearch<T>::search_batch(const T *const *queries, const unsigned int num_queries,
+                                                         const unsigned int dimensions, const unsigned int K,
+                                                         const unsigned int Ls)
+{
+    std::vector<uint64_t> indices_u64((size_t)num_queries * K);
+    std::vector<unsigned> indices((size_t)num_queries * K);
+    std::vector<float> distances((size_t)num_queries * K);
+
+    // the queries are independent beam searches; running them together keeps the SSD queue deep
+    auto startTime = std::chrono::high_resolution_clock::now();
+#pragma omp parallel for schedule(dynamic, 1) num_threads(_num_threads)
+    for (int64_t i = 0; i < (int64_t)num_queries; i++)
+    {
+        _index->cached_beam_search(queries[i], K, Ls, indices_u64.data() + i * K, distances.data() + i * K,
+                                   DEFAULT_W);
+    }
+    auto duration =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - startTime)
+            .count();
+    for (size_t k = 0; k < indices.size(); ++k)
+        indices[k] = (unsigned)indices_u64[k];
+
+    std::vector<SearchResult> results;
+    results.reserve(num_queries);
+    std::vector<std::string> tags(_tags_enabled ? K : 0);
+    for (unsigned int i = 0; i < num_queries; i++)
+    {
+        if (_tags_enabled)
+            lookup_tags(K, indices.data() + (size_t)i * K, tags.data());
+        results.emplace_back(K, (unsigned int)duration, indices.data() + (size_t)i * K,
+                             distances.data() + (size_t)i * K, _tags_enabled ? tags.data() : nullptr);
+    }
+    return results;
+}
+
 template <typename T> PQFlashSearch<T>::~PQFlashSearch()
 {
 }
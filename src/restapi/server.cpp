@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+#include <algorithm>
 #include <ctime>
 #include <functional>
 #include <iomanip>
@@ -15,7 +16,7 @@ namespace diskann
 {
 
 Server::Server(web::uri &uri, std::vector<std::unique_ptr<diskann::BaseSearch>> &multi_searcher,
-               const std::string &typestring)
+               const std::string &typestring, const unsigned int max_batch_size, const unsigned int batch_window_us)
     : _multi_search(multi_searcher.size() > 1 ? true : false)
 {
     for (auto &searcher : multi_searcher)
@@ -25,15 +26,18 @@ Server::Server(web::uri &uri, std::vector<std::unique_ptr<diskann::BaseSearch>>
         new web::http::experimental::listener::http_listener(uri));
     if (typestring == std::string("float"))
     {
+        start_batchers<float>(max_batch_size, batch_window_us);
         _listener->support(std::bind(&Server::handle_post<float>, this, std::placeholders::_1));
     }
     else if (typestring == std::string("int8_t"))
     {
+        start_batchers<int8_t>(max_batch_size, batch_window_us);
         _listener->support(web::http::methods::POST,
                            std::bind(&Server::handle_post<int8_t>, this, std::placeholders::_1));
     }
     else if (typestring == std::string("uint8_t"))
     {
+        start_batchers<uint8_t>(max_batch_size, batch_window_us);
         _listener->support(web::http::methods::POST,
                            std::bind(&Server::handle_post<uint8_t>, this, std::placeholders::_1));
     }
@@ -47,6 +51,15 @@ Server::~Server()
 {
 }
 
+template <class T> void Server::start_batchers(const unsigned int max_batch_size, const unsigned int batch_window_us)
+{
+    for (auto &searcher : _multi_searcher)
+    {
+        _batchers.push_back(std::unique_ptr<QueryBatcherBase>(
+            new QueryBatcher<T>(*searcher, max_batch_size, std::chrono::microseconds(batch_window_us))));
+    }
+}
+
 pplx::task<void> Server::open()
 {
     return _listener->open();
@@ -90,9 +103,10 @@ diskann::SearchResult Server::aggregate_results(const unsigned K, const std::vec
             pos[best_partition]++;
         }
 
+        // the shards are searched concurrently
         unsigned int total_time = 0;
         for (size_t i = 0; i < numsearchers; ++i)
-            total_time += results[i].get_time();
+            total_time = (std::max)(total_time, results[i].get_time());
         diskann::SearchResult result =
             SearchResult(K, total_time, best_indices, best_distances, best_tags, best_partitions);
 
@@ -120,15 +134,39 @@ template <class T> void Server::handle_post(web::http::http_request message)
                 T *queryVector = nullptr;
                 unsigned int dimensions = 0;
                 unsigned int Ls;
+                auto startTime = std::chrono::high_resolution_clock::now();
                 parseJson(body, K, queryId, queryVector, dimensions, Ls);
+                auto parsedTime = std::chrono::high_resolution_clock::now();
+
+                std::vector<std::future<ShardResult>> shard_futures;
+                for (auto &batcher : _batchers)
+                {
+                    shard_futures.push_back(
+                        static_cast<QueryBatcher<T> &>(*batcher).submit(queryVector, dimensions, K, Ls));
+                }
+                // every shard reads queryVector until its future is ready
+                for (auto &shard_future : shard_futures)
+                    shard_future.wait();
+                diskann::aligned_free(queryVector);
 
-                auto startTime = std::chrono::high_resolution_clock::now();
                 std::vector<diskann::SearchResult> results;
+                web::json::value shard_search_times = web::json::value::array();
+                uint64_t queue_time = 0, search_time = 0;
+                unsigned int batch_size = 0;
+                for (size_t i = 0; i < shard_futures.size(); i++)
+                {
+                    ShardResult shard_result = shard_futures[i].get();
+                    queue_time = (std::max)(queue_time, shard_result.queue_time_in_us);
+                    search_time = (std::max)(search_time, shard_result.search_time_in_us);
+                    batch_size = (std::max)(batch_size, shard_result.batch_size);
+                    shard_search_times[i] = web::json::value::number(shard_result.search_time_in_us);
+                    results.push_back(std::move(shard_result.result));
+                }
+                auto searchedTime = std::chrono::high_resolution_clock::now();
 
-                for (auto &searcher : _multi_searcher)
-                    results.push_back(searcher->search(queryVector, dimensions, (unsigned int)K, Ls));
                 diskann::SearchResult result = aggregate_results(K, results);
-                diskann::aligned_free(queryVector);
+                auto aggregatedTime = std::chrono::high_resolution_clock::now();
+
                 web::json::value response = prepareResponse(queryId, K);
                 response[INDICES_KEY] = idsToJsonArray(result);
                 response[DISTANCES_KEY] = distancesToJsonArray(result);
@@ -141,6 +179,18 @@ template <class T> void Server::handle_post(web::http::http_request message)
                                                std::chrono::high_resolution_clock::now() - startTime)
                                                .count();
 
+                // queue and search are the slowest shard's, so they need not add up to the total
+                web::json::value stage_times = web::json::value::object();
+                stage_times[PARSE_TIME_KEY] =
+                    std::chrono::duration_cast<std::chrono::microseconds>(parsedTime - startTime).count();
+                stage_times[QUEUE_TIME_KEY] = queue_time;
+                stage_times[SEARCH_TIME_KEY] = search_time;
+                stage_times[SHARD_SEARCH_TIMES_KEY] = shard_search_times;
+                stage_times[AGGREGATE_TIME_KEY] =
+                    std::chrono::duration_cast<std::chrono::microseconds>(aggregatedTime - searchedTime).count();
+                stage_times[BATCH_SIZE_KEY] = batch_size;
+                response[STAGE_TIMES_KEY] = stage_times;
+
                 std::cout << "Responding to: " << queryId << std::endl;
                 return std::make_pair(web::http::status_codes::OK, response);
             }
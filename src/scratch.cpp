@@ -2,7 +2,6 @@
 // Licensed under the MIT license.
 
 #include <vector>
-#include <boost/dynamic_bitset.hpp>
 
 #include "scratch.h"
 #include "pq_scratch.h"
@@ -34,9 +33,9 @@ InMemQueryScratch<T>::InMemQueryScratch(uint32_t search_l, uint32_t indexing_l,
         this->_pq_scratch = nullptr;
 
     _occlude_factor.reserve(maxc);
-    _inserted_into_pool_bs = new boost::dynamic_bitset<>();
     _id_scratch.reserve((size_t)std::ceil(1.5 * defaults::GRAPH_SLACK_FACTOR * _R));
     _dist_scratch.reserve((size_t)std::ceil(1.5 * defaults::GRAPH_SLACK_FACTOR * _R));
+    _nbr_copy.reserve((size_t)std::ceil(1.5 * defaults::GRAPH_SLACK_FACTOR * _R));
 
     resize_for_new_L(std::max(search_l, indexing_l));
 }
@@ -47,8 +46,7 @@ template <typename T> void InMemQueryScratch<T>::clear()
     _best_l_nodes.clear();
     _occlude_factor.clear();
 
-    _inserted_into_pool_rs.clear();
-    _inserted_into_pool_bs->reset();
+    _inserted_into_pool.clear();
 
     _id_scratch.clear();
     _dist_scratch.clear();
@@ -56,6 +54,7 @@ template <typename T> void InMemQueryScratch<T>::clear()
     _expanded_nodes_set.clear();
     _expanded_nghrs_vec.clear();
     _occlude_list_output.clear();
+    _nbr_copy.clear();
 }
 
 template <typename T> void InMemQueryScratch<T>::resize_for_new_L(uint32_t new_l)
@@ -65,8 +64,6 @@ template <typename T> void InMemQueryScratch<T>::resize_for_new_L(uint32_t new_l
         _L = new_l;
         _pool.reserve(3 * _L + _R);
         _best_l_nodes.reserve(_L);
-
-        _inserted_into_pool_rs.reserve(20 * _L);
     }
 }
 
@@ -79,7 +76,6 @@ template <typename T> InMemQueryScratch<T>::~InMemQueryScratch()
     }
 
     delete this->_pq_scratch;
-    delete _inserted_into_pool_bs;
 }
 
 //
@@ -96,27 +92,27 @@ template <typename T> void SSDQueryScratch<T>::reset()
 template <typename T> SSDQueryScratch<T>::SSDQueryScratch(size_t aligned_dim, size_t visited_reserve)
 {
     size_t coord_alloc_size = ROUND_UP(sizeof(T) * aligned_dim, 256);
+    size_t sector_alloc_size = defaults::MAX_N_SECTOR_READS * defaults::SECTOR_LEN;
 
-    diskann::alloc_aligned((void **)&coord_scratch, coord_alloc_size, 256);
-    diskann::alloc_aligned((void **)&sector_scratch, defaults::MAX_N_SECTOR_READS * defaults::SECTOR_LEN,
-                           defaults::SECTOR_LEN);
-    diskann::alloc_aligned((void **)&this->_aligned_query_T, aligned_dim * sizeof(T), 8 * sizeof(T));
+    _arena.reset(new ScratchArena(ScratchArena::footprint(coord_alloc_size, 256) +
+                                  ScratchArena::footprint(sector_alloc_size, defaults::SECTOR_LEN) +
+                                  ScratchArena::footprint(aligned_dim * sizeof(T), 8 * sizeof(T)) +
+                                  PQScratch<T>::arena_size(defaults::MAX_GRAPH_DEGREE, aligned_dim)));
+    coord_scratch = _arena->allocate_array<T>(coord_alloc_size / sizeof(T), 256);
+    sector_scratch = _arena->allocate_array<char>(sector_alloc_size, defaults::SECTOR_LEN);
+    this->_aligned_query_T = _arena->allocate_array<T>(aligned_dim, 8 * sizeof(T));
 
-    this->_pq_scratch = new PQScratch<T>(defaults::MAX_GRAPH_DEGREE, aligned_dim);
+    this->_pq_scratch = new PQScratch<T>(defaults::MAX_GRAPH_DEGREE, aligned_dim, _arena.get());
 
     memset(coord_scratch, 0, coord_alloc_size);
     memset(this->_aligned_query_T, 0, aligned_dim * sizeof(T));
 
-    visited.reserve(visited_reserve);
+    visited.configure(VisitedSetType::HASH, 0, visited_reserve);
     full_retset.reserve(visited_reserve);
 }
 
 template <typename T> SSDQueryScratch<T>::~SSDQueryScratch()
 {
-    diskann::aligned_free((void *)coord_scratch);
-    diskann::aligned_free((void *)sector_scratch);
-    diskann::aligned_free((void *)this->_aligned_query_T);
-
     delete this->_pq_scratch;
 }
 
@@ -130,14 +126,27 @@ template <typename T> void SSDThreadData<T>::clear()
     scratch.reset();
 }
 
-template <typename T> PQScratch<T>::PQScratch(size_t graph_degree, size_t aligned_dim)
+template <typename T> PQScratch<T>::PQScratch(size_t graph_degree, size_t aligned_dim, ScratchArena *arena)
 {
-    diskann::alloc_aligned((void **)&aligned_pq_coord_scratch,
-                           (size_t)graph_degree * (size_t)MAX_PQ_CHUNKS * sizeof(uint8_t), 256);
-    diskann::alloc_aligned((void **)&aligned_pqtable_dist_scratch, 256 * (size_t)MAX_PQ_CHUNKS * sizeof(float), 256);
-    diskann::alloc_aligned((void **)&aligned_dist_scratch, (size_t)graph_degree * sizeof(float), 256);
-    diskann::alloc_aligned((void **)&aligned_query_float, aligned_dim * sizeof(float), 8 * sizeof(float));
-    diskann::alloc_aligned((void **)&rotated_query, aligned_dim * sizeof(float), 8 * sizeof(float));
+    if (arena != nullptr)
+    {
+        _owns_buffers = false;
+        aligned_pq_coord_scratch = arena->allocate_array<uint8_t>(graph_degree * (size_t)MAX_PQ_CHUNKS, 256);
+        aligned_pqtable_dist_scratch = arena->allocate_array<float>(256 * (size_t)MAX_PQ_CHUNKS, 256);
+        aligned_dist_scratch = arena->allocate_array<float>(graph_degree, 256);
+        aligned_query_float = arena->allocate_array<float>(aligned_dim, 8 * sizeof(float));
+        rotated_query = arena->allocate_array<float>(aligned_dim, 8 * sizeof(float));
+    }
+    else
+    {
+        diskann::alloc_aligned((void **)&aligned_pq_coord_scratch,
+                               (size_t)graph_degree * (size_t)MAX_PQ_CHUNKS * sizeof(uint8_t), 256);
+        diskann::alloc_aligned((void **)&aligned_pqtable_dist_scratch, 256 * (size_t)MAX_PQ_CHUNKS * sizeof(float),
+                               256);
+        diskann::alloc_aligned((void **)&aligned_dist_scratch, (size_t)graph_degree * sizeof(float), 256);
+        diskann::alloc_aligned((void **)&aligned_query_float, aligned_dim * sizeof(float), 8 * sizeof(float));
+        diskann::alloc_aligned((void **)&rotated_query, aligned_dim * sizeof(float), 8 * sizeof(float));
+    }
 
     memset(aligned_query_float, 0, aligned_dim * sizeof(float));
     memset(rotated_query, 0, aligned_dim * sizeof(float));
@@ -145,6 +154,8 @@ template <typename T> PQScratch<T>::PQScratch(size_t graph_degree, size_t aligne
 
 template <typename T> PQScratch<T>::~PQScratch()
 {
+    if (!_owns_buffers)
+        return;
     diskann::aligned_free((void *)aligned_pq_coord_scratch);
     diskann::aligned_free((void *)aligned_pqtable_dist_scratch);
     diskann::aligned_free((void *)aligned_dist_scratch);
@@ -152,6 +163,14 @@ template <typename T> PQScratch<T>::~PQScratch()
     diskann::aligned_free((void *)rotated_query);
 }
 
+template <typename T> size_t PQScratch<T>::arena_size(size_t graph_degree, size_t aligned_dim)
+{
+    return ScratchArena::footprint(graph_degree * (size_t)MAX_PQ_CHUNKS, 256) +
+           ScratchArena::footprint(256 * (size_t)MAX_PQ_CHUNKS * sizeof(float), 256) +
+           ScratchArena::footprint(graph_degree * sizeof(float), 256) +
+           2 * ScratchArena::footprint(aligned_dim * sizeof(float), 8 * sizeof(float));
+}
+
 template <typename T> void PQScratch<T>::initialize(size_t dim, const T *query, const float norm)
 {
     for (size_t d = 0; d < dim; ++d)
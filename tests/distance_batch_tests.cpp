@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "distance.h"
+#include "utils.h"
+
+namespace
+{
+// compare_batch must give what compare gives per query, for query counts on and off the 4-query tile. Vectors are
+// stored the way the data store keeps them: 32-byte aligned and zero-padded to a multiple of 8 floats.
+void check_batch_matches_compare(const diskann::Distance<float> &distance)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> value_distribution(-1.0f, 1.0f);
+
+    for (uint32_t dim : {8, 13, 64, 100})
+    {
+        const uint32_t aligned_dim = (uint32_t)ROUND_UP(dim, 8);
+        for (uint32_t num_queries : {1, 3, 4, 7, 16})
+        {
+            float *vectors = nullptr;
+            diskann::alloc_aligned((void **)&vectors, (num_queries + 1) * aligned_dim * sizeof(float), 32);
+            std::memset(vectors, 0, (num_queries + 1) * aligned_dim * sizeof(float));
+            std::vector<const float *> queries;
+            for (uint32_t i = 0; i <= num_queries; i++)
+            {
+                for (uint32_t d = 0; d < dim; d++)
+                    vectors[i * aligned_dim + d] = value_distribution(generator);
+                if (i < num_queries)
+                    queries.push_back(vectors + i * aligned_dim);
+            }
+            const float *base = vectors + num_queries * aligned_dim;
+
+            std::vector<float> dists(num_queries);
+            distance.compare_batch(queries.data(), num_queries, base, aligned_dim, dists.data());
+            for (uint32_t i = 0; i < num_queries; i++)
+                BOOST_TEST(dists[i] == distance.compare(queries[i], base, aligned_dim),
+                           boost::test_tools::tolerance(1e-4f));
+            diskann::aligned_free(vectors);
+        }
+    }
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(DistanceBatch_tests)
+
+BOOST_AUTO_TEST_CASE(test_l2_float)
+{
+    check_batch_matches_compare(diskann::DistanceL2Float());
+}
+
+BOOST_AUTO_TEST_CASE(test_avx_inner_product_float)
+{
+    check_batch_matches_compare(diskann::AVXDistanceInnerProductFloat());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
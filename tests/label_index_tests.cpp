@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "label_index.h"
+
+namespace
+{
+const uint32_t num_points = 1000;
+const uint32_t universal_label = 0;
+const uint32_t unknown_label = 99;
+
+// label 1 on even points and label 3 on every 7th are dense enough for bitmaps, label 2 on every 100th stays a
+// sorted list; the last point carries only the universal label
+std::vector<std::vector<uint32_t>> make_point_labels()
+{
+    std::vector<std::vector<uint32_t>> point_labels(num_points);
+    for (uint32_t i = 0; i + 1 < num_points; i++)
+    {
+        if (i % 2 == 0)
+            point_labels[i].push_back(1);
+        if (i % 100 == 0)
+            point_labels[i].push_back(2);
+        if (i % 7 == 0)
+            point_labels[i].push_back(3);
+    }
+    point_labels[num_points - 1].push_back(universal_label);
+    return point_labels;
+}
+
+bool brute_force_matches(const std::vector<uint32_t> &labels, const diskann::LabelFilter<uint32_t> &filter)
+{
+    auto has = [&labels](uint32_t label) { return std::find(labels.begin(), labels.end(), label) != labels.end(); };
+    if (has(universal_label))
+        return true;
+    if (filter.match == diskann::LabelMatch::ALL)
+        return !filter.labels.empty() && std::all_of(filter.labels.begin(), filter.labels.end(), has);
+    return std::any_of(filter.labels.begin(), filter.labels.end(), has);
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(LabelIndex_tests)
+
+BOOST_AUTO_TEST_CASE(test_matches_brute_force)
+{
+    const auto point_labels = make_point_labels();
+    std::vector<uint32_t> offsets, counts, pts_to_labels;
+    for (const auto &labels : point_labels)
+    {
+        offsets.push_back((uint32_t)pts_to_labels.size());
+        counts.push_back((uint32_t)labels.size());
+        pts_to_labels.insert(pts_to_labels.end(), labels.begin(), labels.end());
+    }
+
+    diskann::LabelIndex<uint32_t> index;
+    index.build(num_points, offsets.data(), counts.data(), pts_to_labels.data());
+    BOOST_TEST(index.num_labels() == 4U);
+
+    const std::vector<std::vector<uint32_t>> label_sets = {{1}, {2}, {3}, {1, 2}, {1, 3}, {2, 3},
+                                                           {1, 2, 3}, {1, unknown_label}, {unknown_label}};
+    for (auto match : {diskann::LabelMatch::ANY, diskann::LabelMatch::ALL})
+    {
+        for (const auto &labels : label_sets)
+        {
+            const diskann::LabelFilter<uint32_t> filter(labels, match);
+            const diskann::LabelMatcher matcher = index.compile(filter, &universal_label);
+
+            std::vector<uint32_t> expected;
+            for (uint32_t i = 0; i < num_points; i++)
+            {
+                BOOST_REQUIRE(matcher.matches(i) == brute_force_matches(point_labels[i], filter));
+                if (brute_force_matches(point_labels[i], filter))
+                    expected.push_back(i);
+            }
+
+            std::vector<uint32_t> points;
+            index.get_matching_points(matcher, points);
+            BOOST_TEST(points == expected, boost::test_tools::per_element());
+            BOOST_TEST(matcher.max_matches() >= expected.size());
+        }
+    }
+
+    // without a universal label the last point matches nothing
+    const diskann::LabelMatcher matcher = index.compile(diskann::LabelFilter<uint32_t>(1), nullptr);
+    BOOST_TEST(matcher.matches(0));
+    BOOST_TEST(!matcher.matches(1));
+    BOOST_TEST(!matcher.matches(num_points - 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_repeated_label_on_a_point)
+{
+    // point 0 lists label 5 twice; with one point in 100 carrying it, its posting is a list that must hold 0 once
+    const size_t num_sparse_points = 100;
+    std::vector<uint32_t> offsets(num_sparse_points, 2), counts(num_sparse_points, 0);
+    offsets[0] = 0;
+    counts[0] = 2;
+    const std::vector<uint32_t> pts_to_labels = {5, 5};
+    diskann::LabelIndex<uint32_t> index;
+    index.build(num_sparse_points, offsets.data(), counts.data(), pts_to_labels.data());
+
+    std::vector<uint32_t> points;
+    index.get_matching_points(index.compile(diskann::LabelFilter<uint32_t>(5), nullptr), points);
+    BOOST_TEST(points == std::vector<uint32_t>({0}), boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,191 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "node_cache.h"
+
+namespace
+{
+// odd length, so records do not sit on word boundaries inside a shard
+const uint64_t node_len = 100;
+
+// a record whose every byte depends on both id and position, so a torn or misplaced copy is caught
+std::vector<char> make_record(uint32_t id)
+{
+    std::vector<char> record(node_len);
+    for (uint64_t i = 0; i < node_len; i++)
+        record[i] = (char)((id * 31 + i * 7) & 0xff);
+    return record;
+}
+
+bool holds(diskann::NodeCache &cache, uint32_t id)
+{
+    return cache.access(id, [](char *) {});
+}
+
+bool holds_record(diskann::NodeCache &cache, uint32_t id)
+{
+    const std::vector<char> expected = make_record(id);
+    bool intact = false;
+    const bool hit =
+        cache.access(id, [&](char *node_buf) { intact = std::memcmp(node_buf, expected.data(), node_len) == 0; });
+    return hit && intact;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(NodeCache_tests)
+
+BOOST_AUTO_TEST_CASE(test_hit_returns_inserted_bytes)
+{
+    diskann::NodeCache cache(64 * node_len, node_len, 4);
+
+    for (uint32_t id = 0; id < 32; id++)
+        cache.admit(id, make_record(id).data());
+    for (uint32_t id = 0; id < 32; id++)
+        BOOST_TEST(holds_record(cache, id));
+    BOOST_TEST(!holds(cache, 32));
+
+    // admitting a cached id again leaves its record alone
+    cache.admit(0, make_record(1).data());
+    BOOST_TEST(holds_record(cache, 0));
+}
+
+BOOST_AUTO_TEST_CASE(test_stays_within_budget)
+{
+    // the budget is not a whole number of records or of per-shard slots
+    const uint64_t budget_bytes = 50 * node_len + node_len / 2;
+    diskann::NodeCache cache(budget_bytes, node_len, 8);
+    BOOST_TEST(cache.capacity() * node_len <= budget_bytes);
+    BOOST_TEST(cache.capacity() > 0U);
+
+    // a rising request count per id keeps newer ids winning admission, so the cache keeps evicting
+    for (uint32_t id = 0; id < 2000; id++)
+    {
+        for (uint32_t r = 0; r < 1 + id % 8; r++)
+            holds(cache, id);
+        cache.admit(id, make_record(id).data());
+        BOOST_REQUIRE(cache.size() <= cache.capacity());
+    }
+    BOOST_TEST(cache.size() == cache.capacity());
+
+    uint64_t num_cached = 0;
+    for (uint32_t id = 0; id < 2000; id++)
+    {
+        if (holds(cache, id))
+        {
+            BOOST_TEST(holds_record(cache, id));
+            num_cached++;
+        }
+    }
+    BOOST_TEST(num_cached == cache.size());
+
+    // a budget below one record caches nothing
+    diskann::NodeCache tiny(node_len - 1, node_len);
+    BOOST_TEST(tiny.capacity() == 0U);
+    tiny.admit(1, make_record(1).data());
+    BOOST_TEST(tiny.size() == 0U);
+    BOOST_TEST(!holds(tiny, 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_admission_rejects_cold_key)
+{
+    // one shard of four slots; few enough requests that the sketch is never halved
+    diskann::NodeCache cache(4 * node_len, node_len, 1);
+    BOOST_REQUIRE(cache.capacity() == 4U);
+
+    const std::vector<uint32_t> hot = {10, 20, 30, 40};
+    for (uint32_t id : hot)
+        cache.admit(id, make_record(id).data());
+    for (uint32_t round = 0; round < 5; round++)
+        for (uint32_t id : hot)
+            BOOST_REQUIRE(holds(cache, id));
+
+    // a key never requested before does not displace a hot victim
+    const uint32_t cold = 1000;
+    cache.admit(cold, make_record(cold).data());
+    BOOST_TEST(!holds(cache, cold));
+    for (uint32_t id : hot)
+        BOOST_TEST(holds_record(cache, id));
+
+    // once it is requested more often than the victim it gets in, evicting exactly one hot key
+    for (uint32_t round = 0; round < 10; round++)
+        holds(cache, cold);
+    cache.admit(cold, make_record(cold).data());
+    BOOST_TEST(holds_record(cache, cold));
+    uint32_t num_hot_cached = 0;
+    for (uint32_t id : hot)
+        num_hot_cached += holds(cache, id) ? 1 : 0;
+    BOOST_TEST(num_hot_cached == 3U);
+    BOOST_TEST(cache.size() == 4U);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_access_and_admit)
+{
+    const uint32_t num_ids = 1024;
+    const int64_t num_ops = 64 * num_ids;
+
+    // room for every id: after all threads are done nothing may be missing or corrupted
+    {
+        diskann::NodeCache cache(8 * num_ids * node_len, node_len, 8);
+        std::atomic<uint64_t> num_corrupt{0};
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int64_t op = 0; op < num_ops; op++)
+        {
+            const uint32_t id = (uint32_t)((op * 7919) % num_ids);
+            const std::vector<char> record = make_record(id);
+            bool intact = true;
+            if (!cache.access(id, [&](char *node_buf) {
+                    intact = std::memcmp(node_buf, record.data(), node_len) == 0;
+                }))
+                cache.admit(id, record.data());
+            if (!intact)
+                num_corrupt++;
+        }
+        BOOST_TEST(num_corrupt.load() == 0U);
+        BOOST_TEST(cache.size() == (uint64_t)num_ids);
+        for (uint32_t id = 0; id < num_ids; id++)
+            BOOST_REQUIRE(holds_record(cache, id));
+    }
+
+    // under eviction pressure every hit must still see the record of the id it asked for
+    {
+        diskann::NodeCache cache(num_ids / 8 * node_len, node_len, 4);
+        std::atomic<uint64_t> num_corrupt{0}, num_hits{0};
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int64_t op = 0; op < num_ops; op++)
+        {
+            // skew the mix towards low ids so some stay hot
+            const uint32_t id = (uint32_t)((op * 7919) % num_ids) % (op % 2 == 0 ? 64 : num_ids);
+            const std::vector<char> record = make_record(id);
+            bool intact = true;
+            if (cache.access(id, [&](char *node_buf) {
+                    intact = std::memcmp(node_buf, record.data(), node_len) == 0;
+                }))
+                num_hits++;
+            else
+                cache.admit(id, record.data());
+            if (!intact)
+                num_corrupt++;
+        }
+        BOOST_TEST(num_corrupt.load() == 0U);
+        BOOST_TEST(num_hits.load() > 0U);
+        BOOST_TEST(cache.size() <= cache.capacity());
+        uint64_t num_cached = 0;
+        for (uint32_t id = 0; id < num_ids; id++)
+        {
+            if (holds(cache, id))
+            {
+                BOOST_REQUIRE(holds_record(cache, id));
+                num_cached++;
+            }
+        }
+        BOOST_TEST(num_cached == cache.size());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
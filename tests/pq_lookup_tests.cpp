@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "pq.h"
+
+namespace
+{
+// transposed buffers hold n_ids rounded up to a whole block
+size_t padded(size_t n_ids)
+{
+    return DIV_ROUND_UP(n_ids, PQ_TRANSPOSE_BLOCK) * PQ_TRANSPOSE_BLOCK;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(PQLookup_tests)
+
+BOOST_AUTO_TEST_CASE(test_transposed_matches_scalar)
+{
+    const size_t num_points = 500;
+    std::mt19937 generator(1234);
+    std::uniform_int_distribution<uint32_t> code_distribution(0, 255);
+    std::uniform_real_distribution<float> dist_distribution(0.0f, 10.0f);
+
+    // chunk counts with and without a multiple-of-4 tail, id counts on and off a block boundary
+    for (size_t n_chunks : {1, 7, 32, 33})
+    {
+        std::vector<uint8_t> all_coords(num_points * n_chunks);
+        for (auto &code : all_coords)
+            code = (uint8_t)code_distribution(generator);
+        std::vector<float> pq_dists(256 * n_chunks);
+        for (auto &dist : pq_dists)
+            dist = dist_distribution(generator);
+
+        for (size_t n_ids : {1, 8, 31, 32, 45, 64, 100})
+        {
+            std::vector<uint32_t> ids(n_ids);
+            for (auto &id : ids)
+                id = code_distribution(generator) % num_points;
+
+            std::vector<uint8_t> coords(n_ids * n_chunks);
+            diskann::aggregate_coords(ids, all_coords.data(), n_chunks, coords.data());
+            std::vector<float> dists;
+            diskann::pq_dist_lookup(coords.data(), n_ids, n_chunks, pq_dists.data(), dists);
+
+            std::vector<uint8_t> coords_transposed(padded(n_ids) * n_chunks, 0xff);
+            diskann::aggregate_coords_transposed(ids, all_coords.data(), n_chunks, coords_transposed.data());
+            for (size_t i = 0; i < n_ids; i++)
+            {
+                const uint8_t *block =
+                    coords_transposed.data() + (i / PQ_TRANSPOSE_BLOCK) * n_chunks * PQ_TRANSPOSE_BLOCK;
+                for (size_t chunk = 0; chunk < n_chunks; chunk++)
+                    BOOST_REQUIRE(block[chunk * PQ_TRANSPOSE_BLOCK + i % PQ_TRANSPOSE_BLOCK] ==
+                                  coords[i * n_chunks + chunk]);
+            }
+
+            // one guard slot past n_ids catches a lookup that writes its padding lanes
+            std::vector<float> dists_transposed(n_ids + 1, -1.0f);
+            diskann::pq_dist_lookup_transposed(coords_transposed.data(), n_ids, n_chunks, pq_dists.data(),
+                                               dists_transposed.data());
+            for (size_t i = 0; i < n_ids; i++)
+                BOOST_TEST(dists_transposed[i] == dists[i], boost::test_tools::tolerance(1e-5f));
+            BOOST_TEST(dists_transposed[n_ids] == -1.0f);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
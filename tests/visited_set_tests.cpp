@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <boost/test/unit_test.hpp>
+
+#include "visited_set.h"
+
+BOOST_AUTO_TEST_SUITE(VisitedSet_tests)
+
+BOOST_AUTO_TEST_CASE(test_auto_resolves_by_size)
+{
+    diskann::VisitedSet visited;
+
+    visited.configure(diskann::VisitedSetType::AUTO, 1000, 100);
+    BOOST_TEST((visited.type() == diskann::VisitedSetType::EPOCH));
+    BOOST_TEST((visited.requested_type() == diskann::VisitedSetType::AUTO));
+
+    visited.configure(diskann::VisitedSetType::AUTO, MAX_POINTS_FOR_EPOCH_VISITED + 1, 100);
+    BOOST_TEST((visited.type() == diskann::VisitedSetType::HASH));
+}
+
+BOOST_AUTO_TEST_CASE(test_hash)
+{
+    diskann::VisitedSet visited;
+    visited.configure(diskann::VisitedSetType::HASH, 0, 16);
+
+    for (uint32_t id = 0; id < 1000; id += 3)
+        BOOST_TEST(visited.insert(id));
+    for (uint32_t id = 0; id < 1000; id++)
+    {
+        BOOST_TEST(visited.contains(id) == (id % 3 == 0));
+        BOOST_TEST(visited.insert(id) == (id % 3 != 0));
+    }
+
+    visited.clear();
+    for (uint32_t id = 0; id < 1000; id++)
+        BOOST_TEST(!visited.contains(id));
+}
+
+BOOST_AUTO_TEST_CASE(test_epoch_clear_and_wraparound)
+{
+    const uint32_t num_points = 64;
+    diskann::VisitedSet visited;
+    visited.configure(diskann::VisitedSetType::EPOCH, num_points, 16);
+
+    // run past the 16-bit epoch counter several times; ids tagged in an earlier epoch must never look visited
+    for (uint32_t round = 0; round < 3 * 65536 + 10; round++)
+    {
+        const uint32_t id = round % num_points;
+        BOOST_REQUIRE(!visited.contains(id));
+        BOOST_REQUIRE(visited.insert(id));
+        BOOST_REQUIRE(!visited.insert(id));
+        BOOST_REQUIRE(!visited.contains((id + 1) % num_points));
+        visited.clear();
+    }
+
+    // an id left over from the epoch just before the counter wraps must be gone after the wrap
+    diskann::VisitedSet wrapping;
+    wrapping.configure(diskann::VisitedSetType::EPOCH, num_points, 16);
+    for (uint32_t round = 0; round < 65534; round++)
+        wrapping.clear();
+    for (uint32_t id = 0; id < num_points; id++)
+        wrapping.insert(id);
+    wrapping.clear();
+    for (uint32_t id = 0; id < num_points; id++)
+        BOOST_REQUIRE(!wrapping.contains(id));
+}
+
+BOOST_AUTO_TEST_CASE(test_bloom)
+{
+    const uint32_t num_inserted = 1000;
+    diskann::VisitedSet visited;
+    visited.configure(diskann::VisitedSetType::BLOOM, 0, num_inserted);
+
+    // insert() may report a false positive, but nothing inserted is ever missed
+    for (uint32_t id = 0; id < num_inserted; id++)
+        visited.insert(id * 7919);
+    for (uint32_t id = 0; id < num_inserted; id++)
+        BOOST_TEST(visited.contains(id * 7919));
+
+    // false positives stay near the designed rate
+    uint32_t false_positives = 0;
+    const uint32_t num_probes = 100000;
+    for (uint32_t id = 0; id < num_probes; id++)
+        false_positives += visited.contains(id * 7919 + 1) ? 1 : 0;
+    BOOST_TEST(false_positives < num_probes / 20);
+
+    visited.clear();
+    for (uint32_t id = 0; id < num_inserted; id++)
+        BOOST_TEST(!visited.contains(id * 7919));
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_queries_are_independent)
+{
+    const uint32_t num_points = 256;
+    for (auto type : {diskann::VisitedSetType::EPOCH, diskann::VisitedSetType::HASH})
+    {
+        // 40 queries need two mask words per point with EPOCH
+        for (uint32_t batch_size : {4U, 40U})
+        {
+            diskann::BatchVisitedSet visited;
+            visited.configure(type, num_points, 64, batch_size);
+            for (uint32_t round = 0; round < 3; round++)
+            {
+                // queries interleave their inserts, and each sees only its own
+                for (uint32_t id = 0; id < num_points; id++)
+                {
+                    for (uint32_t b = 0; b < batch_size; b++)
+                    {
+                        if ((id + round) % (b + 1) == 0)
+                            BOOST_REQUIRE(visited.insert(b, id));
+                    }
+                }
+                for (uint32_t id = 0; id < num_points; id++)
+                {
+                    for (uint32_t b = 0; b < batch_size; b++)
+                        BOOST_REQUIRE(visited.insert(b, id) == ((id + round) % (b + 1) != 0));
+                }
+                visited.clear();
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()